@@ -9,6 +9,8 @@
 #include "core/SimpleLogger.h"
 #include "core/ErrorHandler.h"
 #include "core/UpdateChecker.h"
+#include "core/StateManager.h"
+#include "core/StartupProfiler.h"
 #include <wx/wx.h>
 #include <wx/stackwalk.h>
 #include <wx/msw/debughlp.h>
@@ -17,6 +19,7 @@
 #include <sstream>
 #include <exception>
 #include <csignal>
+#include <thread>
 
 #ifdef __WXMSW__
 #include <windows.h>
@@ -132,11 +135,19 @@ bool FluidNCApp::OnInit()
     }
     
     LOG_INFO("=== FluidNC gCode Sender Application Starting ===");
+    StartupProfiler::Instance().Mark("application init");
+    
+    // Load settings and replay the state journal on a worker while the window
+    // is built; the GUI thread's first getInstance() waits for it if needed
+    std::thread([]() { StateManager::getInstance(); }).detach();
     
     try {
         LOG_INFO("Creating MainFrame...");
         // Create the main frame
         m_mainFrame = new MainFrame();
+        StartupProfiler::Instance().Mark("main frame constructed");
+        StateManager& state = StateManager::getInstance();
+        StartupProfiler::Instance().Record(std::string("settings read (") + state.getLoadFormat() + ")", state.getLoadTime());
         
         LOG_INFO("Showing MainFrame...");
         // Show the main window
@@ -163,6 +174,7 @@ bool FluidNCApp::OnInit()
 #endif
         
         LOG_INFO("MainFrame displayed successfully");
+        StartupProfiler::Instance().Mark("main frame shown");
         
         // Initialize and start update checking & analytics
         LOG_INFO("Initializing update checker and analytics...");
@@ -0,0 +1,156 @@
+/**
+ * core/AtomicFile.cpp
+ * Write-to-temporary, flush and rename
+ */
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <cstring>
+#endif
+
+#include "AtomicFile.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace AtomicFile {
+
+namespace {
+
+void setError(std::string* error, const std::string& message)
+{
+    if (error) *error = message;
+}
+
+} // namespace
+
+bool write(const std::filesystem::path& path, const Producer& produce, std::string* error)
+{
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(temporary.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        setError(error, "Cannot create " + temporary.string() + " (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+
+    auto sink = [&](const char* data, size_t size) {
+        while (size > 0) {
+            DWORD written = 0;
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1 << 30));
+            if (!WriteFile(file, data, chunk, &written, nullptr)) {
+                throw std::runtime_error("Cannot write " + temporary.string() + " (error " + std::to_string(GetLastError()) + ")");
+            }
+            data += written;
+            size -= written;
+        }
+    };
+    try {
+        produce(sink);
+    } catch (...) {
+        CloseHandle(file);
+        DeleteFileW(temporary.c_str());
+        throw;
+    }
+
+    // Data must be on the disk before the rename makes it the real file
+    bool ok = FlushFileBuffers(file) != 0;
+    DWORD lastError = GetLastError();
+    CloseHandle(file);
+
+    if (!ok) {
+        setError(error, "Cannot write " + temporary.string() + " (error " + std::to_string(lastError) + ")");
+        DeleteFileW(temporary.c_str());
+        return false;
+    }
+
+    if (!MoveFileExW(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        setError(error, "Cannot replace " + path.string() + " (error " + std::to_string(GetLastError()) + ")");
+        DeleteFileW(temporary.c_str());
+        return false;
+    }
+#else
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        setError(error, "Cannot create " + temporary.string() + ": " + std::strerror(errno));
+        return false;
+    }
+
+    auto sink = [&](const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("Cannot write " + temporary.string() + ": " + std::strerror(errno));
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    };
+    try {
+        produce(sink);
+    } catch (...) {
+        ::close(fd);
+        ::unlink(temporary.c_str());
+        throw;
+    }
+
+    // Data must be on the disk before the rename makes it the real file
+    bool ok = ::fsync(fd) == 0;
+    int lastError = errno;
+    ::close(fd);
+
+    if (!ok) {
+        setError(error, "Cannot write " + temporary.string() + ": " + std::strerror(lastError));
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        setError(error, "Cannot replace " + path.string() + ": " + std::strerror(errno));
+        ::unlink(temporary.c_str());
+        return false;
+    }
+
+    // Make the rename itself durable
+    std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+    int directoryFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd >= 0) {
+        ::fsync(directoryFd);
+        ::close(directoryFd);
+    }
+#endif
+
+    return true;
+}
+
+bool write(const std::filesystem::path& path, const std::string& contents, std::string* error)
+{
+    try {
+        return write(path, [&contents](const Sink& sink) { sink(contents.data(), contents.size()); }, error);
+    } catch (const std::exception& e) {
+        setError(error, e.what());
+        return false;
+    }
+}
+
+bool sync(std::FILE* file)
+{
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return ::fsync(fileno(file)) == 0;
+#endif
+}
+
+} // namespace AtomicFile
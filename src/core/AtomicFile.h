@@ -0,0 +1,41 @@
+/**
+ * core/AtomicFile.h
+ * Crash-safe replacement of files
+ * The new contents go to a temporary file next to the target, are flushed
+ * to the disk and then renamed over the target, so a power cut leaves either
+ * the old or the new file - never a truncated one. Append-only files use
+ * sync() to make each batch of appends durable.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <filesystem>
+#include <functional>
+
+namespace AtomicFile {
+
+/**
+ * Replaces 'path' with 'contents'. Callers writing the same path from
+ * several threads must serialize, as the temporary file name is fixed.
+ * Returns false (with a reason in 'error', if given) when the file could not
+ * be written; the previous file is then left untouched.
+ */
+bool write(const std::filesystem::path& path, const std::string& contents, std::string* error = nullptr);
+
+// Appends to the temporary file; throws std::runtime_error if that fails
+using Sink = std::function<void(const char* data, size_t size)>;
+using Producer = std::function<void(const Sink& sink)>;
+
+/**
+ * As above for contents too large to hold in memory: 'produce' writes them
+ * through the sink it is given. An exception from 'produce' (or the sink)
+ * removes the temporary file and propagates, leaving the previous file.
+ */
+bool write(const std::filesystem::path& path, const Producer& produce, std::string* error = nullptr);
+
+// Flushes the stdio buffers of 'file' and the OS cache behind them to the disk
+bool sync(std::FILE* file);
+
+} // namespace AtomicFile
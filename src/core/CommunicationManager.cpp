@@ -201,6 +201,18 @@ std::vector<float> CommunicationManager::GetWorkPosition(const std::string& mach
     return {0.0f, 0.0f, 0.0f}; // Default position
 }
 
+float CommunicationManager::GetFeedRate(const std::string& machineId) const
+{
+    std::lock_guard<std::mutex> lock(m_connectionsMutex);
+    
+    auto it = m_connections.find(machineId);
+    if (it != m_connections.end() && it->second->connected.load()) {
+        return it->second->client->getFeedRate();
+    }
+    
+    return 0.0f;
+}
+
 void CommunicationManager::DisconnectAll()
 {
     std::lock_guard<std::mutex> lock(m_connectionsMutex);
@@ -52,6 +52,7 @@ public:
     // Get current DRO data
     std::vector<float> GetMachinePosition(const std::string& machineId) const;
     std::vector<float> GetWorkPosition(const std::string& machineId) const;
+    float GetFeedRate(const std::string& machineId) const;
     
     // Cleanup
     void DisconnectAll();
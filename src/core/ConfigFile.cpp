@@ -0,0 +1,280 @@
+/**
+ * core/ConfigFile.cpp
+ * JSON/CBOR configuration load and save
+ */
+
+#include "ConfigFile.h"
+#include "AtomicFile.h"
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+namespace ConfigFile {
+
+namespace {
+
+std::atomic<Format> s_format(Format::JSON);
+
+// What a binary copy knows about its JSON file: the hash of the JSON text
+// it was written over, and whether that text holds the same data
+struct JsonRecord {
+    uint64_t hash = 0;
+    bool current = false;
+};
+
+// Records of the files this process has loaded or saved, by JSON path
+std::mutex s_recordsMutex;
+std::map<std::string, JsonRecord> s_records;
+
+uint64_t hashText(const std::string& text)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void remember(const std::filesystem::path& jsonPath, const JsonRecord& record)
+{
+    std::lock_guard<std::mutex> lock(s_recordsMutex);
+    s_records[jsonPath.string()] = record;
+}
+
+bool recall(const std::filesystem::path& jsonPath, JsonRecord& record)
+{
+    std::lock_guard<std::mutex> lock(s_recordsMutex);
+    auto it = s_records.find(jsonPath.string());
+    if (it == s_records.end()) {
+        return false;
+    }
+    record = it->second;
+    return true;
+}
+
+void setError(std::string* error, const std::string& message)
+{
+    if (error) *error = message;
+}
+
+bool readFile(const std::filesystem::path& path, std::string& contents)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+bool parseJson(const std::filesystem::path& path, const std::string& contents, nlohmann::json& data, std::string* error)
+{
+    try {
+        data = nlohmann::json::parse(contents);
+        return true;
+    } catch (const nlohmann::json::exception& e) {
+        setError(error, path.string() + ": " + e.what());
+        return false;
+    }
+}
+
+/**
+ * Reads a binary copy: {"jsonHash": n, "jsonCurrent": b, "data": ...}.
+ * Copies written before the record existed hold the data alone;
+ * 'hasRecord' is false for them.
+ */
+bool parseBinary(const std::filesystem::path& path, nlohmann::json& data, JsonRecord& record,
+                 bool& hasRecord, std::string* error)
+{
+    std::string contents;
+    if (!readFile(path, contents)) {
+        setError(error, "Cannot read " + path.string());
+        return false;
+    }
+    try {
+        nlohmann::json root = nlohmann::json::from_cbor(contents);
+        hasRecord = root.is_object() && root.size() == 3 && root.contains("data")
+                    && root.contains("jsonHash") && root["jsonHash"].is_number_unsigned()
+                    && root.contains("jsonCurrent") && root["jsonCurrent"].is_boolean();
+        if (hasRecord) {
+            record.hash = root["jsonHash"].get<uint64_t>();
+            record.current = root["jsonCurrent"].get<bool>();
+            data = std::move(root["data"]);
+        } else {
+            data = std::move(root);
+        }
+        return true;
+    } catch (const nlohmann::json::exception& e) {
+        setError(error, path.string() + ": " + e.what());
+        return false;
+    }
+}
+
+// Record for a binary copy about to be written without a JSON export
+JsonRecord recordForBinary(const std::filesystem::path& jsonPath)
+{
+    JsonRecord record;
+    if (!recall(jsonPath, record)) {
+        // Not loaded by this process - the JSON file as it is now
+        std::string text;
+        if (readFile(jsonPath, text)) {
+            record.hash = hashText(text);
+        }
+    }
+    record.current = false;
+    return record;
+}
+
+} // namespace
+
+void setFormat(Format format)
+{
+    s_format = format;
+}
+
+Format format()
+{
+    return s_format.load();
+}
+
+std::filesystem::path binaryPath(const std::filesystem::path& jsonPath)
+{
+    std::filesystem::path path = jsonPath;
+    path.replace_extension(".cbor");
+    return path;
+}
+
+bool load(const std::filesystem::path& jsonPath, nlohmann::json& data, std::string* error, Format* loadedFrom)
+{
+    std::filesystem::path binary = binaryPath(jsonPath);
+    std::error_code ec;
+    bool hasJson = std::filesystem::exists(jsonPath, ec);
+    bool hasBinary = std::filesystem::exists(binary, ec);
+    if (!hasJson && !hasBinary) {
+        setError(error, jsonPath.string() + " does not exist");
+        return false;
+    }
+    
+    std::string jsonText;
+    bool jsonRead = hasJson && readFile(jsonPath, jsonText);
+    uint64_t jsonHash = jsonRead ? hashText(jsonText) : 0;
+    
+    std::string binaryError;
+    if (hasBinary) {
+        nlohmann::json binaryData;
+        JsonRecord record;
+        bool hasRecord = false;
+        if (parseBinary(binary, binaryData, record, hasRecord, &binaryError)) {
+            // The binary copy wins unless the JSON file was replaced since
+            // it was written (edited, imported or restored from a backup)
+            bool jsonChanged;
+            if (hasRecord) {
+                jsonChanged = jsonRead && jsonHash != record.hash;
+            } else {
+                std::error_code jsonError, binaryTimeError;
+                auto jsonTime = std::filesystem::last_write_time(jsonPath, jsonError);
+                auto binaryTime = std::filesystem::last_write_time(binary, binaryTimeError);
+                jsonChanged = jsonRead && !jsonError && !binaryTimeError && jsonTime > binaryTime;
+                record.hash = jsonHash;
+                record.current = jsonRead && !jsonChanged && !jsonError && !binaryTimeError && jsonTime == binaryTime;
+            }
+            
+            if (!jsonChanged || !parseJson(jsonPath, jsonText, data, nullptr)) {
+                data = std::move(binaryData);
+                remember(jsonPath, record);
+                if (loadedFrom) *loadedFrom = Format::CBOR;
+                return true;
+            }
+            remember(jsonPath, JsonRecord{jsonHash, true});
+            if (loadedFrom) *loadedFrom = Format::JSON;
+            return true;
+        }
+    }
+    
+    if (!jsonRead) {
+        setError(error, hasJson ? "Cannot read " + jsonPath.string() : binaryError);
+        return false;
+    }
+    std::string jsonError;
+    if (!parseJson(jsonPath, jsonText, data, &jsonError)) {
+        setError(error, hasBinary ? binaryError : jsonError);
+        return false;
+    }
+    remember(jsonPath, JsonRecord{jsonHash, true});
+    if (loadedFrom) *loadedFrom = Format::JSON;
+    return true;
+}
+
+bool save(const std::filesystem::path& jsonPath, const nlohmann::json& data, std::string* error, bool exportJson)
+{
+    try {
+        Format current = format();
+        JsonRecord record;
+        if (exportJson || current == Format::JSON) {
+            std::string text = data.dump(2);
+            text += '\n';
+            if (!AtomicFile::write(jsonPath, text, error)) {
+                return false;
+            }
+            record.hash = hashText(text);
+            record.current = true;
+        } else {
+            record = recordForBinary(jsonPath);
+        }
+        
+        if (current == Format::JSON) {
+            // A binary copy left from CBOR mode would only go stale
+            std::error_code ec;
+            std::filesystem::remove(binaryPath(jsonPath), ec);
+        } else {
+            nlohmann::json root = {
+                {"jsonHash", record.hash},
+                {"jsonCurrent", record.current},
+                {"data", data}
+            };
+            std::vector<std::uint8_t> bytes = nlohmann::json::to_cbor(root);
+            if (!AtomicFile::write(binaryPath(jsonPath), std::string(bytes.begin(), bytes.end()), error)) {
+                return false;
+            }
+        }
+        remember(jsonPath, record);
+        return true;
+    } catch (const nlohmann::json::exception& e) {
+        // Strings that are not valid UTF-8 cannot be serialized
+        setError(error, jsonPath.string() + ": " + e.what());
+        return false;
+    }
+}
+
+bool isJsonCurrent(const std::filesystem::path& jsonPath)
+{
+    std::string text;
+    if (!readFile(jsonPath, text)) {
+        return false;
+    }
+    
+    JsonRecord record;
+    if (!recall(jsonPath, record)) {
+        nlohmann::json data;
+        bool hasRecord = false;
+        if (!parseBinary(binaryPath(jsonPath), data, record, hasRecord, nullptr) || !hasRecord) {
+            return true;  // No binary copy to be behind
+        }
+    }
+    
+    // A JSON file replaced behind our back is left alone - load() prefers it
+    return record.current || hashText(text) != record.hash;
+}
+
+const char* formatName(Format format)
+{
+    return format == Format::CBOR ? "CBOR" : "JSON";
+}
+
+} // namespace ConfigFile
@@ -0,0 +1,58 @@
+/**
+ * core/ConfigFile.h
+ * Configuration files with an optional binary runtime copy
+ * Configurations are pretty-printed JSON files (settings.json, macros.json,
+ * ...). With "configFormat": "cbor" they are stored as CBOR next to it
+ * (settings.cbor) instead, less than half the size. Loading is only about
+ * 10% faster and saving is no faster (ConfigFileBenchmark), so this is not
+ * the default. The JSON file stays the copy for humans: it is exported on
+ * shutdown. The binary copy records a hash of the JSON text it was written
+ * over, so a JSON file edited, imported or restored since then is the one
+ * that is loaded, whatever its time stamp.
+ */
+
+#pragma once
+
+#include <json.hpp>
+#include <string>
+#include <filesystem>
+
+namespace ConfigFile {
+
+enum class Format {
+    JSON,   // Pretty-printed JSON only
+    CBOR    // Binary runtime copy, JSON exported on request
+};
+
+// Format used by save(); JSON unless changed. Safe to call from any thread.
+void setFormat(Format format);
+Format format();
+
+// Binary copy that belongs to 'jsonPath' (settings.json -> settings.cbor)
+std::filesystem::path binaryPath(const std::filesystem::path& jsonPath);
+
+/**
+ * Reads the binary copy of 'jsonPath' into 'data', or the JSON file if it
+ * was changed since the binary copy was written or the copy cannot be
+ * parsed. 'loadedFrom', if given, receives
+ * the format that was read. Returns false (with a reason in 'error', if
+ * given) when neither file could be read.
+ */
+bool load(const std::filesystem::path& jsonPath, nlohmann::json& data,
+          std::string* error = nullptr, Format* loadedFrom = nullptr);
+
+/**
+ * Atomically writes 'data' in the current format. With 'exportJson' the JSON
+ * file is written as well. Saving in JSON format removes the binary copy.
+ * Callers writing the same path from several threads must serialize.
+ */
+bool save(const std::filesystem::path& jsonPath, const nlohmann::json& data,
+          std::string* error = nullptr, bool exportJson = false);
+
+// True if the JSON file exists and holds the binary copy's data, or was
+// changed since the copy was written (load() then prefers it anyway)
+bool isJsonCurrent(const std::filesystem::path& jsonPath);
+
+const char* formatName(Format format);
+
+} // namespace ConfigFile
@@ -0,0 +1,70 @@
+/**
+ * core/ConsoleCoalescer.cpp
+ * Implementation of console chatter collapsing
+ */
+
+#include "ConsoleCoalescer.h"
+
+ConsoleCoalescer::ConsoleCoalescer()
+{
+    Reset();
+}
+
+ConsoleCoalescer::Kind ConsoleCoalescer::Classify(ConsoleLevel level, const std::string& message)
+{
+    if (level == ConsoleLevel::LEVEL_SENT) {
+        return message == "> ?" ? Kind::STATUS_QUERY : Kind::SENT;
+    }
+
+    if (level == ConsoleLevel::LEVEL_RECV) {
+        if (message == "< ok") {
+            return Kind::ACK;
+        }
+        if (message.size() > 3 && message.compare(0, 3, "< <") == 0 && message.back() == '>') {
+            return Kind::STATUS_REPORT;
+        }
+    }
+
+    return Kind::NORMAL;
+}
+
+bool ConsoleCoalescer::FindRow(Kind kind, ConsoleLevel level, const ConsoleLogBuffer& buffer, uint64_t& sequence) const
+{
+    if (kind == Kind::NORMAL || kind == Kind::SENT) return false;
+
+    // A run whose row has been evicted simply starts over
+    int index = static_cast<int>(kind) - 1;
+    if (!m_open[index] || !buffer.Contains(m_rows[index])) return false;
+
+    const ConsoleLogRecord& record = buffer.At(m_rows[index]);
+    if (record.level != level || record.repeatCount == UINT32_MAX) return false;
+
+    sequence = m_rows[index];
+    return true;
+}
+
+void ConsoleCoalescer::OnAppended(Kind kind, uint64_t sequence)
+{
+    if (kind == Kind::NORMAL) {
+        // Anything else received ends the runs so the history keeps its shape around it
+        Reset();
+        return;
+    }
+    if (kind == Kind::SENT) {
+        // Sent lines and their acks alternate while streaming
+        return;
+    }
+
+    // Status chatter and acks interleave freely without breaking each other's runs
+    int index = static_cast<int>(kind) - 1;
+    m_rows[index] = sequence;
+    m_open[index] = true;
+}
+
+void ConsoleCoalescer::Reset()
+{
+    for (int i = 0; i < KIND_COUNT; ++i) {
+        m_rows[i] = 0;
+        m_open[i] = false;
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * core/ConsoleCoalescer.h
+ * Collapses high-rate console chatter into live-updating rows
+ * A machine polled for status answers with a near-identical <Idle|MPos:...>
+ * report several times per second, and streaming produces a burst of "ok"
+ * acknowledgements. Appending each one buries the interesting lines, so runs
+ * of these messages update a single row that carries a repeat counter.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "ConsoleLogBuffer.h"
+
+class ConsoleCoalescer
+{
+public:
+    // Message classes that may be collapsed
+    enum class Kind {
+        NORMAL,         // Always gets its own row and ends all runs
+        STATUS_QUERY,   // "> ?" realtime status request
+        STATUS_REPORT,  // "< <...>" status report
+        ACK,            // "< ok"
+        SENT            // Any other "> cmd": own row, but runs stay open, so
+                        // the acks of a streamed program collapse into one row
+    };
+
+    ConsoleCoalescer();
+
+    // Classifies a console message as logged by ConsolePanel ("> cmd", "< response")
+    static Kind Classify(ConsoleLevel level, const std::string& message);
+
+    // Returns true and sets 'sequence' when the message continues a run and
+    // should update that existing record instead of appending a new one
+    bool FindRow(Kind kind, ConsoleLevel level, const ConsoleLogBuffer& buffer, uint64_t& sequence) const;
+
+    // Must be called for every record appended to the buffer
+    void OnAppended(Kind kind, uint64_t sequence);
+
+    // Forget all open runs (buffer cleared, machine switched)
+    void Reset();
+
+private:
+    static const int KIND_COUNT = 3;  // Collapsible kinds, STATUS_QUERY..ACK
+
+    // Row currently collecting each collapsible kind, if a run is open
+    uint64_t m_rows[KIND_COUNT];
+    bool m_open[KIND_COUNT];
+};
@@ -0,0 +1,23 @@
+/**
+ * core/ConsoleIngestQueue.cpp
+ * Implementation of the console ingestion queue
+ */
+
+#include "ConsoleIngestQueue.h"
+#include <utility>
+
+bool ConsoleIngestQueue::Push(ConsoleIngestEntry entry)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool wasEmpty = m_entries.empty();
+    m_entries.push_back(std::move(entry));
+    return wasEmpty;
+}
+
+void ConsoleIngestQueue::Drain(std::vector<ConsoleIngestEntry>& entries)
+{
+    entries.clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.swap(entries);
+}
@@ -0,0 +1,36 @@
+/**
+ * core/ConsoleIngestQueue.h
+ * Multi-producer, single-consumer hand-off of console entries
+ * The communication threads push lines as they arrive; the GUI thread takes
+ * everything queued so far in one swap and commits it as a single batch.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ConsoleLogBuffer.h"
+
+struct ConsoleIngestEntry {
+    uint32_t timeOfDay = 0;   // Captured when the line arrived, not when it is drained
+    ConsoleLevel level = ConsoleLevel::LEVEL_INFO;
+    std::string message;
+};
+
+class ConsoleIngestQueue
+{
+public:
+    // Safe from any thread. Returns true when the queue was empty, meaning the
+    // consumer has not been woken for this batch yet.
+    bool Push(ConsoleIngestEntry entry);
+
+    // Consumer only. Replaces 'entries' with everything queued so far; the
+    // vectors are swapped so steady-state draining does not allocate.
+    void Drain(std::vector<ConsoleIngestEntry>& entries);
+
+private:
+    std::mutex m_mutex;
+    std::vector<ConsoleIngestEntry> m_entries;
+};
@@ -0,0 +1,226 @@
+/**
+ * core/ConsoleLogBuffer.cpp
+ * Implementation of the console history ring buffer
+ */
+
+#include "ConsoleLogBuffer.h"
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+ConsoleLevel ParseConsoleLevel(const std::string& level)
+{
+    if (level == "INFO") return ConsoleLevel::LEVEL_INFO;
+    if (level == "WARN" || level == "WARNING") return ConsoleLevel::LEVEL_WARN;
+    if (level == "ERROR") return ConsoleLevel::LEVEL_ERROR;
+    if (level == "SENT") return ConsoleLevel::LEVEL_SENT;
+    if (level == "RECV") return ConsoleLevel::LEVEL_RECV;
+    if (level == "DEBUG") return ConsoleLevel::LEVEL_DEBUG;
+    return ConsoleLevel::LEVEL_INFO;
+}
+
+const char* ConsoleLevelName(ConsoleLevel level)
+{
+    switch (level) {
+        case ConsoleLevel::LEVEL_INFO:  return "INFO";
+        case ConsoleLevel::LEVEL_WARN:  return "WARN";
+        case ConsoleLevel::LEVEL_ERROR: return "ERROR";
+        case ConsoleLevel::LEVEL_SENT:  return "SENT";
+        case ConsoleLevel::LEVEL_RECV:  return "RECV";
+        case ConsoleLevel::LEVEL_DEBUG: return "DEBUG";
+        default:                        return "INFO";
+    }
+}
+
+namespace {
+
+int CountTrailingZeros(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int count = 0;
+    while ((value & 1) == 0) {
+        value >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+} // namespace
+
+ConsoleLogBuffer::ConsoleLogBuffer(size_t capacity)
+    : m_capacity(std::max<size_t>(capacity, 1)), m_base(0), m_first(0), m_end(0)
+{
+    // Handle 0 is always the empty string so default-initialized records are valid
+    m_strings.push_back(std::string());
+    m_stringLookup[std::string()] = 0;
+}
+
+uint64_t ConsoleLogBuffer::Append(uint32_t timeOfDay, ConsoleLevel level, Handle machine, const std::string& message)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+    uint64_t sequence = m_end++;
+    size_t slot = SlotFor(sequence);
+
+    if (m_slots.size() < m_capacity) {
+        // Still filling up - grow the storage and the bitsets with it
+        m_slots.emplace_back();
+        size_t words = (m_slots.size() + 63) / 64;
+        for (auto& bits : m_levelBits) {
+            if (bits.size() < words) {
+                bits.resize(words, 0);
+            }
+        }
+    } else {
+        // Full - the slot we are about to reuse holds the oldest record
+        m_first++;
+        SetLevelBit(slot, m_slots[slot].level, false);
+    }
+
+    // Reusing the slot keeps the old string's capacity, so steady-state appends don't allocate
+    ConsoleLogRecord& record = m_slots[slot];
+    record.sequence = sequence;
+    record.timeOfDay = timeOfDay;
+    record.level = level;
+    record.machine = machine;
+    record.repeatCount = 1;
+    record.message.assign(message);
+    SetLevelBit(slot, level, true);
+
+    return sequence;
+}
+
+bool ConsoleLogBuffer::Update(uint64_t sequence, uint32_t timeOfDay, const std::string& message, uint32_t repeatCount)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+    if (!Contains(sequence)) {
+        return false;
+    }
+
+    ConsoleLogRecord& record = m_slots[SlotFor(sequence)];
+    record.timeOfDay = timeOfDay;
+    record.repeatCount = repeatCount;
+    record.message.assign(message);
+    return true;
+}
+
+void ConsoleLogBuffer::Clear()
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+    m_slots.clear();
+    for (auto& bits : m_levelBits) {
+        bits.clear();
+    }
+    m_base = m_end;
+    m_first = m_end;
+}
+
+const ConsoleLogRecord& ConsoleLogBuffer::At(uint64_t sequence) const
+{
+    return m_slots[SlotFor(sequence)];
+}
+
+void ConsoleLogBuffer::SetLevelBit(size_t slot, ConsoleLevel level, bool set)
+{
+    uint64_t& word = m_levelBits[static_cast<int>(level)][slot / 64];
+    uint64_t bit = uint64_t(1) << (slot % 64);
+    if (set) {
+        word |= bit;
+    } else {
+        word &= ~bit;
+    }
+}
+
+void ConsoleLogBuffer::ScanRange(uint64_t from, uint64_t to, ConsoleLevelMask levelMask,
+                                 const RecordVisitor& visitor) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+    from = std::max(from, m_first);
+    to = std::min(to, m_end);
+
+    while (from < to) {
+        // Walk one physically contiguous run of slots at a time (the ring may wrap)
+        size_t slotBegin = SlotFor(from);
+        size_t span = static_cast<size_t>(std::min<uint64_t>(to - from, m_capacity - slotBegin));
+        size_t slotEnd = slotBegin + span;
+
+        for (size_t word = slotBegin / 64; word * 64 < slotEnd; ++word) {
+            uint64_t bits = 0;
+            for (int level = 0; level < static_cast<int>(ConsoleLevel::LEVEL_COUNT); ++level) {
+                if (levelMask & (1u << level)) {
+                    bits |= m_levelBits[level][word];
+                }
+            }
+
+            // Mask off slots outside [slotBegin, slotEnd)
+            size_t wordStart = word * 64;
+            if (slotBegin > wordStart) {
+                bits &= ~uint64_t(0) << (slotBegin - wordStart);
+            }
+            if (slotEnd < wordStart + 64) {
+                bits &= (uint64_t(1) << (slotEnd - wordStart)) - 1;
+            }
+
+            while (bits) {
+                size_t slot = wordStart + CountTrailingZeros(bits);
+                visitor(m_slots[slot]);
+                bits &= bits - 1;
+            }
+        }
+
+        from += span;
+    }
+}
+
+void ConsoleLogBuffer::ScanSequences(const uint64_t* sequences, size_t count, const RecordVisitor& visitor) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (Contains(sequences[i])) {
+            visitor(At(sequences[i]));
+        }
+    }
+}
+
+ConsoleLogBuffer::Handle ConsoleLogBuffer::Intern(const std::string& text)
+{
+    auto it = m_stringLookup.find(text);
+    if (it != m_stringLookup.end()) {
+        return it->second;
+    }
+
+    // Handle space exhausted - fold everything else onto the empty string
+    if (m_strings.size() > 0xFFFF) {
+        return 0;
+    }
+
+    Handle handle = static_cast<Handle>(m_strings.size());
+    m_strings.push_back(text);
+    m_stringLookup[text] = handle;
+    return handle;
+}
+
+const std::string& ConsoleLogBuffer::Lookup(Handle handle) const
+{
+    return handle < m_strings.size() ? m_strings[handle] : m_strings[0];
+}
+
+uint32_t ConsoleLogBuffer::MakeTimeOfDay(int hour, int minute, int second)
+{
+    return static_cast<uint32_t>(hour * 3600 + minute * 60 + second);
+}
+
+std::string ConsoleLogBuffer::FormatTimeOfDay(uint32_t timeOfDay)
+{
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "%02u:%02u:%02u",
+                  (timeOfDay / 3600) % 24, (timeOfDay / 60) % 60, timeOfDay % 60);
+    return buffer;
+}
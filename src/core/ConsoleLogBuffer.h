@@ -0,0 +1,118 @@
+/**
+ * core/ConsoleLogBuffer.h
+ * Fixed-capacity ring buffer holding the terminal console history
+ * Entries are stored compactly (level enum, interned machine id, packed time of day)
+ * so the console can retain a very long history at constant cost per append.
+ * Per-level bitsets let filters skip whole words of hidden entries at once.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <shared_mutex>
+
+// Console message levels - stored as one byte per record instead of a string
+enum class ConsoleLevel : uint8_t {
+    LEVEL_INFO,
+    LEVEL_WARN,
+    LEVEL_ERROR,
+    LEVEL_SENT,
+    LEVEL_RECV,
+    LEVEL_DEBUG,
+    LEVEL_COUNT
+};
+
+// Bit mask of ConsoleLevel values
+using ConsoleLevelMask = uint32_t;
+const ConsoleLevelMask CONSOLE_ALL_LEVELS = (1u << static_cast<int>(ConsoleLevel::LEVEL_COUNT)) - 1;
+
+inline ConsoleLevelMask ConsoleLevelBit(ConsoleLevel level) { return 1u << static_cast<int>(level); }
+
+// Conversion from/to the level strings used by the logging API ("INFO", "WARN", ...)
+ConsoleLevel ParseConsoleLevel(const std::string& level);
+const char* ConsoleLevelName(ConsoleLevel level);
+
+/**
+ * Single console history record.
+ * The sequence number is assigned on append and is never reused, so views can
+ * refer to entries by sequence even after older entries have been overwritten.
+ */
+struct ConsoleLogRecord {
+    uint64_t sequence = 0;    // Monotonic id assigned by the buffer
+    uint32_t timeOfDay = 0;   // Seconds since local midnight
+    ConsoleLevel level = ConsoleLevel::LEVEL_INFO;
+    uint16_t machine = 0;     // Interned machine id
+    uint32_t repeatCount = 1; // >1 when repeated messages were collapsed into this record
+    std::string message;
+};
+
+/**
+ * Ring buffer of console records.
+ * Only one thread (the GUI thread) appends; it may read without locking.
+ * Other threads (the search worker) must go through the Scan* methods, which
+ * hold a shared lock while visiting records.
+ */
+class ConsoleLogBuffer
+{
+public:
+    using Handle = uint16_t;
+    using RecordVisitor = std::function<void(const ConsoleLogRecord& record)>;
+
+    static constexpr size_t DEFAULT_CAPACITY = 1u << 20; // ~1M entries
+
+    explicit ConsoleLogBuffer(size_t capacity = DEFAULT_CAPACITY);
+
+    // Appends a record, overwriting the oldest one once the buffer is full.
+    // Returns the sequence number assigned to the new record.
+    uint64_t Append(uint32_t timeOfDay, ConsoleLevel level, Handle machine, const std::string& message);
+    // Rewrites a retained record in place (used for collapsed, live-updating rows)
+    bool Update(uint64_t sequence, uint32_t timeOfDay, const std::string& message, uint32_t repeatCount);
+    void Clear();
+
+    // Size and sequence range of the retained records: [FirstSequence(), EndSequence())
+    size_t Size() const { return static_cast<size_t>(m_end - m_first); }
+    size_t Capacity() const { return m_capacity; }
+    bool Empty() const { return m_end == m_first; }
+    uint64_t FirstSequence() const { return m_first; }
+    uint64_t EndSequence() const { return m_end; }
+    bool Contains(uint64_t sequence) const { return sequence >= m_first && sequence < m_end; }
+
+    // Record access by sequence number (caller must check Contains())
+    const ConsoleLogRecord& At(uint64_t sequence) const;
+
+    // Thread-safe scans. Visits, in sequence order, the retained records in
+    // [from, to) whose level is in levelMask, using the per-level bitsets.
+    void ScanRange(uint64_t from, uint64_t to, ConsoleLevelMask levelMask, const RecordVisitor& visitor) const;
+    // Visits the given (ascending) sequences that are still retained
+    void ScanSequences(const uint64_t* sequences, size_t count, const RecordVisitor& visitor) const;
+
+    // String interning for machine ids
+    Handle Intern(const std::string& text);
+    const std::string& Lookup(Handle handle) const;
+
+    // Helpers for the packed time of day
+    static uint32_t MakeTimeOfDay(int hour, int minute, int second);
+    static std::string FormatTimeOfDay(uint32_t timeOfDay);
+
+private:
+    size_t SlotFor(uint64_t sequence) const { return static_cast<size_t>((sequence - m_base) % m_capacity); }
+    void SetLevelBit(size_t slot, ConsoleLevel level, bool set);
+
+    std::vector<ConsoleLogRecord> m_slots;  // Grows lazily up to m_capacity, then wraps
+    size_t m_capacity;
+    uint64_t m_base;   // Sequence stored in slot 0 since the last Clear()
+    uint64_t m_first;  // Oldest retained sequence
+    uint64_t m_end;    // Next sequence to assign
+
+    // One bit per slot for each level
+    std::vector<uint64_t> m_levelBits[static_cast<int>(ConsoleLevel::LEVEL_COUNT)];
+
+    mutable std::shared_mutex m_mutex;
+
+    std::vector<std::string> m_strings;
+    std::unordered_map<std::string, Handle> m_stringLookup;
+};
@@ -0,0 +1,148 @@
+/**
+ * core/ConsoleSearch.cpp
+ * Implementation of the background console search
+ */
+
+#include "ConsoleSearch.h"
+#include "SubstringFinder.h"
+#include <algorithm>
+
+// Compiled form of the query text, shared by ConsoleQuery copies
+struct ConsoleQuery::Pattern {
+    explicit Pattern(const std::string& pattern)
+        : finder(pattern, true) {}
+
+    SubstringFinder finder;
+    std::regex regex;
+};
+
+ConsoleQuery::ConsoleQuery()
+    : m_regex(false), m_valid(true), m_levelMask(CONSOLE_ALL_LEVELS)
+{
+}
+
+ConsoleQuery::ConsoleQuery(const std::string& text, bool regex, ConsoleLevelMask levelMask)
+    : m_text(text), m_regex(regex), m_valid(true), m_levelMask(levelMask)
+{
+    if (m_text.empty()) {
+        return;
+    }
+
+    try {
+        auto pattern = std::make_shared<Pattern>(m_text);
+        if (m_regex) {
+            pattern->regex = std::regex(m_text, std::regex::ECMAScript | std::regex::optimize);
+        }
+        m_pattern = pattern;
+    } catch (const std::regex_error&) {
+        m_valid = false;
+    }
+}
+
+bool ConsoleQuery::Matches(const ConsoleLogRecord& record) const
+{
+    if (!(m_levelMask & ConsoleLevelBit(record.level))) return false;
+    return MatchesText(record.message);
+}
+
+bool ConsoleQuery::MatchesText(const std::string& message) const
+{
+    if (m_text.empty()) return true;
+    if (!m_valid || !m_pattern) return false;
+
+    if (m_regex) {
+        return std::regex_search(message, m_pattern->regex);
+    }
+
+    return m_pattern->finder.Contains(message);
+}
+
+bool ConsoleQuery::Refines(const ConsoleQuery& previous) const
+{
+    if (!m_valid || !previous.m_valid) return false;
+
+    // Levels may only be removed
+    if ((m_levelMask & ~previous.m_levelMask) != 0) return false;
+
+    if (previous.m_text.empty()) return true;
+    if (m_regex || previous.m_regex) {
+        return m_regex == previous.m_regex && m_text == previous.m_text;
+    }
+
+    // A longer substring containing the previous one can only match fewer records
+    return m_text.find(previous.m_text) != std::string::npos;
+}
+
+ConsoleSearch::ConsoleSearch(const ConsoleLogBuffer& buffer)
+    : m_buffer(buffer), m_worker("ConsoleSearch")
+{
+}
+
+uint64_t ConsoleSearch::Start(const ConsoleQuery& query, uint64_t endSequence,
+                              std::shared_ptr<const std::vector<uint64_t>> candidates,
+                              ResultCallback callback)
+{
+    Job job;
+    job.query = query;
+    job.startSequence = m_buffer.FirstSequence();
+    job.endSequence = endSequence;
+    job.candidates = candidates;
+    job.callback = callback;
+
+    return m_worker.Post([this, job](uint64_t generation) mutable {
+        job.generation = generation;
+        RunJob(job);
+    });
+}
+
+void ConsoleSearch::Cancel()
+{
+    m_worker.Cancel();
+}
+
+void ConsoleSearch::RunJob(const Job& job)
+{
+    std::vector<uint64_t> batch;
+    auto collect = [&batch, &job](const ConsoleLogRecord& record) {
+        if (job.query.MatchesText(record.message)) {
+            batch.push_back(record.sequence);
+        }
+    };
+
+    auto flush = [&batch, &job]() {
+        if (!batch.empty()) {
+            job.callback(job.generation, std::move(batch), false);
+            batch = std::vector<uint64_t>();
+        }
+    };
+
+    if (job.candidates) {
+        // Incremental refinement - only re-check the previous matches
+        const std::vector<uint64_t>& candidates = *job.candidates;
+        for (size_t offset = 0; offset < candidates.size(); offset += CHUNK_SIZE) {
+            if (IsCancelled(job)) return;
+
+            size_t count = std::min(CHUNK_SIZE, candidates.size() - offset);
+            m_buffer.ScanSequences(candidates.data() + offset, count,
+                [&job, &collect](const ConsoleLogRecord& record) {
+                    if (job.query.GetLevelMask() & ConsoleLevelBit(record.level)) {
+                        collect(record);
+                    }
+                });
+            flush();
+        }
+    } else {
+        // Full scan - the level bitsets skip hidden records without touching them
+        for (uint64_t from = job.startSequence; from < job.endSequence; from += CHUNK_SIZE) {
+            if (IsCancelled(job)) return;
+
+            uint64_t to = std::min<uint64_t>(from + CHUNK_SIZE, job.endSequence);
+            m_buffer.ScanRange(from, to, job.query.GetLevelMask(), collect);
+            flush();
+        }
+    }
+
+    if (!IsCancelled(job)) {
+        job.callback(job.generation, std::vector<uint64_t>(), true);
+    }
+}
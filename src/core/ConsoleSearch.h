@@ -0,0 +1,91 @@
+/**
+ * core/ConsoleSearch.h
+ * Background filtering/search over the console history
+ * Queries run on a worker thread and stream matching sequence numbers back in
+ * batches, so changing the console filter never blocks the GUI thread
+ */
+
+#pragma once
+
+#include "ConsoleLogBuffer.h"
+#include "LatestRequestWorker.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <regex>
+#include <functional>
+
+/**
+ * Compiled console filter: visible levels plus an optional substring or regex.
+ * Cheap to copy - the compiled pattern is shared.
+ */
+class ConsoleQuery
+{
+public:
+    ConsoleQuery();
+    ConsoleQuery(const std::string& text, bool regex, ConsoleLevelMask levelMask);
+
+    bool IsValid() const { return m_valid; }
+    bool HasText() const { return !m_text.empty(); }
+    bool IsRegex() const { return m_regex; }
+    const std::string& GetText() const { return m_text; }
+    ConsoleLevelMask GetLevelMask() const { return m_levelMask; }
+
+    // True if this query hides nothing
+    bool IsEmpty() const { return m_text.empty() && m_levelMask == CONSOLE_ALL_LEVELS; }
+
+    bool Matches(const ConsoleLogRecord& record) const;
+    bool MatchesText(const std::string& message) const;
+
+    // True if every record matching this query also matches 'previous', so the
+    // previous result set can be searched instead of the whole history
+    bool Refines(const ConsoleQuery& previous) const;
+
+private:
+    struct Pattern;
+
+    std::string m_text;
+    bool m_regex;
+    bool m_valid;
+    ConsoleLevelMask m_levelMask;
+    std::shared_ptr<const Pattern> m_pattern;
+};
+
+class ConsoleSearch
+{
+public:
+    // Called on the worker thread; GUI code must marshal to the main thread
+    using ResultCallback = std::function<void(uint64_t generation, std::vector<uint64_t> matches, bool finished)>;
+
+    explicit ConsoleSearch(const ConsoleLogBuffer& buffer);
+
+    // Starts a search over records older than endSequence, cancelling any search
+    // in progress. If candidates is non-null only those sequences are checked
+    // (incremental refinement of a previous result). Returns the generation id
+    // that will be passed to the callback. Must be called on the thread that
+    // appends to the buffer.
+    uint64_t Start(const ConsoleQuery& query, uint64_t endSequence,
+                   std::shared_ptr<const std::vector<uint64_t>> candidates,
+                   ResultCallback callback);
+    void Cancel();
+
+private:
+    struct Job {
+        uint64_t generation = 0;
+        ConsoleQuery query;
+        uint64_t startSequence = 0;
+        uint64_t endSequence = 0;
+        std::shared_ptr<const std::vector<uint64_t>> candidates;
+        ResultCallback callback;
+    };
+
+    void RunJob(const Job& job);
+    bool IsCancelled(const Job& job) const { return m_worker.IsCancelled(job.generation); }
+
+    // Records visited per lock acquisition / result batch
+    static constexpr size_t CHUNK_SIZE = 4096;
+
+    const ConsoleLogBuffer& m_buffer;
+
+    LatestRequestWorker m_worker;
+};
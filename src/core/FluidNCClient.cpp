@@ -24,7 +24,7 @@
 FluidNCClient::FluidNCClient(const std::string& host, int port, DROCallback droCallback)
     : m_host(host), m_port(port),
       m_connected(false), m_autoReconnect(false), m_running(false),
-      m_machinePos(3, 0.0f), m_workPos(3, 0.0f),
+      m_machinePos(3, 0.0f), m_workPos(3, 0.0f), m_feedRate(0.0f),
       m_droCallback(droCallback),
       m_networkManager(NetworkManager::getInstance())
 {
@@ -105,6 +105,12 @@ std::vector<float> FluidNCClient::getWorkPosition() const
     return m_workPos;
 }
 
+float FluidNCClient::getFeedRate() const
+{
+    std::lock_guard<std::mutex> lock(m_droMutex);
+    return m_feedRate;
+}
+
 void FluidNCClient::rxLoop()
 {
     LOG_INFO("FluidNCClient::rxLoop() - Starting receive loop");
@@ -309,8 +315,9 @@ void FluidNCClient::handleLine(const std::string& line)
         std::stringstream ss(content);
         std::string part;
         
-        bool mposUpdated = false, wposUpdated = false;
+        bool mposUpdated = false, wposUpdated = false, feedUpdated = false;
         std::vector<float> newMPos, newWPos;
+        float newFeedRate = 0.0f;
         
         while (std::getline(ss, part, '|')) {
             if (part.substr(0, 5) == "MPos:") {
@@ -343,6 +350,20 @@ void FluidNCClient::handleLine(const std::string& line)
                 }
                 wposUpdated = !newWPos.empty();
             }
+            else if (part.substr(0, 3) == "FS:" || part.substr(0, 2) == "F:") {
+                // FS:feed,spindle or F:feed - only the feed is needed
+                try {
+                    newFeedRate = std::stof(part.substr(part.find(':') + 1));
+                    feedUpdated = true;
+                } catch (...) {
+                    // Ignore parse errors
+                }
+            }
+        }
+        
+        if (feedUpdated) {
+            std::lock_guard<std::mutex> lock(m_droMutex);
+            m_feedRate = newFeedRate;
         }
         
         // Update stored positions and call callback
@@ -60,6 +60,8 @@ public:
     // Current position access (thread-safe)
     std::vector<float> getMachinePosition() const;
     std::vector<float> getWorkPosition() const;
+    // Current feed from the FS: (or F:) field of the last status report
+    float getFeedRate() const;
 
 private:
     void rxLoop();      // Receive thread
@@ -89,6 +91,7 @@ private:
     mutable std::mutex m_droMutex;
     std::vector<float> m_machinePos;
     std::vector<float> m_workPos;
+    float m_feedRate;
 
     // Callbacks
     DROCallback m_droCallback;
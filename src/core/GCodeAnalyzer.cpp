@@ -0,0 +1,99 @@
+/**
+ * core/GCodeAnalyzer.cpp
+ * Implementation of the background G-code analysis
+ */
+
+#include "GCodeAnalyzer.h"
+
+namespace {
+
+// Thrown from the parser's progress callback to abandon a superseded analysis
+struct AnalysisCancelled {};
+
+} // namespace
+
+GCodeAnalyzer::GCodeAnalyzer(ResultCallback callback)
+    : m_callback(callback), m_worker("GCodeAnalyzer")
+{
+}
+
+uint64_t GCodeAnalyzer::Start(std::shared_ptr<const std::string> text)
+{
+    return m_worker.Post([this, text](uint64_t generation) {
+        Run(*text, generation);
+    });
+}
+
+void GCodeAnalyzer::Cancel()
+{
+    m_worker.Cancel();
+}
+
+void GCodeAnalyzer::Run(const std::string& text, uint64_t generation)
+{
+    auto analysis = std::make_shared<GCodeAnalysis>();
+    analysis->generation = generation;
+
+    bool complete = Analyze(text, *analysis, [this, generation]() {
+        return m_worker.IsCancelled(generation);
+    });
+    if (complete && m_callback) {
+        m_callback(analysis);
+    }
+}
+
+bool GCodeAnalyzer::Analyze(const std::string& text, GCodeAnalysis& analysis,
+                            const std::function<bool()>& cancelled)
+{
+    GCodeParser parser;
+    parser.enableStatistics(true);
+    parser.enableToolpathGeneration(true);
+    parser.setStrictMode(false);
+
+    if (cancelled) {
+        // Checked every few thousand lines
+        parser.setProgressCallback([&cancelled](int currentLine, int) {
+            if ((currentLine & 4095) == 0 && cancelled()) {
+                throw AnalysisCancelled();
+            }
+        });
+    }
+
+    try {
+        parser.parseString(text);
+    } catch (const AnalysisCancelled&) {
+        return false;
+    }
+
+    const GCodeStatistics& statistics = parser.getStatistics();
+    analysis.bytes = text.size();
+    analysis.totalLines = statistics.totalLines;
+    analysis.commandLines = statistics.commandLines;
+    analysis.commentLines = statistics.commentLines;
+    analysis.errorLines = statistics.errorLines;
+    analysis.emptyLines = statistics.totalLines - statistics.commandLines -
+                          statistics.commentLines - statistics.errorLines;
+    analysis.rapidMoves = statistics.rapidMoves;
+    analysis.linearMoves = statistics.linearMoves;
+    analysis.arcMoves = statistics.arcMoves;
+    analysis.toolChanges = statistics.toolChanges;
+    analysis.boundsValid = statistics.boundsValid;
+    analysis.minBounds = statistics.minBounds;
+    analysis.maxBounds = statistics.maxBounds;
+    analysis.tools.assign(statistics.toolsUsed.begin(), statistics.toolsUsed.end());
+    analysis.errors = parser.getErrors();
+    analysis.inches = parser.getState().units == Units::INCHES;
+
+    // Distances and time come from the generated segments
+    for (const auto& segment : parser.getToolpath()) {
+        analysis.totalDistance += segment.length;
+        if (segment.type == ToolpathSegment::RAPID) {
+            analysis.rapidDistance += segment.length;
+        } else {
+            analysis.cuttingDistance += segment.length;
+        }
+        analysis.estimatedSeconds += segment.estimatedTime;
+    }
+
+    return !cancelled || !cancelled();
+}
@@ -0,0 +1,70 @@
+/**
+ * core/GCodeAnalyzer.h
+ * Background job statistics for the G-code editor
+ * The program text is run through the real parser on a worker thread. A new
+ * request supersedes the one in progress, so a burst of edits costs at most
+ * one complete analysis of the latest text.
+ */
+
+#pragma once
+
+#include "GCodeParser.h"
+#include "LatestRequestWorker.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+struct GCodeAnalysis {
+    uint64_t generation = 0;
+    size_t bytes = 0;
+
+    int totalLines = 0;
+    int commandLines = 0;
+    int commentLines = 0;
+    int emptyLines = 0;
+    int errorLines = 0;
+
+    int rapidMoves = 0;
+    int linearMoves = 0;
+    int arcMoves = 0;
+    int toolChanges = 0;
+
+    double totalDistance = 0.0;
+    double rapidDistance = 0.0;
+    double cuttingDistance = 0.0;
+    double estimatedSeconds = 0.0;
+    bool inches = false;  // Program units at the end of the file (G20)
+
+    bool boundsValid = false;
+    Position minBounds, maxBounds;
+
+    std::vector<int> tools;
+    std::vector<ParseError> errors;
+};
+
+class GCodeAnalyzer
+{
+public:
+    // Called on the worker thread; GUI code must marshal to the main thread
+    using ResultCallback = std::function<void(std::shared_ptr<const GCodeAnalysis> analysis)>;
+
+    explicit GCodeAnalyzer(ResultCallback callback);
+
+    // Queues an analysis of 'text', cancelling any analysis in progress. The
+    // snapshot is shared, not copied, so the editor can hand the same text to
+    // other background work. Returns the generation id the result will carry.
+    uint64_t Start(std::shared_ptr<const std::string> text);
+    void Cancel();
+
+    // Synchronous analysis; stops early (returning false) once cancelled() is true
+    static bool Analyze(const std::string& text, GCodeAnalysis& analysis,
+                        const std::function<bool()>& cancelled = nullptr);
+
+private:
+    void Run(const std::string& text, uint64_t generation);
+
+    ResultCallback m_callback;
+    LatestRequestWorker m_worker;  // Last member: stopped before the others go away
+};
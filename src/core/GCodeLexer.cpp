@@ -0,0 +1,123 @@
+/**
+ * core/GCodeLexer.cpp
+ * G-code word scanner implementation
+ */
+
+#include "GCodeLexer.h"
+
+namespace {
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isLetter(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+inline char upper(char c) { return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c; }
+inline bool isAxis(char c)
+{
+    c = upper(c);
+    return c == 'X' || c == 'Y' || c == 'Z' || c == 'A' || c == 'B' || c == 'C';
+}
+
+// Length of the number starting at text[i] ([+-]digits[.digits]), 0 if none.
+// 'code' receives the integer value, or -1 when it has a non-zero fraction.
+size_t scanNumber(const char* text, size_t i, size_t length, int& code)
+{
+    size_t start = i;
+    if (i < length && (text[i] == '+' || text[i] == '-')) i++;
+
+    size_t digits = 0;
+    long value = 0;
+    while (i < length && isDigit(text[i])) {
+        if (value < 100000) value = value * 10 + (text[i] - '0');
+        i++;
+        digits++;
+    }
+    bool fraction = false;
+    if (i < length && text[i] == '.') {
+        i++;
+        while (i < length && isDigit(text[i])) {
+            if (text[i] != '0') fraction = true;
+            i++;
+            digits++;
+        }
+    }
+    if (digits == 0) return 0;
+
+    code = fraction ? -1 : static_cast<int>(value);
+    return i - start;
+}
+
+} // namespace
+
+int GCodeLexer::styleLine(const char* text, size_t length, unsigned char* styles, int state)
+{
+    bool hasAxisWords = false;
+    bool firstWord = true;
+    size_t i = 0;
+
+    while (i < length) {
+        char c = text[i];
+
+        if (c == ';') {
+            // Comment to end of line
+            while (i < length && text[i] != '\r' && text[i] != '\n') styles[i++] = STYLE_COMMENT;
+            continue;
+        }
+        if (c == '(') {
+            while (i < length && text[i] != '\r' && text[i] != '\n') {
+                styles[i] = STYLE_COMMENT;
+                if (text[i++] == ')') break;
+            }
+            continue;
+        }
+        if (c == '$' && firstWord) {
+            // Controller command ($H, $X, $$ ...), not G-code
+            while (i < length && text[i] != '\r' && text[i] != '\n') styles[i++] = STYLE_DEFAULT;
+            continue;
+        }
+        if (!isLetter(c)) {
+            styles[i++] = STYLE_DEFAULT;
+            continue;
+        }
+
+        char letter = upper(c);
+        int code = 0;
+        size_t numberLength = scanNumber(text, i + 1, length, code);
+        if (numberLength == 0) {
+            styles[i++] = STYLE_ERROR;
+            firstWord = false;
+            continue;
+        }
+
+        size_t wordEnd = i + 1 + numberLength;
+        if (letter == 'G' || letter == 'M' || (letter == 'N' && firstWord)) {
+            unsigned char style = letter == 'G' ? STYLE_GCODE : letter == 'M' ? STYLE_MCODE : STYLE_LINE_NUMBER;
+            for (size_t j = i; j < wordEnd; j++) styles[j] = style;
+
+            if (letter == 'G') {
+                switch (code) {
+                    case 0: state = STATE_G0; break;
+                    case 1: state = STATE_G1; break;
+                    case 2: state = STATE_G2; break;
+                    case 3: state = STATE_G3; break;
+                    case 80: state = STATE_NONE; break;
+                    default: break;
+                }
+            }
+        } else {
+            hasAxisWords = hasAxisWords || isAxis(letter);
+            styles[i] = STYLE_PARAMETER;
+            for (size_t j = i + 1; j < wordEnd; j++) styles[j] = STYLE_NUMBER;
+        }
+
+        i = wordEnd;
+        firstWord = false;
+    }
+
+    // The motion word may follow the coordinates, so rapids are marked last
+    if (hasAxisWords && state == STATE_G0) {
+        for (size_t j = 0; j < length; j++) {
+            if (styles[j] == STYLE_PARAMETER && isAxis(text[j])) styles[j] = STYLE_RAPID;
+        }
+    }
+
+    return state;
+}
@@ -0,0 +1,41 @@
+/**
+ * core/GCodeLexer.h
+ * Single-pass G-code word scanner for syntax highlighting
+ * Assigns a style to every byte of a line without allocating. The only state
+ * carried from one line to the next is the modal motion mode, so a caller can
+ * start styling at any line given the state stored for the line before it.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+class GCodeLexer {
+public:
+    enum Style : unsigned char {
+        STYLE_DEFAULT = 0,
+        STYLE_GCODE = 1,
+        STYLE_MCODE = 2,
+        STYLE_COMMENT = 3,
+        STYLE_NUMBER = 4,
+        STYLE_PARAMETER = 5,
+        STYLE_LINE_NUMBER = 6,
+        STYLE_RAPID = 7,    // Axis words of a line executed as a rapid (G0)
+        STYLE_ERROR = 8,    // Address letter without a value
+        STYLE_COUNT
+    };
+
+    // Modal motion mode at the end of a line
+    enum State {
+        STATE_NONE = 0,
+        STATE_G0,
+        STATE_G1,
+        STATE_G2,
+        STATE_G3
+    };
+
+    // Styles 'length' bytes of one line (line ending included) into 'styles'.
+    // 'state' is the state at the end of the previous line; the state at the
+    // end of this line is returned.
+    static int styleLine(const char* text, size_t length, unsigned char* styles, int state);
+};
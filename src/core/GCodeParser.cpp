@@ -11,11 +11,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cctype>
-
-// Static member initialization
-std::map<int, CommandType> GCodeParser::s_gcodeLookup;
-std::map<int, CommandType> GCodeParser::s_mcodeLookup;
-bool GCodeParser::s_tablesInitialized = false;
+#include <cstring>
 
 // Constants
 constexpr double EPSILON = 1e-6;
@@ -68,58 +64,62 @@ void GCodeStatistics::reset() {
 
 // Constructor/Destructor
 GCodeParser::GCodeParser() {
-    initializeLookupTables();
     resetState();
 }
 
 GCodeParser::~GCodeParser() = default;
 
-void GCodeParser::initializeLookupTables() {
-    if (s_tablesInitialized) return;
-    
-    // G-code lookup table
-    s_gcodeLookup[0] = CommandType::RAPID_MOVE;
-    s_gcodeLookup[1] = CommandType::LINEAR_MOVE;
-    s_gcodeLookup[2] = CommandType::CW_ARC;
-    s_gcodeLookup[3] = CommandType::CCW_ARC;
-    s_gcodeLookup[4] = CommandType::DWELL;
-    s_gcodeLookup[17] = CommandType::PLANE_XY;
-    s_gcodeLookup[18] = CommandType::PLANE_XZ;
-    s_gcodeLookup[19] = CommandType::PLANE_YZ;
-    s_gcodeLookup[20] = CommandType::INCHES;
-    s_gcodeLookup[21] = CommandType::MILLIMETERS;
-    s_gcodeLookup[28] = CommandType::RETURN_HOME;
-    s_gcodeLookup[30] = CommandType::RETURN_PREDEFINED;
-    s_gcodeLookup[54] = CommandType::WORK_COORD_1;
-    s_gcodeLookup[55] = CommandType::WORK_COORD_2;
-    s_gcodeLookup[56] = CommandType::WORK_COORD_3;
-    s_gcodeLookup[57] = CommandType::WORK_COORD_4;
-    s_gcodeLookup[58] = CommandType::WORK_COORD_5;
-    s_gcodeLookup[59] = CommandType::WORK_COORD_6;
-    s_gcodeLookup[80] = CommandType::CANCEL_CYCLE;
-    s_gcodeLookup[81] = CommandType::CANNED_CYCLE_DRILL;
-    s_gcodeLookup[82] = CommandType::CANNED_CYCLE_DWELL;
-    s_gcodeLookup[83] = CommandType::CANNED_CYCLE_PECK;
-    s_gcodeLookup[84] = CommandType::CANNED_CYCLE_TAP;
-    s_gcodeLookup[85] = CommandType::CANNED_CYCLE_BORE;
-    s_gcodeLookup[90] = CommandType::ABSOLUTE_MODE;
-    s_gcodeLookup[91] = CommandType::INCREMENTAL_MODE;
-    s_gcodeLookup[92] = CommandType::COORDINATE_OFFSET;
-    
-    // M-code lookup table
-    s_mcodeLookup[0] = CommandType::PROGRAM_STOP;
-    s_mcodeLookup[1] = CommandType::OPTIONAL_STOP;
-    s_mcodeLookup[2] = CommandType::PROGRAM_END;
-    s_mcodeLookup[3] = CommandType::SPINDLE_CW;
-    s_mcodeLookup[4] = CommandType::SPINDLE_CCW;
-    s_mcodeLookup[5] = CommandType::SPINDLE_STOP;
-    s_mcodeLookup[6] = CommandType::TOOL_CHANGE;
-    s_mcodeLookup[7] = CommandType::COOLANT_MIST;
-    s_mcodeLookup[8] = CommandType::COOLANT_FLOOD;
-    s_mcodeLookup[9] = CommandType::COOLANT_OFF;
-    s_mcodeLookup[30] = CommandType::PROGRAM_END;
-    
-    s_tablesInitialized = true;
+// Lookup tables. Parsers run on worker threads (thumbnails, analysis), so the
+// tables are built once by a thread-safe static initializer and never written
+// afterwards.
+const std::map<int, CommandType>& GCodeParser::gcodeLookup() {
+    static const std::map<int, CommandType> table = {
+        {0, CommandType::RAPID_MOVE},
+        {1, CommandType::LINEAR_MOVE},
+        {2, CommandType::CW_ARC},
+        {3, CommandType::CCW_ARC},
+        {4, CommandType::DWELL},
+        {17, CommandType::PLANE_XY},
+        {18, CommandType::PLANE_XZ},
+        {19, CommandType::PLANE_YZ},
+        {20, CommandType::INCHES},
+        {21, CommandType::MILLIMETERS},
+        {28, CommandType::RETURN_HOME},
+        {30, CommandType::RETURN_PREDEFINED},
+        {54, CommandType::WORK_COORD_1},
+        {55, CommandType::WORK_COORD_2},
+        {56, CommandType::WORK_COORD_3},
+        {57, CommandType::WORK_COORD_4},
+        {58, CommandType::WORK_COORD_5},
+        {59, CommandType::WORK_COORD_6},
+        {80, CommandType::CANCEL_CYCLE},
+        {81, CommandType::CANNED_CYCLE_DRILL},
+        {82, CommandType::CANNED_CYCLE_DWELL},
+        {83, CommandType::CANNED_CYCLE_PECK},
+        {84, CommandType::CANNED_CYCLE_TAP},
+        {85, CommandType::CANNED_CYCLE_BORE},
+        {90, CommandType::ABSOLUTE_MODE},
+        {91, CommandType::INCREMENTAL_MODE},
+        {92, CommandType::COORDINATE_OFFSET}
+    };
+    return table;
+}
+
+const std::map<int, CommandType>& GCodeParser::mcodeLookup() {
+    static const std::map<int, CommandType> table = {
+        {0, CommandType::PROGRAM_STOP},
+        {1, CommandType::OPTIONAL_STOP},
+        {2, CommandType::PROGRAM_END},
+        {3, CommandType::SPINDLE_CW},
+        {4, CommandType::SPINDLE_CCW},
+        {5, CommandType::SPINDLE_STOP},
+        {6, CommandType::TOOL_CHANGE},
+        {7, CommandType::COOLANT_MIST},
+        {8, CommandType::COOLANT_FLOOD},
+        {9, CommandType::COOLANT_OFF},
+        {30, CommandType::PROGRAM_END}
+    };
+    return table;
 }
 
 // Main parsing methods
@@ -138,14 +138,24 @@ bool GCodeParser::parseFile(const std::string& filename) {
 }
 
 bool GCodeParser::parseString(const std::string& gcode) {
+    return parseBuffer(gcode.data(), gcode.size());
+}
+
+bool GCodeParser::parseBuffer(const char* data, size_t size) {
     resetState();
     
-    std::istringstream stream(gcode);
+    const char* end = data + size;
     std::string line;
     int lineNumber = 0;
-    int totalLines = std::count(gcode.begin(), gcode.end(), '\n') + 1;
-    
-    while (std::getline(stream, line) && m_errors.size() < m_maxErrors) {
+    int totalLines = static_cast<int>(std::count(data, end, '\n')) + 1;
+    
+    const char* p = data;
+    while (p < end && m_errors.size() < m_maxErrors) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        line.assign(p, eol);
+        p = eol + 1;
+        
         lineNumber++;
         m_state.lineNumber = lineNumber;
         
@@ -190,7 +200,8 @@ ParsedLine GCodeParser::parseLine(const std::string& line, int lineNumber) {
     
     try {
         // Parse line into tokens
-        std::regex tokenRegex(R"(([GMSTFPXYZIJKRABCUVWDEFHLNQR])([+-]?\d*\.?\d*))");
+        // Compiled once; matching against a const regex is safe from several threads
+        static const std::regex tokenRegex(R"(([GMSTFPXYZIJKRABCUVWDEFHLNQR])([+-]?\d*\.?\d*))");
         std::sregex_iterator iter(cleanedLine.begin(), cleanedLine.end(), tokenRegex);
         std::sregex_iterator end;
         
@@ -274,8 +285,8 @@ ParsedLine GCodeParser::parseLine(const std::string& line, int lineNumber) {
 }
 
 bool GCodeParser::parseGCode(int gcode, GCodeCommand& command) {
-    auto it = s_gcodeLookup.find(gcode);
-    if (it != s_gcodeLookup.end()) {
+    auto it = gcodeLookup().find(gcode);
+    if (it != gcodeLookup().end()) {
         command.type = it->second;
         return true;
     }
@@ -286,8 +297,8 @@ bool GCodeParser::parseGCode(int gcode, GCodeCommand& command) {
 }
 
 bool GCodeParser::parseMCode(int mcode, GCodeCommand& command) {
-    auto it = s_mcodeLookup.find(mcode);
-    if (it != s_mcodeLookup.end()) {
+    auto it = mcodeLookup().find(mcode);
+    if (it != mcodeLookup().end()) {
         command.type = it->second;
         return true;
     }
@@ -298,7 +309,7 @@ bool GCodeParser::parseMCode(int mcode, GCodeCommand& command) {
 }
 
 bool GCodeParser::parseParameters(const std::string& line, GCodeCommand& command) {
-    std::regex paramRegex(R"(([XYZABCIJKRFSTPQUVWDEFHLN])([+-]?\d*\.?\d*))");
+    static const std::regex paramRegex(R"(([XYZABCIJKRFSTPQUVWDEFHLN])([+-]?\d*\.?\d*))");
     std::sregex_iterator iter(line.begin(), line.end(), paramRegex);
     std::sregex_iterator end;
     
@@ -567,6 +578,7 @@ void GCodeParser::generateToolpathSegment(const GCodeCommand& command) {
     segment.spindleOn = (m_state.spindleState != SpindleState::OFF);
     segment.coolantOn = (m_state.coolantState.mist || m_state.coolantState.flood);
     segment.toolNumber = m_state.currentTool;
+    segment.lineNumber = command.lineNumber;
     
     Position targetPos = m_state.currentPosition;
     if (m_state.positionMode == MotionMode::ABSOLUTE_MODE) {
@@ -627,7 +639,9 @@ void GCodeParser::generateToolpathSegment(const GCodeCommand& command) {
         segment.estimatedTime = (segment.length / 10000.0) * 60.0;
     }
     
-    m_toolpath.push_back(segment);
+    if (m_keepToolpath) {
+        m_toolpath.push_back(segment);
+    }
     
     if (m_segmentCallback) {
         m_segmentCallback(segment);
@@ -647,6 +661,7 @@ void GCodeParser::generateToolpathSegmentFromPositions(const GCodeCommand& comma
     segment.spindleOn = (m_state.spindleState != SpindleState::OFF);
     segment.coolantOn = (m_state.coolantState.mist || m_state.coolantState.flood);
     segment.toolNumber = m_state.currentTool;
+    segment.lineNumber = command.lineNumber;
     
     switch (command.type) {
         case CommandType::RAPID_MOVE:
@@ -710,7 +725,9 @@ void GCodeParser::generateToolpathSegmentFromPositions(const GCodeCommand& comma
         segment.estimatedTime = (segment.length / 10000.0) * 60.0;
     }
     
-    m_toolpath.push_back(segment);
+    if (m_keepToolpath) {
+        m_toolpath.push_back(segment);
+    }
     
     if (m_segmentCallback) {
         m_segmentCallback(segment);
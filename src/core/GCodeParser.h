@@ -232,6 +232,7 @@ struct ToolpathSegment {
     bool spindleOn = false;
     bool coolantOn = false;
     int toolNumber = 0;
+    int lineNumber = 0;         // Source line that produced the segment (1-based)
     
     // Calculated values
     double length = 0.0;        // Segment length
@@ -287,6 +288,8 @@ public:
     // Main parsing methods
     bool parseFile(const std::string& filename);
     bool parseString(const std::string& gcode);
+    // Same as parseString for text that is not held in a std::string (mapped files)
+    bool parseBuffer(const char* data, size_t size);
     ParsedLine parseLine(const std::string& line, int lineNumber = 0);
     
     // State management
@@ -303,6 +306,9 @@ public:
     void setMaxErrorCount(int maxErrors) { m_maxErrors = maxErrors; }
     void enableStatistics(bool enable) { m_calculateStatistics = enable; }
     void enableToolpathGeneration(bool enable) { m_generateToolpath = enable; }
+    // With false, generated segments only go to the segment callback and
+    // getToolpath() stays empty (files too large to hold every segment)
+    void setKeepToolpath(bool keep) { m_keepToolpath = keep; }
     
     // Callbacks
     void setProgressCallback(ProgressCallback callback) { m_progressCallback = callback; }
@@ -352,6 +358,7 @@ private:
     bool m_strictMode = false;
     bool m_calculateStatistics = true;
     bool m_generateToolpath = true;
+    bool m_keepToolpath = true;
     int m_maxErrors = 100;
     
     // Callbacks
@@ -359,9 +366,7 @@ private:
     ErrorCallback m_errorCallback;
     SegmentCallback m_segmentCallback;
     
-    // Internal lookup tables
-    static std::map<int, CommandType> s_gcodeLookup;
-    static std::map<int, CommandType> s_mcodeLookup;
-    static void initializeLookupTables();
-    static bool s_tablesInitialized;
+    // Internal lookup tables (read-only, shared by all parsers)
+    static const std::map<int, CommandType>& gcodeLookup();
+    static const std::map<int, CommandType>& mcodeLookup();
 };
@@ -0,0 +1,317 @@
+/**
+ * core/GCodeSearch.cpp
+ * Implementation of the background G-code search
+ */
+
+#include "GCodeSearch.h"
+#include "SubstringFinder.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// Text handed to the scanning threads per round; results are streamed after each
+const size_t BLOCK_BYTES = 16 * 1024 * 1024;
+// Blocks smaller than this are not split between threads
+const size_t MIN_BYTES_PER_THREAD = 1024 * 1024;
+
+inline bool IsLetter(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+inline char Upper(char c) { return static_cast<char>(std::toupper(static_cast<unsigned char>(c))); }
+
+size_t CountNewlines(const char* p, const char* end)
+{
+    size_t count = 0;
+    while (p < end && (p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr) {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+// Start of the line following the one containing p (or end)
+const char* NextLine(const char* p, const char* end)
+{
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return eol ? eol + 1 : end;
+}
+
+// Number in [p, end) - [+-]digits[.digits]; returns false if there is none
+bool ParseNumber(const char*& p, const char* end, double& value)
+{
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    double result = 0.0;
+    int digits = 0;
+    while (p < end && IsDigit(*p)) {
+        result = result * 10.0 + (*p++ - '0');
+        digits++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        double scale = 0.1;
+        while (p < end && IsDigit(*p)) {
+            result += (*p++ - '0') * scale;
+            scale *= 0.1;
+            digits++;
+        }
+    }
+    if (digits == 0) return false;
+
+    value = negative ? -result : result;
+    return true;
+}
+
+struct RangeResult {
+    std::vector<size_t> lines;  // Relative to the first line of the range
+    size_t newlines = 0;
+};
+
+void ScanText(const SubstringFinder& finder, const char* p, const char* end, RangeResult& result)
+{
+    size_t line = 0;
+    while (p < end) {
+        const char* match = finder.Find(p, end);
+        if (match == end) break;
+
+        line += CountNewlines(p, match);
+        result.lines.push_back(line);
+
+        // One hit per line - continue on the next one
+        const char* eol = static_cast<const char*>(std::memchr(match, '\n', end - match));
+        if (!eol) {
+            p = end;
+            break;
+        }
+        line++;
+        p = eol + 1;
+    }
+    result.newlines = line + CountNewlines(p, end);
+}
+
+void ScanWords(const GCodeQuery& query, const char* p, const char* end, RangeResult& result)
+{
+    size_t line = 0;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = eol ? eol : end;
+        if (query.MatchesWords(p, static_cast<size_t>(lineEnd - p))) {
+            result.lines.push_back(line);
+        }
+        if (!eol) break;
+        line++;
+        p = eol + 1;
+    }
+    result.newlines = line;
+}
+
+} // namespace
+
+GCodeQuery::GCodeQuery(const std::string& text, bool matchCase)
+    : m_text(text), m_matchCase(matchCase)
+{
+    // Structured only if every whitespace/comma separated term is a condition
+    std::vector<Condition> conditions;
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && (std::isspace(static_cast<unsigned char>(text[i])) || text[i] == ',')) i++;
+        if (i >= text.size()) break;
+
+        // A term is a letter, an optional operator and a number; spaces are
+        // allowed around the operator ("Z < -5")
+        size_t start = i++;
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) i++;
+        while (i < text.size() && std::strchr("<>=!", text[i])) i++;
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) i++;
+        while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])) && text[i] != ',') i++;
+
+        Condition condition;
+        if (!ParseCondition(text.substr(start, i - start), condition)) {
+            return;
+        }
+        conditions.push_back(condition);
+    }
+    m_conditions = conditions;
+}
+
+bool GCodeQuery::ParseCondition(const std::string& term, Condition& condition)
+{
+    const char* p = term.data();
+    const char* end = p + term.size();
+    if (p == end || !IsLetter(*p)) return false;
+    condition.letter = Upper(*p++);
+
+    auto skipSpaces = [&p, end]() {
+        while (p < end && std::isspace(static_cast<unsigned char>(*p))) p++;
+    };
+
+    skipSpaces();
+    condition.compare = Compare::EQ;
+    if (end - p >= 2 && p[1] == '=') {
+        switch (*p) {
+            case '<': condition.compare = Compare::LE; p += 2; break;
+            case '>': condition.compare = Compare::GE; p += 2; break;
+            case '!': condition.compare = Compare::NE; p += 2; break;
+            case '=': condition.compare = Compare::EQ; p += 2; break;
+            default: break;
+        }
+    } else if (p < end) {
+        switch (*p) {
+            case '<': condition.compare = Compare::LT; p++; break;
+            case '>': condition.compare = Compare::GT; p++; break;
+            case '=': condition.compare = Compare::EQ; p++; break;
+            default: break;
+        }
+    }
+    skipSpaces();
+
+    return ParseNumber(p, end, condition.value) && p == end;
+}
+
+bool GCodeQuery::MatchesWords(const char* line, size_t length) const
+{
+    // Each condition must be met by at least one word with its letter
+    uint32_t satisfied = 0;
+    const uint32_t all = m_conditions.size() >= 32 ? ~0u : (1u << m_conditions.size()) - 1;
+
+    const char* p = line;
+    const char* end = line + length;
+    while (p < end) {
+        char c = *p;
+        if (c == ';') break;
+        if (c == '(') {
+            const char* close = static_cast<const char*>(std::memchr(p, ')', end - p));
+            p = close ? close + 1 : end;
+            continue;
+        }
+        if (!IsLetter(c)) {
+            p++;
+            continue;
+        }
+
+        char letter = Upper(c);
+        p++;
+        double value;
+        if (!ParseNumber(p, end, value)) continue;
+
+        for (size_t i = 0; i < m_conditions.size() && i < 32; i++) {
+            const Condition& condition = m_conditions[i];
+            if (condition.letter != letter) continue;
+
+            bool match = false;
+            switch (condition.compare) {
+                case Compare::EQ: match = value == condition.value; break;
+                case Compare::NE: match = value != condition.value; break;
+                case Compare::LT: match = value < condition.value; break;
+                case Compare::LE: match = value <= condition.value; break;
+                case Compare::GT: match = value > condition.value; break;
+                case Compare::GE: match = value >= condition.value; break;
+            }
+            if (match) satisfied |= 1u << i;
+        }
+        if (satisfied == all) return true;
+    }
+    return false;
+}
+
+GCodeSearch::GCodeSearch()
+    : m_worker("GCodeSearch")
+{
+}
+
+uint64_t GCodeSearch::Start(const GCodeQuery& query, const char* data, size_t size,
+                            std::shared_ptr<const void> owner, ResultCallback callback)
+{
+    Job job;
+    job.query = query;
+    job.data = data;
+    job.size = size;
+    job.owner = owner;
+    job.callback = callback;
+
+    return m_worker.Post([this, job](uint64_t generation) mutable {
+        job.generation = generation;
+        RunJob(job);
+    });
+}
+
+void GCodeSearch::Cancel()
+{
+    m_worker.Cancel();
+}
+
+void GCodeSearch::RunJob(const Job& job)
+{
+    if (job.query.IsEmpty() || !job.data) {
+        job.callback(job.generation, std::vector<size_t>(), true);
+        return;
+    }
+
+    SubstringFinder finder(job.query.GetText(), job.query.IsMatchCase());
+    bool structured = job.query.IsStructured();
+    auto scan = [&](const char* first, const char* last, RangeResult& result) {
+        if (structured) {
+            ScanWords(job.query, first, last, result);
+        } else {
+            ScanText(finder, first, last, result);
+        }
+    };
+
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    const char* end = job.data + job.size;
+    size_t baseLine = 0;
+
+    for (const char* block = job.data; block < end;) {
+        if (IsCancelled(job.generation)) return;
+
+        // Blocks and their per-thread ranges are cut at line starts so no
+        // line is split and line numbers add up
+        const char* blockEnd = block + std::min(BLOCK_BYTES, static_cast<size_t>(end - block));
+        if (blockEnd < end) blockEnd = NextLine(blockEnd, end);
+
+        size_t blockBytes = static_cast<size_t>(blockEnd - block);
+        unsigned int threadCount = static_cast<unsigned int>(
+            std::max<size_t>(1, std::min<size_t>(maxThreads, blockBytes / MIN_BYTES_PER_THREAD)));
+
+        std::vector<const char*> bounds(threadCount + 1);
+        bounds[0] = block;
+        for (unsigned int t = 1; t < threadCount; ++t) {
+            const char* cut = block + blockBytes * t / threadCount;
+            bounds[t] = std::max(bounds[t - 1], NextLine(std::max(cut - 1, block), blockEnd));
+        }
+        bounds[threadCount] = blockEnd;
+
+        std::vector<RangeResult> results(threadCount);
+        std::vector<std::thread> workers;
+        for (unsigned int t = 1; t < threadCount; ++t) {
+            workers.emplace_back([&, t]() { scan(bounds[t], bounds[t + 1], results[t]); });
+        }
+        scan(bounds[0], bounds[1], results[0]);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        std::vector<size_t> lines;
+        for (const RangeResult& result : results) {
+            for (size_t line : result.lines) {
+                lines.push_back(baseLine + line);
+            }
+            baseLine += result.newlines;
+        }
+        if (!lines.empty() && !IsCancelled(job.generation)) {
+            job.callback(job.generation, std::move(lines), false);
+        }
+
+        block = blockEnd;
+    }
+
+    if (!IsCancelled(job.generation)) {
+        job.callback(job.generation, std::vector<size_t>(), true);
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * core/GCodeSearch.h
+ * Background whole-program search for the G-code editor
+ * A query is either plain text (scanned 16 bytes at a time with SSE2) or a
+ * list of word conditions such as "Z<-5", "F>3000" or "T2" that are checked
+ * against the words of every line. The text is split into blocks that are
+ * scanned by several threads, and matching line numbers are streamed back
+ * block by block in ascending order.
+ */
+
+#pragma once
+
+#include "LatestRequestWorker.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+/**
+ * Parsed search query. Text made only of word conditions ("X>10 Y<0", "T2",
+ * "G0") is structured and matches lines whose words satisfy every condition;
+ * anything else is searched for literally.
+ * Conditions see only the words written on the line, not the modal state:
+ * "Z<-5" finds the lines that set such a Z, not the moves after them that
+ * keep it, and values are compared in the units and distance mode they are
+ * written in.
+ */
+class GCodeQuery
+{
+public:
+    GCodeQuery() = default;
+    GCodeQuery(const std::string& text, bool matchCase);
+
+    bool IsEmpty() const { return m_text.empty(); }
+    bool IsStructured() const { return !m_conditions.empty(); }
+    const std::string& GetText() const { return m_text; }
+    bool IsMatchCase() const { return m_matchCase; }
+
+    // Structured queries only: true if the words of the line satisfy every condition
+    bool MatchesWords(const char* line, size_t length) const;
+
+private:
+    enum class Compare { EQ, NE, LT, LE, GT, GE };
+    struct Condition {
+        char letter;
+        Compare compare;
+        double value;
+    };
+
+    static bool ParseCondition(const std::string& term, Condition& condition);
+
+    std::string m_text;
+    bool m_matchCase = false;
+    std::vector<Condition> m_conditions;
+};
+
+class GCodeSearch
+{
+public:
+    // Matching 0-based line numbers, ascending across calls. Called on a worker
+    // thread; GUI code must marshal to the main thread.
+    using ResultCallback = std::function<void(uint64_t generation, std::vector<size_t> lines, bool finished)>;
+
+    GCodeSearch();
+
+    // Searches [data, data + size), cancelling any search in progress. 'owner'
+    // keeps the buffer alive until the search is done with it (the text
+    // snapshot or the mapped file). Returns the generation id passed to the callback.
+    uint64_t Start(const GCodeQuery& query, const char* data, size_t size,
+                   std::shared_ptr<const void> owner, ResultCallback callback);
+    void Cancel();
+
+private:
+    struct Job {
+        uint64_t generation = 0;
+        GCodeQuery query;
+        const char* data = nullptr;
+        size_t size = 0;
+        std::shared_ptr<const void> owner;
+        ResultCallback callback;
+    };
+
+    void RunJob(const Job& job);
+    bool IsCancelled(uint64_t generation) const { return m_worker.IsCancelled(generation); }
+
+    LatestRequestWorker m_worker;
+};
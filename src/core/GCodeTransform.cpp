@@ -0,0 +1,1062 @@
+/**
+ * core/GCodeTransform.cpp
+ * Implementation of the G-code program transforms
+ *
+ * The program is cut into chunks at line boundaries and processed in three
+ * parallel passes. The first records the modal codes (units, distance mode,
+ * plane, motion mode) each chunk leaves behind, the second the position each
+ * chunk ends at - absolute, or relative to where it started - and the third
+ * rewrites every chunk knowing the exact state it starts in. Only the short
+ * steps between passes run on one thread.
+ */
+
+#include "GCodeTransform.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Nominal chunk size; smaller programs are a single chunk on the calling thread
+const size_t MIN_CHUNK_BYTES = 256 * 1024;
+// Chunks a large program is cut into, per thread
+const size_t CHUNKS_PER_THREAD = 16;
+// Chunks rewritten per round before their output is handed on, per thread
+const size_t CHUNKS_PER_THREAD_ROUND = 2;
+
+const double MM_PER_INCH = 25.4;
+const double EPSILON = 1e-12;
+const double PI = 3.14159265358979323846;
+const size_t MAX_ARC_SEGMENTS = 20000;
+
+// Modal G codes are kept as ten times their number (G38.2 -> 382)
+const int UNITS_INCHES = 200;
+const int UNITS_MM = 210;
+const int DISTANCE_ABSOLUTE = 900;
+const int DISTANCE_INCREMENTAL = 910;
+const int PLANE_XY = 170;
+const int PLANE_ZX = 180;
+const int PLANE_YZ = 190;
+const int MOTION_RAPID = 0;
+const int MOTION_CW_ARC = 20;
+const int MOTION_CCW_ARC = 30;
+const int MOTION_CANCEL = 800;
+const int FEED_INVERSE_TIME = 930;
+const int FEED_UNITS_PER_MINUTE = 940;
+const int UNSET = -1;
+
+inline bool IsLetter(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+inline char Upper(char c) { return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c; }
+
+struct Word {
+    char letter;
+    double value;
+    uint32_t begin;  // Offsets of the whole word in its line
+    uint32_t end;
+};
+
+struct Modal {
+    int units;
+    int distance;
+    int plane;
+    int motion;
+    int feedMode;
+};
+
+const Modal DEFAULT_MODAL = {UNITS_MM, DISTANCE_ABSOLUTE, PLANE_XY, MOTION_RAPID, FEED_UNITS_PER_MINUTE};
+const Modal UNSET_MODAL = {UNSET, UNSET, UNSET, UNSET, UNSET};
+
+// Program state between lines. Positions are millimetres in program
+// coordinates, NaN where unknown. While summarizing a chunk a position may
+// be relative to wherever the chunk started.
+struct State {
+    Modal modal;
+    double pos[3];
+    bool relative[3];
+};
+
+bool IsMotionCode(int code)
+{
+    return code == 0 || code == 10 || code == 20 || code == 30 || (code >= 382 && code <= 385) ||
+           code == MOTION_CANCEL || (code >= 810 && code <= 890 && code % 10 == 0);
+}
+
+bool IsCannedCycle(int motion) { return motion >= 810 && motion <= 890; }
+bool IsArc(int motion) { return motion == MOTION_CW_ARC || motion == MOTION_CCW_ARC; }
+
+// Applies the modal G codes of a line; returns its non-modal code, if any
+int ApplyModalCodes(const std::vector<Word>& words, Modal& modal, int* motionWord = nullptr)
+{
+    int nonModal = 0;
+    for (size_t k = 0; k < words.size(); k++) {
+        if (words[k].letter != 'G') continue;
+
+        int code = static_cast<int>(std::lround(words[k].value * 10.0));
+        if (code == UNITS_INCHES || code == UNITS_MM) {
+            modal.units = code;
+        } else if (code == DISTANCE_ABSOLUTE || code == DISTANCE_INCREMENTAL) {
+            modal.distance = code;
+        } else if (code == PLANE_XY || code == PLANE_ZX || code == PLANE_YZ) {
+            modal.plane = code;
+        } else if (code == 930 || code == 940 || code == 950) {
+            modal.feedMode = code;
+        } else if (IsMotionCode(code)) {
+            modal.motion = code;
+            if (motionWord) *motionWord = static_cast<int>(k);
+        } else if (code == 40 || code == 100 || code == 280 || code == 300 || code == 530 ||
+                   (code >= 920 && code <= 923)) {
+            nonModal = code;
+        }
+    }
+    return nonModal;
+}
+
+// Number without exponent, as G-code writes it
+bool ParseNumber(const char* p, const char* end, double& value, const char*& next)
+{
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int fraction = 0;
+    bool any = false;
+    for (; p < end && IsDigit(*p); p++, any = true) {
+        if (digits < 18) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            if (mantissa) digits++;
+        } else {
+            fraction--;  // Integer digits beyond the mantissa scale it up
+        }
+    }
+    if (p < end && *p == '.') {
+        p++;
+        for (; p < end && IsDigit(*p); p++, any = true) {
+            if (digits < 18) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                if (mantissa) digits++;
+                fraction++;
+            }
+        }
+    }
+    if (!any) return false;
+
+    value = static_cast<double>(mantissa);
+    if (fraction > 0) {
+        value /= powers[fraction];
+    } else if (fraction < 0) {
+        value *= std::pow(10.0, -fraction);
+    }
+    if (negative) value = -value;
+    next = p;
+    return true;
+}
+
+// Words of one line; (...) and ; comments are skipped
+void Tokenize(const char* line, size_t length, std::vector<Word>& words)
+{
+    words.clear();
+    const char* end = line + length;
+    const char* p = line;
+    while (p < end) {
+        char c = *p;
+        if (c == '(') {
+            const char* close = static_cast<const char*>(std::memchr(p, ')', end - p));
+            if (!close) break;
+            p = close + 1;
+        } else if (c == ';') {
+            break;
+        } else if (IsLetter(c)) {
+            const char* number = p + 1;
+            while (number < end && (*number == ' ' || *number == '\t')) number++;
+
+            Word word;
+            const char* next;
+            if (ParseNumber(number, end, word.value, next)) {
+                word.letter = Upper(c);
+                word.begin = static_cast<uint32_t>(p - line);
+                word.end = static_cast<uint32_t>(next - line);
+                words.push_back(word);
+                p = next;
+            } else {
+                p++;
+            }
+        } else {
+            p++;
+        }
+    }
+}
+
+void AppendNumber(std::string& out, double value, int decimals)
+{
+    static const uint64_t scales[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    if (!std::isfinite(value)) value = 0.0;
+
+    double scaled = std::round(std::fabs(value) * static_cast<double>(scales[decimals]));
+    if (scaled >= 9e15) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        out += buffer;
+        return;
+    }
+
+    uint64_t units = static_cast<uint64_t>(scaled);
+    if (units == 0) {
+        out += '0';
+        return;
+    }
+    if (value < 0) out += '-';
+
+    char buffer[32];
+    char* end = buffer + sizeof(buffer);
+    char* p = end;
+    uint64_t integer = units / scales[decimals];
+    uint64_t fraction = units % scales[decimals];
+
+    if (fraction) {
+        int width = decimals;
+        while (fraction % 10 == 0) {
+            fraction /= 10;
+            width--;
+        }
+        for (int i = 0; i < width; i++) {
+            *--p = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        *--p = '.';
+    }
+    do {
+        *--p = static_cast<char>('0' + integer % 10);
+        integer /= 10;
+    } while (integer);
+
+    out.append(p, end - p);
+}
+
+// Runs a function for indices [0, count) on up to 'threads' threads, the
+// calling thread included; the first exception is rethrown afterwards
+template <typename Function>
+void ParallelFor(size_t count, unsigned int threads, Function work)
+{
+    std::atomic<size_t> next(0);
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+
+    auto run = [&]() {
+        try {
+            for (size_t i = next++; i < count; i = next++) {
+                work(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) failure = std::current_exception();
+            next = count;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    unsigned int extra = static_cast<unsigned int>(std::min<size_t>(threads, count)) - 1;
+    for (unsigned int t = 0; t < extra; t++) {
+        workers.emplace_back(run);
+    }
+    run();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (failure) std::rethrow_exception(failure);
+}
+
+// True if the program selects its units before any word that depends on
+// them. Units words are rewritten to the output units, so such a program
+// needs no units line of its own.
+bool SelectsUnitsFirst(const char* data, size_t size)
+{
+    std::vector<Word> words;
+    const char* end = data + size;
+    for (const char* line = data; line < end;) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        const char* next = newline ? newline + 1 : end;
+        Tokenize(line, static_cast<size_t>(next - line), words);
+
+        Modal modal = UNSET_MODAL;
+        ApplyModalCodes(words, modal);
+        if (modal.units != UNSET) return true;
+        for (const Word& word : words) {
+            if (std::strchr("XYZIJKRF", word.letter)) return false;
+        }
+        line = next;
+    }
+    return false;
+}
+
+// Rewrites the lines of one chunk. The same code summarizes a chunk (no
+// output) so both passes agree on how every line moves the machine.
+class ChunkTransformer
+{
+public:
+    explicit ChunkTransformer(const GCodeTransform& transform)
+        : m_zScale(transform.GetZScale())
+        , m_zOffset(transform.GetZOffset())
+        , m_tolerance(transform.GetArcTolerance())
+    {
+        std::copy(transform.GetMatrix(), transform.GetMatrix() + 6, m_m);
+        m_mixing = std::fabs(m_m[1]) > EPSILON || std::fabs(m_m[3]) > EPSILON;
+
+        switch (transform.GetOutputUnits()) {
+            case GCodeTransform::OutputUnits::MILLIMETERS: m_targetUnits = UNITS_MM; break;
+            case GCodeTransform::OutputUnits::INCHES: m_targetUnits = UNITS_INCHES; break;
+            default: m_targetUnits = UNSET; break;
+        }
+
+        // Arcs keep their centre form where the transform maps circles in
+        // their plane to circles; elsewhere they are linearized
+        double a = m_m[0], b = m_m[1], c = m_m[3], d = m_m[4];
+        bool rotation = std::fabs(a - d) < EPSILON && std::fabs(b + c) < EPSILON;
+        bool reflection = std::fabs(a + d) < EPSILON && std::fabs(b - c) < EPSILON;
+        m_arcKept[0] = rotation || reflection;
+        m_arcScale[0] = std::hypot(a, c);
+        m_arcFlip[0] = reflection && !rotation;
+
+        m_arcKept[1] = !m_mixing && std::fabs(std::fabs(a) - std::fabs(m_zScale)) < EPSILON;
+        m_arcScale[1] = std::fabs(a);
+        m_arcFlip[1] = a * m_zScale < 0;
+
+        m_arcKept[2] = !m_mixing && std::fabs(std::fabs(d) - std::fabs(m_zScale)) < EPSILON;
+        m_arcScale[2] = std::fabs(d);
+        m_arcFlip[2] = d * m_zScale < 0;
+
+        // Upper bound of how much the transform stretches a distance
+        m_maxStretch = std::max({std::sqrt(a * a + b * b + c * c + d * d), std::fabs(m_zScale), EPSILON});
+    }
+
+    void Run(const char* begin, const char* end, State& state, std::string* out, GCodeTransform::Result& result)
+    {
+        m_out = out;
+        m_result = &result;
+
+        for (const char* line = begin; line < end;) {
+            const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+            const char* next = newline ? newline + 1 : end;
+            const char* lineEnd = newline ? newline : end;
+            if (lineEnd > line && lineEnd[-1] == '\r') lineEnd--;
+
+            ProcessLine(line, static_cast<size_t>(lineEnd - line), lineEnd, static_cast<size_t>(next - lineEnd), state);
+            line = next;
+        }
+    }
+
+private:
+    struct Edit {
+        uint32_t begin;
+        uint32_t end;
+        size_t textOffset;
+        size_t textLength;
+    };
+
+    int Index(char letter) const { return m_index[letter - 'A']; }
+    bool Has(char letter) const { return m_index[letter - 'A'] >= 0; }
+    double Value(char letter) const { return Has(letter) ? m_words[Index(letter)].value * m_sourceScale : 0.0; }
+
+    void ProcessLine(const char* line, size_t length, const char* eol, size_t eolLength, State& state)
+    {
+        Tokenize(line, length, m_words);
+        if (m_words.empty()) {
+            if (m_out) {
+                m_out->append(line, length + eolLength);
+                m_result->lines++;
+            }
+            return;
+        }
+
+        m_line = line;
+        m_length = length;
+        m_separator.assign(eolLength > 0 ? eol : "\n", eolLength > 0 ? eolLength : 1);
+        m_edits.clear();
+        m_editText.clear();
+        m_extraLines.clear();
+        m_extraLineCount = 0;
+        m_removedWords = false;
+        m_unknownPosition = false;
+        std::fill(std::begin(m_index), std::end(m_index), -1);
+
+        int motionWord = -1;
+        int nonModal = ApplyModalCodes(m_words, state.modal, &motionWord);
+        for (size_t k = 0; k < m_words.size(); k++) {
+            char letter = m_words[k].letter;
+            if (letter != 'G') {
+                m_index[letter - 'A'] = static_cast<int>(k);
+            } else if (m_out && m_targetUnits != UNSET) {
+                int code = static_cast<int>(std::lround(m_words[k].value * 10.0));
+                if ((code == UNITS_INCHES || code == UNITS_MM) && code != m_targetUnits) {
+                    Replace(static_cast<int>(k), m_targetUnits == UNITS_INCHES ? "G20" : "G21");
+                }
+            }
+        }
+
+        int outputUnits = m_targetUnits != UNSET ? m_targetUnits : state.modal.units;
+        m_sourceScale = state.modal.units == UNITS_INCHES ? MM_PER_INCH : 1.0;
+        m_outputScale = outputUnits == UNITS_INCHES ? 1.0 / MM_PER_INCH : 1.0;
+        m_decimals = outputUnits == UNITS_INCHES ? 4 : 3;
+        m_halfStep = 0.5 * std::pow(10.0, -m_decimals);
+        m_unitsChange = outputUnits != state.modal.units;
+
+        if (m_out && m_unitsChange && state.modal.feedMode != FEED_INVERSE_TIME) {
+            ConvertWord('F');
+        }
+
+        bool incremental = state.modal.distance == DISTANCE_INCREMENTAL;
+        bool hasAxis = Has('X') || Has('Y') || Has('Z');
+
+        switch (nonModal) {
+            case 920:  // G92 names the current position
+                if (hasAxis) MovePoint(state, false, true);
+                break;
+            case 921: case 922: case 923:
+                ForgetPosition(state, true);
+                break;
+            case 100:  // G10 offsets are machine data - units only
+                ConvertWord('X');
+                ConvertWord('Y');
+                ConvertWord('Z');
+                break;
+            case 530:  // G53 moves in machine coordinates
+                ConvertWord('X');
+                ConvertWord('Y');
+                ConvertWord('Z');
+                ForgetPosition(state, false);
+                break;
+            case 280: case 300:  // Through the (transformed) intermediate point to home
+                if (hasAxis) MovePoint(state, incremental, true);
+                ForgetPosition(state, !hasAxis);
+                break;
+            case 40:
+                break;
+            default: {
+                int motion = state.modal.motion;
+                bool hasOffset = Has('I') || Has('J') || Has('K') || Has('R');
+                if (IsArc(motion) && (hasAxis || hasOffset)) {
+                    Arc(state, incremental, motionWord);
+                } else if (IsCannedCycle(motion) && (hasAxis || Has('R'))) {
+                    CannedCycle(state, incremental);
+                } else if (hasAxis) {
+                    MovePoint(state, incremental, true);
+                }
+                break;
+            }
+        }
+
+        if (!m_out) return;
+
+        // Apply the edits in line order; inserts sort before a replacement at
+        // the same offset and otherwise keep the order they were made in
+        std::stable_sort(m_edits.begin(), m_edits.end(), [](const Edit& a, const Edit& b) {
+            return a.begin != b.begin ? a.begin < b.begin : a.end < b.end;
+        });
+        uint32_t cursor = 0;
+        for (const Edit& edit : m_edits) {
+            if (edit.begin < cursor) continue;
+            m_out->append(line + cursor, edit.begin - cursor);
+            m_out->append(m_editText, edit.textOffset, edit.textLength);
+            cursor = edit.end;
+        }
+        m_out->append(line + cursor, length - cursor);
+        if (m_removedWords) {
+            // Removed words can leave the blank before them at the end
+            size_t last = m_out->find_last_not_of(" \t");
+            m_out->resize(last == std::string::npos ? 0 : last + 1);
+        }
+        m_out->append(m_extraLines);
+        m_out->append(eol, eolLength);
+        m_result->lines += 1 + m_extraLineCount;
+
+        if (m_unknownPosition) {
+            m_result->unknownPositions++;
+        }
+    }
+
+    // Straight move, G92 and canned cycle positions. Absolute points go
+    // through the whole transform, increments through its linear part only.
+    void MovePoint(State& state, bool incremental, bool withZ)
+    {
+        bool given[3] = {Has('X'), Has('Y'), withZ && Has('Z')};
+        double value[3] = {Value('X'), Value('Y'), given[2] ? Value('Z') : 0.0};
+
+        if (m_out) {
+            double x, y, z;
+            if (incremental) {
+                x = m_m[0] * value[0] + m_m[1] * value[1];
+                y = m_m[3] * value[0] + m_m[4] * value[1];
+                z = m_zScale * value[2];
+            } else {
+                double px = given[0] ? value[0] : (m_mixing && given[1] ? Known(state, 0) : 0.0);
+                double py = given[1] ? value[1] : (m_mixing && given[0] ? Known(state, 1) : 0.0);
+                x = m_m[0] * px + m_m[1] * py + m_m[2];
+                y = m_m[3] * px + m_m[4] * py + m_m[5];
+                z = m_zScale * value[2] + m_zOffset;
+            }
+            EmitPair('X', 'Y', x * m_outputScale, y * m_outputScale);
+            if (given[2]) SetWord(Index('Z'), z * m_outputScale);
+        }
+
+        UpdatePosition(state, incremental, given, value);
+    }
+
+    void CannedCycle(State& state, bool incremental)
+    {
+        MovePoint(state, incremental, false);
+
+        if (m_out) {
+            // Z (depth) and R (retract plane) are heights; Q is a peck depth
+            double offset = incremental ? 0.0 : m_zOffset;
+            if (Has('Z')) SetWord(Index('Z'), (m_zScale * Value('Z') + offset) * m_outputScale);
+            if (Has('R')) SetWord(Index('R'), (m_zScale * Value('R') + offset) * m_outputScale);
+            if (Has('Q')) SetWord(Index('Q'), std::fabs(m_zScale) * Value('Q') * m_outputScale);
+        }
+
+        // Where the cycle leaves Z depends on G98/G99 and the initial height
+        state.pos[2] = NAN;
+        state.relative[2] = false;
+    }
+
+    void Arc(State& state, bool incremental, int motionWord)
+    {
+        bool clockwise = state.modal.motion == MOTION_CW_ARC;
+        int planeIndex = state.modal.plane == PLANE_ZX ? 1 : state.modal.plane == PLANE_YZ ? 2 : 0;
+
+        if (m_arcKept[planeIndex]) {
+            MovePoint(state, incremental, true);
+            if (!m_out) return;
+
+            double i = Value('I'), j = Value('J'), k = Value('K');
+            if (planeIndex == 0) {
+                EmitPair('I', 'J', (m_m[0] * i + m_m[1] * j) * m_outputScale, (m_m[3] * i + m_m[4] * j) * m_outputScale);
+            } else if (planeIndex == 1) {
+                if (Has('I')) SetWord(Index('I'), m_m[0] * i * m_outputScale);
+                if (Has('K')) SetWord(Index('K'), m_zScale * k * m_outputScale);
+            } else {
+                if (Has('J')) SetWord(Index('J'), m_m[4] * j * m_outputScale);
+                if (Has('K')) SetWord(Index('K'), m_zScale * k * m_outputScale);
+            }
+            if (Has('R')) SetWord(Index('R'), m_arcScale[planeIndex] * Value('R') * m_outputScale);
+
+            if (m_arcFlip[planeIndex]) {
+                const char* flipped = clockwise ? "G3" : "G2";
+                if (motionWord >= 0) {
+                    Replace(motionWord, flipped);
+                } else {
+                    Insert(FirstCodeOffset(), std::string(flipped) + " ");
+                }
+            }
+            return;
+        }
+
+        bool given[3] = {Has('X'), Has('Y'), Has('Z')};
+        double value[3] = {Value('X'), Value('Y'), Value('Z')};
+
+        if (m_out) {
+            double start[3], end[3];
+            static const int helixAxis[3] = {2, 1, 0};
+            for (int axis = 0; axis < 3; axis++) {
+                // Increments and a helix axis that does not move only need a
+                // start relative to themselves
+                bool needed = !incremental && (axis != helixAxis[planeIndex] || given[axis]);
+                start[axis] = std::isnan(state.pos[axis]) ? (needed ? Unknown() : 0.0) : state.pos[axis];
+                end[axis] = given[axis] ? (incremental ? start[axis] + value[axis] : value[axis]) : start[axis];
+            }
+            LinearizeArc(start, end, planeIndex, clockwise, incremental, motionWord);
+        }
+
+        UpdatePosition(state, incremental, given, value);
+    }
+
+    void LinearizeArc(const double* start, const double* end, int planeIndex, bool clockwise, bool incremental, int motionWord)
+    {
+        // Plane axes (u, v) and the helix axis w, as the arc commands define them
+        static const int axes[3][3] = {{0, 1, 2}, {2, 0, 1}, {1, 2, 0}};
+        static const char offsetLetters[3] = {'I', 'J', 'K'};
+        int u = axes[planeIndex][0], v = axes[planeIndex][1], w = axes[planeIndex][2];
+
+        double du = end[u] - start[u];
+        double dv = end[v] - start[v];
+        double centerU, centerV;  // Centre relative to the start
+        if (Has('R')) {
+            // Centre on the side of the chord chosen by the direction and the sign of R
+            double radius = Value('R');
+            double chord = std::hypot(du, dv);
+            double h = chord > EPSILON ? -std::sqrt(std::max(0.0, 4.0 * radius * radius - chord * chord)) / chord : 0.0;
+            if (!clockwise) h = -h;
+            if (radius < 0) h = -h;
+            centerU = 0.5 * (du - dv * h);
+            centerV = 0.5 * (dv + du * h);
+        } else {
+            centerU = Value(offsetLetters[u]);
+            centerV = Value(offsetLetters[v]);
+        }
+
+        double radius = std::hypot(centerU, centerV);
+        std::vector<std::array<double, 3>>& points = m_arcPoints;
+        points.clear();
+
+        if (radius > EPSILON) {
+            double fromU = -centerU, fromV = -centerV;  // Centre to start
+            double toU = du - centerU, toV = dv - centerV;
+            double sweep = std::atan2(fromU * toV - fromV * toU, fromU * toU + fromV * toV);
+            if (clockwise) {
+                if (sweep >= -1e-9) sweep -= 2.0 * PI;
+            } else if (sweep <= 1e-9) {
+                sweep += 2.0 * PI;
+            }
+
+            double tolerance = std::min(m_tolerance / m_maxStretch, radius);
+            double step = 2.0 * std::sqrt(tolerance * (2.0 * radius - tolerance));
+            size_t segments = static_cast<size_t>(std::ceil(std::fabs(sweep) * radius / std::max(step, EPSILON)));
+            segments = std::min(std::max<size_t>(segments, 1), MAX_ARC_SEGMENTS);
+
+            for (size_t s = 1; s < segments; s++) {
+                double t = static_cast<double>(s) / segments;
+                double angle = sweep * t;
+                double cosA = std::cos(angle), sinA = std::sin(angle);
+                std::array<double, 3> point;
+                point[u] = start[u] + centerU + fromU * cosA - fromV * sinA;
+                point[v] = start[v] + centerV + fromU * sinA + fromV * cosA;
+                point[w] = start[w] + (end[w] - start[w]) * t;
+                points.push_back(point);
+            }
+        }
+        points.push_back({end[0], end[1], end[2]});
+
+        // First point replaces the arc's words; the rest follow on lines of their own
+        std::array<double, 3> previous = TransformPoint(start);
+        std::string first = "G1";
+        for (size_t p = 0; p < points.size(); p++) {
+            std::array<double, 3> next = TransformPoint(points[p].data());
+            if (p == 0) {
+                AppendPointWords(first, previous, next, incremental, Has('Z'));
+            } else {
+                m_extraLines += m_separator;
+                size_t lineStart = m_extraLines.size();
+                AppendPointWords(m_extraLines, previous, next, incremental, false);
+                m_extraLines.erase(lineStart, 1);  // No leading space at the start of a line
+                m_extraLineCount++;
+            }
+            previous = next;
+        }
+
+        for (char letter : {'X', 'Y', 'Z', 'I', 'J', 'K', 'R'}) {
+            if (Has(letter)) Remove(Index(letter));
+        }
+        if (motionWord >= 0) {
+            Replace(motionWord, first);
+        } else {
+            Insert(FirstCodeOffset(), first + " ");
+        }
+        m_result->arcsLinearized++;
+    }
+
+    std::array<double, 3> TransformPoint(const double* p) const
+    {
+        return {m_m[0] * p[0] + m_m[1] * p[1] + m_m[2],
+                m_m[3] * p[0] + m_m[4] * p[1] + m_m[5],
+                m_zScale * p[2] + m_zOffset};
+    }
+
+    void AppendPointWords(std::string& text, const std::array<double, 3>& from, const std::array<double, 3>& to,
+                          bool incremental, bool forceZ)
+    {
+        static const char letters[3] = {'X', 'Y', 'Z'};
+        for (int axis = 0; axis < 3; axis++) {
+            double value = incremental ? to[axis] - from[axis] : to[axis];
+            double change = (to[axis] - from[axis]) * m_outputScale;
+            if (axis == 2 && !forceZ && std::fabs(change) < m_halfStep) continue;
+            text += ' ';
+            text += letters[axis];
+            AppendNumber(text, value * m_outputScale, m_decimals);
+        }
+    }
+
+    void UpdatePosition(State& state, bool incremental, const bool* given, const double* value)
+    {
+        for (int axis = 0; axis < 3; axis++) {
+            if (!given[axis]) continue;
+            if (incremental) {
+                state.pos[axis] += value[axis];
+            } else {
+                state.pos[axis] = value[axis];
+                state.relative[axis] = false;
+            }
+        }
+    }
+
+    // After homing or machine moves only the axes that moved (or all) are unknown
+    void ForgetPosition(State& state, bool all)
+    {
+        static const char letters[3] = {'X', 'Y', 'Z'};
+        for (int axis = 0; axis < 3; axis++) {
+            if (all || Has(letters[axis])) {
+                state.pos[axis] = NAN;
+                state.relative[axis] = false;
+            }
+        }
+    }
+
+    double Known(const State& state, int axis)
+    {
+        return std::isnan(state.pos[axis]) ? Unknown() : state.pos[axis];
+    }
+
+    double Unknown()
+    {
+        m_unknownPosition = true;
+        return 0.0;
+    }
+
+    // Writes X/Y (or I/J) pairs in output units: a rotation needs both words
+    // once either is given
+    void EmitPair(char first, char second, double a, double b)
+    {
+        bool hasFirst = Has(first), hasSecond = Has(second);
+        bool needFirst = hasFirst || (m_mixing && hasSecond);
+        bool needSecond = hasSecond || (m_mixing && hasFirst);
+
+        if (needFirst) {
+            if (hasFirst) {
+                SetWord(Index(first), a);
+            } else {
+                Insert(m_words[Index(second)].begin, WordText(first, a) + " ");
+            }
+        }
+        if (needSecond) {
+            if (hasSecond) {
+                SetWord(Index(second), b);
+            } else {
+                Insert(m_words[Index(first)].end, " " + WordText(second, b));
+            }
+        }
+    }
+
+    void ConvertWord(char letter)
+    {
+        if (m_out && m_unitsChange && Has(letter)) {
+            SetWord(Index(letter), Value(letter) * m_outputScale);
+        }
+    }
+
+    // Rewrites a word with a new value in output units, keeping the original
+    // text where the value did not change at output precision
+    void SetWord(int index, double value)
+    {
+        const Word& word = m_words[index];
+        if (!m_unitsChange && std::fabs(value - word.value) < m_halfStep) return;
+        Replace(index, WordText(word.letter, value));
+    }
+
+    std::string WordText(char letter, double value) const
+    {
+        std::string text(1, letter);
+        AppendNumber(text, value, m_decimals);
+        return text;
+    }
+
+    void Replace(int index, const std::string& text)
+    {
+        AddEdit(m_words[index].begin, m_words[index].end, text);
+    }
+
+    void Insert(uint32_t offset, const std::string& text)
+    {
+        AddEdit(offset, offset, text);
+    }
+
+    // Removes a word with the blanks after it
+    void Remove(int index)
+    {
+        uint32_t end = m_words[index].end;
+        while (end < m_length && (m_line[end] == ' ' || m_line[end] == '\t')) end++;
+        AddEdit(m_words[index].begin, end, "");
+        m_removedWords = true;
+    }
+
+    void AddEdit(uint32_t begin, uint32_t end, const std::string& text)
+    {
+        m_edits.push_back({begin, end, m_editText.size(), text.size()});
+        m_editText += text;
+    }
+
+    // Where a new motion word goes: after a leading N line number
+    uint32_t FirstCodeOffset() const
+    {
+        for (const Word& word : m_words) {
+            if (word.letter != 'N') return word.begin;
+        }
+        return m_words.back().end;
+    }
+
+    double m_m[6];
+    double m_zScale;
+    double m_zOffset;
+    double m_tolerance;
+    double m_maxStretch;
+    bool m_mixing;
+    int m_targetUnits;
+    bool m_arcKept[3];
+    double m_arcScale[3];
+    bool m_arcFlip[3];
+
+    // Per line
+    const char* m_line = nullptr;
+    size_t m_length = 0;
+    std::string m_separator;  // The line's own line ending
+    std::vector<Word> m_words;
+    int m_index[26];
+    std::vector<Edit> m_edits;
+    std::string m_editText;
+    std::string m_extraLines;  // Lines added after this one, each preceded by m_separator
+    size_t m_extraLineCount = 0;
+    bool m_removedWords = false;
+    std::vector<std::array<double, 3>> m_arcPoints;
+    double m_sourceScale = 1.0;
+    double m_outputScale = 1.0;
+    int m_decimals = 3;
+    double m_halfStep = 0.0005;
+    bool m_unitsChange = false;
+    bool m_unknownPosition = false;
+
+    std::string* m_out = nullptr;
+    GCodeTransform::Result* m_result = nullptr;
+};
+
+} // namespace
+
+GCodeTransform::GCodeTransform()
+    : m_arcTolerance(0.01)
+{
+    Reset();
+}
+
+void GCodeTransform::Reset()
+{
+    static const double identity[6] = {1, 0, 0, 0, 1, 0};
+    std::copy(identity, identity + 6, m_matrix);
+    m_zScale = 1.0;
+    m_zOffset = 0.0;
+    m_outputUnits = OutputUnits::KEEP;
+}
+
+void GCodeTransform::Multiply(const double* t)
+{
+    const double* m = m_matrix;
+    double result[6] = {
+        t[0] * m[0] + t[1] * m[3], t[0] * m[1] + t[1] * m[4], t[0] * m[2] + t[1] * m[5] + t[2],
+        t[3] * m[0] + t[4] * m[3], t[3] * m[1] + t[4] * m[4], t[3] * m[2] + t[4] * m[5] + t[5],
+    };
+    std::copy(result, result + 6, m_matrix);
+}
+
+void GCodeTransform::Translate(double x, double y, double z)
+{
+    const double t[6] = {1, 0, x, 0, 1, y};
+    Multiply(t);
+    m_zOffset += z;
+}
+
+void GCodeTransform::RotateZ(double degrees, double centerX, double centerY)
+{
+    // Quarter turns are exact, so they keep arcs and words they do not move
+    double radians = degrees * PI / 180.0;
+    double c = std::cos(radians), s = std::sin(radians);
+    for (double* value : {&c, &s}) {
+        if (std::fabs(*value) < 1e-15) *value = 0.0;
+        if (std::fabs(std::fabs(*value) - 1.0) < 1e-15) *value = *value > 0 ? 1.0 : -1.0;
+    }
+
+    const double t[6] = {c, -s, centerX - c * centerX + s * centerY,
+                         s, c, centerY - s * centerX - c * centerY};
+    Multiply(t);
+}
+
+void GCodeTransform::Scale(double x, double y, double z)
+{
+    const double t[6] = {x, 0, 0, 0, y, 0};
+    Multiply(t);
+    m_zScale *= z;
+    m_zOffset *= z;
+}
+
+void GCodeTransform::MirrorX(double axisX)
+{
+    const double t[6] = {-1, 0, 2.0 * axisX, 0, 1, 0};
+    Multiply(t);
+}
+
+void GCodeTransform::MirrorY(double axisY)
+{
+    const double t[6] = {1, 0, 0, 0, -1, 2.0 * axisY};
+    Multiply(t);
+}
+
+void GCodeTransform::SetArcTolerance(double tolerance)
+{
+    if (tolerance > 0) m_arcTolerance = tolerance;
+}
+
+bool GCodeTransform::IsIdentity() const
+{
+    static const double identity[6] = {1, 0, 0, 0, 1, 0};
+    for (int i = 0; i < 6; i++) {
+        if (std::fabs(m_matrix[i] - identity[i]) > EPSILON) return false;
+    }
+    return std::fabs(m_zScale - 1.0) <= EPSILON && std::fabs(m_zOffset) <= EPSILON &&
+           m_outputUnits == OutputUnits::KEEP;
+}
+
+GCodeTransform::Result GCodeTransform::Apply(const std::string& text, std::string& output) const
+{
+    output.clear();
+    output.reserve(text.size() + text.size() / 8);
+    return Apply(text.data(), text.size(), [&output](const char* data, size_t size) {
+        output.append(data, size);
+    });
+}
+
+GCodeTransform::Result GCodeTransform::Apply(const char* data, size_t size, const OutputCallback& output,
+                                             const ProgressCallback& progress) const
+{
+    Result result;
+    if (!data || size == 0) return result;
+
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Chunks end at line boundaries; many per thread even out uneven lines
+    // and let progress be reported a round at a time
+    size_t nominal = std::max(MIN_CHUNK_BYTES, size / (threads * CHUNKS_PER_THREAD));
+    std::vector<const char*> bounds = {data};
+    const char* end = data + size;
+    while (end - bounds.back() > static_cast<ptrdiff_t>(nominal)) {
+        const char* cut = static_cast<const char*>(std::memchr(bounds.back() + nominal, '\n', end - bounds.back() - nominal));
+        if (!cut || cut + 1 >= end) break;
+        bounds.push_back(cut + 1);
+    }
+    bounds.push_back(end);
+    size_t chunkCount = bounds.size() - 1;
+
+    std::vector<State> entry(chunkCount);
+    entry[0].modal = DEFAULT_MODAL;
+    for (int axis = 0; axis < 3; axis++) {
+        entry[0].pos[axis] = 0.0;  // Where the parser and visualizer start too
+        entry[0].relative[axis] = false;
+    }
+
+    // Passes 1 and 2 cost about 60% of the rewrite itself; with one thread
+    // the chunks instead run in order, each starting where the last stopped
+    bool sequential = threads == 1 || chunkCount == 1;
+    if (!sequential) {
+        // Pass 1: the modal codes each chunk leaves set
+        std::vector<Modal> modalChanges(chunkCount, UNSET_MODAL);
+        ParallelFor(chunkCount, threads, [&](size_t chunk) {
+            std::vector<Word> words;
+            Modal& modal = modalChanges[chunk];
+            for (const char* line = bounds[chunk]; line < bounds[chunk + 1];) {
+                const char* newline = static_cast<const char*>(std::memchr(line, '\n', bounds[chunk + 1] - line));
+                const char* next = newline ? newline + 1 : bounds[chunk + 1];
+                Tokenize(line, static_cast<size_t>(next - line), words);
+                ApplyModalCodes(words, modal);
+                line = next;
+            }
+        });
+
+        for (size_t chunk = 1; chunk < chunkCount; chunk++) {
+            const Modal& previous = entry[chunk - 1].modal;
+            const Modal& changes = modalChanges[chunk - 1];
+            Modal& modal = entry[chunk].modal;
+            modal.units = changes.units != UNSET ? changes.units : previous.units;
+            modal.distance = changes.distance != UNSET ? changes.distance : previous.distance;
+            modal.plane = changes.plane != UNSET ? changes.plane : previous.plane;
+            modal.motion = changes.motion != UNSET ? changes.motion : previous.motion;
+            modal.feedMode = changes.feedMode != UNSET ? changes.feedMode : previous.feedMode;
+        }
+
+        // Pass 2: where each chunk leaves the tool, relative to its start
+        // where the chunk only moves incrementally
+        std::vector<State> exits(chunkCount);
+        ParallelFor(chunkCount - 1, threads, [&](size_t chunk) {
+            State& state = exits[chunk];
+            state.modal = entry[chunk].modal;
+            for (int axis = 0; axis < 3; axis++) {
+                state.pos[axis] = 0.0;
+                state.relative[axis] = true;
+            }
+            Result unused;
+            ChunkTransformer transformer(*this);
+            transformer.Run(bounds[chunk], bounds[chunk + 1], state, nullptr, unused);
+        });
+
+        for (size_t chunk = 1; chunk < chunkCount; chunk++) {
+            const State& exit = exits[chunk - 1];
+            for (int axis = 0; axis < 3; axis++) {
+                entry[chunk].pos[axis] = exit.relative[axis] ? entry[chunk - 1].pos[axis] + exit.pos[axis] : exit.pos[axis];
+                entry[chunk].relative[axis] = false;
+            }
+        }
+    }
+
+    // Without a units word ahead of its first coordinates the program would
+    // be read in the machine's default units
+    if (m_outputUnits != OutputUnits::KEEP && !SelectsUnitsFirst(data, size)) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', size));
+        bool crlf = newline && newline > data && newline[-1] == '\r';
+        std::string header = m_outputUnits == OutputUnits::INCHES ? "G20" : "G21";
+        header += crlf ? "\r\n" : "\n";
+        output(header.data(), header.size());
+        result.outputBytes += header.size();
+        result.lines++;
+    }
+
+    // Pass 3: rewrite, a round of chunks at a time, handing each round's
+    // output on in order
+    size_t round = std::max<size_t>(1, threads * CHUNKS_PER_THREAD_ROUND);
+    std::vector<std::string> texts(std::min(round, chunkCount));
+    std::vector<Result> results(texts.size());
+    for (size_t first = 0; first < chunkCount; first += round) {
+        size_t count = std::min(round, chunkCount - first);
+        ParallelFor(count, threads, [&](size_t i) {
+            size_t chunk = first + i;
+            State state = entry[chunk];
+            texts[i].clear();
+            texts[i].reserve(static_cast<size_t>(bounds[chunk + 1] - bounds[chunk]) * 9 / 8);
+            results[i] = Result();
+            ChunkTransformer transformer(*this);
+            transformer.Run(bounds[chunk], bounds[chunk + 1], state, &texts[i], results[i]);
+            if (sequential && chunk + 1 < chunkCount) {
+                entry[chunk + 1] = state;
+            }
+        });
+
+        for (size_t i = 0; i < count; i++) {
+            output(texts[i].data(), texts[i].size());
+            result.lines += results[i].lines;
+            result.outputBytes += texts[i].size();
+            result.arcsLinearized += results[i].arcsLinearized;
+            result.unknownPositions += results[i].unknownPositions;
+        }
+        if (progress) {
+            progress(static_cast<size_t>(bounds[first + count] - data), size);
+        }
+    }
+
+    return result;
+}
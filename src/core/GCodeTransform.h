@@ -0,0 +1,84 @@
+/**
+ * core/GCodeTransform.h
+ * Geometric transforms of G-code programs
+ * Moves, rotates about Z, scales and mirrors a program and optionally
+ * normalizes it to millimetres or inches, rewriting only the words that
+ * change. Arcs keep their I/J/K/R form under similarity transforms and are
+ * linearized otherwise. The text is processed in chunks by several threads
+ * and the result is handed to the caller in order as it is produced.
+ *
+ * The parallel path scans the program twice more to find each chunk's
+ * starting state, so it does about 1.6x the work of one sequential pass and
+ * N cores can at best take 1.6/N of the single-thread time. On one core
+ * the chunks simply run in order instead (2M lines: 1.7 s -> 1.1 s).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <functional>
+
+class GCodeTransform
+{
+public:
+    enum class OutputUnits {
+        KEEP,         // Each line stays in the units it was written in
+        MILLIMETERS,  // G21
+        INCHES        // G20
+    };
+
+    struct Result {
+        size_t lines = 0;
+        size_t outputBytes = 0;
+        size_t arcsLinearized = 0;
+        // Lines whose result depended on a position the program never set
+        // (start of file, after G28/G53); it was taken as 0
+        size_t unknownPositions = 0;
+    };
+
+    // Receives the transformed program in order, piece by piece
+    using OutputCallback = std::function<void(const char* data, size_t size)>;
+    // Called on the calling thread as the output advances through the input
+    using ProgressCallback = std::function<void(size_t doneBytes, size_t totalBytes)>;
+
+    GCodeTransform();
+
+    // Operations apply after the ones already added. Lengths are millimetres
+    // in program coordinates, angles are degrees counter-clockwise.
+    void Reset();
+    void Translate(double x, double y, double z = 0.0);
+    void RotateZ(double degrees, double centerX = 0.0, double centerY = 0.0);
+    void Scale(double x, double y, double z = 1.0);
+    void MirrorX(double axisX = 0.0);  // x -> 2 * axisX - x
+    void MirrorY(double axisY = 0.0);  // y -> 2 * axisY - y
+
+    void SetOutputUnits(OutputUnits units) { m_outputUnits = units; }
+    OutputUnits GetOutputUnits() const { return m_outputUnits; }
+
+    // Largest distance between a linearized arc and the true arc (mm)
+    void SetArcTolerance(double tolerance);
+    double GetArcTolerance() const { return m_arcTolerance; }
+
+    bool IsIdentity() const;
+
+    // Transforms [data, data + size). Exceptions thrown by either callback
+    // (e.g. a failed write or a cancel) abort the transform and propagate.
+    Result Apply(const char* data, size_t size, const OutputCallback& output,
+                 const ProgressCallback& progress = ProgressCallback()) const;
+    Result Apply(const std::string& text, std::string& output) const;
+
+    // Affine map of the XY plane: x' = m[0]x + m[1]y + m[2], y' = m[3]x + m[4]y + m[5]
+    const double* GetMatrix() const { return m_matrix; }
+    double GetZScale() const { return m_zScale; }
+    double GetZOffset() const { return m_zOffset; }
+
+private:
+    void Multiply(const double* matrix);
+
+    double m_matrix[6];
+    double m_zScale;
+    double m_zOffset;
+    OutputUnits m_outputUnits;
+    double m_arcTolerance;
+};
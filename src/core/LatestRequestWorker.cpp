@@ -0,0 +1,76 @@
+/**
+ * core/LatestRequestWorker.cpp
+ * Implementation of the latest-request-wins worker thread
+ */
+
+#include "LatestRequestWorker.h"
+#include "SimpleLogger.h"
+
+LatestRequestWorker::LatestRequestWorker(const std::string& name)
+    : m_name(name), m_pendingGeneration(0), m_generation(0), m_stop(false)
+{
+}
+
+LatestRequestWorker::~LatestRequestWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_pending = nullptr;
+        m_generation++;
+    }
+    m_condition.notify_all();
+
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+uint64_t LatestRequestWorker::Post(Task task)
+{
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        generation = ++m_generation;  // Also cancels the task currently running
+        m_pending = std::move(task);
+        m_pendingGeneration = generation;
+
+        if (!m_worker.joinable()) {
+            m_worker = std::thread(&LatestRequestWorker::WorkerLoop, this);
+        }
+    }
+    m_condition.notify_one();
+
+    return generation;
+}
+
+void LatestRequestWorker::Cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending = nullptr;
+    m_generation++;
+}
+
+void LatestRequestWorker::WorkerLoop()
+{
+    while (true) {
+        Task task;
+        uint64_t generation;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stop || m_pending; });
+            if (m_stop) {
+                return;
+            }
+            task = std::move(m_pending);
+            m_pending = nullptr;
+            generation = m_pendingGeneration;
+        }
+
+        try {
+            task(generation);
+        } catch (const std::exception& e) {
+            LOG_ERROR(m_name + " - request failed: " + std::string(e.what()));
+        }
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * core/LatestRequestWorker.h
+ * Single background thread where the latest request wins
+ * Posting a request replaces the one still queued and marks the one running
+ * as cancelled; tasks poll IsCancelled() with their generation id and return
+ * early. Used by the editor analysis/search and the console search.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+class LatestRequestWorker
+{
+public:
+    // Runs on the worker thread with the generation id returned by Post()
+    using Task = std::function<void(uint64_t generation)>;
+
+    // 'name' prefixes the log message of a task that throws
+    explicit LatestRequestWorker(const std::string& name);
+    // Cancels the running task and waits for it to return
+    ~LatestRequestWorker();
+
+    // Queues 'task', replacing any queued task and cancelling the running one.
+    // The thread is started on the first request.
+    uint64_t Post(Task task);
+    void Cancel();
+
+    bool IsCancelled(uint64_t generation) const { return m_generation.load() != generation; }
+
+private:
+    void WorkerLoop();
+
+    std::string m_name;
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    Task m_pending;
+    uint64_t m_pendingGeneration;
+    std::atomic<uint64_t> m_generation;
+    bool m_stop;
+
+    // Non-copyable
+    LatestRequestWorker(const LatestRequestWorker&) = delete;
+    LatestRequestWorker& operator=(const LatestRequestWorker&) = delete;
+};
@@ -5,6 +5,7 @@
 
 #include "MachineConfigManager.h"
 #include "SimpleLogger.h"
+#include "ConfigFile.h"
 #include <fstream>
 #include <filesystem>
 #include <chrono>
@@ -18,103 +19,180 @@ MachineConfigManager& MachineConfigManager::Instance() {
     return instance;
 }
 
+MachineConfigManager::MachineConfigManager()
+    : m_snapshot(std::make_shared<const Snapshot>())
+    , m_savePending(false)
+    , m_stopSaver(false)
+    , m_savedGeneration(0)
+{
+}
+
+MachineConfigManager::~MachineConfigManager() {
+    // Stopping the saver writes any change still pending
+    if (m_saveThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_saveMutex);
+            m_stopSaver = true;
+        }
+        m_saveCondition.notify_one();
+        m_saveThread.join();
+    }
+    
+    // Leave a readable copy of what the binary file holds
+    if (!ConfigFile::isJsonCurrent(GetConfigFilePath())
+        && std::filesystem::exists(ConfigFile::binaryPath(GetConfigFilePath()))) {
+        SaveToFile();
+    }
+}
+
+MachineConfigManager::MachinePtr MachineConfigManager::Snapshot::Find(const std::string& machineId) const {
+    for (const auto& machine : machines) {
+        if (machine->id == machineId) {
+            return machine;
+        }
+    }
+    return nullptr;
+}
+
+// Snapshot access
+std::shared_ptr<const MachineConfigManager::Snapshot> MachineConfigManager::GetSnapshot() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+MachineConfigManager::MachinePtr MachineConfigManager::FindMachine(const std::string& machineId) const {
+    return GetSnapshot()->Find(machineId);
+}
+
 // Machine management
 std::vector<EnhancedMachineConfig> MachineConfigManager::GetAllMachines() const {
-    return m_machines;
+    auto snapshot = GetSnapshot();
+    std::vector<EnhancedMachineConfig> machines;
+    machines.reserve(snapshot->machines.size());
+    for (const auto& machine : snapshot->machines) {
+        machines.push_back(*machine);
+    }
+    return machines;
 }
 
 EnhancedMachineConfig MachineConfigManager::GetMachine(const std::string& machineId) const {
-    size_t index = FindMachineIndex(machineId);
-    if (index < m_machines.size()) {
-        return m_machines[index];
+    MachinePtr machine = FindMachine(machineId);
+    if (machine) {
+        return *machine;
     }
     return EnhancedMachineConfig(); // Return empty config if not found
 }
 
 void MachineConfigManager::AddMachine(const EnhancedMachineConfig& machine) {
-    // Check if machine already exists
-    size_t index = FindMachineIndex(machine.id);
-    if (index < m_machines.size()) {
-        // Update existing
-        m_machines[index] = machine;
-    } else {
-        // Add new
-        m_machines.push_back(machine);
+    auto added = std::make_shared<const EnhancedMachineConfig>(machine);
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        auto next = std::make_shared<Snapshot>(*GetSnapshot());
+        
+        // Check if machine already exists
+        size_t index = FindMachineIndex(*next, machine.id);
+        if (index < next->machines.size()) {
+            // Update existing
+            next->machines[index] = added;
+        } else {
+            // Add new
+            next->machines.push_back(added);
+        }
+        Publish(next);
     }
     
-    SaveToFile();
-    NotifyMachineUpdate(machine.id);
+    NotifyMachineUpdate(added);
     
     LOG_INFO("Added/Updated machine configuration: " + machine.name + " (" + machine.id + ")");
 }
 
 void MachineConfigManager::UpdateMachine(const std::string& machineId, const EnhancedMachineConfig& machine) {
-    size_t index = FindMachineIndex(machineId);
-    if (index < m_machines.size()) {
-        m_machines[index] = machine;
-        SaveToFile();
-        NotifyMachineUpdate(machineId);
+    MachinePtr updated = ModifyMachine(machineId, [&machine](EnhancedMachineConfig& config) {
+        config = machine;
+    });
+    if (updated) {
+        NotifyMachineUpdate(updated);
         LOG_INFO("Updated machine configuration: " + machine.name + " (" + machineId + ")");
     }
 }
 
 void MachineConfigManager::RemoveMachine(const std::string& machineId) {
-    size_t index = FindMachineIndex(machineId);
-    if (index < m_machines.size()) {
-        std::string machineName = m_machines[index].name;
-        m_machines.erase(m_machines.begin() + index);
+    std::string machineName;
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        auto next = std::make_shared<Snapshot>(*GetSnapshot());
         
-        // Clear active machine if it was the removed one
-        if (m_activeMachineId == machineId) {
-            m_activeMachineId.clear();
+        size_t index = FindMachineIndex(*next, machineId);
+        if (index >= next->machines.size()) {
+            return;
         }
+        machineName = next->machines[index]->name;
+        next->machines.erase(next->machines.begin() + index);
         
-        SaveToFile();
-        LOG_INFO("Removed machine configuration: " + machineName + " (" + machineId + ")");
+        // Clear active machine if it was the removed one
+        if (next->activeMachineId == machineId) {
+            next->activeMachineId.clear();
+        }
+        Publish(next);
     }
+    
+    LOG_INFO("Removed machine configuration: " + machineName + " (" + machineId + ")");
 }
 
 // Active machine management
 void MachineConfigManager::SetActiveMachine(const std::string& machineId) {
-    if (FindMachineIndex(machineId) < m_machines.size() || machineId.empty()) {
-        m_activeMachineId = machineId;
-        LOG_INFO("Active machine set to: " + (machineId.empty() ? "None" : machineId));
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        auto current = GetSnapshot();
+        if (!machineId.empty() && !current->Find(machineId)) {
+            return;
+        }
+        auto next = std::make_shared<Snapshot>(*current);
+        next->activeMachineId = machineId;
+        Publish(next);
     }
+    LOG_INFO("Active machine set to: " + (machineId.empty() ? "None" : machineId));
 }
 
 std::string MachineConfigManager::GetActiveMachineId() const {
-    return m_activeMachineId;
+    return GetSnapshot()->activeMachineId;
 }
 
 EnhancedMachineConfig MachineConfigManager::GetActiveMachine() const {
-    return GetMachine(m_activeMachineId);
+    auto snapshot = GetSnapshot();
+    MachinePtr machine = snapshot->Find(snapshot->activeMachineId);
+    return machine ? *machine : EnhancedMachineConfig();
 }
 
 bool MachineConfigManager::HasActiveMachine() const {
-    return !m_activeMachineId.empty() && FindMachineIndex(m_activeMachineId) < m_machines.size();
+    auto snapshot = GetSnapshot();
+    return !snapshot->activeMachineId.empty() && snapshot->Find(snapshot->activeMachineId);
 }
 
 // Machine capability management
 void MachineConfigManager::UpdateMachineCapabilities(const std::string& machineId, const MachineCapabilities& capabilities) {
-    size_t index = FindMachineIndex(machineId);
-    if (index < m_machines.size()) {
-        m_machines[index].capabilities = capabilities;
+    bool configureHoming = !capabilities.kinematics.empty() && capabilities.capabilitiesValid;
+    MachinePtr updated = ModifyMachine(machineId, [&](EnhancedMachineConfig& machine) {
+        machine.capabilities = capabilities;
         
         // Auto-configure homing based on detected kinematics
-        if (!capabilities.kinematics.empty() && capabilities.capabilitiesValid) {
-            AutoConfigureHoming(machineId, capabilities.kinematics);
+        if (configureHoming) {
+            ApplyHomingForKinematics(machine, capabilities.kinematics);
         }
-        
-        SaveToFile();
-        NotifyCapabilityUpdate(machineId);
-        LOG_INFO("Updated capabilities for machine: " + m_machines[index].name + " (Kinematics: " + capabilities.kinematics + ")");
+    });
+    
+    if (updated) {
+        if (configureHoming) {
+            NotifyMachineUpdate(updated);
+        }
+        NotifyCapabilityUpdate(updated);
+        LOG_INFO("Updated capabilities for machine: " + updated->name + " (Kinematics: " + capabilities.kinematics + ")");
     }
 }
 
 MachineCapabilities MachineConfigManager::GetMachineCapabilities(const std::string& machineId) const {
-    size_t index = FindMachineIndex(machineId);
-    if (index < m_machines.size()) {
-        return m_machines[index].capabilities;
+    MachinePtr machine = FindMachine(machineId);
+    if (machine) {
+        return machine->capabilities;
     }
     return MachineCapabilities();
 }
@@ -171,11 +249,15 @@ std::string MachineConfigManager::DetectKinematics(const std::map<int, float>& g
 }
 
 void MachineConfigManager::AutoConfigureHoming(const std::string& machineId, const std::string& kinematics) {
-    size_t index = FindMachineIndex(machineId);
-    if (index >= m_machines.size()) return;
-    
-    auto& machine = m_machines[index];
-    
+    MachinePtr updated = ModifyMachine(machineId, [&kinematics](EnhancedMachineConfig& machine) {
+        ApplyHomingForKinematics(machine, kinematics);
+    });
+    if (updated) {
+        NotifyMachineUpdate(updated);
+    }
+}
+
+void MachineConfigManager::ApplyHomingForKinematics(EnhancedMachineConfig& machine, const std::string& kinematics) {
     // Configure homing sequence based on kinematics
     if (kinematics == "CoreXY") {
         machine.homing.sequence = HomingSettings::SEQUENTIAL_ZXY;
@@ -192,91 +274,126 @@ void MachineConfigManager::AutoConfigureHoming(const std::string& machineId, con
         machine.homing.sequence = HomingSettings::SIMULTANEOUS;
         LOG_INFO("Auto-configured homing for Cartesian machine: " + machine.name + " (Simultaneous)");
     }
-    
-    SaveToFile();
-    NotifyMachineUpdate(machineId);
 }
 
 // Connection status updates
 void MachineConfigManager::UpdateConnectionStatus(const std::string& machineId, bool connected, const std::string& timestamp) {
-    size_t index = FindMachineIndex(machineId);
-    if (index < m_machines.size()) {
-        m_machines[index].connected = connected;
+    MachinePtr updated = ModifyMachine(machineId, [&](EnhancedMachineConfig& machine) {
+        machine.connected = connected;
         
         if (!timestamp.empty()) {
-            m_machines[index].lastConnected = timestamp;
+            machine.lastConnected = timestamp;
         } else if (connected) {
             // Generate current timestamp
             auto now = std::chrono::system_clock::now();
             auto time_t = std::chrono::system_clock::to_time_t(now);
             std::stringstream ss;
             ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-            m_machines[index].lastConnected = ss.str();
+            machine.lastConnected = ss.str();
         }
-        
-        SaveToFile();
-        NotifyMachineUpdate(machineId);
+    });
+    if (updated) {
+        NotifyMachineUpdate(updated);
     }
 }
 
 // Persistence
 void MachineConfigManager::SaveToFile() {
+    WriteSnapshot(*GetSnapshot(), true);
+}
+
+void MachineConfigManager::WriteSnapshot(const Snapshot& snapshot, bool exportJson) {
     try {
+        // Serialized without any lock; readers and writers carry on meanwhile
         json j = json::array();
         
-        for (const auto& machine : m_machines) {
-            j.push_back(machine.ToJson());
+        for (const auto& machine : snapshot.machines) {
+            j.push_back(machine->ToJson());
         }
         
         json root;
         root["machines"] = j;
-        root["activeMachine"] = m_activeMachineId;
+        root["activeMachine"] = snapshot.activeMachineId;
         root["version"] = "2.0";
         root["lastSaved"] = std::chrono::duration_cast<std::chrono::seconds>(
             std::chrono::system_clock::now().time_since_epoch()).count();
         
         std::string configPath = GetConfigFilePath();
+        std::lock_guard<std::mutex> lock(m_fileMutex);
+        
+        // A newer snapshot may have been written while this one was serialized
+        if (snapshot.generation < m_savedGeneration) {
+            return;
+        }
+        
         std::filesystem::create_directories(std::filesystem::path(configPath).parent_path());
         
-        std::ofstream file(configPath);
-        if (file.is_open()) {
-            file << root.dump(2);
-            file.close();
+        std::string error;
+        if (ConfigFile::save(configPath, root, &error, exportJson)) {
+            m_savedGeneration = snapshot.generation;
             LOG_INFO("Saved machine configurations to: " + configPath);
         } else {
-            LOG_ERROR("Failed to save machine configurations to: " + configPath);
+            LOG_ERROR("Failed to save machine configurations to: " + configPath + " (" + error + ")");
         }
     } catch (const std::exception& e) {
         LOG_ERROR("Error saving machine configurations: " + std::string(e.what()));
     }
 }
 
+void MachineConfigManager::ScheduleSave() {
+    {
+        std::lock_guard<std::mutex> lock(m_saveMutex);
+        m_savePending = true;
+        if (!m_saveThread.joinable()) {
+            m_saveThread = std::thread(&MachineConfigManager::SaverLoop, this);
+        }
+    }
+    m_saveCondition.notify_one();
+}
+
+void MachineConfigManager::SaverLoop() {
+    std::unique_lock<std::mutex> lock(m_saveMutex);
+    
+    while (true) {
+        m_saveCondition.wait(lock, [this] { return m_savePending || m_stopSaver; });
+        if (!m_savePending) {
+            return;  // Stopped with nothing left to write
+        }
+        
+        // Let a burst of changes (connect, capability query, homing setup) share one write
+        m_saveCondition.wait_for(lock, std::chrono::milliseconds(SAVE_DELAY_MS), [this] { return m_stopSaver; });
+        m_savePending = false;
+        
+        lock.unlock();
+        WriteSnapshot(*GetSnapshot());
+        lock.lock();
+    }
+}
+
 void MachineConfigManager::LoadFromFile() {
     try {
         std::string configPath = GetConfigFilePath();
         
-        if (!std::filesystem::exists(configPath)) {
-            LOG_INFO("Machine config file does not exist, starting with empty configuration");
-            return;
-        }
-        
-        std::ifstream file(configPath);
-        if (!file.is_open()) {
-            LOG_ERROR("Failed to open machine config file: " + configPath);
+        auto start = std::chrono::steady_clock::now();
+        json root;
+        std::string error;
+        ConfigFile::Format format;
+        if (!ConfigFile::load(configPath, root, &error, &format)) {
+            if (std::filesystem::exists(configPath) || std::filesystem::exists(ConfigFile::binaryPath(configPath))) {
+                LOG_ERROR("Failed to read machine config file: " + error);
+            } else {
+                LOG_INFO("Machine config file does not exist, starting with empty configuration");
+            }
             return;
         }
+        double readMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
         
-        json root;
-        file >> root;
-        file.close();
-        
-        m_machines.clear();
+        auto loaded = std::make_shared<Snapshot>();
         
         if (root.contains("machines") && root["machines"].is_array()) {
             for (const auto& machineJson : root["machines"]) {
                 try {
-                    EnhancedMachineConfig machine = EnhancedMachineConfig::FromJson(machineJson);
-                    m_machines.push_back(machine);
+                    loaded->machines.push_back(std::make_shared<const EnhancedMachineConfig>(EnhancedMachineConfig::FromJson(machineJson)));
                 } catch (const std::exception& e) {
                     LOG_ERROR("Error loading machine config: " + std::string(e.what()));
                 }
@@ -284,10 +401,23 @@ void MachineConfigManager::LoadFromFile() {
         }
         
         if (root.contains("activeMachine")) {
-            m_activeMachineId = root["activeMachine"].get<std::string>();
+            loaded->activeMachineId = root["activeMachine"].get<std::string>();
+        }
+        
+        size_t count = loaded->machines.size();
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            loaded->generation = GetSnapshot()->generation + 1;
+            std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(loaded));
+        }
+        {
+            // What was just read is what is on disk
+            std::lock_guard<std::mutex> lock(m_fileMutex);
+            m_savedGeneration = loaded->generation;
         }
         
-        LOG_INFO("Loaded " + std::to_string(m_machines.size()) + " machine configurations from: " + configPath);
+        LOG_INFO("Loaded " + std::to_string(count) + " machine configurations from: " + configPath
+                 + " (" + ConfigFile::formatName(format) + ", " + std::to_string(static_cast<int>(readMs + 0.5)) + " ms)");
         
     } catch (const std::exception& e) {
         LOG_ERROR("Error loading machine configurations: " + std::string(e.what()));
@@ -308,30 +438,51 @@ void MachineConfigManager::ImportLegacyMachines(const std::vector<LegacyMachineC
 }
 
 // Helper methods
-size_t MachineConfigManager::FindMachineIndex(const std::string& machineId) const {
-    for (size_t i = 0; i < m_machines.size(); ++i) {
-        if (m_machines[i].id == machineId) {
+void MachineConfigManager::Publish(std::shared_ptr<Snapshot> next) {
+    next->generation = GetSnapshot()->generation + 1;
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(next)));
+    ScheduleSave();
+}
+
+MachineConfigManager::MachinePtr MachineConfigManager::ModifyMachine(const std::string& machineId,
+                                                                     const std::function<void(EnhancedMachineConfig&)>& update) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    auto current = GetSnapshot();
+    
+    size_t index = FindMachineIndex(*current, machineId);
+    if (index >= current->machines.size()) {
+        return nullptr;
+    }
+    
+    // Copy only the machine that changes; the others are shared with the old snapshot
+    auto machine = std::make_shared<EnhancedMachineConfig>(*current->machines[index]);
+    update(*machine);
+    
+    auto next = std::make_shared<Snapshot>(*current);
+    next->machines[index] = machine;
+    Publish(next);
+    return machine;
+}
+
+size_t MachineConfigManager::FindMachineIndex(const Snapshot& snapshot, const std::string& machineId) {
+    for (size_t i = 0; i < snapshot.machines.size(); ++i) {
+        if (snapshot.machines[i]->id == machineId) {
             return i;
         }
     }
-    return m_machines.size(); // Not found
+    return snapshot.machines.size(); // Not found
 }
 
-void MachineConfigManager::NotifyMachineUpdate(const std::string& machineId) {
+// Callbacks run on the caller's thread, outside m_writeMutex
+void MachineConfigManager::NotifyMachineUpdate(const MachinePtr& machine) {
     if (m_machineUpdateCallback) {
-        size_t index = FindMachineIndex(machineId);
-        if (index < m_machines.size()) {
-            m_machineUpdateCallback(machineId, m_machines[index]);
-        }
+        m_machineUpdateCallback(machine->id, *machine);
     }
 }
 
-void MachineConfigManager::NotifyCapabilityUpdate(const std::string& machineId) {
+void MachineConfigManager::NotifyCapabilityUpdate(const MachinePtr& machine) {
     if (m_capabilityUpdateCallback) {
-        size_t index = FindMachineIndex(machineId);
-        if (index < m_machines.size()) {
-            m_capabilityUpdateCallback(machineId, m_machines[index].capabilities);
-        }
+        m_capabilityUpdateCallback(machine->id, machine->capabilities);
     }
 }
 
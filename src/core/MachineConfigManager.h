@@ -6,11 +6,16 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
 #include <json.hpp>
 
 using json = nlohmann::json;
@@ -145,13 +150,32 @@ struct EnhancedMachineConfig {
  * Singleton Machine Configuration Manager
  * Centralized management of all machine configurations and capabilities
  * All panels can access machine information through this manager
+ *
+ * Thread-safe: the configuration is an immutable snapshot that writers
+ * replace copy-on-write (only the changed machine is copied), so readers on
+ * any thread hold a shared_ptr to it without locking or copying. Changes
+ * are written to disk by a background saver shortly after they happen.
  */
 class MachineConfigManager {
 public:
+    using MachinePtr = std::shared_ptr<const EnhancedMachineConfig>;
+    
+    struct Snapshot {
+        std::vector<MachinePtr> machines;
+        std::string activeMachineId;
+        uint64_t generation = 0;
+        
+        MachinePtr Find(const std::string& machineId) const;
+    };
+    
     // Singleton access
     static MachineConfigManager& Instance();
     
-    // Machine management
+    // Current configuration - cheap, never blocks on writers
+    std::shared_ptr<const Snapshot> GetSnapshot() const;
+    MachinePtr FindMachine(const std::string& machineId) const;  // nullptr if not found
+    
+    // Machine management (the getters return copies)
     std::vector<EnhancedMachineConfig> GetAllMachines() const;
     EnhancedMachineConfig GetMachine(const std::string& machineId) const;
     void AddMachine(const EnhancedMachineConfig& machine);
@@ -182,7 +206,8 @@ public:
     void SetMachineUpdateCallback(MachineUpdateCallback callback) { m_machineUpdateCallback = callback; }
     void SetCapabilityUpdateCallback(CapabilityUpdateCallback callback) { m_capabilityUpdateCallback = callback; }
     
-    // Persistence
+    // Persistence - changes are saved in the background as enhanced_machines.cbor;
+    // SaveToFile() writes now and refreshes the JSON copy as well
     void SaveToFile();
     void LoadFromFile();
     std::string GetConfigFilePath() const;
@@ -191,25 +216,42 @@ public:
     void ImportLegacyMachines(const std::vector<struct LegacyMachineConfig>& legacyMachines);
     
 private:
-    MachineConfigManager() = default;
-    ~MachineConfigManager() = default;
+    MachineConfigManager();
+    ~MachineConfigManager();
     
     // Non-copyable
     MachineConfigManager(const MachineConfigManager&) = delete;
     MachineConfigManager& operator=(const MachineConfigManager&) = delete;
     
-    // Internal data
-    std::vector<EnhancedMachineConfig> m_machines;
-    std::string m_activeMachineId;
+    // Current configuration - std::atomic_load/atomic_store only
+    std::shared_ptr<const Snapshot> m_snapshot;
+    std::mutex m_writeMutex;  // One writer at a time builds the next snapshot
+    
+    // Background saver
+    std::thread m_saveThread;
+    std::mutex m_saveMutex;
+    std::condition_variable m_saveCondition;
+    bool m_savePending;
+    bool m_stopSaver;
+    std::mutex m_fileMutex;               // One file write at a time
+    uint64_t m_savedGeneration;           // Guarded by m_fileMutex
+    static const int SAVE_DELAY_MS = 500; // Changes within this window share one write
     
     // Callbacks
     MachineUpdateCallback m_machineUpdateCallback;
     CapabilityUpdateCallback m_capabilityUpdateCallback;
     
-    // Helper methods
-    size_t FindMachineIndex(const std::string& machineId) const;
-    void NotifyMachineUpdate(const std::string& machineId);
-    void NotifyCapabilityUpdate(const std::string& machineId);
+    // Helper methods - m_writeMutex held
+    void Publish(std::shared_ptr<Snapshot> next);
+    MachinePtr ModifyMachine(const std::string& machineId, const std::function<void(EnhancedMachineConfig&)>& update);
+    static size_t FindMachineIndex(const Snapshot& snapshot, const std::string& machineId);
+    static void ApplyHomingForKinematics(EnhancedMachineConfig& machine, const std::string& kinematics);
+    
+    void ScheduleSave();
+    void SaverLoop();
+    void WriteSnapshot(const Snapshot& snapshot, bool exportJson = false);
+    void NotifyMachineUpdate(const MachinePtr& machine);
+    void NotifyCapabilityUpdate(const MachinePtr& machine);
 };
 
 // Legacy compatibility structure (matches existing MachineManagerPanel::MachineConfig)
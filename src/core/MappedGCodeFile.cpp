@@ -0,0 +1,253 @@
+/**
+ * core/MappedGCodeFile.cpp
+ * Memory-mapped G-code file implementation
+ */
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+#include "MappedGCodeFile.h"
+#include "SubstringFinder.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace {
+
+// Below this size the index is built on the calling thread only
+const size_t PARALLEL_INDEX_MIN_BYTES = 4 * 1024 * 1024;
+
+} // namespace
+
+MappedGCodeFile::~MappedGCodeFile()
+{
+    Close();
+}
+
+bool MappedGCodeFile::Open(const std::string& path, std::string* error)
+{
+    Close();
+
+#ifdef _WIN32
+    int wideLength = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring widePath(wideLength > 0 ? wideLength - 1 : 0, L'\0');
+    if (wideLength > 0) {
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], wideLength);
+    }
+
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        if (error) *error = "Cannot open file (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        if (error) *error = "Cannot read file size (error " + std::to_string(GetLastError()) + ")";
+        CloseHandle(file);
+        return false;
+    }
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    m_fileHandle = file;
+
+    // Empty files cannot be mapped, but are valid documents
+    if (m_size > 0) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            if (error) *error = "Cannot map file (error " + std::to_string(GetLastError()) + ")";
+            if (mapping) CloseHandle(mapping);
+            CloseHandle(file);
+            m_fileHandle = nullptr;
+            m_size = 0;
+            return false;
+        }
+        m_mappingHandle = mapping;
+        m_data = static_cast<const char*>(view);
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (error) *error = std::string("Cannot open file: ") + std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        if (error) *error = std::string("Cannot read file size: ") + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    m_size = static_cast<size_t>(info.st_size);
+
+    if (m_size > 0) {
+        void* view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            if (error) *error = std::string("Cannot map file: ") + std::strerror(errno);
+            ::close(fd);
+            m_size = 0;
+            return false;
+        }
+        m_data = static_cast<const char*>(view);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+#endif
+
+    m_path = path;
+    m_open = true;
+    BuildLineIndex();
+    return true;
+}
+
+void MappedGCodeFile::Close()
+{
+#ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mappingHandle) CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+    if (m_fileHandle) CloseHandle(static_cast<HANDLE>(m_fileHandle));
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+#else
+    if (m_data) munmap(const_cast<char*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+    m_path.clear();
+    std::vector<uint64_t>().swap(m_lineStarts);
+}
+
+void MappedGCodeFile::BuildLineIndex()
+{
+    m_lineStarts.clear();
+    if (m_size == 0) return;
+
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    if (m_size < PARALLEL_INDEX_MIN_BYTES) {
+        threadCount = 1;
+    }
+
+    // Pass 1 counts the newlines of each chunk so the index is allocated
+    // exactly once; pass 2 writes each chunk's line starts at its own offset
+    size_t chunkSize = (m_size + threadCount - 1) / threadCount;
+    std::vector<size_t> counts(threadCount, 0);
+
+    auto forEachChunk = [threadCount](const std::function<void(unsigned int)>& work) {
+        std::vector<std::thread> workers;
+        for (unsigned int t = 1; t < threadCount; ++t) {
+            workers.emplace_back(work, t);
+        }
+        work(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    forEachChunk([this, chunkSize, &counts](unsigned int chunk) {
+        const char* p = m_data + std::min(m_size, chunk * chunkSize);
+        const char* end = m_data + std::min(m_size, (chunk + 1) * chunkSize);
+        size_t count = 0;
+        while (p < end && (p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr) {
+            count++;
+            p++;
+        }
+        counts[chunk] = count;
+    });
+
+    // Line 0 starts the file; every newline except a final one starts another line
+    std::vector<size_t> firstSlot(threadCount, 0);
+    size_t total = 1;
+    for (unsigned int t = 0; t < threadCount; ++t) {
+        firstSlot[t] = total;
+        total += counts[t];
+    }
+    m_lineStarts.resize(total);
+    m_lineStarts[0] = 0;
+
+    forEachChunk([this, chunkSize, &firstSlot](unsigned int chunk) {
+        const char* p = m_data + std::min(m_size, chunk * chunkSize);
+        const char* end = m_data + std::min(m_size, (chunk + 1) * chunkSize);
+        uint64_t* slot = m_lineStarts.data() + firstSlot[chunk];
+        while (p < end && (p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr) {
+            p++;
+            *slot++ = static_cast<uint64_t>(p - m_data);
+        }
+    });
+
+    if (m_lineStarts.size() > 1 && m_lineStarts.back() == m_size) {
+        m_lineStarts.pop_back();
+    }
+
+#ifndef _WIN32
+    // Viewing and searching jump around the file from here on
+    madvise(const_cast<char*>(m_data), m_size, MADV_RANDOM);
+#endif
+}
+
+std::string_view MappedGCodeFile::GetLine(size_t line) const
+{
+    if (line >= m_lineStarts.size()) return std::string_view();
+
+    size_t begin = static_cast<size_t>(m_lineStarts[line]);
+    size_t end = line + 1 < m_lineStarts.size() ? static_cast<size_t>(m_lineStarts[line + 1]) : m_size;
+    if (end > begin && m_data[end - 1] == '\n') end--;
+    if (end > begin && m_data[end - 1] == '\r') end--;
+    return std::string_view(m_data + begin, end - begin);
+}
+
+size_t MappedGCodeFile::LineFromOffset(uint64_t offset) const
+{
+    if (m_lineStarts.empty()) return 0;
+    auto it = std::upper_bound(m_lineStarts.begin(), m_lineStarts.end(), offset);
+    return static_cast<size_t>(it - m_lineStarts.begin()) - 1;
+}
+
+size_t MappedGCodeFile::FindInRange(const std::string& text, bool matchCase, size_t begin, size_t end, bool last) const
+{
+    const char* first = m_data + begin;
+    const char* stop = m_data + end;
+    size_t found = npos;
+
+    SubstringFinder finder(text, matchCase);
+    const char* p = first;
+    while (p < stop) {
+        const char* match = finder.Find(p, stop);
+        if (match == stop) break;
+        found = static_cast<size_t>(match - m_data);
+        if (!last) break;
+        // Continue after this line - one match per line is enough
+        size_t next = LineFromOffset(found) + 1;
+        p = m_data + (next < m_lineStarts.size() ? static_cast<size_t>(m_lineStarts[next]) : m_size);
+    }
+    return found;
+}
+
+size_t MappedGCodeFile::Find(const std::string& text, size_t fromLine, bool forward, bool matchCase) const
+{
+    if (text.empty() || m_lineStarts.empty()) return npos;
+    fromLine = std::min(fromLine, m_lineStarts.size() - 1);
+    size_t pivot = static_cast<size_t>(m_lineStarts[fromLine]);
+
+    size_t found;
+    if (forward) {
+        found = FindInRange(text, matchCase, pivot, m_size, false);
+        if (found == npos) found = FindInRange(text, matchCase, 0, pivot, false);
+    } else {
+        found = FindInRange(text, matchCase, 0, pivot, true);
+        if (found == npos) found = FindInRange(text, matchCase, pivot, m_size, true);
+    }
+    return found == npos ? npos : LineFromOffset(found);
+}
@@ -0,0 +1,66 @@
+/**
+ * core/MappedGCodeFile.h
+ * Read-only G-code file mapped into memory with a line offset index
+ * The file content is never copied: pages are loaded by the OS as lines are
+ * viewed, parsed or sent, and the only allocation is the index of line start
+ * offsets, which is built by scanning chunks of the file in parallel.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class MappedGCodeFile
+{
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    MappedGCodeFile() = default;
+    ~MappedGCodeFile();
+
+    // Maps the file and indexes its lines; on failure 'error' says why
+    bool Open(const std::string& path, std::string* error = nullptr);
+    void Close();
+
+    bool IsOpen() const { return m_open; }
+    const std::string& GetPath() const { return m_path; }
+    const char* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+    // Lines are 0-based; the returned text excludes the line ending
+    size_t GetLineCount() const { return m_lineStarts.size(); }
+    std::string_view GetLine(size_t line) const;
+    uint64_t GetLineOffset(size_t line) const { return m_lineStarts[line]; }
+    // Line containing the byte at 'offset'
+    size_t LineFromOffset(uint64_t offset) const;
+
+    // First line at or after 'fromLine' (before it when searching backwards)
+    // containing 'text', or npos. Wraps around the end of the file.
+    size_t Find(const std::string& text, size_t fromLine, bool forward = true, bool matchCase = false) const;
+
+    // Bytes held by the line index
+    size_t GetIndexBytes() const { return m_lineStarts.capacity() * sizeof(uint64_t); }
+
+private:
+    void BuildLineIndex();
+    size_t FindInRange(const std::string& text, bool matchCase, size_t begin, size_t end, bool last) const;
+
+    std::string m_path;
+    bool m_open = false;
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<uint64_t> m_lineStarts;
+
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+
+    // Non-copyable
+    MappedGCodeFile(const MappedGCodeFile&) = delete;
+    MappedGCodeFile& operator=(const MappedGCodeFile&) = delete;
+};
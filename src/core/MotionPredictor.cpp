@@ -0,0 +1,159 @@
+/**
+ * core/MotionPredictor.cpp
+ * Implementation of the tool position predictor
+ */
+
+#include "MotionPredictor.h"
+#include <algorithm>
+#include <cmath>
+
+void MotionPredictor::setPath(const std::vector<MotionPoint>& points)
+{
+    m_points = points;
+    m_distance.assign(m_points.size(), 0.0);
+
+    for (size_t i = 1; i < m_points.size(); ++i) {
+        double dx = m_points[i].x - m_points[i - 1].x;
+        double dy = m_points[i].y - m_points[i - 1].y;
+        double dz = m_points[i].z - m_points[i - 1].z;
+        m_distance[i] = m_distance[i - 1] + std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    m_predicting = false;
+    m_segment = 0;
+    m_resyncCursor = 0;
+}
+
+void MotionPredictor::clear()
+{
+    m_points.clear();
+    m_distance.clear();
+    m_predicting = false;
+    m_segment = 0;
+    m_resyncCursor = 0;
+}
+
+bool MotionPredictor::report(const MotionPoint& position, double feedRate, double timeSeconds)
+{
+    m_predicting = false;
+    m_reportTime = timeSeconds;
+    m_speed = feedRate / 60.0;
+
+    if (m_points.size() < 2 || feedRate <= 0.0) {
+        return false;
+    }
+
+    size_t segment;
+    double pathDistance;
+    if (!locate(position, segment, pathDistance)) {
+        return false;
+    }
+
+    m_segment = segment;
+    m_reportDistance = pathDistance;
+    m_predicting = true;
+    return true;
+}
+
+bool MotionPredictor::predict(double timeSeconds, MotionPoint& position) const
+{
+    if (!m_predicting) return false;
+
+    double elapsed = std::min(std::max(timeSeconds - m_reportTime, 0.0), MAX_EXTRAPOLATION_S);
+    double pathDistance = std::min(m_reportDistance + m_speed * elapsed, m_distance.back());
+
+    position = pointAt(pathDistance);
+    return true;
+}
+
+double MotionPredictor::nearestOnSegment(size_t segment, const MotionPoint& position, double& t) const
+{
+    const MotionPoint& a = m_points[segment];
+    const MotionPoint& b = m_points[segment + 1];
+
+    double dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+    double lengthSq = dx * dx + dy * dy + dz * dz;
+
+    t = 0.0;
+    if (lengthSq > 0.0) {
+        t = ((position.x - a.x) * dx + (position.y - a.y) * dy + (position.z - a.z) * dz) / lengthSq;
+        t = std::min(std::max(t, 0.0), 1.0);
+    }
+
+    double px = a.x + dx * t - position.x;
+    double py = a.y + dy * t - position.y;
+    double pz = a.z + dz * t - position.z;
+    return px * px + py * py + pz * pz;
+}
+
+bool MotionPredictor::locate(const MotionPoint& position, size_t& segment, double& pathDistance)
+{
+    const size_t segmentCount = m_points.size() - 1;
+    const double maxDistanceSq = MAX_PATH_DISTANCE * MAX_PATH_DISTANCE;
+
+    double bestDistanceSq = -1.0;
+    double bestT = 0.0;
+    size_t best = 0;
+
+    auto scan = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            double t;
+            double distanceSq = nearestOnSegment(i, position, t);
+            if (bestDistanceSq < 0.0 || distanceSq < bestDistanceSq) {
+                bestDistanceSq = distanceSq;
+                bestT = t;
+                best = i;
+            }
+        }
+    };
+
+    // The tool normally moved forward a few segments since the last report
+    size_t first = m_segment > SEARCH_WINDOW / 8 ? m_segment - SEARCH_WINDOW / 8 : 0;
+    size_t last = std::min(segmentCount, m_segment + SEARCH_WINDOW);
+    scan(first, last);
+
+    // Not found there (new run, seek, resume): look through the next chunk of
+    // the path instead of all of it - this runs on the GUI thread for every
+    // report, and a program of millions of moves is found within a few reports
+    if (bestDistanceSq < 0.0 || bestDistanceSq > maxDistanceSq) {
+        if (m_resyncCursor >= segmentCount) {
+            m_resyncCursor = 0;
+        }
+        size_t chunkEnd = std::min(segmentCount, m_resyncCursor + RESYNC_CHUNK);
+        scan(m_resyncCursor, chunkEnd);
+        m_resyncCursor = chunkEnd;
+    }
+
+    if (bestDistanceSq < 0.0 || bestDistanceSq > maxDistanceSq) {
+        return false;
+    }
+
+    segment = best;
+    pathDistance = m_distance[best] + (m_distance[best + 1] - m_distance[best]) * bestT;
+    return true;
+}
+
+MotionPoint MotionPredictor::pointAt(double pathDistance) const
+{
+    // First point at or beyond the distance, searched from the reported segment
+    auto it = std::lower_bound(m_distance.begin() + m_segment, m_distance.end(), pathDistance);
+    if (it == m_distance.end()) {
+        return m_points.back();
+    }
+
+    size_t index = static_cast<size_t>(it - m_distance.begin());
+    if (index == 0) {
+        return m_points.front();
+    }
+
+    const MotionPoint& a = m_points[index - 1];
+    const MotionPoint& b = m_points[index];
+    double length = m_distance[index] - m_distance[index - 1];
+    double t = length > 0.0 ? (pathDistance - m_distance[index - 1]) / length : 1.0;
+
+    MotionPoint point;
+    point.x = static_cast<float>(a.x + (b.x - a.x) * t);
+    point.y = static_cast<float>(a.y + (b.y - a.y) * t);
+    point.z = static_cast<float>(a.z + (b.z - a.z) * t);
+    return point;
+}
@@ -0,0 +1,65 @@
+/**
+ * core/MotionPredictor.h
+ * Tool position prediction between status reports
+ * Status reports arrive a few times a second. Between two reports the tool
+ * keeps moving along the programmed path at the reported feed, so the marker
+ * can be advanced along that path at display rate and snapped back onto the
+ * next real report, instead of polling the controller faster.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct MotionPoint {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+class MotionPredictor {
+public:
+    // Longest time a prediction runs ahead of the last report (1.5 poll periods at 5 Hz)
+    static constexpr double MAX_EXTRAPOLATION_S = 0.3;
+    // A report farther than this from the path (jogging, probing) is not predicted
+    static constexpr double MAX_PATH_DISTANCE = 0.5;
+
+    // Programmed path as one polyline in program order (arcs flattened)
+    void setPath(const std::vector<MotionPoint>& points);
+    void clear();
+
+    // A real status report at timeSeconds; feedRate is the reported feed in units/min.
+    // Returns true when the report lies on the path and the tool is moving.
+    bool report(const MotionPoint& position, double feedRate, double timeSeconds);
+
+    // Predicted position at timeSeconds, or false when there is nothing to predict
+    bool predict(double timeSeconds, MotionPoint& position) const;
+
+    bool isPredicting() const { return m_predicting; }
+    // Path segment (index of its first point) holding the last report on the path
+    size_t getSegment() const { return m_segment; }
+
+private:
+    // Index of the path segment nearest to 'position' and the distance along the
+    // path of the nearest point; searches near the previous match first, then
+    // one further chunk of the path per call
+    bool locate(const MotionPoint& position, size_t& segment, double& pathDistance);
+    double nearestOnSegment(size_t segment, const MotionPoint& position, double& t) const;
+    MotionPoint pointAt(double pathDistance) const;
+
+    static const size_t SEARCH_WINDOW = 256;
+    // Segments searched per report when the tool is not near the last match,
+    // so resynchronizing on a long program is spread over several reports
+    static const size_t RESYNC_CHUNK = 16384;
+
+    std::vector<MotionPoint> m_points;
+    std::vector<double> m_distance;  // Path length from the start to each point
+
+    bool m_predicting = false;
+    size_t m_segment = 0;            // Segment holding the last report
+    size_t m_resyncCursor = 0;       // Start of the next resync chunk
+    double m_reportDistance = 0.0;   // Path distance of the last report
+    double m_reportTime = 0.0;
+    double m_speed = 0.0;            // Units per second
+};
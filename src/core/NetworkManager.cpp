@@ -3,6 +3,7 @@
     #define UNICODE
     #endif
     #define WIN32_LEAN_AND_MEAN
+    #define FD_SETSIZE 1024  // select() in probeTcpPorts() waits on many connects
     #include <winsock2.h>
     #include <ws2tcpip.h>
     #include <iphlpapi.h>
@@ -17,6 +18,13 @@
     #include <unistd.h>
     #include <fcntl.h>
     #include <errno.h>
+    #include <netdb.h>
+    #include <ifaddrs.h>
+    #include <net/if.h>
+    #include <poll.h>
+    #ifdef __linux__
+        #include <sys/epoll.h>
+    #endif
 #endif
 
 #include "NetworkManager.h"
@@ -26,6 +34,193 @@
 #include <cstdint>
 #include <sstream>
 #include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+#ifdef _WIN32
+typedef SOCKET SocketHandle;
+const SocketHandle BAD_SOCKET = INVALID_SOCKET;
+void closeSocket(SocketHandle sock) { closesocket(sock); }
+#else
+typedef int SocketHandle;
+const SocketHandle BAD_SOCKET = -1;
+void closeSocket(SocketHandle sock) { close(sock); }
+#endif
+
+// Sockets open at once during a sweep; a /24 with two ports fits
+const size_t MAX_CONCURRENT_CONNECTS = 512;
+
+// Longest wait between checks of the cancel flag
+const int CANCEL_CHECK_MS = 50;
+
+int elapsedMs(std::chrono::steady_clock::time_point since) {
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
+#ifndef _WIN32
+// ICMP echo, built by hand - the header structs differ between Linux and BSD
+const unsigned char ICMP_TYPE_ECHO_REPLY = 0;
+const unsigned char ICMP_TYPE_ECHO_REQUEST = 8;
+const size_t ICMP_HEADER_SIZE = 8;
+const char ICMP_PAYLOAD[] = "FluidNC scan";
+
+// Timeout of a single sendPing()
+const int PING_TIMEOUT_MS = 500;
+
+uint16_t icmpChecksum(const unsigned char* data, size_t size) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        sum += (data[i] << 8) | data[i + 1];
+    }
+    if (size & 1) {
+        sum += data[size - 1] << 8;
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+/**
+ * Opens the socket for echo requests: an unprivileged datagram socket where
+ * the system allows it (Linux ping_group_range, macOS), else a raw socket
+ * when running with the rights for one. 'raw' tells which; a datagram socket
+ * has its echo id assigned and its replies filtered by the kernel.
+ */
+int openIcmpSocket(bool& raw) {
+    static bool logged = false;
+    
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP);
+    raw = false;
+    if (sock < 0) {
+        sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+        raw = true;
+    }
+    if (!logged) {
+        logged = true;
+        if (sock < 0) {
+            LOG_WARNING("ICMP echo unavailable (no ping socket permission, no raw socket rights); only TCP answers are used");
+        } else {
+            LOG_INFO(std::string("ICMP echo uses a ") + (raw ? "raw socket" : "datagram ping socket"));
+        }
+    }
+    return sock;
+}
+#endif
+
+/**
+ * Waits for non-blocking connects to complete, successfully or not.
+ * epoll on Linux; select() on Windows, where WSAPoll does not report failed
+ * connects on older versions; poll() elsewhere.
+ */
+class ConnectWaiter {
+public:
+    ConnectWaiter() {
+#ifdef __linux__
+        m_epoll = epoll_create1(EPOLL_CLOEXEC);
+#endif
+    }
+    
+    ~ConnectWaiter() {
+#ifdef __linux__
+        if (m_epoll >= 0) close(m_epoll);
+#endif
+    }
+    
+    bool isValid() const {
+#ifdef __linux__
+        return m_epoll >= 0;
+#else
+        return true;
+#endif
+    }
+    
+    bool add(SocketHandle sock, size_t tag) {
+#ifdef __linux__
+        epoll_event event = {};
+        event.events = EPOLLOUT;  // EPOLLERR and EPOLLHUP are always reported
+        event.data.u64 = tag;
+        return epoll_ctl(m_epoll, EPOLL_CTL_ADD, sock, &event) == 0;
+#else
+        m_sockets.push_back(std::make_pair(sock, tag));
+        return true;
+#endif
+    }
+    
+    void remove(SocketHandle sock) {
+#ifdef __linux__
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, sock, nullptr);
+#else
+        for (size_t i = 0; i < m_sockets.size(); i++) {
+            if (m_sockets[i].first == sock) {
+                m_sockets[i] = m_sockets.back();
+                m_sockets.pop_back();
+                break;
+            }
+        }
+#endif
+    }
+    
+    // Appends the tags of completed connects to 'ready'
+    void wait(int timeoutMs, std::vector<size_t>& ready) {
+#ifdef __linux__
+        epoll_event events[64];
+        int count = epoll_wait(m_epoll, events, 64, timeoutMs);
+        for (int i = 0; i < count; i++) {
+            ready.push_back(static_cast<size_t>(events[i].data.u64));
+        }
+#elif defined(_WIN32)
+        if (m_sockets.empty()) {
+            Sleep(timeoutMs);
+            return;
+        }
+        fd_set writeSet, exceptSet;
+        FD_ZERO(&writeSet);
+        FD_ZERO(&exceptSet);
+        for (const auto& entry : m_sockets) {
+            FD_SET(entry.first, &writeSet);   // Connected
+            FD_SET(entry.first, &exceptSet);  // Failed
+        }
+        timeval timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_usec = (timeoutMs % 1000) * 1000;
+        if (select(0, nullptr, &writeSet, &exceptSet, &timeout) > 0) {
+            for (const auto& entry : m_sockets) {
+                if (FD_ISSET(entry.first, &writeSet) || FD_ISSET(entry.first, &exceptSet)) {
+                    ready.push_back(entry.second);
+                }
+            }
+        }
+#else
+        std::vector<pollfd> fds(m_sockets.size());
+        for (size_t i = 0; i < m_sockets.size(); i++) {
+            fds[i].fd = m_sockets[i].first;
+            fds[i].events = POLLOUT;
+            fds[i].revents = 0;
+        }
+        if (poll(fds.data(), fds.size(), timeoutMs) > 0) {
+            for (size_t i = 0; i < fds.size(); i++) {
+                if (fds[i].revents != 0) {
+                    ready.push_back(m_sockets[i].second);
+                }
+            }
+        }
+#endif
+    }
+    
+private:
+#ifdef __linux__
+    int m_epoll;
+#else
+    std::vector<std::pair<SocketHandle, size_t>> m_sockets;
+#endif
+};
+
+} // namespace
 
 bool NetworkManager::initialize() {
     if (m_initialized) return true;
@@ -176,8 +371,381 @@ bool NetworkManager::sendPing(const std::string& ip, int& responseTime) {
     IcmpCloseHandle(hIcmp);
     return success;
 #else
+    bool replied = false;
     responseTime = -1;
-    return false;  // Not implemented for Unix yet
+    pingHosts({ip}, PING_TIMEOUT_MS, [&](const std::string&, int time) {
+        responseTime = time;
+        replied = true;
+    });
+    return replied;
+#endif
+}
+
+void NetworkManager::probeTcpPorts(const std::vector<std::string>& ips, const std::vector<int>& ports, int timeoutMs,
+                                   const HostProbeCallback& callback, const CancelCheck& cancelled) {
+    if (!m_initialized || ports.empty()) return;
+    
+    enum class PortState { PENDING, OPEN, REFUSED, FAILED };
+    
+    struct Host {
+        sockaddr_in addr;
+        std::vector<PortState> states;
+        int fastest = -1;
+        bool decided = false;
+    };
+    
+    // One probe per host and port; probes[host * ports.size() + port]
+    struct Probe {
+        SocketHandle sock = BAD_SOCKET;
+        std::chrono::steady_clock::time_point start;
+    };
+    
+    ConnectWaiter waiter;
+    if (!waiter.isValid()) {
+        LOG_ERROR("Cannot create the connect waiter for the TCP sweep");
+        return;
+    }
+    
+    std::vector<Host> hosts(ips.size());
+    for (size_t i = 0; i < ips.size(); i++) {
+        hosts[i].states.assign(ports.size(), PortState::PENDING);
+        hosts[i].addr = sockaddr_in();
+        hosts[i].addr.sin_family = AF_INET;
+        if (inet_pton(AF_INET, ips[i].c_str(), &hosts[i].addr.sin_addr) != 1) {
+            hosts[i].states.assign(ports.size(), PortState::FAILED);
+        }
+    }
+    std::vector<Probe> probes(ips.size() * ports.size());
+    size_t active = 0;
+    
+    auto closeProbe = [&](size_t index) {
+        Probe& probe = probes[index];
+        if (probe.sock != BAD_SOCKET) {
+            waiter.remove(probe.sock);
+            closeSocket(probe.sock);
+            probe.sock = BAD_SOCKET;
+            active--;
+        }
+    };
+    
+    // A host is decided once its most preferred open port is known, or when
+    // every port has answered or timed out
+    auto settle = [&](size_t hostIndex) {
+        Host& host = hosts[hostIndex];
+        if (host.decided) return;
+        
+        HostProbeResult result;
+        result.ip = ips[hostIndex];
+        for (size_t port = 0; port < ports.size(); port++) {
+            if (host.states[port] == PortState::PENDING) {
+                return;
+            }
+            if (host.states[port] == PortState::OPEN) {
+                result.openPort = ports[port];
+                break;
+            }
+        }
+        host.decided = true;
+        
+        // Later ports cannot change the result
+        for (size_t port = 0; port < ports.size(); port++) {
+            closeProbe(hostIndex * ports.size() + port);
+        }
+        
+        result.reachable = host.fastest >= 0;
+        result.responseTime = host.fastest;
+        if (callback) {
+            callback(result);
+        }
+    };
+    
+    auto finish = [&](size_t index, PortState state) {
+        size_t hostIndex = index / ports.size();
+        Host& host = hosts[hostIndex];
+        if (state != PortState::FAILED) {
+            int ms = elapsedMs(probes[index].start);
+            host.fastest = host.fastest < 0 ? ms : std::min(host.fastest, ms);
+        }
+        host.states[index % ports.size()] = state;
+        closeProbe(index);
+        settle(hostIndex);
+    };
+    
+    auto start = [&](size_t index) {
+        size_t hostIndex = index / ports.size();
+        Host& host = hosts[hostIndex];
+        if (host.decided || host.states[index % ports.size()] != PortState::PENDING) {
+            settle(hostIndex);
+            return;
+        }
+        
+        Probe& probe = probes[index];
+        probe.start = std::chrono::steady_clock::now();
+        probe.sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (probe.sock == BAD_SOCKET) {
+            finish(index, PortState::FAILED);
+            return;
+        }
+        active++;
+        
+#ifdef _WIN32
+        u_long mode = 1;
+        ioctlsocket(probe.sock, FIONBIO, &mode);
+#else
+        int flags = fcntl(probe.sock, F_GETFL, 0);
+        fcntl(probe.sock, F_SETFL, flags | O_NONBLOCK);
+#endif
+        
+        sockaddr_in addr = host.addr;
+        addr.sin_port = htons(static_cast<unsigned short>(ports[index % ports.size()]));
+        int result = connect(probe.sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        if (result == 0) {
+            finish(index, PortState::OPEN);
+            return;
+        }
+#ifdef _WIN32
+        int error = WSAGetLastError();
+        bool inProgress = error == WSAEWOULDBLOCK;
+        bool refused = error == WSAECONNREFUSED;
+#else
+        int error = errno;
+        bool inProgress = error == EINPROGRESS;
+        bool refused = error == ECONNREFUSED;
+#endif
+        if (!inProgress) {
+            finish(index, refused ? PortState::REFUSED : PortState::FAILED);
+        } else if (!waiter.add(probe.sock, index)) {
+            finish(index, PortState::FAILED);
+        }
+    };
+    
+    size_t next = 0;
+    std::vector<size_t> ready;
+    while (next < probes.size() || active > 0) {
+        if (cancelled && cancelled()) break;
+        
+        while (next < probes.size() && active < MAX_CONCURRENT_CONNECTS) {
+            start(next++);
+        }
+        if (active == 0) continue;
+        
+        // Sleep until a connect completes, the oldest one times out or it is
+        // time to look at the cancel flag
+        int wait = CANCEL_CHECK_MS;
+        for (const Probe& probe : probes) {
+            if (probe.sock != BAD_SOCKET) {
+                wait = std::min(wait, std::max(0, timeoutMs - elapsedMs(probe.start)));
+            }
+        }
+        
+        ready.clear();
+        waiter.wait(wait, ready);
+        for (size_t index : ready) {
+            if (probes[index].sock == BAD_SOCKET) continue;  // Closed by an earlier event of this batch
+            
+            int error = 0;
+#ifdef _WIN32
+            int length = sizeof(error);
+            getsockopt(probes[index].sock, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length);
+            bool refused = error == WSAECONNREFUSED;
+#else
+            socklen_t length = sizeof(error);
+            getsockopt(probes[index].sock, SOL_SOCKET, SO_ERROR, &error, &length);
+            bool refused = error == ECONNREFUSED;
+#endif
+            finish(index, error == 0 ? PortState::OPEN : refused ? PortState::REFUSED : PortState::FAILED);
+        }
+        
+        for (size_t index = 0; index < probes.size(); index++) {
+            if (probes[index].sock != BAD_SOCKET && elapsedMs(probes[index].start) >= timeoutMs) {
+                finish(index, PortState::FAILED);
+            }
+        }
+    }
+    
+    // Cancelled: drop whatever is still connecting
+    for (size_t index = 0; index < probes.size(); index++) {
+        closeProbe(index);
+    }
+}
+
+void NetworkManager::pingHosts(const std::vector<std::string>& ips, int timeoutMs,
+                               const PingReplyCallback& callback, const CancelCheck& cancelled) {
+    if (!m_initialized) return;
+
+#ifdef _WIN32
+    // Every echo is in flight at once; each request signals its own event
+    HANDLE icmp = IcmpCreateFile();
+    if (icmp == INVALID_HANDLE_VALUE) return;
+    
+    struct Request {
+        size_t host;
+        HANDLE event;
+        std::vector<char> reply;
+    };
+    char sendData[] = "Ping";
+    std::vector<Request> pending;
+    
+    for (size_t i = 0; i < ips.size(); i++) {
+        if (cancelled && cancelled()) break;
+        
+        in_addr addr;
+        if (inet_pton(AF_INET, ips[i].c_str(), &addr) != 1) continue;
+        
+        Request request;
+        request.host = i;
+        request.event = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        if (!request.event) break;
+        // Room for the reply, the echoed data and the status block of an asynchronous request
+        request.reply.resize(sizeof(ICMP_ECHO_REPLY) + sizeof(sendData) + 8 + 64);
+        
+        DWORD result = IcmpSendEcho2(icmp, request.event, nullptr, nullptr, addr.s_addr,
+                                     sendData, sizeof(sendData), nullptr,
+                                     request.reply.data(), static_cast<DWORD>(request.reply.size()), timeoutMs);
+        if (result == 0 && GetLastError() != ERROR_IO_PENDING) {
+            CloseHandle(request.event);
+            continue;
+        }
+        pending.push_back(std::move(request));
+    }
+    
+    // The reply buffers stay in use until each request completes, which it
+    // does by itself within timeoutMs - so wait for all of them
+    while (!pending.empty()) {
+        for (size_t i = 0; i < pending.size();) {
+            Request& request = pending[i];
+            if (WaitForSingleObject(request.event, 0) != WAIT_OBJECT_0) {
+                i++;
+                continue;
+            }
+            if (IcmpParseReplies(request.reply.data(), static_cast<DWORD>(request.reply.size())) > 0) {
+                PICMP_ECHO_REPLY echoReply = reinterpret_cast<PICMP_ECHO_REPLY>(request.reply.data());
+                if (echoReply->Status == IP_SUCCESS && callback && !(cancelled && cancelled())) {
+                    callback(ips[request.host], static_cast<int>(echoReply->RoundTripTime));
+                }
+            }
+            CloseHandle(request.event);
+            pending[i] = std::move(pending.back());
+            pending.pop_back();
+        }
+        if (!pending.empty()) {
+            WaitForSingleObject(pending.front().event, 10);
+        }
+    }
+    
+    IcmpCloseHandle(icmp);
+#else
+    // One socket for the whole sweep: every echo goes out first, then the
+    // replies are collected until the deadline and matched by sequence number
+    // (and by id on a raw socket, which sees every echo reply of the machine)
+    bool raw = false;
+    int sock = openIcmpSocket(raw);
+    if (sock < 0) return;
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+    int bufferSize = 512 * 1024;  // A raw socket also queues the requests sent to this machine
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    
+    std::random_device random;
+    uint16_t id = static_cast<uint16_t>(random());  // Raw sockets only; the kernel sets it otherwise
+    uint16_t firstSequence = static_cast<uint16_t>(random());
+    
+    struct Target {
+        sockaddr_in addr;
+        std::chrono::steady_clock::time_point sent;
+        bool pending = false;
+    };
+    std::vector<Target> targets(ips.size());
+    size_t remaining = 0;
+    
+    // Reads every reply already queued
+    unsigned char reply[1500];
+    auto drain = [&]() {
+        while (true) {
+            sockaddr_in from;
+            socklen_t fromLength = sizeof(from);
+            ssize_t length = recvfrom(sock, reply, sizeof(reply), 0, reinterpret_cast<sockaddr*>(&from), &fromLength);
+            if (length <= 0) break;
+            
+            // Raw sockets (and datagram ones outside Linux) include the IP header
+            const unsigned char* icmp = reply;
+            size_t size = static_cast<size_t>(length);
+            if ((reply[0] >> 4) == 4) {
+                size_t headerSize = (reply[0] & 0x0F) * 4;
+                if (headerSize >= size) continue;
+                icmp += headerSize;
+                size -= headerSize;
+            }
+            
+            if (size < ICMP_HEADER_SIZE || icmp[0] != ICMP_TYPE_ECHO_REPLY || icmp[1] != 0) continue;
+            if (raw && ((icmp[4] << 8) | icmp[5]) != id) continue;  // Another process's ping
+            
+            size_t index = static_cast<uint16_t>(((icmp[6] << 8) | icmp[7]) - firstSequence);
+            if (index >= targets.size()) continue;
+            Target& target = targets[index];
+            if (!target.pending || target.addr.sin_addr.s_addr != from.sin_addr.s_addr) continue;
+            
+            target.pending = false;
+            remaining--;
+            double roundTrip = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - target.sent).count();
+            if (callback) {
+                callback(ips[index], static_cast<int>(roundTrip + 0.5));
+            }
+        }
+    };
+    
+    unsigned char packet[ICMP_HEADER_SIZE + sizeof(ICMP_PAYLOAD)];
+    std::memcpy(packet + ICMP_HEADER_SIZE, ICMP_PAYLOAD, sizeof(ICMP_PAYLOAD));
+    
+    for (size_t i = 0; i < ips.size(); i++) {
+        if (cancelled && cancelled()) break;
+        
+        Target& target = targets[i];
+        target.addr = sockaddr_in();
+        target.addr.sin_family = AF_INET;
+        if (inet_pton(AF_INET, ips[i].c_str(), &target.addr.sin_addr) != 1) continue;
+        
+        uint16_t sequence = static_cast<uint16_t>(firstSequence + i);
+        packet[0] = ICMP_TYPE_ECHO_REQUEST;
+        packet[1] = 0;
+        packet[2] = packet[3] = 0;
+        packet[4] = id >> 8;
+        packet[5] = id & 0xFF;
+        packet[6] = sequence >> 8;
+        packet[7] = sequence & 0xFF;
+        uint16_t checksum = icmpChecksum(packet, sizeof(packet));
+        packet[2] = checksum >> 8;
+        packet[3] = checksum & 0xFF;
+        
+        // Replies of fast hosts arrive while the rest are still being sent
+        drain();
+        
+        // A full send buffer drains quickly; give it a moment once
+        for (int attempt = 0; attempt < 2; attempt++) {
+            target.sent = std::chrono::steady_clock::now();
+            if (sendto(sock, packet, sizeof(packet), 0, reinterpret_cast<sockaddr*>(&target.addr), sizeof(target.addr)) >= 0) {
+                target.pending = true;
+                remaining++;
+                break;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) break;
+            pollfd writable = { sock, POLLOUT, 0 };
+            poll(&writable, 1, 10);
+        }
+    }
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (remaining > 0 && !(cancelled && cancelled())) {
+        int wait = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count());
+        if (wait <= 0) break;
+        
+        pollfd readable = { sock, POLLIN, 0 };
+        if (poll(&readable, 1, std::min(wait, CANCEL_CHECK_MS)) > 0) {
+            drain();
+        }
+    }
+    
+    close(sock);
 #endif
 }
 
@@ -233,6 +801,35 @@ std::vector<std::pair<std::string, std::string>> NetworkManager::getNetworkAdapt
             free(adapterInfo);
         }
     }
+#else
+    ifaddrs* interfaces = nullptr;
+    if (getifaddrs(&interfaces) == 0) {
+        for (ifaddrs* entry = interfaces; entry; entry = entry->ifa_next) {
+            if (!entry->ifa_addr || !entry->ifa_netmask || entry->ifa_addr->sa_family != AF_INET) continue;
+            if (!(entry->ifa_flags & IFF_UP) || (entry->ifa_flags & IFF_LOOPBACK)) continue;
+            
+            in_addr ip = reinterpret_cast<sockaddr_in*>(entry->ifa_addr)->sin_addr;
+            in_addr mask = reinterpret_cast<sockaddr_in*>(entry->ifa_netmask)->sin_addr;
+            char ipStr[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &ip, ipStr, sizeof(ipStr));
+            if (std::string(ipStr).find("169.254.") == 0) continue;
+            
+            in_addr network;
+            network.s_addr = ip.s_addr & mask.s_addr;
+            char networkStr[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &network, networkStr, sizeof(networkStr));
+            
+            int cidr = 0;
+            uint32_t maskVal = ntohl(mask.s_addr);
+            while (maskVal & 0x80000000) {
+                cidr++;
+                maskVal <<= 1;
+            }
+            
+            adapters.push_back(std::make_pair(std::string(ipStr), std::string(networkStr) + "/" + std::to_string(cidr)));
+        }
+        freeifaddrs(interfaces);
+    }
 #endif
 
     return adapters;
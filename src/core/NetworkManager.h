@@ -6,6 +6,7 @@
 #include <mutex>
 #include <map>
 #include <memory>
+#include <functional>
 
 // Forward declarations
 class NetworkConnection;
@@ -19,6 +20,18 @@ struct ConnectionOptions {
     int keepAliveCount = 3;       // Number of keepalive probes
 };
 
+// Outcome for one address of a TCP sweep
+struct HostProbeResult {
+    std::string ip;
+    int openPort = -1;       // First port of the list that accepted a connection, -1 if none
+    bool reachable = false;  // Some port accepted or refused - the host is up
+    int responseTime = -1;   // Fastest answer in milliseconds, -1 if none
+};
+
+using HostProbeCallback = std::function<void(const HostProbeResult&)>;
+using PingReplyCallback = std::function<void(const std::string& ip, int responseTime)>;
+using CancelCheck = std::function<bool()>;
+
 class NetworkManager {
 public:
     static NetworkManager& getInstance() {
@@ -35,6 +48,16 @@ public:
     bool sendPing(const std::string& ip, int& responseTime);
     std::vector<std::pair<std::string, std::string>> getNetworkAdapters();  // returns IP, Subnet pairs
     std::string resolveHostname(const std::string& ip);
+    
+    // Sweeps - all addresses are probed at once, each with its own timeout,
+    // and the callback runs on the calling thread as each host is decided.
+    // probeTcpPorts() tries 'ports' in order of preference and stops probing a
+    // host once no later port can change its result; it reports every address.
+    // pingHosts() reports only the addresses that reply.
+    void probeTcpPorts(const std::vector<std::string>& ips, const std::vector<int>& ports, int timeoutMs,
+                       const HostProbeCallback& callback, const CancelCheck& cancelled = nullptr);
+    void pingHosts(const std::vector<std::string>& ips, int timeoutMs,
+                   const PingReplyCallback& callback, const CancelCheck& cancelled = nullptr);
 
     // Connection management
     std::shared_ptr<NetworkConnection> openConnection(const std::string& ip, int port, const ConnectionOptions& options = ConnectionOptions());
@@ -12,6 +12,11 @@
 #include <algorithm>
 #include <sstream>
 #include <regex>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <climits>
 
 NetworkScanner::NetworkScanner()
     : wxThread(wxTHREAD_JOINABLE),
@@ -69,10 +74,7 @@ void NetworkScanner::StartScan(const std::string& subnet)
 void NetworkScanner::StopScan()
 {
     wxCriticalSectionLocker lock(m_criticalSection);
-    m_stopRequested = true;
-    
-    // Stop any ongoing network operations
-    NetworkManager::getInstance().cleanup();
+    m_stopRequested = true;  // The sweeps check it at least every 50 ms
 }
 
 wxThread::ExitCode NetworkScanner::Entry()
@@ -130,65 +132,127 @@ std::vector<NetworkDevice> NetworkScanner::ScanDevices(const std::string& subnet
         return {};
     }
     
-    // Process each device in the subnet
-    std::vector<NetworkDevice> devices;
     std::vector<std::string> ipRange = GenerateIPRange(subnet);
+    int totalIPs = static_cast<int>(ipRange.size());
+    auto cancelled = [this]() { return m_stopRequested; };
     
-    int totalIPs = ipRange.size();
-    int currentIP = 0;
+    // What each answering address said; shared by the TCP sweep and the pings
+    struct Answer {
+        int openPort = -1;
+        int connectTime = -1;
+        int pingTime = -1;
+        bool reported = false;
+    };
+    std::mutex answersMutex;
+    std::map<std::string, Answer> answers;
     
-    for (const std::string& ip : ipRange) {
-        if (m_stopRequested) break;
+    auto report = [this](const std::string& ip, Answer& answer) {
+        if (answer.reported || !m_deviceCallback) return;
+        answer.reported = true;
         
-        currentIP++;
+        NetworkDevice device;
+        device.ip = ip;
+        device.isReachable = true;
+        device.responseTime = answer.pingTime >= 0 ? answer.pingTime : answer.connectTime;
+        device.deviceType = answer.openPort == 23 ? "FluidNC" : answer.openPort == 80 ? "Web Device" : "Unknown";
+        m_deviceCallback(device);
+    };
+    
+    if (m_progressCallback) {
+        m_progressCallback(0, totalIPs, "", "Probing " + std::to_string(totalIPs) + " addresses...");
+    }
+    
+    // Hosts that answer neither telnet nor HTTP may still answer a ping, and
+    // the echo times rank the results; the echoes are sent alongside the TCP
+    // sweep so both take one timeout
+    std::thread pinger([&]() {
+        netman.pingHosts(ipRange, CONNECT_TIMEOUT_MS, [&](const std::string& ip, int responseTime) {
+            std::lock_guard<std::mutex> lock(answersMutex);
+            Answer& answer = answers[ip];
+            answer.pingTime = responseTime;
+            report(ip, answer);
+        }, cancelled);
+    });
+    
+    // Telnet first (FluidNC), then HTTP; a refused connection still proves the host is up
+    int decided = 0;
+    netman.probeTcpPorts(ipRange, {23, 80}, CONNECT_TIMEOUT_MS, [&](const HostProbeResult& result) {
+        decided++;
+        if (result.reachable) {
+            std::lock_guard<std::mutex> lock(answersMutex);
+            Answer& answer = answers[result.ip];
+            answer.openPort = result.openPort;
+            answer.connectTime = result.responseTime;
+            report(result.ip, answer);
+        }
         if (m_progressCallback) {
-            m_progressCallback((currentIP * 100) / totalIPs, 100, ip, "Checking address...");
+            m_progressCallback(decided, totalIPs, result.ip, "Checking addresses...");
         }
-        
-        // Try telnet port first (for FluidNC)
-        if (netman.testTcpPort(ip, 23)) {
-            NetworkDevice device;
-            device.ip = ip;
-            device.hostname = netman.resolveHostname(ip);
-            device.isReachable = true;
-            device.responseTime = -1;
-            device.deviceType = "FluidNC";
-            devices.push_back(device);
-            continue;
+    }, cancelled);
+    pinger.join();
+    
+    std::vector<std::string> found;
+    for (const std::string& ip : ipRange) {
+        if (answers.count(ip)) {
+            found.push_back(ip);
         }
-        
-        // Try HTTP port next (common for network devices)
-        if (netman.testTcpPort(ip, 80)) {
-            NetworkDevice device;
-            device.ip = ip;
-            device.hostname = netman.resolveHostname(ip);
-            device.isReachable = true;
-            device.responseTime = -1;
-            device.deviceType = "Web Device";
-            devices.push_back(device);
-            continue;
+    }
+    
+    // Reverse lookups can each take a DNS timeout, so they run side by side;
+    // a stopped scan keeps what it found without them
+    std::vector<std::future<std::string>> hostnames;
+    if (!m_stopRequested) {
+        if (m_progressCallback) {
+            m_progressCallback(totalIPs, totalIPs, "", "Resolving host names...");
         }
-        
-        // Finally try a ping
-        int responseTime;
-        if (netman.sendPing(ip, responseTime)) {
-            NetworkDevice device;
-            device.ip = ip;
-            device.hostname = netman.resolveHostname(ip);
-            device.isReachable = true;
-            device.responseTime = responseTime;
-            device.deviceType = GuessDeviceType(ip, device.hostname);
-            devices.push_back(device);
+        for (const std::string& ip : found) {
+            hostnames.push_back(std::async(std::launch::async, [&netman, ip]() { return netman.resolveHostname(ip); }));
         }
+    }
+    
+    std::vector<NetworkDevice> devices;
+    for (size_t i = 0; i < found.size(); i++) {
+        const Answer& answer = answers[found[i]];
         
-        // Small delay between devices
-        wxMilliSleep(5);
+        NetworkDevice device;
+        device.ip = found[i];
+        device.hostname = i < hostnames.size() ? hostnames[i].get() : "";
+        device.isReachable = true;
+        device.responseTime = answer.pingTime >= 0 ? answer.pingTime : answer.connectTime;
+        if (answer.openPort == 23) {
+            device.deviceType = "FluidNC";
+        } else if (answer.openPort == 80) {
+            device.deviceType = "Web Device";
+        } else {
+            device.deviceType = GuessDeviceType(device.ip, device.hostname);
+        }
+        devices.push_back(device);
     }
     
+    RankDevices(devices);
     LOG_INFO("Found " + std::to_string(devices.size()) + " devices");
     return devices;
 }
 
+void NetworkScanner::RankDevices(std::vector<NetworkDevice>& devices)
+{
+    auto typeRank = [](const NetworkDevice& device) {
+        if (device.deviceType == "FluidNC") return 0;
+        if (device.deviceType == "ESP32/ESP8266") return 1;
+        return 2;
+    };
+    
+    // Unknown times (-1) go after every measured one
+    auto timeRank = [](const NetworkDevice& device) {
+        return device.responseTime < 0 ? INT_MAX : device.responseTime;
+    };
+    
+    std::stable_sort(devices.begin(), devices.end(), [&](const NetworkDevice& a, const NetworkDevice& b) {
+        if (typeRank(a) != typeRank(b)) return typeRank(a) < typeRank(b);
+        return timeRank(a) < timeRank(b);
+    });
+}
+
 std::string NetworkScanner::GuessVendor(const std::string& macAddress)
 {
     if (macAddress.empty()) {
@@ -210,6 +274,9 @@ std::string NetworkScanner::GuessDeviceType(const std::string& ip, const std::st
 
 std::string NetworkScanner::GuessDeviceType(const std::string& ip, const std::string& hostname, const std::string& macAddress)
 {
+    // Only asked about hosts whose telnet port did not accept the scan's
+    // connect, so they are not FluidNC and are not probed again
+
     // Get vendor information if MAC address is available
     std::string vendor = "Unknown";
     if (!macAddress.empty()) {
@@ -218,19 +285,10 @@ std::string NetworkScanner::GuessDeviceType(const std::string& ip, const std::st
         // Use MacVendorLookup's enhanced device type detection
         std::string vendorBasedType = MacVendorLookup::GetDeviceType(macAddress, vendor);
         if (vendorBasedType != "Unknown") {
-            // For ESP32/ESP8266 devices, check for FluidNC specifically
-            if (vendorBasedType == "ESP32/ESP8266" && NetworkManager::getInstance().testTcpPort(ip, 23)) {
-                return "FluidNC";
-            }
             return vendorBasedType;
         }
     }
     
-    // Check if it might be FluidNC by attempting telnet connection
-    if (NetworkManager::getInstance().testTcpPort(ip, 23)) {
-        return "FluidNC";
-    }
-    
     // Check hostname patterns
     std::string lowerHostname = hostname;
     std::transform(lowerHostname.begin(), lowerHostname.end(), lowerHostname.begin(), ::tolower);
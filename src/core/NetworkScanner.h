@@ -32,6 +32,13 @@ struct NetworkDevice {
  */
 using ScanProgressCallback = std::function<void(int, int, const std::string&, const std::string&)>;
 
+/**
+ * Device discovered callback, called as soon as a device answers; the
+ * hostname and device type may be refined in the completion list
+ * Parameters: device
+ */
+using ScanDeviceCallback = std::function<void(const NetworkDevice&)>;
+
 /**
  * Network scanning completion callback
  * Parameters: devices, success, errorMessage
@@ -54,6 +61,7 @@ public:
 
     // Callbacks
     void SetProgressCallback(ScanProgressCallback callback) { m_progressCallback = callback; }
+    void SetDeviceCallback(ScanDeviceCallback callback) { m_deviceCallback = callback; }
     void SetCompleteCallback(ScanCompleteCallback callback) { m_completeCallback = callback; }
 
 protected:
@@ -67,9 +75,15 @@ private:
     std::string GuessDeviceType(const std::string& ip, const std::string& hostname);
     std::string GuessDeviceType(const std::string& ip, const std::string& hostname, const std::string& macAddress);
     
+    // Likely controllers first, then by round-trip time; otherwise address order
+    static void RankDevices(std::vector<NetworkDevice>& devices);
+    
     // Subnet utilities
     std::vector<std::string> GenerateIPRange(const std::string& subnet);
     
+    // Every address is probed at once; a scan takes about this long
+    static const int CONNECT_TIMEOUT_MS = 1000;
+    
     // Threading and state
     volatile bool m_isScanning;
     volatile bool m_stopRequested;
@@ -77,6 +91,7 @@ private:
     
     // Callbacks
     ScanProgressCallback m_progressCallback;
+    ScanDeviceCallback m_deviceCallback;
     ScanCompleteCallback m_completeCallback;
     
     // Current scan parameters
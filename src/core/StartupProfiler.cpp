@@ -0,0 +1,82 @@
+/**
+ * core/StartupProfiler.cpp
+ * Startup timing implementation
+ */
+
+#include "StartupProfiler.h"
+#include "SimpleLogger.h"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+// Initialized with the other statics, before main() - close enough to process start
+const std::chrono::steady_clock::time_point s_processStart = std::chrono::steady_clock::now();
+
+std::string formatMs(double milliseconds)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.1f ms", milliseconds);
+    return buffer;
+}
+
+} // namespace
+
+StartupProfiler& StartupProfiler::Instance()
+{
+    static StartupProfiler instance;
+    return instance;
+}
+
+StartupProfiler::StartupProfiler()
+    : m_lastMark(0.0)
+    , m_finished(false)
+{
+}
+
+double StartupProfiler::Elapsed() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - s_processStart).count();
+}
+
+void StartupProfiler::Mark(const std::string& name)
+{
+    if (m_finished) return;
+    
+    double now = Elapsed();
+    m_entries.push_back({name, now, now - m_lastMark, true});
+    m_lastMark = now;
+}
+
+void StartupProfiler::Record(const std::string& name, double milliseconds)
+{
+    if (m_finished) {
+        LOG_INFO("Startup profile (late): " + name + " " + formatMs(milliseconds));
+        return;
+    }
+    m_entries.push_back({name, Elapsed(), milliseconds, false});
+}
+
+void StartupProfiler::Finish(const std::string& name)
+{
+    if (m_finished) return;
+    
+    Mark(name);
+    m_finished = true;
+    
+    LOG_INFO(Report());
+    if (m_lastMark > TARGET_MS) {
+        LOG_WARNING("Startup took " + formatMs(m_lastMark) + ", over the " + std::to_string(TARGET_MS) + " ms target");
+    }
+}
+
+std::string StartupProfiler::Report() const
+{
+    std::string report = "Startup profile:";
+    for (const Entry& entry : m_entries) {
+        report += "\n  ";
+        report += entry.phase ? "" : "  ";  // Steps are indented; they belong to the next phase
+        report += entry.name + ": " + formatMs(entry.duration) + " (at " + formatMs(entry.at) + ")";
+    }
+    return report;
+}
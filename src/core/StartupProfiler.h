@@ -0,0 +1,50 @@
+/**
+ * core/StartupProfiler.h
+ * Startup timing - time per phase and time to an interactive window
+ * Phases are marked in order on the GUI thread; Finish() writes the report
+ * to the log once the main window has painted and gone idle.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class StartupProfiler
+{
+public:
+    static StartupProfiler& Instance();
+    
+    // Ends the current phase under 'name', timed from the previous mark
+    void Mark(const std::string& name);
+    
+    // Adds a step timed on its own (e.g. building a panel); after Finish()
+    // it is only logged
+    void Record(const std::string& name, double milliseconds);
+    
+    // Milliseconds since the process started
+    double Elapsed() const;
+    
+    // Marks 'name', logs the report and stops recording
+    void Finish(const std::string& name);
+    bool IsFinished() const { return m_finished; }
+    
+    std::string Report() const;
+    
+    // Startup budget to an interactive window on shop PCs
+    static const int TARGET_MS = 300;
+    
+private:
+    StartupProfiler();
+    
+    struct Entry {
+        std::string name;
+        double at;        // ms since start, at the end of the entry
+        double duration;  // ms
+        bool phase;       // false for Record()ed steps
+    };
+    
+    std::vector<Entry> m_entries;
+    double m_lastMark;
+    bool m_finished;
+};
@@ -4,10 +4,13 @@
  */
 
 #include "StateManager.h"
+#include "AtomicFile.h"
+#include "ConfigFile.h"
 #include <fstream>
 #include <chrono>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 StateManager& StateManager::getInstance()
 {
@@ -15,7 +18,15 @@ StateManager& StateManager::getInstance()
     return instance;
 }
 
-StateManager::StateManager() : m_stopAutosave(false)
+StateManager::StateManager()
+    : m_stopAutosave(false)
+    , m_generation(0)
+    , m_savedGeneration(0)
+    , m_journalGeneration(0)
+    , m_journal(nullptr)
+    , m_journalBytes(0)
+    , m_loadMilliseconds(0.0)
+    , m_loadFormat(-1)
 {
     createConfigDirs();
     load();
@@ -29,16 +40,32 @@ StateManager::~StateManager()
     shutdown();
 }
 
-void StateManager::save()
+void StateManager::save(bool exportJson)
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
     
     try {
-        std::ofstream file(m_settingsFile);
-        if (file.is_open()) {
-            file << m_data.dump(2) << std::endl;
-            file.close();
+        // The journal must hold every change up to the snapshot before
+        // settings.json moves on: if we crash before it is truncated, replaying
+        // it over the new settings.json reproduces the same state
+        std::shared_ptr<const Snapshot> current;
+        std::string entries;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            current = snapshot();
+            entries.swap(m_journalBuffer);
+        }
+        appendJournal(entries, current->generation);
+        
+        // Serialize outside m_mutex so readers are not held up by the disk
+        std::string error;
+        if (!ConfigFile::save(m_settingsFile, current->data, &error, exportJson)) {
+            std::cerr << "Error saving settings: " << error << std::endl;
+            return;
         }
+        m_savedGeneration = current->generation;
+        
+        truncateJournal();
     } catch (const std::exception& e) {
         std::cerr << "Error saving settings: " << e.what() << std::endl;
     }
@@ -46,17 +73,21 @@ void StateManager::save()
 
 void StateManager::saveRecovery()
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
     
-    try {
-        std::ofstream file(m_recoveryFile);
-        if (file.is_open()) {
-            file << m_data.dump() << std::endl;  // No indentation for speed
-            file.close();
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Error saving recovery: " << e.what() << std::endl;
+    std::string entries;
+    uint64_t generation;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        entries.swap(m_journalBuffer);
+        generation = m_generation.load();
     }
+    appendJournal(entries, generation);
+}
+
+bool StateManager::isDirty() const
+{
+    return m_generation.load() != m_savedGeneration.load();
 }
 
 void StateManager::shutdown()
@@ -69,30 +100,207 @@ void StateManager::shutdown()
     shutdownCalled = true;
     
     if (m_autosaveThread.joinable()) {
-        m_stopAutosave = true;
+        {
+            std::lock_guard<std::mutex> lock(m_autosaveMutex);
+            m_stopAutosave = true;
+        }
+        m_autosaveCondition.notify_all();
         m_autosaveThread.join();
     }
-    save();  // Final save
+    
+    if (isDirty() || !ConfigFile::isJsonCurrent(m_settingsFile)) {
+        save(true);  // Final save, also empties the journal and leaves settings.json current
+    }
+    
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
+    if (m_journal) {
+        std::fclose(m_journal);
+        m_journal = nullptr;
+    }
+}
+
+void StateManager::markDirty(const std::vector<std::string>& keys, const json& value)
+{
+    m_journalBuffer += "{\"p\":";
+    m_journalBuffer += json(keys).dump();
+    m_journalBuffer += ",\"v\":";
+    m_journalBuffer += value.dump();
+    m_journalBuffer += "}\n";
+    
+    m_generation++;
+    {
+        // Taking the lock orders the bump with the autosave thread's wait
+        std::lock_guard<std::mutex> lock(m_autosaveMutex);
+    }
+    m_autosaveCondition.notify_one();
+}
+
+void StateManager::markElementDirty(const std::vector<std::string>& keys, const std::string& field,
+                                    const json& match, const json* element)
+{
+    json entry = {{"p", keys}, {"f", field}, {"m", match}};
+    if (element) {
+        entry["v"] = *element;
+    }
+    m_journalBuffer += entry.dump();
+    m_journalBuffer += '\n';
+    
+    m_generation++;
+    {
+        std::lock_guard<std::mutex> lock(m_autosaveMutex);
+    }
+    m_autosaveCondition.notify_one();
+}
+
+std::shared_ptr<const StateManager::Snapshot> StateManager::snapshot() const
+{
+    auto current = std::atomic_load(&m_snapshot);
+    if (current && current->generation == m_generation.load()) {
+        return current;
+    }
+    
+    // Stale - the first reader after a change copies m_data once for everyone
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    current = std::atomic_load(&m_snapshot);
+    uint64_t generation = m_generation.load();
+    if (!current || current->generation != generation) {
+        current = std::make_shared<const Snapshot>(Snapshot{generation, m_data});
+        std::atomic_store(&m_snapshot, current);
+    }
+    return current;
+}
+
+void StateManager::appendJournal(std::string& entries, uint64_t generation)
+{
+    if (entries.empty()) {
+        m_journalGeneration = generation;
+        return;
+    }
+    
+    if (!m_journal) {
+        m_journal = std::fopen(m_journalFile.string().c_str(), "ab");
+    }
+    
+    // One write and one fsync for the whole batch
+    if (m_journal && std::fwrite(entries.data(), 1, entries.size(), m_journal) == entries.size()
+        && AtomicFile::sync(m_journal)) {
+        m_journalBytes += entries.size();
+        m_journalGeneration = generation;
+        return;
+    }
+    
+    std::cerr << "Error writing state journal " << m_journalFile.string() << std::endl;
+    
+    // Keep the entries, in order, for the next attempt
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    m_journalBuffer.insert(0, entries);
+}
+
+void StateManager::truncateJournal()
+{
+    if (m_journal) {
+        std::fclose(m_journal);
+    }
+    m_journal = std::fopen(m_journalFile.string().c_str(), "wb");
+    if (m_journal) {
+        AtomicFile::sync(m_journal);
+    }
+    m_journalBytes = 0;
 }
 
 void StateManager::load()
 {
-    try {
-        if (std::filesystem::exists(m_settingsFile)) {
-            std::ifstream file(m_settingsFile);
-            if (file.is_open()) {
-                file >> m_data;
-                file.close();
-                return;
+    auto start = std::chrono::steady_clock::now();
+    bool loaded = false;
+    std::string error;
+    ConfigFile::Format format;
+    if (ConfigFile::load(m_settingsFile, m_data, &error, &format)) {
+        loaded = true;
+        m_loadFormat = static_cast<int>(format);
+    } else if (std::filesystem::exists(m_settingsFile) || std::filesystem::exists(ConfigFile::binaryPath(m_settingsFile))) {
+        std::cerr << "Error loading settings: " << error << std::endl;
+    }
+    m_loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    if (!loaded) {
+        // Initialize with empty JSON object if loading failed
+        m_data = json::object();
+        initializeDefaults();
+        m_generation++;  // Defaults exist only in memory until saved
+    }
+    
+    bool damaged = replayJournal();
+    m_journalGeneration = m_generation.load();
+    
+    const json* configFormat = findNestedValue(m_data, {"configFormat"});
+    bool useCbor = configFormat && configFormat->is_string() && configFormat->get<std::string>() == "cbor";
+    ConfigFile::setFormat(useCbor ? ConfigFile::Format::CBOR : ConfigFile::Format::JSON);
+    
+    if (damaged) {
+        save();  // Start the next session from a clean journal
+    }
+}
+
+bool StateManager::replayJournal()
+{
+    std::ifstream file(m_journalFile, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    size_t applied = 0;
+    size_t damaged = 0;
+    uintmax_t complete = 0;  // Bytes up to the last newline
+    bool tornTail = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (file.eof()) {
+            tornTail = true;  // Last line without its newline
+        } else {
+            complete += line.size() + 1;
+        }
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            json entry = json::parse(line);
+            auto keys = entry.at("p").get<std::vector<std::string>>();
+            if (keys.empty()) {
+                continue;
             }
+            if (entry.contains("f")) {
+                auto value = entry.find("v");
+                setNestedElement(keys, entry.at("f").get<std::string>(), entry.at("m"),
+                                 value != entry.end() ? &*value : nullptr);
+            } else {
+                setNestedValue(keys, entry.at("v"));
+            }
+            applied++;
+        } catch (const json::exception&) {
+            // A write torn by a crash - later entries are still valid
+            damaged++;
+        }
+    }
+    file.close();
+    
+    std::error_code ec;
+    if (tornTail) {
+        // Otherwise the next append would continue the torn line and be lost with it
+        std::filesystem::resize_file(m_journalFile, complete, ec);
+        if (ec) {
+            std::cerr << "Error truncating state journal: " << ec.message() << std::endl;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error loading settings: " << e.what() << std::endl;
     }
+    auto size = std::filesystem::file_size(m_journalFile, ec);
+    m_journalBytes = ec ? 0 : static_cast<size_t>(size);
     
-    // Initialize with empty JSON object if loading failed
-    m_data = json::object();
-    initializeDefaults();
+    if (damaged > 0) {
+        std::cerr << "Skipped " << damaged << " damaged state journal entries" << std::endl;
+    }
+    if (applied > 0) {
+        m_generation++;  // Ahead of settings.json until the next save
+    }
+    return damaged > 0 || tornTail;
 }
 
 void StateManager::initializeDefaults()
@@ -118,19 +326,31 @@ void StateManager::initializeDefaults()
 
 void StateManager::autosaveLoop()
 {
+    std::unique_lock<std::mutex> lock(m_autosaveMutex);
+    
     while (!m_stopAutosave) {
-        // Wait for 5 seconds or until stop signal
-        auto start = std::chrono::steady_clock::now();
-        while (std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
-            if (m_stopAutosave) {
-                return;
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        // Sleep until something changes
+        m_autosaveCondition.wait(lock, [this] {
+            return m_stopAutosave || m_generation.load() != m_journalGeneration.load();
+        });
+        if (m_stopAutosave) {
+            return;
+        }
+        
+        // Let the changes of the next moment share one append and fsync
+        m_autosaveCondition.wait_for(lock, std::chrono::milliseconds(JOURNAL_BATCH_MS), [this] {
+            return m_stopAutosave.load();
+        });
+        if (m_stopAutosave) {
+            return;  // shutdown() saves the final state
         }
         
-        if (!m_stopAutosave) {
-            saveRecovery();
+        lock.unlock();
+        saveRecovery();
+        if (m_journalBytes > JOURNAL_COMPACT_BYTES) {
+            save();
         }
+        lock.lock();
     }
 }
 
@@ -143,24 +363,26 @@ void StateManager::createConfigDirs()
     }
 }
 
-json* StateManager::getNestedValue(const std::string& key)
+const json* StateManager::findNestedValue(const json& root, const std::vector<std::string>& keys)
 {
-    auto keys = splitKey(key);
-    json* current = &m_data;
+    const json* current = &root;
     
     for (const auto& k : keys) {
-        if (!current->is_object() || !current->contains(k)) {
+        if (!current->is_object()) {
             return nullptr;
         }
-        current = &(*current)[k];
+        auto it = current->find(k);
+        if (it == current->end()) {
+            return nullptr;
+        }
+        current = &*it;
     }
     
     return current;
 }
 
-void StateManager::setNestedValue(const std::string& key, const json& value)
+void StateManager::setNestedValue(const std::vector<std::string>& keys, const json& value)
 {
-    auto keys = splitKey(key);
     json* current = &m_data;
     
     // Navigate to parent, creating objects as needed
@@ -178,6 +400,36 @@ void StateManager::setNestedValue(const std::string& key, const json& value)
     (*current)[keys.back()] = value;
 }
 
+void StateManager::setNestedElement(const std::vector<std::string>& keys, const std::string& field,
+                                    const json& match, const json* element)
+{
+    json* current = &m_data;
+    for (const auto& k : keys) {
+        if (!current->is_object()) {
+            *current = json::object();
+        }
+        current = &(*current)[k];
+    }
+    if (!current->is_array()) {
+        *current = json::array();
+    }
+    
+    auto matches = [&field, &match](const json& item) {
+        return item.is_object() && item.contains(field) && item[field] == match;
+    };
+    if (!element) {
+        current->erase(std::remove_if(current->begin(), current->end(), matches), current->end());
+        return;
+    }
+    
+    auto it = std::find_if(current->begin(), current->end(), matches);
+    if (it != current->end()) {
+        *it = *element;
+    } else {
+        current->push_back(*element);
+    }
+}
+
 std::vector<std::string> StateManager::splitKey(const std::string& key)
 {
     std::vector<std::string> result;
@@ -196,11 +448,12 @@ std::vector<std::string> StateManager::splitKey(const std::string& key)
 // Machine management methods
 std::vector<MachineConfig> StateManager::getMachines() const
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto current = snapshot();
+    const json& data = current->data;
     
     std::vector<MachineConfig> machines;
-    if (m_data.contains("machines") && m_data["machines"].is_array()) {
-        for (const auto& machineJson : m_data["machines"]) {
+    if (data.contains("machines") && data["machines"].is_array()) {
+        for (const auto& machineJson : data["machines"]) {
             machines.push_back(machineConfigFromJson(machineJson));
         }
     }
@@ -220,12 +473,14 @@ void StateManager::addMachine(const MachineConfig& machine)
         if (machineJson["id"] == machine.id) {
             // Update existing
             machineJson = machineConfigToJson(machine);
+            markElementDirty({"machines"}, "id", machine.id, &machineJson);
             return;
         }
     }
     
     // Add new machine
     m_data["machines"].push_back(machineConfigToJson(machine));
+    markElementDirty({"machines"}, "id", machine.id, &m_data["machines"].back());
 }
 
 void StateManager::updateMachine(const std::string& id, const MachineConfig& machine)
@@ -236,6 +491,7 @@ void StateManager::updateMachine(const std::string& id, const MachineConfig& mac
         for (auto& machineJson : m_data["machines"]) {
             if (machineJson["id"] == id) {
                 machineJson = machineConfigToJson(machine);
+                markElementDirty({"machines"}, "id", id, &machineJson);
                 return;
             }
         }
@@ -252,15 +508,17 @@ void StateManager::removeMachine(const std::string& id)
             [&id](const json& machineJson) {
                 return machineJson.contains("id") && machineJson["id"] == id;
             }), machines.end());
+        markElementDirty({"machines"}, "id", id, nullptr);
     }
 }
 
 MachineConfig StateManager::getMachine(const std::string& id) const
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto current = snapshot();
+    const json& data = current->data;
     
-    if (m_data.contains("machines") && m_data["machines"].is_array()) {
-        for (const auto& machineJson : m_data["machines"]) {
+    if (data.contains("machines") && data["machines"].is_array()) {
+        for (const auto& machineJson : data["machines"]) {
             if (machineJson.contains("id") && machineJson["id"] == id) {
                 return machineConfigFromJson(machineJson);
             }
@@ -274,13 +532,15 @@ void StateManager::setActiveMachine(const std::string& id)
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
     m_data["activeMachine"] = id;
+    markDirty({"activeMachine"}, m_data["activeMachine"]);
 }
 
 std::string StateManager::getActiveMachineId() const
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    if (m_data.contains("activeMachine")) {
-        return m_data["activeMachine"].get<std::string>();
+    auto current = snapshot();
+    const json& data = current->data;
+    if (data.contains("activeMachine")) {
+        return data["activeMachine"].get<std::string>();
     }
     return "";
 }
@@ -288,11 +548,12 @@ std::string StateManager::getActiveMachineId() const
 // Window layout management
 std::vector<WindowLayout> StateManager::getWindowLayouts() const
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto current = snapshot();
+    const json& data = current->data;
     
     std::vector<WindowLayout> layouts;
-    if (m_data.contains("windowLayouts") && m_data["windowLayouts"].is_array()) {
-        for (const auto& layoutJson : m_data["windowLayouts"]) {
+    if (data.contains("windowLayouts") && data["windowLayouts"].is_array()) {
+        for (const auto& layoutJson : data["windowLayouts"]) {
             layouts.push_back(windowLayoutFromJson(layoutJson));
         }
     }
@@ -308,39 +569,27 @@ void StateManager::saveWindowLayout(const WindowLayout& layout)
     }
     
     // Check if layout already exists
-    bool updated = false;
     for (auto& layoutJson : m_data["windowLayouts"]) {
         if (layoutJson["windowId"] == layout.windowId) {
             // Update existing
             layoutJson = windowLayoutToJson(layout);
-            updated = true;
-            break;
+            markElementDirty({"windowLayouts"}, "windowId", layout.windowId, &layoutJson);
+            return;
         }
     }
     
-    if (!updated) {
-        // Add new layout
-        m_data["windowLayouts"].push_back(windowLayoutToJson(layout));
-    }
-    
-    // Save immediately to disk to ensure window state is preserved
-    try {
-        std::ofstream file(m_settingsFile);
-        if (file.is_open()) {
-            file << m_data.dump(2) << std::endl;
-            file.close();
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Error saving window layout: " << e.what() << std::endl;
-    }
+    // Add new layout
+    m_data["windowLayouts"].push_back(windowLayoutToJson(layout));
+    markElementDirty({"windowLayouts"}, "windowId", layout.windowId, &m_data["windowLayouts"].back());
 }
 
 WindowLayout StateManager::getWindowLayout(const std::string& windowId) const
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto current = snapshot();
+    const json& data = current->data;
     
-    if (m_data.contains("windowLayouts") && m_data["windowLayouts"].is_array()) {
-        for (const auto& layoutJson : m_data["windowLayouts"]) {
+    if (data.contains("windowLayouts") && data["windowLayouts"].is_array()) {
+        for (const auto& layoutJson : data["windowLayouts"]) {
             if (layoutJson.contains("windowId") && layoutJson["windowId"] == windowId) {
                 return windowLayoutFromJson(layoutJson);
             }
@@ -357,15 +606,17 @@ void StateManager::resetWindowLayouts()
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
     m_data["windowLayouts"] = json::array();
+    markDirty({"windowLayouts"}, m_data["windowLayouts"]);
 }
 
 // Job settings management
 JobSettings StateManager::getCurrentJobSettings() const
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto current = snapshot();
+    const json& data = current->data;
     
-    if (m_data.contains("currentJobSettings")) {
-        return jobSettingsFromJson(m_data["currentJobSettings"]);
+    if (data.contains("currentJobSettings")) {
+        return jobSettingsFromJson(data["currentJobSettings"]);
     }
     
     return JobSettings(); // Return default settings
@@ -375,15 +626,17 @@ void StateManager::setCurrentJobSettings(const JobSettings& settings)
 {
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
     m_data["currentJobSettings"] = jobSettingsToJson(settings);
+    markDirty({"currentJobSettings"}, m_data["currentJobSettings"]);
 }
 
 std::vector<JobSettings> StateManager::getSavedJobProfiles() const
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto current = snapshot();
+    const json& data = current->data;
     
     std::vector<JobSettings> profiles;
-    if (m_data.contains("jobProfiles") && m_data["jobProfiles"].is_array()) {
-        for (const auto& profileJson : m_data["jobProfiles"]) {
+    if (data.contains("jobProfiles") && data["jobProfiles"].is_array()) {
+        for (const auto& profileJson : data["jobProfiles"]) {
             profiles.push_back(jobSettingsFromJson(profileJson));
         }
     }
@@ -403,12 +656,14 @@ void StateManager::saveJobProfile(const JobSettings& settings)
         if (profileJson["name"] == settings.name) {
             // Update existing
             profileJson = jobSettingsToJson(settings);
+            markElementDirty({"jobProfiles"}, "name", settings.name, &profileJson);
             return;
         }
     }
     
     // Add new profile
     m_data["jobProfiles"].push_back(jobSettingsToJson(settings));
+    markElementDirty({"jobProfiles"}, "name", settings.name, &m_data["jobProfiles"].back());
 }
 
 void StateManager::deleteJobProfile(const std::string& name)
@@ -421,6 +676,7 @@ void StateManager::deleteJobProfile(const std::string& name)
             [&name](const json& profileJson) {
                 return profileJson.contains("name") && profileJson["name"] == name;
             }), profiles.end());
+        markElementDirty({"jobProfiles"}, "name", name, nullptr);
     }
 }
 
@@ -430,9 +686,14 @@ std::string StateManager::getSettingsFilePath() const
     return m_settingsFile.string();
 }
 
+const char* StateManager::getLoadFormat() const
+{
+    return m_loadFormat < 0 ? "defaults" : ConfigFile::formatName(static_cast<ConfigFile::Format>(m_loadFormat));
+}
+
 std::string StateManager::getRecoveryFilePath() const
 {
-    return m_recoveryFile.string();
+    return m_journalFile.string();
 }
 
 // JSON conversion helper implementations
@@ -2,6 +2,11 @@
  * core/StateManager.h
  * Comprehensive state management for multi-machine CNC control application
  * Handles: UI layouts, machine configurations, job settings, user preferences
+ * Every change is appended to config/journal.jsonl within a fraction of a
+ * second and replayed at startup; the journal is compacted into
+ * settings.json when it grows large and on shutdown. With "configFormat":
+ * "cbor" settings.json is kept as a binary copy (settings.cbor, see
+ * ConfigFile) and the JSON file itself is refreshed on shutdown.
  */
 
 #pragma once
@@ -13,7 +18,11 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
 #include <filesystem>
+#include <memory>
+#include <cstdint>
+#include <cstdio>
 
 using json = nlohmann::json;
 
@@ -62,6 +71,33 @@ struct JobSettings {
     float toolDiameter = 3.175f;
 };
 
+/**
+ * Pre-resolved, typed settings key for values read often (layout code, UI
+ * handlers). The '/'-separated path is split once, and the converted value
+ * is cached until the state changes, so a repeated read is one atomic load
+ * and a copy of T. A handle caches per instance: keep one per thread, e.g.
+ * a static in GUI code.
+ */
+template<typename T>
+class StateKey
+{
+public:
+    explicit StateKey(std::string key, T defaultValue = T{})
+        : m_key(std::move(key)), m_default(std::move(defaultValue)) {}
+    
+    const std::string& key() const { return m_key; }
+    const T& defaultValue() const { return m_default; }
+    
+private:
+    friend class StateManager;
+    
+    std::string m_key;
+    T m_default;
+    mutable std::vector<std::string> m_path;       // Split on first use
+    mutable uint64_t m_cachedGeneration = UINT64_MAX;
+    mutable T m_cachedValue{};
+};
+
 class StateManager
 {
 public:
@@ -79,6 +115,13 @@ public:
     template<typename T>
     void setValue(const std::string& key, const T& value);
     
+    // Same through a handle - see StateKey
+    template<typename T>
+    T getValue(const StateKey<T>& key);
+    
+    template<typename T>
+    void setValue(const StateKey<T>& key, const T& value);
+    
     // Machine management
     std::vector<MachineConfig> getMachines() const;
     void addMachine(const MachineConfig& machine);
@@ -102,27 +145,55 @@ public:
     void deleteJobProfile(const std::string& name);
     
     // File management
-    void save();                    // Manual save to settings.json
-    void saveRecovery();           // Fast dump for power-cut recovery
-    void shutdown();               // Stop autosave thread and save
+    void save(bool exportJson = false);  // Manual save; exportJson also refreshes settings.json
+    void saveRecovery();           // Flush pending changes to the journal
+    void shutdown();               // Stop autosave thread and save if dirty
+    bool isDirty() const;          // Changed since the last save()
     
     // Configuration file paths
     std::string getSettingsFilePath() const;
     std::string getRecoveryFilePath() const;
     
+    // How settings were read at startup, for the startup profile
+    double getLoadTime() const { return m_loadMilliseconds; }
+    const char* getLoadFormat() const;
+    
 private:
     StateManager();
     ~StateManager();
     
-    void load();                   // Load from settings.json
+    void load();                   // Load from settings.json and replay the journal
+    bool replayJournal();          // True if damaged and in need of compaction
     void autosaveLoop();          // Autosave thread function
     void createConfigDirs();      // Ensure config directory exists
     void initializeDefaults();    // Set up default configuration
     
+    // Immutable copy of m_data published for readers, which never take m_mutex
+    // while it is current
+    struct Snapshot {
+        uint64_t generation;
+        json data;
+    };
+    
+    // Change tracking - call with m_mutex held after every change to m_data,
+    // passing the changed key and its new value for the journal
+    void markDirty(const std::vector<std::string>& keys, const json& value);
+    // Same for one element of the array at 'keys', the one whose 'field' is
+    // 'match'; 'element' is its new value, or null if it was removed
+    void markElementDirty(const std::vector<std::string>& keys, const std::string& field,
+                          const json& match, const json* element);
+    std::shared_ptr<const Snapshot> snapshot() const;  // Rebuilt only when stale
+    
+    // Journal file access - m_writeMutex held
+    void appendJournal(std::string& entries, uint64_t generation);
+    void truncateJournal();
+    
     // Helper functions for nested key access
-    json* getNestedValue(const std::string& key);
-    void setNestedValue(const std::string& key, const json& value);
-    std::vector<std::string> splitKey(const std::string& key);
+    static const json* findNestedValue(const json& root, const std::vector<std::string>& keys);
+    void setNestedValue(const std::vector<std::string>& keys, const json& value);
+    void setNestedElement(const std::vector<std::string>& keys, const std::string& field,
+                          const json& match, const json* element);
+    static std::vector<std::string> splitKey(const std::string& key);
     
     // JSON conversion helpers
     json machineConfigToJson(const MachineConfig& config) const;
@@ -134,15 +205,40 @@ private:
     
     mutable std::recursive_mutex m_mutex;
     json m_data;
+    mutable std::shared_ptr<const Snapshot> m_snapshot;  // std::atomic_load/atomic_store only
     
     // Autosave thread
     std::thread m_autosaveThread;
     std::atomic<bool> m_stopAutosave;
+    std::mutex m_autosaveMutex;
+    std::condition_variable m_autosaveCondition;
+    
+    // Generations: bumped on every change, and the last ones written to disk
+    std::atomic<uint64_t> m_generation;
+    std::atomic<uint64_t> m_savedGeneration;    // settings.json
+    std::atomic<uint64_t> m_journalGeneration;  // settings.json + journal
+    std::mutex m_writeMutex;  // One file write at a time
+    
+    // Change journal: one JSON line {"p":[key...],"v":value} per change, or
+    // {"p":[key...],"f":field,"m":match,"v":element} for one array element
+    // (no "v" if it was removed)
+    std::string m_journalBuffer;  // Not yet written; guarded by m_mutex
+    std::FILE* m_journal;
+    std::atomic<size_t> m_journalBytes;
+    
+    // Settings file read by load(); m_loadFormat is a ConfigFile::Format, -1 if none
+    double m_loadMilliseconds;
+    int m_loadFormat;
+    
+    // Changes are batched for JOURNAL_BATCH_MS into one append and fsync;
+    // a journal past JOURNAL_COMPACT_BYTES is folded into settings.json
+    static const int JOURNAL_BATCH_MS = 200;
+    static const size_t JOURNAL_COMPACT_BYTES = 1024 * 1024;
     
     // File paths
     const std::filesystem::path m_configDir = "config";
     const std::filesystem::path m_settingsFile = m_configDir / "settings.json";
-    const std::filesystem::path m_recoveryFile = m_configDir / "recovery.json";
+    const std::filesystem::path m_journalFile = m_configDir / "journal.jsonl";
     const std::filesystem::path m_machinesFile = m_configDir / "machines.json";
     const std::filesystem::path m_jobProfilesFile = m_configDir / "job_profiles.json";
 };
@@ -155,13 +251,13 @@ ConnectionType connectionTypeFromString(const std::string& str);
 template<typename T>
 T StateManager::getValue(const std::string& key, const T& defaultValue)
 {
-    std::lock_guard<std::recursive_mutex> lock(m_mutex);
-    
-    if (key.empty()) {
+    auto keys = splitKey(key);
+    if (keys.empty()) {
         return defaultValue;
     }
     
-    json* valuePtr = getNestedValue(key);
+    auto current = snapshot();
+    const json* valuePtr = findNestedValue(current->data, keys);
     if (valuePtr && !valuePtr->is_null()) {
         try {
             return valuePtr->get<T>();
@@ -176,9 +272,59 @@ T StateManager::getValue(const std::string& key, const T& defaultValue)
 template<typename T>
 void StateManager::setValue(const std::string& key, const T& value)
 {
+    auto keys = splitKey(key);
+    if (keys.empty()) {
+        return;
+    }
+    
     std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    json newValue(value);
+    setNestedValue(keys, newValue);
+    markDirty(keys, newValue);
+}
+
+template<typename T>
+T StateManager::getValue(const StateKey<T>& key)
+{
+    // Unchanged since the last read: no lock, no allocation
+    if (key.m_cachedGeneration == m_generation.load()) {
+        return key.m_cachedValue;
+    }
+    
+    if (key.m_path.empty()) {
+        key.m_path = splitKey(key.m_key);
+        if (key.m_path.empty()) {
+            return key.m_default;
+        }
+    }
+    
+    auto current = snapshot();
+    key.m_cachedValue = key.m_default;
+    const json* valuePtr = findNestedValue(current->data, key.m_path);
+    if (valuePtr && !valuePtr->is_null()) {
+        try {
+            key.m_cachedValue = valuePtr->get<T>();
+        } catch (const json::exception&) {
+            // Type conversion failed, keep the default
+        }
+    }
+    key.m_cachedGeneration = current->generation;
     
-    if (!key.empty()) {
-        setNestedValue(key, json(value));
+    return key.m_cachedValue;
+}
+
+template<typename T>
+void StateManager::setValue(const StateKey<T>& key, const T& value)
+{
+    if (key.m_path.empty()) {
+        key.m_path = splitKey(key.m_key);
+        if (key.m_path.empty()) {
+            return;
+        }
     }
+    
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    json newValue(value);
+    setNestedValue(key.m_path, newValue);
+    markDirty(key.m_path, newValue);
 }
@@ -0,0 +1,362 @@
+/**
+ * core/StockSimulator.cpp
+ * Implementation of the heightmap stock simulation
+ */
+
+#include "StockSimulator.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STOCK_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const float PI_F = 3.14159265358979f;
+
+// Per-move constants shared by the scalar and vector paths
+struct SweepParams {
+    float dx, dy, dz;     // Move vector
+    float length2;        // Squared XY length
+    float invLength2;
+    bool plunge;          // No XY motion - the tool only moves along Z
+    float z0;
+    float plungeZ;        // Lowest Z of a plunge
+    float radius, radius2;
+    float vSlope;         // Height gained per unit radius (VBIT)
+    StockToolShape shape;
+};
+
+// Height of the tool surface above its tip at squared radius r2
+inline float profile(const SweepParams& p, float r2)
+{
+    switch (p.shape) {
+        case StockToolShape::BALL: return p.radius - std::sqrt(std::max(p.radius2 - r2, 0.0f));
+        case StockToolShape::VBIT: return std::sqrt(r2) * p.vSlope;
+        default:                   return 0.0f;
+    }
+}
+
+// Lowest tool surface height over cell (wx, wy) relative to the move start,
+// or +inf when the cell is out of reach. The tool is evaluated where it
+// enters and leaves reach of the cell and at the closest approach, which is
+// exact for flat tools and a close bound for ball and V tools.
+inline float sweepHeight(const SweepParams& p, float wx, float wy)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+
+    if (p.plunge) {
+        float r2 = wx * wx + wy * wy;
+        return r2 <= p.radius2 ? p.plungeZ + profile(p, r2) : inf;
+    }
+
+    float ts = (wx * p.dx + wy * p.dy) * p.invLength2;
+    float perp2 = std::max(wx * wx + wy * wy - ts * ts * p.length2, 0.0f);
+    if (perp2 > p.radius2) return inf;
+
+    float half = std::sqrt((p.radius2 - perp2) * p.invLength2);
+    float ta = std::max(ts - half, 0.0f);
+    float tb = std::min(ts + half, 1.0f);
+    if (ta > tb) return inf;
+
+    float ea = ta - ts, eb = tb - ts;
+    float height = std::min(p.z0 + p.dz * ta + profile(p, perp2 + ea * ea * p.length2),
+                            p.z0 + p.dz * tb + profile(p, perp2 + eb * eb * p.length2));
+    if (p.shape != StockToolShape::FLAT) {
+        float tc = std::min(std::max(ts, 0.0f), 1.0f);
+        float ec = tc - ts;
+        height = std::min(height, p.z0 + p.dz * tc + profile(p, perp2 + ec * ec * p.length2));
+    }
+    return height;
+}
+
+#ifdef STOCK_USE_SSE2
+
+inline __m128 profile4(const SweepParams& p, __m128 r2)
+{
+    switch (p.shape) {
+        case StockToolShape::BALL:
+            return _mm_sub_ps(_mm_set1_ps(p.radius),
+                              _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(p.radius2), r2), _mm_setzero_ps())));
+        case StockToolShape::VBIT:
+            return _mm_mul_ps(_mm_sqrt_ps(r2), _mm_set1_ps(p.vSlope));
+        default:
+            return _mm_setzero_ps();
+    }
+}
+
+// sweepHeight() for four cells of a row
+inline __m128 sweepHeight4(const SweepParams& p, __m128 wx, __m128 wy)
+{
+    const __m128 inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 radius2 = _mm_set1_ps(p.radius2);
+
+    __m128 dist2 = _mm_add_ps(_mm_mul_ps(wx, wx), _mm_mul_ps(wy, wy));
+
+    if (p.plunge) {
+        __m128 height = _mm_add_ps(_mm_set1_ps(p.plungeZ), profile4(p, dist2));
+        __m128 inReach = _mm_cmple_ps(dist2, radius2);
+        return _mm_or_ps(_mm_and_ps(inReach, height), _mm_andnot_ps(inReach, inf));
+    }
+
+    const __m128 length2 = _mm_set1_ps(p.length2);
+    const __m128 z0 = _mm_set1_ps(p.z0);
+    const __m128 dz = _mm_set1_ps(p.dz);
+
+    __m128 ts = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(wx, _mm_set1_ps(p.dx)), _mm_mul_ps(wy, _mm_set1_ps(p.dy))),
+                           _mm_set1_ps(p.invLength2));
+    __m128 perp2 = _mm_max_ps(_mm_sub_ps(dist2, _mm_mul_ps(_mm_mul_ps(ts, ts), length2)), zero);
+    __m128 half = _mm_sqrt_ps(_mm_mul_ps(_mm_max_ps(_mm_sub_ps(radius2, perp2), zero), _mm_set1_ps(p.invLength2)));
+    __m128 ta = _mm_max_ps(_mm_sub_ps(ts, half), zero);
+    __m128 tb = _mm_min_ps(_mm_add_ps(ts, half), one);
+
+    __m128 ea = _mm_sub_ps(ta, ts);
+    __m128 eb = _mm_sub_ps(tb, ts);
+    __m128 heightA = _mm_add_ps(_mm_add_ps(z0, _mm_mul_ps(dz, ta)),
+                                profile4(p, _mm_add_ps(perp2, _mm_mul_ps(_mm_mul_ps(ea, ea), length2))));
+    __m128 heightB = _mm_add_ps(_mm_add_ps(z0, _mm_mul_ps(dz, tb)),
+                                profile4(p, _mm_add_ps(perp2, _mm_mul_ps(_mm_mul_ps(eb, eb), length2))));
+    __m128 height = _mm_min_ps(heightA, heightB);
+
+    if (p.shape != StockToolShape::FLAT) {
+        __m128 tc = _mm_min_ps(_mm_max_ps(ts, zero), one);
+        __m128 ec = _mm_sub_ps(tc, ts);
+        __m128 heightC = _mm_add_ps(_mm_add_ps(z0, _mm_mul_ps(dz, tc)),
+                                    profile4(p, _mm_add_ps(perp2, _mm_mul_ps(_mm_mul_ps(ec, ec), length2))));
+        height = _mm_min_ps(height, heightC);
+    }
+
+    __m128 inReach = _mm_and_ps(_mm_cmple_ps(perp2, radius2), _mm_cmple_ps(ta, tb));
+    return _mm_or_ps(_mm_and_ps(inReach, height), _mm_andnot_ps(inReach, inf));
+}
+
+#endif
+
+} // namespace
+
+StockTool StockTool::fromJobSettings(const std::string& toolType, float diameter)
+{
+    std::string type;
+    for (char c : toolType) {
+        type += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    StockTool tool;
+    tool.diameter = diameter > 0.0f ? diameter : 3.175f;
+    if (type.find("ball") != std::string::npos) {
+        tool.shape = StockToolShape::BALL;
+    } else if (type.find("v-bit") != std::string::npos || type.find("v bit") != std::string::npos ||
+               type.find("vbit") != std::string::npos || type.find("engrav") != std::string::npos ||
+               type.find("chamfer") != std::string::npos) {
+        tool.shape = StockToolShape::VBIT;
+    } else {
+        tool.shape = StockToolShape::FLAT;
+    }
+    return tool;
+}
+
+double StockSimulator::reset(double minX, double minY, double maxX, double maxY, double resolution, float topZ)
+{
+    resolution = std::max(resolution, 1e-3);
+    double spanX = std::max(maxX - minX, 0.0);
+    double spanY = std::max(maxY - minY, 0.0);
+
+    // Coarsen until the grid fits the cell budget
+    while ((spanX / resolution + 1) * (spanY / resolution + 1) > static_cast<double>(MAX_CELLS)) {
+        resolution *= 1.25;
+    }
+
+    m_resolution = resolution;
+    m_width = static_cast<int>(std::ceil(spanX / resolution)) + 1;
+    m_height = static_cast<int>(std::ceil(spanY / resolution)) + 1;
+    m_tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    m_originX = minX;
+    m_originY = minY;
+    m_topZ = topZ;
+    m_minZ = topZ;
+    m_shadeMinZ = topZ;
+    m_heights.assign(static_cast<size_t>(m_width) * m_height, topZ);
+
+    return m_resolution;
+}
+
+StockRect StockSimulator::cut(const std::vector<StockMove>& moves, size_t first, size_t last)
+{
+    StockRect dirty;
+    last = std::min(last, moves.size());
+    if (first >= last || m_heights.empty()) return dirty;
+
+    const double radius = m_tool.diameter / 2.0;
+    dirty.x0 = m_width;
+    dirty.y0 = m_height;
+
+    // Bin the moves that reach into the stock by the tiles they touch
+    std::vector<std::vector<uint32_t>> tileMoves(static_cast<size_t>(m_tilesX) * m_tilesY);
+    for (size_t i = first; i < last; ++i) {
+        const StockMove& move = moves[i];
+        float lowZ = std::min(move.z0, move.z1);
+        if (lowZ >= m_topZ) continue;  // Tool tip above the stock
+        m_minZ = std::min(m_minZ, lowZ);
+
+        int cellX0 = std::max(0, static_cast<int>(std::floor((std::min(move.x0, move.x1) - radius - m_originX) / m_resolution)));
+        int cellY0 = std::max(0, static_cast<int>(std::floor((std::min(move.y0, move.y1) - radius - m_originY) / m_resolution)));
+        int cellX1 = std::min(m_width, static_cast<int>(std::ceil((std::max(move.x0, move.x1) + radius - m_originX) / m_resolution)) + 1);
+        int cellY1 = std::min(m_height, static_cast<int>(std::ceil((std::max(move.y0, move.y1) + radius - m_originY) / m_resolution)) + 1);
+        if (cellX0 >= cellX1 || cellY0 >= cellY1) continue;
+
+        dirty.x0 = std::min(dirty.x0, cellX0);
+        dirty.y0 = std::min(dirty.y0, cellY0);
+        dirty.x1 = std::max(dirty.x1, cellX1);
+        dirty.y1 = std::max(dirty.y1, cellY1);
+
+        for (int ty = cellY0 / TILE_SIZE; ty <= (cellY1 - 1) / TILE_SIZE; ++ty) {
+            for (int tx = cellX0 / TILE_SIZE; tx <= (cellX1 - 1) / TILE_SIZE; ++tx) {
+                tileMoves[static_cast<size_t>(ty) * m_tilesX + tx].push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    if (dirty.empty()) return StockRect();
+
+    // Tiles own disjoint cells - hand them out to a few threads
+    std::atomic<size_t> next(0);
+    auto worker = [this, &moves, &tileMoves, &next]() {
+        for (size_t tile = next++; tile < tileMoves.size(); tile = next++) {
+            if (!tileMoves[tile].empty()) {
+                cutTile(static_cast<int>(tile), moves, tileMoves[tile]);
+            }
+        }
+    };
+
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, tileMoves.size()));
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threadCount; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    return dirty;
+}
+
+void StockSimulator::cutTile(int tile, const std::vector<StockMove>& moves, const std::vector<uint32_t>& moveIndices)
+{
+    const int tileX0 = (tile % m_tilesX) * TILE_SIZE;
+    const int tileY0 = (tile / m_tilesX) * TILE_SIZE;
+    const int tileX1 = std::min(tileX0 + TILE_SIZE, m_width);
+    const int tileY1 = std::min(tileY0 + TILE_SIZE, m_height);
+    const double radius = m_tool.diameter / 2.0;
+
+    for (uint32_t index : moveIndices) {
+        const StockMove& move = moves[index];
+
+        int cellX0 = std::max(tileX0, static_cast<int>(std::floor((std::min(move.x0, move.x1) - radius - m_originX) / m_resolution)));
+        int cellY0 = std::max(tileY0, static_cast<int>(std::floor((std::min(move.y0, move.y1) - radius - m_originY) / m_resolution)));
+        int cellX1 = std::min(tileX1, static_cast<int>(std::ceil((std::max(move.x0, move.x1) + radius - m_originX) / m_resolution)) + 1);
+        int cellY1 = std::min(tileY1, static_cast<int>(std::ceil((std::max(move.y0, move.y1) + radius - m_originY) / m_resolution)) + 1);
+
+        if (cellX0 < cellX1 && cellY0 < cellY1) {
+            cutMove(move, cellX0, cellY0, cellX1, cellY1);
+        }
+    }
+}
+
+void StockSimulator::cutMove(const StockMove& move, int cellX0, int cellY0, int cellX1, int cellY1)
+{
+    SweepParams p;
+    p.dx = move.x1 - move.x0;
+    p.dy = move.y1 - move.y0;
+    p.dz = move.z1 - move.z0;
+    p.length2 = p.dx * p.dx + p.dy * p.dy;
+    p.plunge = p.length2 < 1e-10f;
+    p.invLength2 = p.plunge ? 0.0f : 1.0f / p.length2;
+    p.z0 = move.z0;
+    p.plungeZ = std::min(move.z0, move.z1);
+    p.radius = m_tool.diameter / 2.0f;
+    p.radius2 = p.radius * p.radius;
+    p.vSlope = 1.0f / std::tan(std::max(m_tool.vAngle, 1.0f) * PI_F / 360.0f);
+    p.shape = m_tool.shape;
+
+    // Cell centers relative to the move start
+    const float step = static_cast<float>(m_resolution);
+    const float wx0 = static_cast<float>(m_originX + cellX0 * m_resolution - move.x0);
+
+    for (int y = cellY0; y < cellY1; ++y) {
+        float wy = static_cast<float>(m_originY + y * m_resolution - move.y0);
+        float* row = &m_heights[static_cast<size_t>(y) * m_width];
+        int x = cellX0;
+
+#ifdef STOCK_USE_SSE2
+        const __m128 wyv = _mm_set1_ps(wy);
+        const __m128 lane = _mm_mul_ps(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), _mm_set1_ps(step));
+        for (; x + 4 <= cellX1; x += 4) {
+            __m128 wxv = _mm_add_ps(_mm_set1_ps(wx0 + (x - cellX0) * step), lane);
+            __m128 height = sweepHeight4(p, wxv, wyv);
+            _mm_storeu_ps(row + x, _mm_min_ps(_mm_loadu_ps(row + x), height));
+        }
+#endif
+
+        for (; x < cellX1; ++x) {
+            float height = sweepHeight(p, wx0 + (x - cellX0) * step, wy);
+            row[x] = std::min(row[x], height);
+        }
+    }
+}
+
+void StockSimulator::renderShaded(unsigned char* rgb) const
+{
+    StockRect all;
+    all.x1 = m_width;
+    all.y1 = m_height;
+    renderShaded(rgb, all);
+}
+
+void StockSimulator::renderShaded(unsigned char* rgb, const StockRect& rect) const
+{
+    // Light from the upper left, above the stock
+    const float lightX = -0.5f, lightY = 0.5f, lightZ = 0.7071f;
+    const float depthRange = std::max(m_topZ - std::min(m_minZ, m_shadeMinZ), 1e-3f);
+    const float inverseStep = static_cast<float>(0.5 / m_resolution);
+
+    const int rectWidth = rect.x1 - rect.x0;
+    for (int y = rect.y0; y < rect.y1; ++y) {
+        const float* row = &m_heights[static_cast<size_t>(y) * m_width];
+        const float* below = &m_heights[static_cast<size_t>(std::max(y - 1, 0)) * m_width];
+        const float* above = &m_heights[static_cast<size_t>(std::min(y + 1, m_height - 1)) * m_width];
+        unsigned char* out = rgb + static_cast<size_t>(y - rect.y0) * rectWidth * 3;
+
+        for (int x = rect.x0; x < rect.x1; ++x) {
+            float h = row[x];
+            float gx = (row[std::min(x + 1, m_width - 1)] - row[std::max(x - 1, 0)]) * inverseStep;
+            float gy = (above[x] - below[x]) * inverseStep;
+
+            // Lambert term of the surface normal (-gx, -gy, 1)
+            float shade = (-gx * lightX - gy * lightY + lightZ) / std::sqrt(gx * gx + gy * gy + 1.0f);
+            shade = 0.35f + 0.65f * std::max(shade, 0.0f);
+
+            // Uncut stock in a light wood tone, darker with depth
+            float depth = (m_topZ - h) / depthRange;
+            float red = 222.0f - 90.0f * depth;
+            float green = 184.0f - 100.0f * depth;
+            float blue = 135.0f - 85.0f * depth;
+
+            unsigned char* pixel = out + (x - rect.x0) * 3;
+            pixel[0] = static_cast<unsigned char>(std::min(red * shade, 255.0f));
+            pixel[1] = static_cast<unsigned char>(std::min(green * shade, 255.0f));
+            pixel[2] = static_cast<unsigned char>(std::min(blue * shade, 255.0f));
+        }
+    }
+}
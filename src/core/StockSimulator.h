@@ -0,0 +1,103 @@
+/**
+ * core/StockSimulator.h
+ * Material removal simulation on a Z heightmap
+ * The stock is a grid of surface heights. Every move lowers the cells within
+ * reach of the tool to the height of the tool surface swept along it (flat,
+ * ball or V profile), which shows gouges and the finish of 3D passes before
+ * the job runs. The grid is split into tiles that are cut in parallel; each
+ * tile only sees the moves crossing it, and rows are processed four cells at
+ * a time with SSE2.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class StockToolShape {
+    FLAT,
+    BALL,
+    VBIT
+};
+
+struct StockTool {
+    StockToolShape shape = StockToolShape::FLAT;
+    float diameter = 3.175f;
+    float vAngle = 60.0f;  // Included angle in degrees (VBIT only)
+
+    // Maps the job settings tool type ("End Mill", "Ball Nose", "V-Bit", ...)
+    static StockTool fromJobSettings(const std::string& toolType, float diameter);
+};
+
+// Straight move in program coordinates (arcs are flattened by the caller)
+struct StockMove {
+    float x0, y0, z0;
+    float x1, y1, z1;
+};
+
+// Cell range [x0, x1) x [y0, y1) touched by a cut
+struct StockRect {
+    int x0 = 0, y0 = 0;
+    int x1 = 0, y1 = 0;
+    bool empty() const { return x0 >= x1 || y0 >= y1; }
+};
+
+class StockSimulator {
+public:
+    static const int TILE_SIZE = 64;
+    // Grids are coarsened beyond this many cells
+    static const size_t MAX_CELLS = size_t(1) << 24;
+
+    // New uncut stock covering [minX, maxX] x [minY, maxY] with its top at topZ.
+    // Returns the resolution actually used (coarser than requested when the
+    // grid would exceed MAX_CELLS).
+    double reset(double minX, double minY, double maxX, double maxY, double resolution, float topZ);
+    void setTool(const StockTool& tool) { m_tool = tool; }
+
+    // Sweeps the tool along moves [first, last). Cuts can be applied in any
+    // order and in pieces (progressive preview, live execution); the result
+    // is the same. Returns the cells that were lowered.
+    StockRect cut(const std::vector<StockMove>& moves, size_t first, size_t last);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    double getResolution() const { return m_resolution; }
+    double getOriginX() const { return m_originX; }
+    double getOriginY() const { return m_originY; }
+    float getTopZ() const { return m_topZ; }
+    float getMinZ() const { return m_minZ; }
+
+    // Height shaded darkest; by default the deepest cut so far. Setting the
+    // program's lowest Z after reset() keeps the colors of cells rendered
+    // earlier valid while further cuts come in.
+    void setShadeMinZ(float z) { m_shadeMinZ = z; }
+
+    // Row-major heights, row 0 at minY
+    const std::vector<float>& getHeights() const { return m_heights; }
+
+    // Hill-shaded RGB image of the whole grid (width * height * 3 bytes), row 0 at minY
+    void renderShaded(unsigned char* rgb) const;
+    // The same for the cells of 'rect' only (rect width * height * 3 bytes).
+    // Shading reads the neighbours of each cell, so a cut changes the image
+    // one cell beyond the rect it returned.
+    void renderShaded(unsigned char* rgb, const StockRect& rect) const;
+
+private:
+    void cutTile(int tile, const std::vector<StockMove>& moves, const std::vector<uint32_t>& moveIndices);
+    void cutMove(const StockMove& move, int cellX0, int cellY0, int cellX1, int cellY1);
+
+    StockTool m_tool;
+    int m_width = 0;
+    int m_height = 0;
+    int m_tilesX = 0;
+    int m_tilesY = 0;
+    double m_resolution = 0.1;
+    double m_originX = 0.0;  // Center of cell (0, 0)
+    double m_originY = 0.0;
+    float m_topZ = 0.0f;
+    float m_minZ = 0.0f;
+    float m_shadeMinZ = 0.0f;
+    std::vector<float> m_heights;
+};
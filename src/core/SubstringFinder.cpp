@@ -0,0 +1,96 @@
+/**
+ * core/SubstringFinder.cpp
+ * Implementation of the shared substring search
+ */
+
+#include "SubstringFinder.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SEARCH_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+inline bool IsLetter(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+inline char Lower(char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); }
+
+inline int CountTrailingZeros(unsigned int value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(value);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<int>(index);
+#else
+    int count = 0;
+    while ((value & 1) == 0) {
+        value >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+} // namespace
+
+SubstringFinder::SubstringFinder(const std::string& needle, bool matchCase)
+    : m_needle(needle), m_matchCase(matchCase)
+{
+    if (!m_matchCase) {
+        std::transform(m_needle.begin(), m_needle.end(), m_needle.begin(), Lower);
+    }
+}
+
+const char* SubstringFinder::Find(const char* first, const char* last) const
+{
+    size_t length = m_needle.size();
+    if (length == 0 || static_cast<size_t>(last - first) < length) return last;
+
+    const char* p = first;
+#ifdef SEARCH_USE_SSE2
+    const char firstByte = m_needle[0];
+    const char lastByte = m_needle[length - 1];
+    const __m128i firstNeedle = _mm_set1_epi8(firstByte);
+    const __m128i lastNeedle = _mm_set1_epi8(lastByte);
+    // OR-ing 0x20 lowercases ASCII letters; only done for letter bytes of the needle
+    const __m128i firstFold = _mm_set1_epi8(!m_matchCase && IsLetter(firstByte) ? 0x20 : 0);
+    const __m128i lastFold = _mm_set1_epi8(!m_matchCase && IsLetter(lastByte) ? 0x20 : 0);
+
+    for (; p + length - 1 + 16 <= last; p += 16) {
+        __m128i blockFirst = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), firstFold);
+        __m128i blockLast = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + length - 1)), lastFold);
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(blockFirst, firstNeedle), _mm_cmpeq_epi8(blockLast, lastNeedle))));
+
+        while (mask != 0) {
+            int bit = CountTrailingZeros(mask);
+            if (Equal(p + bit)) return p + bit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; p + length <= last; ++p) {
+        if (Equal(p)) return p;
+    }
+    return last;
+}
+
+bool SubstringFinder::Equal(const char* p) const
+{
+    if (m_matchCase) {
+        return std::memcmp(p, m_needle.data(), m_needle.size()) == 0;
+    }
+    for (size_t i = 0; i < m_needle.size(); i++) {
+        if (Lower(p[i]) != m_needle[i]) return false;
+    }
+    return true;
+}
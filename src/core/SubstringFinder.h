@@ -0,0 +1,32 @@
+/**
+ * core/SubstringFinder.h
+ * Literal substring search shared by the editor, mapped file and console searches
+ * Candidate positions are found 16 at a time (SSE2) by comparing the first and
+ * last needle bytes against two overlapping loads; only candidates are
+ * compared in full. Case folding is ASCII only.
+ */
+
+#pragma once
+
+#include <string>
+
+class SubstringFinder
+{
+public:
+    SubstringFinder(const std::string& needle, bool matchCase);
+
+    // First match in [first, last), or last. An empty needle never matches.
+    const char* Find(const char* first, const char* last) const;
+    bool Contains(const std::string& text) const
+    {
+        return Find(text.data(), text.data() + text.size()) != text.data() + text.size();
+    }
+
+    size_t Length() const { return m_needle.size(); }
+
+private:
+    bool Equal(const char* p) const;
+
+    std::string m_needle;  // Lower case unless m_matchCase
+    bool m_matchCase;
+};
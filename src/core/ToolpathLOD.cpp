@@ -0,0 +1,191 @@
+/**
+ * core/ToolpathLOD.cpp
+ * Implementation of the toolpath level-of-detail hierarchy
+ */
+
+#include "ToolpathLOD.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+namespace {
+
+// Squared distance from p to the segment a-b
+double segmentDistanceSquared(const LODPoint& p, const LODPoint& a, const LODPoint& b)
+{
+    double x = a.x, y = a.y;
+    double dx = b.x - x, dy = b.y - y;
+
+    if (dx != 0.0 || dy != 0.0) {
+        double t = ((p.x - x) * dx + (p.y - y) * dy) / (dx * dx + dy * dy);
+        if (t > 1.0) {
+            x = b.x;
+            y = b.y;
+        } else if (t > 0.0) {
+            x += dx * t;
+            y += dy * t;
+        }
+    }
+
+    dx = p.x - x;
+    dy = p.y - y;
+    return dx * dx + dy * dy;
+}
+
+} // namespace
+
+std::vector<LODPoint> ToolpathLOD::simplify(const std::vector<LODPoint>& points, double tolerance)
+{
+    if (points.size() <= 2) {
+        return points;
+    }
+
+    double toleranceSquared = tolerance * tolerance;
+
+    // Radial pre-pass: drop points closer than the tolerance to the last kept
+    // one. Cheap, and removes most of the work for dense relief paths.
+    std::vector<LODPoint> reduced;
+    reduced.reserve(points.size());
+    reduced.push_back(points.front());
+    for (size_t i = 1; i + 1 < points.size(); ++i) {
+        double dx = points[i].x - reduced.back().x;
+        double dy = points[i].y - reduced.back().y;
+        if (dx * dx + dy * dy > toleranceSquared) {
+            reduced.push_back(points[i]);
+        }
+    }
+    reduced.push_back(points.back());
+
+    if (reduced.size() <= 2) {
+        return reduced;
+    }
+
+    // Douglas-Peucker with an explicit stack (recursion depth is unbounded for long paths)
+    std::vector<char> keep(reduced.size(), 0);
+    keep.front() = 1;
+    keep.back() = 1;
+
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.emplace_back(0, reduced.size() - 1);
+
+    while (!stack.empty()) {
+        size_t first = stack.back().first;
+        size_t last = stack.back().second;
+        stack.pop_back();
+
+        double maxDistance = toleranceSquared;
+        size_t index = 0;
+        for (size_t i = first + 1; i < last; ++i) {
+            double distance = segmentDistanceSquared(reduced[i], reduced[first], reduced[last]);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                index = i;
+            }
+        }
+
+        if (index != 0) {
+            keep[index] = 1;
+            if (index - first > 1) stack.emplace_back(first, index);
+            if (last - index > 1) stack.emplace_back(index, last);
+        }
+    }
+
+    std::vector<LODPoint> result;
+    for (size_t i = 0; i < reduced.size(); ++i) {
+        if (keep[i]) {
+            result.push_back(reduced[i]);
+        }
+    }
+    return result;
+}
+
+void ToolpathLOD::simplifyLevel(const std::vector<LODPolyline>& source, double tolerance, LODLevel& level)
+{
+    level.polylines.resize(source.size());
+
+    // Polylines are independent - hand them out to a few threads
+    std::atomic<size_t> next(0);
+    auto worker = [&source, &level, &next, tolerance]() {
+        for (size_t i = next++; i < source.size(); i = next++) {
+            level.polylines[i].renderClass = source[i].renderClass;
+            level.polylines[i].points = simplify(source[i].points, tolerance);
+        }
+    };
+
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, source.size()));
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threadCount; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    level.pointCount = 0;
+    for (const auto& polyline : level.polylines) {
+        level.pointCount += polyline.points.size();
+    }
+}
+
+void ToolpathLOD::build(const std::vector<LODPolyline>& source, double baseTolerance, int levelCount)
+{
+    m_levels.clear();
+    if (source.empty() || baseTolerance <= 0.0 || levelCount <= 0) {
+        return;
+    }
+
+    // Split very long polylines so a single huge pass still spreads over the
+    // threads; neighbouring pieces share their boundary point
+    std::vector<LODPolyline> pieces;
+    size_t sourcePoints = 0;
+    for (const auto& polyline : source) {
+        sourcePoints += polyline.points.size();
+        const auto& points = polyline.points;
+        size_t begin = 0;
+        size_t end = 0;
+        do {
+            end = std::min(points.size(), begin + MAX_PIECE_POINTS);
+            LODPolyline piece;
+            piece.renderClass = polyline.renderClass;
+            piece.points.assign(points.begin() + begin, points.begin() + end);
+            pieces.push_back(std::move(piece));
+            begin = end - 1;
+        } while (end < points.size());
+    }
+
+    // Each level is simplified from the previous one, so the work shrinks as
+    // the levels get coarser. Deviations add up, and the stored tolerance is
+    // the accumulated bound (below twice the step tolerance).
+    const std::vector<LODPolyline>* input = &pieces;
+    double step = baseTolerance;
+    double accumulated = 0.0;
+    std::vector<LODLevel> levels(static_cast<size_t>(levelCount));
+    for (auto& level : levels) {
+        accumulated += step;
+        level.tolerance = accumulated;
+        simplifyLevel(*input, step, level);
+        input = &level.polylines;
+        step *= 2.0;
+    }
+
+    for (auto& level : levels) {
+        if (level.pointCount * 2 <= sourcePoints) {
+            m_levels.push_back(std::move(level));
+        }
+    }
+}
+
+int ToolpathLOD::selectLevel(double maxTolerance) const
+{
+    int selected = -1;
+    for (size_t i = 0; i < m_levels.size(); ++i) {
+        if (m_levels[i].tolerance <= maxTolerance) {
+            selected = static_cast<int>(i);
+        }
+    }
+    return selected;
+}
@@ -0,0 +1,61 @@
+/**
+ * core/ToolpathLOD.h
+ * Level-of-detail hierarchy for toolpath rendering
+ * Relief and 3D finishing programs contain millions of tiny moves that
+ * collapse into a few thousand pixels when zoomed out. Each level holds the
+ * toolpath polylines simplified (Douglas-Peucker) from the previous level
+ * with a tolerance twice as coarse, so the renderer can pick the level matching
+ * the current pixel size and keep paint cost bounded by screen resolution.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct LODPoint {
+    float x = 0.0f;
+    float y = 0.0f;
+    uint32_t segment = 0;  // Source moves completed on reaching this point (progress drawing)
+};
+
+// Continuous run of moves sharing one render class
+struct LODPolyline {
+    int renderClass = 0;
+    std::vector<LODPoint> points;
+};
+
+struct LODLevel {
+    double tolerance = 0.0;        // Bound on the deviation from the source path
+    std::vector<LODPolyline> polylines;
+    size_t pointCount = 0;
+};
+
+class ToolpathLOD {
+public:
+    static const int DEFAULT_LEVEL_COUNT = 12;
+
+    // Builds the levels with step tolerances baseTolerance * 2^n, simplifying
+    // the polylines of each level in parallel. Levels that would keep more than half of the source
+    // points are not stored - the full-detail path is just as cheap to draw.
+    void build(const std::vector<LODPolyline>& source, double baseTolerance,
+               int levelCount = DEFAULT_LEVEL_COUNT);
+    void clear() { m_levels.clear(); }
+
+    const std::vector<LODLevel>& getLevels() const { return m_levels; }
+
+    // Index of the coarsest level whose tolerance does not exceed maxTolerance,
+    // or -1 when the full-detail path should be drawn
+    int selectLevel(double maxTolerance) const;
+
+    // Douglas-Peucker simplification of one polyline (endpoints are kept)
+    static std::vector<LODPoint> simplify(const std::vector<LODPoint>& points, double tolerance);
+
+private:
+    static void simplifyLevel(const std::vector<LODPolyline>& source, double tolerance, LODLevel& level);
+
+    static const size_t MAX_PIECE_POINTS = 65536;
+
+    std::vector<LODLevel> m_levels;  // Ordered fine to coarse
+};
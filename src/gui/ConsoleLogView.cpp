@@ -0,0 +1,330 @@
+/**
+ * gui/ConsoleLogView.cpp
+ * Owner-drawn virtual list implementation for the console history
+ */
+
+#include "ConsoleLogView.h"
+#include <wx/dcclient.h>
+#include <wx/clipbrd.h>
+
+ConsoleLogView::ConsoleLogView(wxWindow* parent, wxWindowID id, const ConsoleLogBuffer& buffer)
+    : wxVListBox(parent, id, wxDefaultPosition, wxDefaultSize, wxLB_MULTIPLE)
+    , m_buffer(buffer)
+    , m_filtered(false)
+    , m_searching(false)
+    , m_knownFirst(buffer.FirstSequence())
+    , m_showTimestamps(true)
+    , m_frameTimer(this)
+    , m_syncPending(false)
+    , m_refreshPending(false)
+    , m_pendingFollowTail(true)
+    , m_pendingDropped(0)
+{
+    SetBackgroundColour(*wxBLACK);
+    SetForegroundColour(*wxWHITE);
+    SetSelectionBackground(wxColour(60, 60, 110));
+
+    for (bool& cached : m_styleCached) {
+        cached = false;
+    }
+
+    // All rows share one height - use the largest font any level can use (bold 10pt)
+    wxClientDC dc(this);
+    dc.SetFont(wxFont(10, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_BOLD));
+    m_rowHeight = dc.GetCharHeight() + 2;
+
+    Bind(wxEVT_KEY_DOWN, &ConsoleLogView::OnKeyDown, this);
+    Bind(wxEVT_TIMER, &ConsoleLogView::OnFrameTimer, this, m_frameTimer.GetId());
+
+    SetItemCount(RowCount());
+}
+
+void ConsoleLogView::SetStyleProvider(StyleProvider provider)
+{
+    m_styleProvider = provider;
+    for (bool& cached : m_styleCached) {
+        cached = false;
+    }
+    RefreshAll();
+}
+
+void ConsoleLogView::SetShowTimestamps(bool show)
+{
+    if (m_showTimestamps == show) return;
+    m_showTimestamps = show;
+    RefreshAll();
+}
+
+void ConsoleLogView::OnRecordAppended(uint64_t sequence, bool visible)
+{
+    if (m_filtered && visible) {
+        (m_searching ? m_liveRows : m_rows).push_back(sequence);
+    }
+
+    QueueSync(DropEvictedRows());
+}
+
+void ConsoleLogView::OnRecordUpdated(uint64_t WXUNUSED(sequence))
+{
+    // The row keeps its position, only its text changes
+    m_refreshPending = true;
+    ScheduleFrame();
+}
+
+void ConsoleLogView::ShowAll()
+{
+    m_filtered = false;
+    m_searching = false;
+    m_rows.clear();
+    m_liveRows.clear();
+    m_knownFirst = m_buffer.FirstSequence();
+
+    SyncRowCount(true, 0);
+}
+
+void ConsoleLogView::BeginResults()
+{
+    m_filtered = true;
+    m_searching = true;
+    m_rows.clear();
+    m_liveRows.clear();
+    m_knownFirst = m_buffer.FirstSequence();
+
+    SyncRowCount(true, 0);
+}
+
+void ConsoleLogView::AppendResults(const std::vector<uint64_t>& sequences)
+{
+    if (!m_searching) return;
+
+    uint64_t first = m_buffer.FirstSequence();
+
+    for (uint64_t seq : sequences) {
+        // Results may refer to records evicted since the worker saw them
+        if (seq >= first) {
+            m_rows.push_back(seq);
+        }
+    }
+
+    QueueSync(DropEvictedRows());
+}
+
+void ConsoleLogView::EndResults()
+{
+    if (!m_searching) return;
+
+    // Everything in the live tail is newer than any search result
+    m_rows.insert(m_rows.end(), m_liveRows.begin(), m_liveRows.end());
+    m_liveRows.clear();
+    m_searching = false;
+}
+
+std::vector<uint64_t> ConsoleLogView::GetFilteredRows() const
+{
+    std::vector<uint64_t> rows(m_rows.begin(), m_rows.end());
+    rows.insert(rows.end(), m_liveRows.begin(), m_liveRows.end());
+    return rows;
+}
+
+void ConsoleLogView::Reset()
+{
+    m_rows.clear();
+    m_liveRows.clear();
+    m_searching = false;
+    m_knownFirst = m_buffer.FirstSequence();
+
+    SyncRowCount(true, 0);
+}
+
+size_t ConsoleLogView::DropEvictedRows()
+{
+    uint64_t first = m_buffer.FirstSequence();
+    size_t dropped = 0;
+
+    if (m_filtered) {
+        while (!m_rows.empty() && m_rows.front() < first) {
+            m_rows.pop_front();
+            dropped++;
+        }
+        while (m_rows.empty() && !m_liveRows.empty() && m_liveRows.front() < first) {
+            m_liveRows.pop_front();
+            dropped++;
+        }
+    } else if (first > m_knownFirst) {
+        dropped = static_cast<size_t>(first - m_knownFirst);
+    }
+
+    m_knownFirst = first;
+    return dropped;
+}
+
+void ConsoleLogView::QueueSync(size_t rowsDropped)
+{
+    // Capture the scroll intent before the row count starts moving
+    if (!m_syncPending) {
+        m_pendingFollowTail = IsAtBottom();
+        m_syncPending = true;
+    }
+    m_pendingDropped += rowsDropped;
+    ScheduleFrame();
+}
+
+void ConsoleLogView::ScheduleFrame()
+{
+    if (!m_frameTimer.IsRunning()) {
+        m_frameTimer.StartOnce(FRAME_INTERVAL_MS);
+    }
+}
+
+void ConsoleLogView::OnFrameTimer(wxTimerEvent& WXUNUSED(event))
+{
+    if (m_syncPending) {
+        SyncRowCount(m_pendingFollowTail, m_pendingDropped);
+    } else if (m_refreshPending) {
+        m_refreshPending = false;
+        RefreshAll();
+    }
+}
+
+void ConsoleLogView::SyncRowCount(bool followTail, size_t rowsDropped)
+{
+    // Also completes any deferred update
+    m_syncPending = false;
+    m_refreshPending = false;
+    m_pendingDropped = 0;
+
+    size_t firstVisible = GetVisibleRowsBegin();
+    size_t rows = RowCount();
+
+    SetItemCount(rows);
+
+    if (rows == 0) {
+        RefreshAll();
+        return;
+    }
+
+    if (followTail) {
+        ScrollToRow(rows - 1);
+    } else if (rowsDropped > 0) {
+        // Keep the rows the user is reading in place while old history rolls off
+        ScrollToRow(firstVisible > rowsDropped ? firstVisible - rowsDropped : 0);
+    }
+
+    // Only the visible rows are repainted
+    RefreshAll();
+}
+
+bool ConsoleLogView::IsAtBottom() const
+{
+    return GetItemCount() == 0 || GetVisibleRowsEnd() >= GetItemCount();
+}
+
+size_t ConsoleLogView::RowCount() const
+{
+    return m_filtered ? m_rows.size() + m_liveRows.size() : m_buffer.Size();
+}
+
+uint64_t ConsoleLogView::SequenceForRow(size_t row) const
+{
+    if (!m_filtered) {
+        return m_buffer.FirstSequence() + row;
+    }
+    return row < m_rows.size() ? m_rows[row] : m_liveRows[row - m_rows.size()];
+}
+
+const wxTextAttr& ConsoleLogView::StyleFor(ConsoleLevel level) const
+{
+    int index = static_cast<int>(level);
+    if (index < 0 || index >= LEVEL_COUNT) {
+        index = static_cast<int>(ConsoleLevel::LEVEL_INFO);
+    }
+
+    if (!m_styleCached[index]) {
+        wxTextAttr attr;
+        if (m_styleProvider) {
+            attr = m_styleProvider(static_cast<ConsoleLevel>(index));
+        } else {
+            attr.SetTextColour(*wxWHITE);
+            attr.SetFont(wxFont(9, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+        }
+        m_styleCache[index] = attr;
+        m_styleCached[index] = true;
+    }
+
+    return m_styleCache[index];
+}
+
+wxString ConsoleLogView::FormatRecord(const ConsoleLogRecord& record) const
+{
+    wxString line;
+    if (m_showTimestamps) {
+        line << "[" << ConsoleLogBuffer::FormatTimeOfDay(record.timeOfDay) << "] ";
+    }
+    line << "[" << ConsoleLevelName(record.level) << "] " << record.message;
+    if (record.repeatCount > 1) {
+        line << "  (x" << record.repeatCount << ")";
+    }
+    return line;
+}
+
+wxString ConsoleLogView::GetRowText(size_t row) const
+{
+    if (row >= RowCount()) return wxEmptyString;
+
+    uint64_t seq = SequenceForRow(row);
+    if (!m_buffer.Contains(seq)) return wxEmptyString;
+
+    return FormatRecord(m_buffer.At(seq));
+}
+
+void ConsoleLogView::CopySelectionToClipboard()
+{
+    wxString text;
+    unsigned long cookie;
+    for (int row = GetFirstSelected(cookie); row != wxNOT_FOUND; row = GetNextSelected(cookie)) {
+        text << GetRowText(static_cast<size_t>(row)) << "\n";
+    }
+
+    if (text.IsEmpty()) return;
+
+    if (wxTheClipboard->Open()) {
+        wxTheClipboard->SetData(new wxTextDataObject(text));
+        wxTheClipboard->Close();
+    }
+}
+
+void ConsoleLogView::OnDrawItem(wxDC& dc, const wxRect& rect, size_t n) const
+{
+    if (n >= RowCount()) return;
+
+    uint64_t seq = SequenceForRow(n);
+    if (!m_buffer.Contains(seq)) return;
+
+    const ConsoleLogRecord& record = m_buffer.At(seq);
+    const wxTextAttr& style = StyleFor(record.level);
+
+    wxDCClipper clip(dc, rect);
+    dc.SetFont(style.GetFont());
+    dc.SetTextForeground(style.GetTextColour());
+    dc.DrawText(FormatRecord(record), rect.x + 2, rect.y + 1);
+}
+
+wxCoord ConsoleLogView::OnMeasureItem(size_t WXUNUSED(n)) const
+{
+    return m_rowHeight;
+}
+
+void ConsoleLogView::OnKeyDown(wxKeyEvent& event)
+{
+    if (event.ControlDown()) {
+        switch (event.GetKeyCode()) {
+            case 'C':
+                CopySelectionToClipboard();
+                return;
+            case 'A':
+                SelectAll();
+                return;
+        }
+    }
+    event.Skip();
+}
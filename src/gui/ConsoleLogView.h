@@ -0,0 +1,98 @@
+/**
+ * gui/ConsoleLogView.h
+ * Owner-drawn virtual list showing the console history
+ * Only the visible rows are ever formatted and painted, so the cost of an
+ * append does not depend on how much history the console is holding.
+ * Row count updates and repaints are coalesced to at most one per frame.
+ */
+
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/vlbox.h>
+#include <wx/timer.h>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "core/ConsoleLogBuffer.h"
+
+class ConsoleLogView : public wxVListBox
+{
+public:
+    // Returns the text style used for a given level
+    using StyleProvider = std::function<wxTextAttr(ConsoleLevel level)>;
+
+    ConsoleLogView(wxWindow* parent, wxWindowID id, const ConsoleLogBuffer& buffer);
+
+    void SetStyleProvider(StyleProvider provider);
+    void SetShowTimestamps(bool show);
+
+    // Called after a record was appended to the buffer; 'visible' tells whether it
+    // passes the current filter. Evicted records are dropped from the row index.
+    void OnRecordAppended(uint64_t sequence, bool visible);
+    // Called after a record was rewritten in place (collapsed repeats)
+    void OnRecordUpdated(uint64_t sequence);
+
+    // Show every record in the buffer (no row index needed)
+    void ShowAll();
+
+    // Filtered display fed by a background search: results stream in through
+    // AppendResults (ascending); records appended meanwhile are kept in a live
+    // tail so the ordering stays correct when the search completes
+    void BeginResults();
+    void AppendResults(const std::vector<uint64_t>& sequences);
+    void EndResults();
+    bool IsSearching() const { return m_searching; }
+    bool IsFiltered() const { return m_filtered; }
+    std::vector<uint64_t> GetFilteredRows() const;
+
+    // Buffer was cleared
+    void Reset();
+
+    // Formatted text of a row (as displayed)
+    wxString GetRowText(size_t row) const;
+    void CopySelectionToClipboard();
+
+protected:
+    void OnDrawItem(wxDC& dc, const wxRect& rect, size_t n) const override;
+    wxCoord OnMeasureItem(size_t n) const override;
+
+private:
+    void OnKeyDown(wxKeyEvent& event);
+    void OnFrameTimer(wxTimerEvent& event);
+
+    size_t RowCount() const;
+    uint64_t SequenceForRow(size_t row) const;
+    const wxTextAttr& StyleFor(ConsoleLevel level) const;
+    wxString FormatRecord(const ConsoleLogRecord& record) const;
+    size_t DropEvictedRows();
+    void SyncRowCount(bool followTail, size_t rowsDropped);
+    void QueueSync(size_t rowsDropped);
+    void ScheduleFrame();
+    bool IsAtBottom() const;
+
+    static const int LEVEL_COUNT = static_cast<int>(ConsoleLevel::LEVEL_COUNT);
+    static const int FRAME_INTERVAL_MS = 33;  // ~30 display updates per second
+
+    const ConsoleLogBuffer& m_buffer;
+    StyleProvider m_styleProvider;
+    mutable wxTextAttr m_styleCache[LEVEL_COUNT];
+    mutable bool m_styleCached[LEVEL_COUNT];
+
+    // Row index used while a filter is active (sequence numbers in display order)
+    bool m_filtered;
+    bool m_searching;
+    std::deque<uint64_t> m_rows;      // Search results
+    std::deque<uint64_t> m_liveRows;  // Matching records appended while searching
+    uint64_t m_knownFirst;  // Buffer's first sequence at the last sync, to detect evictions
+
+    bool m_showTimestamps;
+    wxCoord m_rowHeight;
+    
+    // Work deferred to the next frame
+    wxTimer m_frameTimer;
+    bool m_syncPending;
+    bool m_refreshPending;
+    bool m_pendingFollowTail;  // Whether the view was at the bottom when the first change arrived
+    size_t m_pendingDropped;
+};
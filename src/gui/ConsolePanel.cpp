@@ -4,9 +4,11 @@
  */
 
 #include "ConsolePanel.h"
+#include "ConsoleLogView.h"
 #include "MacroConfigDialog.h"
 #include "CommunicationManager.h"
 #include "NotificationSystem.h"
+#include "core/ConfigFile.h"
 #include <wx/sizer.h>
 #include <wx/msgdlg.h>
 #include <wx/filedlg.h>
@@ -26,6 +28,8 @@ enum {
     ID_CLEAR_LOG,
     ID_SAVE_LOG,
     ID_FILTER_TEXT,
+    ID_FILTER_REGEX,
+    ID_COLLAPSE_REPEATS,
     ID_SHOW_TIMESTAMPS,
     ID_SHOW_INFO,
     ID_SHOW_WARNING,
@@ -33,13 +37,16 @@ enum {
     ID_SHOW_SENT,
     ID_SHOW_RECEIVED,
     ID_COMMAND_HISTORY,
-    ID_CONFIGURE_MACROS
+    ID_CONFIGURE_MACROS,
+    ID_SESSION_LOG_FLUSH
 };
 
 wxBEGIN_EVENT_TABLE(ConsolePanel, wxPanel)
     EVT_BUTTON(ID_SEND_COMMAND, ConsolePanel::OnSendCommand)
     EVT_TEXT_ENTER(ID_COMMAND_INPUT, ConsolePanel::OnCommandEnter)
     EVT_TEXT(ID_FILTER_TEXT, ConsolePanel::OnFilterChanged)
+    EVT_CHECKBOX(ID_FILTER_REGEX, ConsolePanel::OnFilterRegex)
+    EVT_CHECKBOX(ID_COLLAPSE_REPEATS, ConsolePanel::OnCollapseRepeats)
     EVT_CHECKBOX(ID_SHOW_TIMESTAMPS, ConsolePanel::OnShowTimestamps)
     EVT_CHECKBOX(ID_SHOW_INFO, ConsolePanel::OnShowInfo)
     EVT_CHECKBOX(ID_SHOW_WARNING, ConsolePanel::OnShowWarning)
@@ -50,19 +57,28 @@ wxBEGIN_EVENT_TABLE(ConsolePanel, wxPanel)
     EVT_LISTBOX_DCLICK(ID_COMMAND_HISTORY, ConsolePanel::OnHistoryActivated)
     EVT_BUTTON(ID_CONFIGURE_MACROS, ConsolePanel::OnConfigureMacros)
     EVT_CHAR_HOOK(ConsolePanel::OnKeyDown)
+    EVT_TIMER(ID_SESSION_LOG_FLUSH, ConsolePanel::OnSessionLogFlush)
 wxEND_EVENT_TABLE()
 
 ConsolePanel::ConsolePanel(wxWindow* parent)
-    : wxPanel(parent, wxID_ANY), m_splitter(nullptr)
+    : wxPanel(parent, wxID_ANY), m_splitter(nullptr), m_logBuffer(MAX_LOG_ENTRIES),
+      m_sessionFlushTimer(this, ID_SESSION_LOG_FLUSH)
 {
     // Initialize display settings
     m_showTimestampsFlag = true;
+    m_filterRegexFlag = false;
+    m_collapseRepeatsFlag = true;
     m_showInfoFlag = true;
     m_showWarningFlag = true;
     m_showErrorFlag = true;
     m_showSentFlag = true;
     m_showReceivedFlag = true;
     
+    // Background filtering over the history buffer
+    m_search = std::make_unique<ConsoleSearch>(m_logBuffer);
+    m_searchComplete = true;
+    m_searchGeneration = 0;
+    
     // Initialize command history navigation
     m_historyIndex = -1;
     m_historyExpanded = false;
@@ -70,14 +86,12 @@ ConsolePanel::ConsolePanel(wxWindow* parent)
     
     // Initialize session logging
     m_sessionLogActive = false;
+    m_sessionLogDirty = false;
     m_sessionMachineId = "";
     m_sessionMachineName = "";
     m_sessionStartTime = "";
     m_sessionLogPath = "";
     
-    // Initialize console display tracking
-    m_displayedEntries = 0;
-    
     CreateControls();
     LoadCommandHistory();
     
@@ -88,6 +102,9 @@ ConsolePanel::ConsolePanel(wxWindow* parent)
 
 ConsolePanel::~ConsolePanel()
 {
+    // Stop the search worker before anything it references goes away
+    m_search.reset();
+    
     // Ensure session log is properly closed on destruction
     StopSessionLog();
 }
@@ -124,7 +141,17 @@ void ConsolePanel::CreateFilterControls()
     // Filter text
     filterSizer->Add(new wxStaticText(m_filterPanel, wxID_ANY, "Filter:"), 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 5);
     m_filterText = new wxTextCtrl(m_filterPanel, ID_FILTER_TEXT, wxEmptyString, wxDefaultPosition, wxSize(150, -1));
-    filterSizer->Add(m_filterText, 0, wxRIGHT, 10);
+    filterSizer->Add(m_filterText, 0, wxRIGHT, 5);
+    
+    m_filterRegex = new wxCheckBox(m_filterPanel, ID_FILTER_REGEX, "Regex");
+    m_filterRegex->SetValue(m_filterRegexFlag);
+    m_filterRegex->SetToolTip("Treat the filter text as a regular expression");
+    filterSizer->Add(m_filterRegex, 0, wxRIGHT, 10);
+    
+    m_collapseRepeats = new wxCheckBox(m_filterPanel, ID_COLLAPSE_REPEATS, "Collapse");
+    m_collapseRepeats->SetValue(m_collapseRepeatsFlag);
+    m_collapseRepeats->SetToolTip("Collapse repeated status reports and ok acknowledgements into a single updating line");
+    filterSizer->Add(m_collapseRepeats, 0, wxRIGHT, 10);
     
     // Checkboxes for message types
     m_showTimestamps = new wxCheckBox(m_filterPanel, ID_SHOW_TIMESTAMPS, "Timestamps");
@@ -161,16 +188,12 @@ void ConsolePanel::CreateLogDisplay()
     m_logPanel = new wxPanel(this, wxID_ANY);
     wxBoxSizer* logSizer = new wxBoxSizer(wxVERTICAL);
     
-    // Log display
-    m_logDisplay = new wxTextCtrl(m_logPanel, ID_CONSOLE_LOG, wxEmptyString,
-                                 wxDefaultPosition, wxDefaultSize,
-                                 wxTE_MULTILINE | wxTE_READONLY | wxTE_RICH2 | wxHSCROLL);
-    
-    // Use monospace font for log display
-    wxFont font(9, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
-    m_logDisplay->SetFont(font);
-    m_logDisplay->SetBackgroundColour(*wxBLACK);
-    m_logDisplay->SetForegroundColour(*wxWHITE);
+    // Log display - virtual list over the history ring buffer, only visible rows are drawn
+    m_logDisplay = new ConsoleLogView(m_logPanel, ID_CONSOLE_LOG, m_logBuffer);
+    m_logDisplay->SetStyleProvider([this](ConsoleLevel level) {
+        return GetColorForLevel(level);
+    });
+    m_logDisplay->SetShowTimestamps(m_showTimestampsFlag);
     
     logSizer->Add(m_logDisplay, 1, wxEXPAND, 0);
     
@@ -217,109 +240,142 @@ void ConsolePanel::CreateCommandInterface()
     m_commandPanel->SetSizer(commandSizer);
 }
 
-std::string ConsolePanel::GetTimestamp() const
+uint32_t ConsolePanel::GetTimeOfDay() const
 {
     wxDateTime now = wxDateTime::Now();
-    return now.Format("%H:%M:%S").ToStdString();
+    return ConsoleLogBuffer::MakeTimeOfDay(now.GetHour(), now.GetMinute(), now.GetSecond());
 }
 
-void ConsolePanel::AddLogEntry(const std::string& timestamp, const std::string& level, 
-                              const std::string& message)
+void ConsolePanel::AddLogEntry(const std::string& level, const std::string& message)
 {
-    LogEntry entry;
-    entry.timestamp = timestamp;
+    // Commit anything still queued first so the history stays in arrival order
+    DrainIngestQueue();
+    CommitLogEntry(ParseConsoleLevel(level), GetTimeOfDay(), message);
+}
+
+void ConsolePanel::PostLogEntry(ConsoleLevel level, const std::string& message)
+{
+    ConsoleIngestEntry entry;
+    entry.timeOfDay = GetTimeOfDay();
     entry.level = level;
     entry.message = message;
-    entry.machineId = m_currentMachine;
     
-    m_logEntries.push_back(entry);
-    
-    // Limit log entries to prevent memory issues
-    if (m_logEntries.size() > MAX_LOG_ENTRIES) {
-        m_logEntries.pop_front();
-        // If we removed entries, we need to rebuild the display
-        m_displayedEntries = 0;
-        UpdateLogDisplay();
-    } else {
-        // Just append the new entry
-        AppendNewLogEntry(entry);
+    // Only the first entry of a batch posts an event; the rest ride along with it
+    if (m_ingestQueue.Push(std::move(entry))) {
+        CallAfter(&ConsolePanel::DrainIngestQueue);
     }
-    
-    // Write to session log if active
-    WriteToSessionLog(timestamp, level, message);
 }
 
-void ConsolePanel::UpdateLogDisplay()
+void ConsolePanel::DrainIngestQueue()
 {
-    if (!m_logDisplay) return;
+    m_ingestQueue.Drain(m_ingestBatch);
     
-    // Clear the display first
-    m_logDisplay->Clear();
-    m_displayedEntries = 0;
-    
-    for (const auto& entry : m_logEntries) {
-        if (!ShouldShowMessage(entry.level)) continue;
-        if (!FilterMessage(entry.message).empty() && !m_currentFilter.empty()) {
-            if (entry.message.find(m_currentFilter) == std::string::npos) continue;
+    // The view defers its row count update and repaint to the next frame,
+    // so the whole batch costs a single invalidate
+    for (const ConsoleIngestEntry& entry : m_ingestBatch) {
+        CommitLogEntry(entry.level, entry.timeOfDay, entry.message);
+    }
+    m_ingestBatch.clear();
+}
+
+void ConsolePanel::CommitLogEntry(ConsoleLevel consoleLevel, uint32_t timeOfDay, const std::string& message)
+{
+    ConsoleCoalescer::Kind kind = m_collapseRepeatsFlag ? ConsoleCoalescer::Classify(consoleLevel, message)
+                                                        : ConsoleCoalescer::Kind::NORMAL;
+    
+    uint64_t sequence;
+    if (m_coalescer.FindRow(kind, consoleLevel, m_logBuffer, sequence)) {
+        // Continues a run of status reports / acks - update that row in place
+        m_logBuffer.Update(sequence, timeOfDay, message, m_logBuffer.At(sequence).repeatCount + 1);
+        if (m_logDisplay) {
+            m_logDisplay->OnRecordUpdated(sequence);
         }
+    } else {
+        // Constant cost: the ring buffer overwrites the oldest entry once full
+        sequence = m_logBuffer.Append(timeOfDay, consoleLevel, m_logBuffer.Intern(m_currentMachine), message);
+        m_coalescer.OnAppended(kind, sequence);
         
-        wxString line;
-        
-        if (m_showTimestampsFlag) {
-            line += "[" + entry.timestamp + "] ";
+        if (m_logDisplay) {
+            m_logDisplay->OnRecordAppended(sequence, PassesFilter(m_logBuffer.At(sequence)));
         }
-        
-        line += "[" + entry.level + "] " + entry.message + "\n";
-        
-        // Get the color for this level and append colored text
-        wxTextAttr attr = GetColorForLevel(entry.level);
-        AppendColoredText(line, attr);
-        m_displayedEntries++;
     }
     
-    // Scroll to bottom
-    m_logDisplay->SetInsertionPointEnd();
+    // The session log always gets every raw line, collapsed or not
+    WriteToSessionLog(ConsoleLogBuffer::FormatTimeOfDay(timeOfDay), ConsoleLevelName(consoleLevel), message);
 }
 
-void ConsolePanel::AppendNewLogEntry(const LogEntry& entry)
+void ConsolePanel::UpdateLogDisplay()
 {
     if (!m_logDisplay) return;
     
-    // Check if this entry should be shown
-    if (!ShouldShowMessage(entry.level)) return;
-    if (!FilterMessage(entry.message).empty() && !m_currentFilter.empty()) {
-        if (entry.message.find(m_currentFilter) == std::string::npos) return;
+    m_logDisplay->SetShowTimestamps(m_showTimestampsFlag);
+    
+    ConsoleQuery query(m_currentFilter, m_filterRegexFlag, GetVisibleLevelMask());
+    
+    // Flag regex syntax errors and keep the previous results until it compiles
+    if (m_filterText) {
+        m_filterText->SetBackgroundColour(query.IsValid() ? wxNullColour : wxColour(255, 200, 200));
+        m_filterText->Refresh();
     }
+    if (!query.IsValid()) return;
     
-    // Format the line
-    wxString line;
+    m_activeQuery = query;
     
-    if (m_showTimestampsFlag) {
-        line += "[" + entry.timestamp + "] ";
+    if (query.IsEmpty()) {
+        m_search->Cancel();
+        m_completedQuery = query;
+        m_searchComplete = true;
+        m_logDisplay->ShowAll();
+        return;
     }
     
-    line += "[" + entry.level + "] " + entry.message + "\n";
+    // Narrowing the previous filter (typing more characters, hiding a level)
+    // only needs to re-check the rows already shown
+    std::shared_ptr<const std::vector<uint64_t>> candidates;
+    if (m_searchComplete && m_logDisplay->IsFiltered() && query.Refines(m_completedQuery)) {
+        candidates = std::make_shared<const std::vector<uint64_t>>(m_logDisplay->GetFilteredRows());
+    }
     
-    // Get the color for this level and append colored text
-    wxTextAttr attr = GetColorForLevel(entry.level);
-    AppendColoredText(line, attr);
+    m_searchComplete = false;
+    m_logDisplay->BeginResults();
     
-    m_displayedEntries++;
+    // Results stream in from the worker thread and are applied on the GUI thread
+    m_searchGeneration = m_search->Start(query, m_logBuffer.EndSequence(), candidates,
+        [this](uint64_t generation, std::vector<uint64_t> matches, bool finished) {
+            CallAfter([this, generation, matches, finished]() {
+                OnSearchResults(generation, matches, finished);
+            });
+        });
 }
 
-bool ConsolePanel::ShouldShowMessage(const std::string& level) const
+void ConsolePanel::OnSearchResults(uint64_t generation, const std::vector<uint64_t>& matches, bool finished)
 {
-    if (level == "INFO" && !m_showInfoFlag) return false;
-    if (level == "WARN" && !m_showWarningFlag) return false;
-    if (level == "ERROR" && !m_showErrorFlag) return false;
-    if (level == "SENT" && !m_showSentFlag) return false;
-    if (level == "RECV" && !m_showReceivedFlag) return false;
-    return true;
+    // Ignore batches from searches that were superseded
+    if (generation != m_searchGeneration || !m_logDisplay) return;
+    
+    m_logDisplay->AppendResults(matches);
+    
+    if (finished) {
+        m_logDisplay->EndResults();
+        m_completedQuery = m_activeQuery;
+        m_searchComplete = true;
+    }
 }
 
-std::string ConsolePanel::FilterMessage(const std::string& message) const
+ConsoleLevelMask ConsolePanel::GetVisibleLevelMask() const
 {
-    return message; // Simple pass-through for now
+    ConsoleLevelMask mask = CONSOLE_ALL_LEVELS;
+    if (!m_showInfoFlag) mask &= ~ConsoleLevelBit(ConsoleLevel::LEVEL_INFO);
+    if (!m_showWarningFlag) mask &= ~ConsoleLevelBit(ConsoleLevel::LEVEL_WARN);
+    if (!m_showErrorFlag) mask &= ~ConsoleLevelBit(ConsoleLevel::LEVEL_ERROR);
+    if (!m_showSentFlag) mask &= ~ConsoleLevelBit(ConsoleLevel::LEVEL_SENT);
+    if (!m_showReceivedFlag) mask &= ~ConsoleLevelBit(ConsoleLevel::LEVEL_RECV);
+    return mask;
+}
+
+bool ConsolePanel::PassesFilter(const ConsoleLogRecord& record) const
+{
+    return m_activeQuery.Matches(record);
 }
 
 void ConsolePanel::LoadCommandHistory()
@@ -364,34 +420,49 @@ void ConsolePanel::AddToHistory(const std::string& command)
 // Public interface methods
 void ConsolePanel::LogMessage(const std::string& message, const std::string& level)
 {
-    AddLogEntry(GetTimestamp(), level, message);
+    AddLogEntry(level, message);
 }
 
 void ConsolePanel::LogSentCommand(const std::string& command)
 {
-    AddLogEntry(GetTimestamp(), "SENT", "> " + command);
+    AddLogEntry("SENT", "> " + command);
 }
 
 void ConsolePanel::LogReceivedResponse(const std::string& response)
 {
-    AddLogEntry(GetTimestamp(), "RECV", "< " + response);
+    AddLogEntry("RECV", "< " + response);
+}
+
+void ConsolePanel::PostSentCommand(const std::string& command)
+{
+    PostLogEntry(ConsoleLevel::LEVEL_SENT, "> " + command);
+}
+
+void ConsolePanel::PostReceivedResponse(const std::string& response)
+{
+    PostLogEntry(ConsoleLevel::LEVEL_RECV, "< " + response);
 }
 
 void ConsolePanel::LogError(const std::string& error)
 {
-    AddLogEntry(GetTimestamp(), "ERROR", error);
+    AddLogEntry("ERROR", error);
 }
 
 void ConsolePanel::LogWarning(const std::string& warning)
 {
-    AddLogEntry(GetTimestamp(), "WARN", warning);
+    AddLogEntry("WARN", warning);
 }
 
 void ConsolePanel::ClearLog()
 {
-    m_logEntries.clear();
-    m_displayedEntries = 0;
-    UpdateLogDisplay();
+    m_search->Cancel();
+    m_logBuffer.Clear();
+    m_coalescer.Reset();
+    if (m_logDisplay) {
+        m_logDisplay->Reset();
+    }
+    m_completedQuery = m_activeQuery;
+    m_searchComplete = true;
 }
 
 void ConsolePanel::SaveLog()
@@ -403,7 +474,7 @@ void ConsolePanel::SaveLog()
     if (dialog.ShowModal() == wxID_OK) {
         NotificationSystem::Instance().ShowInfo(
             "Save Log",
-            wxString::Format("Would save log to: %s (%zu entries)", dialog.GetPath(), m_logEntries.size())
+            wxString::Format("Would save log to: %s (%zu entries)", dialog.GetPath(), m_logBuffer.Size())
         );
     }
 }
@@ -436,16 +507,27 @@ void ConsolePanel::SetShowTimestamps(bool show)
     if (m_showTimestamps) {
         m_showTimestamps->SetValue(show);
     }
-    UpdateLogDisplay();
+    // Timestamps only change how rows are drawn, not which rows are shown
+    if (m_logDisplay) {
+        m_logDisplay->SetShowTimestamps(show);
+    }
 }
 
 void ConsolePanel::SetShowLevel(const std::string& level, bool show)
 {
-    if (level == "INFO") m_showInfoFlag = show;
-    else if (level == "WARN") m_showWarningFlag = show;
-    else if (level == "ERROR") m_showErrorFlag = show;
-    else if (level == "SENT") m_showSentFlag = show;
-    else if (level == "RECV") m_showReceivedFlag = show;
+    SetShowLevel(ParseConsoleLevel(level), show);
+}
+
+void ConsolePanel::SetShowLevel(ConsoleLevel level, bool show)
+{
+    switch (level) {
+        case ConsoleLevel::LEVEL_INFO:  m_showInfoFlag = show; break;
+        case ConsoleLevel::LEVEL_WARN:  m_showWarningFlag = show; break;
+        case ConsoleLevel::LEVEL_ERROR: m_showErrorFlag = show; break;
+        case ConsoleLevel::LEVEL_SENT:  m_showSentFlag = show; break;
+        case ConsoleLevel::LEVEL_RECV:  m_showReceivedFlag = show; break;
+        default: return;
+    }
     
     UpdateLogDisplay();
 }
@@ -521,10 +603,24 @@ void ConsolePanel::OnFilterChanged(wxCommandEvent& WXUNUSED(event))
     UpdateLogDisplay();
 }
 
+void ConsolePanel::OnFilterRegex(wxCommandEvent& WXUNUSED(event))
+{
+    m_filterRegexFlag = m_filterRegex->GetValue();
+    UpdateLogDisplay();
+}
+
+void ConsolePanel::OnCollapseRepeats(wxCommandEvent& WXUNUSED(event))
+{
+    m_collapseRepeatsFlag = m_collapseRepeats->GetValue();
+    m_coalescer.Reset();
+}
+
 void ConsolePanel::OnShowTimestamps(wxCommandEvent& WXUNUSED(event))
 {
     m_showTimestampsFlag = m_showTimestamps->GetValue();
-    UpdateLogDisplay();
+    if (m_logDisplay) {
+        m_logDisplay->SetShowTimestamps(m_showTimestampsFlag);
+    }
 }
 
 void ConsolePanel::OnShowInfo(wxCommandEvent& WXUNUSED(event))
@@ -873,6 +969,8 @@ void ConsolePanel::StopSessionLog()
         LogMessage("Session log stopped and saved: " + m_sessionLogPath, "INFO");
         
         m_sessionLogActive = false;
+        m_sessionLogDirty = false;
+        m_sessionFlushTimer.Stop();
         m_sessionLogPath.clear();
         m_sessionMachineId.clear();
         m_sessionMachineName.clear();
@@ -885,8 +983,21 @@ void ConsolePanel::WriteToSessionLog(const std::string& timestamp, const std::st
     if (m_sessionLogActive && m_sessionLogFile.is_open()) {
         std::string logLine = "[" + timestamp + "] [" + level + "] " + message + "\n";
         m_sessionLogFile << logLine;
-        m_sessionLogFile.flush(); // Ensure immediate write for real-time logging
+        
+        // Flushing every line costs a syscall per status report; flush on a timer instead
+        if (!m_sessionLogDirty) {
+            m_sessionLogDirty = true;
+            m_sessionFlushTimer.StartOnce(SESSION_LOG_FLUSH_MS);
+        }
+    }
+}
+
+void ConsolePanel::OnSessionLogFlush(wxTimerEvent& WXUNUSED(event))
+{
+    if (m_sessionLogActive && m_sessionLogFile.is_open()) {
+        m_sessionLogFile.flush();
     }
+    m_sessionLogDirty = false;
 }
 
 std::string ConsolePanel::GetSessionLogPath(const std::string& machineName, const std::string& timestamp) const
@@ -915,7 +1026,7 @@ std::string ConsolePanel::GetSessionLogPath(const std::string& machineName, cons
 }
 
 // Color management for log display
-wxTextAttr ConsolePanel::GetColorForLevel(const std::string& level) const
+wxTextAttr ConsolePanel::GetColorForLevel(ConsoleLevel level) const
 {
     wxTextAttr attr;
     
@@ -923,17 +1034,17 @@ wxTextAttr ConsolePanel::GetColorForLevel(const std::string& level) const
     int baseFontSize = 9;
     wxFontWeight fontWeight = wxFONTWEIGHT_NORMAL;
     
-    if (level == "ERROR") {
+    if (level == ConsoleLevel::LEVEL_ERROR) {
         attr.SetTextColour(wxColour(255, 85, 85));  // Light red
-    } else if (level == "WARN") {
+    } else if (level == ConsoleLevel::LEVEL_WARN) {
         attr.SetTextColour(wxColour(255, 215, 0));  // Gold/Yellow
-    } else if (level == "INFO") {
+    } else if (level == ConsoleLevel::LEVEL_INFO) {
         attr.SetTextColour(wxColour(135, 206, 235)); // Sky blue
-    } else if (level == "SENT") {
+    } else if (level == ConsoleLevel::LEVEL_SENT) {
         attr.SetTextColour(*wxWHITE); // White
         fontWeight = wxFONTWEIGHT_BOLD; // Bold weight
         baseFontSize = 10; // Slightly larger for better visibility
-    } else if (level == "RECV") {
+    } else if (level == ConsoleLevel::LEVEL_RECV) {
         attr.SetTextColour(wxColour(144, 238, 144)); // Light green for better distinction from SENT
         fontWeight = wxFONTWEIGHT_BOLD; // Bold weight
         baseFontSize = 10; // Slightly larger for better visibility
@@ -948,21 +1059,6 @@ wxTextAttr ConsolePanel::GetColorForLevel(const std::string& level) const
     return attr;
 }
 
-void ConsolePanel::AppendColoredText(const wxString& text, const wxTextAttr& attr)
-{
-    if (!m_logDisplay) return;
-    
-    // Set insertion point to the end
-    m_logDisplay->SetInsertionPointEnd();
-    
-    // Apply the text attribute and append the text
-    m_logDisplay->SetDefaultStyle(attr);
-    m_logDisplay->AppendText(text);
-    
-    // Scroll to bottom
-    m_logDisplay->SetInsertionPointEnd();
-}
-
 // Macro button implementation
 void ConsolePanel::CreateMacroButtons()
 {
@@ -1290,30 +1386,13 @@ bool ConsolePanel::LoadMacroConfiguration(std::vector<MacroDefinition>& macros)
 {
     std::string configPath = GetMacroConfigPath();
     
-    // Check if configuration file exists
-    if (!wxFileExists(configPath)) {
-        return false; // No configuration file exists
-    }
-    
     try {
-        // Read the configuration file
-        std::ifstream configFile(configPath);
-        if (!configFile.is_open()) {
-            return false;
-        }
-        
-        // Parse JSON
+        // Read macros.json or its binary copy - see ConfigFile::load
         nlohmann::json root;
-        
-        try {
-            configFile >> root;
-        } catch (const std::exception& e) {
-            configFile.close();
-            return false;
+        if (!ConfigFile::load(configPath, root)) {
+            return false; // No configuration file exists or it cannot be parsed
         }
         
-        configFile.close();
-        
         // Check if it's a valid macro configuration
         if (!root.is_object() || !root.contains("macros") || !root["macros"].is_array()) {
             return false;
@@ -1371,15 +1450,8 @@ bool ConsolePanel::SaveMacroConfiguration(const std::vector<MacroDefinition>& ma
         
         root["macros"] = macroArray;
         
-        // Write to file with pretty formatting
-        std::ofstream configFile(configPath);
-        if (!configFile.is_open()) {
-            return false;
-        }
-        
-        configFile << root.dump(2); // Pretty print with 2-space indentation
-        configFile.close();
-        return true;
+        // Saved rarely and edited by hand - keep the JSON copy current too
+        return ConfigFile::save(configPath, root, nullptr, true);
         
     } catch (const std::exception& e) {
         // JSON creation or file I/O error
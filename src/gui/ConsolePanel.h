@@ -10,21 +10,19 @@
 #include <wx/textctrl.h>
 #include <wx/listbox.h>
 #include <wx/splitter.h>
+#include <wx/timer.h>
 #include <vector>
 #include <string>
-#include <deque>
 #include <fstream>
+#include <memory>
+#include "core/ConsoleLogBuffer.h"
+#include "core/ConsoleSearch.h"
+#include "core/ConsoleCoalescer.h"
+#include "core/ConsoleIngestQueue.h"
 
 // Forward declarations
 struct MacroDefinition;
-
-// Log entry structure
-struct LogEntry {
-    std::string timestamp;
-    std::string level;
-    std::string message;
-    std::string machineId;
-};
+class ConsoleLogView;
 
 /**
  * Terminal Panel - real-time machine communication interface
@@ -53,6 +51,11 @@ public:
     void LogError(const std::string& error);
     void LogWarning(const std::string& warning);
     
+    // Thread-safe variants for the communication threads: entries are queued and
+    // committed in one batch on the GUI thread
+    void PostSentCommand(const std::string& command);
+    void PostReceivedResponse(const std::string& response);
+    
     // Console operations
     void ClearLog();
     void SaveLog();
@@ -62,6 +65,7 @@ public:
     void SetFilter(const std::string& filter);
     void SetShowTimestamps(bool show);
     void SetShowLevel(const std::string& level, bool show);
+    void SetShowLevel(ConsoleLevel level, bool show);
     
     // Connection status
     void SetConnectionEnabled(bool connected, const std::string& machineName = "");
@@ -80,6 +84,8 @@ private:
     void OnSendCommand(wxCommandEvent& event);
     void OnCommandEnter(wxCommandEvent& event);
     void OnFilterChanged(wxCommandEvent& event);
+    void OnFilterRegex(wxCommandEvent& event);
+    void OnCollapseRepeats(wxCommandEvent& event);
     void OnShowTimestamps(wxCommandEvent& event);
     void OnShowInfo(wxCommandEvent& event);
     void OnShowWarning(wxCommandEvent& event);
@@ -89,6 +95,7 @@ private:
     void OnHistorySelected(wxCommandEvent& event);
     void OnHistoryActivated(wxCommandEvent& event);
     void OnKeyDown(wxKeyEvent& event);
+    void OnSessionLogFlush(wxTimerEvent& event);
     
     // Macro button event handlers
     void OnMacroButton(wxCommandEvent& event);
@@ -102,25 +109,26 @@ private:
     void CreateMacroButtons();
     
     // Color management
-    wxTextAttr GetColorForLevel(const std::string& level) const;
-    void AppendColoredText(const wxString& text, const wxTextAttr& attr);
+    wxTextAttr GetColorForLevel(ConsoleLevel level) const;
     
     // Log management
     void UpdateLogDisplay();
-    void AppendNewLogEntry(const LogEntry& entry);
-    void AddLogEntry(const std::string& timestamp, const std::string& level, 
-                    const std::string& message);
+    void AddLogEntry(const std::string& level, const std::string& message);
+    void CommitLogEntry(ConsoleLevel level, uint32_t timeOfDay, const std::string& message);
+    void PostLogEntry(ConsoleLevel level, const std::string& message);
+    void DrainIngestQueue();
     void LoadCommandHistory();
     void SaveCommandHistory();
     void AddToHistory(const std::string& command);
-    std::string GetTimestamp() const;
+    uint32_t GetTimeOfDay() const;
     
     // Command history navigation
     void ShowCommandHistory(bool show);
     
-    // Message filtering
-    bool ShouldShowMessage(const std::string& level) const;
-    std::string FilterMessage(const std::string& message) const;
+    // Message filtering (runs on the background search worker)
+    ConsoleLevelMask GetVisibleLevelMask() const;
+    bool PassesFilter(const ConsoleLogRecord& record) const;
+    void OnSearchResults(uint64_t generation, const std::vector<uint64_t>& matches, bool finished);
     
     // Special character processing for terminal functionality
     std::string ProcessSpecialCharacters(const std::string& input) const;
@@ -150,9 +158,11 @@ private:
     
     // Log display panel
     wxPanel* m_logPanel;
-    wxTextCtrl* m_logDisplay;
+    ConsoleLogView* m_logDisplay;
     wxPanel* m_filterPanel;
     wxTextCtrl* m_filterText;
+    wxCheckBox* m_filterRegex;
+    wxCheckBox* m_collapseRepeats;
     wxCheckBox* m_showTimestamps;
     wxCheckBox* m_showInfo;
     wxCheckBox* m_showWarning;
@@ -171,7 +181,15 @@ private:
     wxButton* m_configureMacrosBtn;
     
     // Data
-    std::deque<LogEntry> m_logEntries;
+    ConsoleLogBuffer m_logBuffer;
+    std::unique_ptr<ConsoleSearch> m_search;  // Must be destroyed before m_logBuffer
+    ConsoleCoalescer m_coalescer;     // Collapses status reports and ok acks
+    ConsoleIngestQueue m_ingestQueue; // Entries posted from other threads
+    std::vector<ConsoleIngestEntry> m_ingestBatch;
+    ConsoleQuery m_activeQuery;       // Filter currently applied to the display
+    ConsoleQuery m_completedQuery;    // Filter whose results are fully displayed
+    bool m_searchComplete;
+    uint64_t m_searchGeneration;
     std::vector<std::string> m_commandHistoryData;
     std::string m_currentMachine;
     std::string m_activeMachine;  // Currently active machine for sending commands
@@ -180,6 +198,8 @@ private:
     
     // Display settings
     bool m_showTimestampsFlag;
+    bool m_filterRegexFlag;
+    bool m_collapseRepeatsFlag;
     bool m_showInfoFlag;
     bool m_showWarningFlag;
     bool m_showErrorFlag;
@@ -198,17 +218,17 @@ private:
     std::string m_sessionMachineName;
     std::string m_sessionStartTime;
     bool m_sessionLogActive;
+    bool m_sessionLogDirty;       // Lines written since the last flush
+    wxTimer m_sessionFlushTimer;
     
     // Macro buttons
     std::vector<MacroButton> m_macroButtons;
     static const int MACRO_BUTTON_BASE_ID = 5000;
     
-    // Console display tracking
-    size_t m_displayedEntries;
-    
     // Limits
-    static const size_t MAX_LOG_ENTRIES = 1000;
+    static const size_t MAX_LOG_ENTRIES = ConsoleLogBuffer::DEFAULT_CAPACITY;
     static const size_t MAX_COMMAND_HISTORY = 50;
+    static const int SESSION_LOG_FLUSH_MS = 1000;
     
     wxDECLARE_EVENT_TABLE();
 };
@@ -5,14 +5,33 @@
 
 #include "GCodeEditor.h"
 #include "core/SimpleLogger.h"
+#include "core/GCodeLexer.h"
+#include "core/AtomicFile.h"
 #include "NotificationSystem.h"
+#include "LargeFileView.h"
+#include "GCodeTransformDialog.h"
 #include <wx/sizer.h>
 #include <wx/msgdlg.h>
 #include <wx/filedlg.h>
 #include <wx/notebook.h>
-#include <wx/tokenzr.h>
 #include <wx/filename.h>
 #include <wx/textfile.h>
+#include <wx/numdlg.h>
+#include <wx/textdlg.h>
+#include <wx/progdlg.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <filesystem>
+#include <future>
+
+namespace {
+
+// Thrown from the transform's progress callback when the user cancels
+struct TransformCancelled {};
+
+} // namespace
 
 // File drop target for drag and drop support
 class GCodeFileDropTarget : public wxFileDropTarget
@@ -46,6 +65,36 @@ private:
     GCodeEditor* m_parent;
 };
 
+// Virtual list of search hits; rows are read from the editor when painted, so
+// any number of hits costs one vector of line numbers
+class SearchResultsList : public wxListCtrl
+{
+public:
+    SearchResultsList(wxWindow* parent, wxWindowID id, GCodeEditor* editor, const std::vector<size_t>* hits)
+        : wxListCtrl(parent, id, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_VIRTUAL | wxLC_SINGLE_SEL)
+        , m_editor(editor), m_hits(hits)
+    {
+        AppendColumn("Line", wxLIST_FORMAT_LEFT, 70);
+        AppendColumn("Text", wxLIST_FORMAT_LEFT, 300);
+    }
+    
+protected:
+    wxString OnGetItemText(long item, long column) const override
+    {
+        if (item < 0 || static_cast<size_t>(item) >= m_hits->size()) return wxEmptyString;
+        
+        size_t line = (*m_hits)[item];
+        if (column == 0) {
+            return wxString::Format("%zu", line + 1);
+        }
+        return wxString::FromUTF8(m_editor->GetLineText(line));
+    }
+    
+private:
+    GCodeEditor* m_editor;
+    const std::vector<size_t>* m_hits;
+};
+
 // Control IDs
 enum {
     ID_EDITOR = wxID_HIGHEST + 3000,
@@ -66,7 +115,11 @@ enum {
     ID_VALIDATE_CODE,
     ID_ANALYZE_JOB,
     ID_STATISTICS_LIST,
-    ID_ISSUES_LIST
+    ID_ISSUES_LIST,
+    ID_ANALYSIS_TIMER,
+    ID_LARGE_FILE_VIEW,
+    ID_SEARCH_LIST,
+    ID_TRANSFORM
 };
 
 wxBEGIN_EVENT_TABLE(GCodeEditor, wxPanel)
@@ -77,13 +130,29 @@ wxBEGIN_EVENT_TABLE(GCodeEditor, wxPanel)
     EVT_BUTTON(ID_ANALYZE_JOB, GCodeEditor::OnValidateCode)
     EVT_BUTTON(ID_SEND_TO_MACHINE, GCodeEditor::OnSendToMachine)
     EVT_BUTTON(ID_VALIDATE_CODE, GCodeEditor::OnValidateCode)
+    EVT_BUTTON(ID_FIND, GCodeEditor::OnFind)
+    EVT_BUTTON(ID_GOTO, GCodeEditor::OnGoto)
+    EVT_BUTTON(ID_TRANSFORM, GCodeEditor::OnTransform)
+    EVT_LISTBOX(ID_LARGE_FILE_VIEW, GCodeEditor::OnLargeViewSelect)
+    EVT_LIST_ITEM_ACTIVATED(ID_SEARCH_LIST, GCodeEditor::OnSearchHitActivated)
     EVT_STC_CHANGE(ID_EDITOR, GCodeEditor::OnTextChanged)
+    EVT_STC_STYLENEEDED(ID_EDITOR, GCodeEditor::OnStyleNeeded)
+    EVT_STC_UPDATEUI(ID_EDITOR, GCodeEditor::OnUpdateUI)
+    EVT_TIMER(ID_ANALYSIS_TIMER, GCodeEditor::OnAnalysisTimer)
 wxEND_EVENT_TABLE()
 
 GCodeEditor::GCodeEditor(wxWindow* parent)
     : wxPanel(parent, wxID_ANY), m_splitter(nullptr), m_editor(nullptr), 
-      m_modified(false)
+      m_jobNotebook(nullptr), m_searchList(nullptr), m_searchPage(wxNOT_FOUND),
+      m_modified(false), m_analysisGeneration(0), m_analysisTimer(this, ID_ANALYSIS_TIMER),
+      m_textChangePending(false), m_largeView(nullptr), m_largeFileMode(false),
+      m_selectedLine(0), m_searchGeneration(0), m_searchRunning(false)
 {
+    m_analyzer = std::make_unique<GCodeAnalyzer>([this](std::shared_ptr<const GCodeAnalysis> analysis) {
+        CallAfter([this, analysis]() { ApplyAnalysis(analysis); });
+    });
+    m_search = std::make_unique<GCodeSearch>();
+    
     CreateControls();
     
     // Start with empty document
@@ -91,6 +160,14 @@ GCodeEditor::GCodeEditor(wxWindow* parent)
     UpdateJobStatistics();
 }
 
+GCodeEditor::~GCodeEditor()
+{
+    m_analysisTimer.Stop();
+    // Joins the workers before any member they call back into goes away
+    m_search.reset();
+    m_analyzer.reset();
+}
+
 void GCodeEditor::CreateControls()
 {
     wxBoxSizer* mainSizer = new wxBoxSizer(wxVERTICAL);
@@ -134,7 +211,17 @@ void GCodeEditor::CreateToolbar()
         toolbarSizer->Add(openBtn, 0, wxRIGHT, 2);
         toolbarSizer->Add(saveBtn, 0, wxRIGHT, 10);
         
+        // Navigation
+        wxButton* findBtn = new wxButton(m_toolbar, ID_FIND, "Find", wxDefaultPosition, wxSize(60, -1));
+        wxButton* gotoBtn = new wxButton(m_toolbar, ID_GOTO, "Go To", wxDefaultPosition, wxSize(60, -1));
+        
+        toolbarSizer->Add(findBtn, 0, wxRIGHT, 2);
+        toolbarSizer->Add(gotoBtn, 0, wxRIGHT, 10);
+        
         // G-code operations
+        wxButton* transformBtn = new wxButton(m_toolbar, ID_TRANSFORM, "Transform", wxDefaultPosition, wxSize(80, -1));
+        toolbarSizer->Add(transformBtn, 0, wxRIGHT, 2);
+        
         wxButton* validateBtn = new wxButton(m_toolbar, ID_VALIDATE_CODE, "Validate", wxDefaultPosition, wxSize(80, -1));
         wxButton* sendBtn = new wxButton(m_toolbar, ID_SEND_TO_MACHINE, "Send to Machine", wxDefaultPosition, wxSize(120, -1));
         
@@ -170,8 +257,19 @@ void GCodeEditor::CreateEditor()
     
     // Enable drag and drop for files
     m_editor->SetDropTarget(new GCodeFileDropTarget(this));
+    
+    // Shown in place of the editor while a large file is open
+    m_largeView = new LargeFileView(m_editorPanel, ID_LARGE_FILE_VIEW);
+    for (int style = 0; style < GCodeLexer::STYLE_COUNT; style++) {
+        wxColour background = m_editor->StyleGetBackground(style);
+        m_largeView->SetStyleColours(style, m_editor->StyleGetForeground(style),
+                                     background == m_editor->StyleGetBackground(wxSTC_STYLE_DEFAULT) ? wxNullColour : background);
+    }
+    m_largeView->SetDropTarget(new GCodeFileDropTarget(this));
+    m_largeView->Hide();
 
     editorSizer->Add(m_editor, 1, wxALL | wxEXPAND, 0);
+    editorSizer->Add(m_largeView, 1, wxALL | wxEXPAND, 0);
     m_editorPanel->SetSizerAndFit(editorSizer);
 }
 
@@ -187,6 +285,7 @@ void GCodeEditor::CreateJobPanel()
     
     // Create notebook for tabs
     wxNotebook* notebook = new wxNotebook(m_jobPanel, wxID_ANY);
+    m_jobNotebook = notebook;
     
     // Statistics tab
     wxPanel* statsPanel = new wxPanel(notebook, wxID_ANY);
@@ -215,6 +314,17 @@ void GCodeEditor::CreateJobPanel()
     issuesPanel->SetSizer(issuesSizer);
     notebook->AddPage(issuesPanel, "Issues");
     
+    // Search tab
+    wxPanel* searchPanel = new wxPanel(notebook, wxID_ANY);
+    wxBoxSizer* searchSizer = new wxBoxSizer(wxVERTICAL);
+    
+    m_searchList = new SearchResultsList(searchPanel, ID_SEARCH_LIST, this, &m_searchHits);
+    
+    searchSizer->Add(m_searchList, 1, wxALL | wxEXPAND, 5);
+    searchPanel->SetSizer(searchSizer);
+    notebook->AddPage(searchPanel, "Search");
+    m_searchPage = static_cast<int>(notebook->GetPageCount()) - 1;
+    
     jobSizer->Add(notebook, 1, wxALL | wxEXPAND, 5);
     
     // Action buttons
@@ -236,6 +346,10 @@ void GCodeEditor::CreateJobPanel()
 
 void GCodeEditor::SetText(const std::string& text)
 {
+    if (m_largeFileMode) {
+        CloseLargeFile();
+    }
+    ClearSearch();
     if (m_editor) {
         m_editor->SetText(wxString::FromUTF8(text));
         m_editor->EmptyUndoBuffer();
@@ -266,69 +380,407 @@ bool GCodeEditor::IsModified() const
     return false;
 }
 
-void GCodeEditor::UpdateJobStatistics()
+void GCodeEditor::GotoLine(int line)
+{
+    if (line < 1) return;
+    
+    if (m_largeFileMode) {
+        m_largeView->GotoLine(static_cast<size_t>(line - 1));
+        NotifyLineSelected(line);
+    } else if (m_editor) {
+        m_editor->GotoLine(line - 1);
+        m_editor->EnsureCaretVisible();
+        m_editor->SetFocus();
+    }
+}
+
+bool GCodeEditor::FindNext(const wxString& text, bool forward, bool matchCase)
 {
-    // Clear existing statistics
-    m_statisticsList->DeleteAllItems();
-    m_issuesList->DeleteAllItems();
+    if (text.IsEmpty()) return false;
     
-    std::string text = GetText();
+    if (m_largeFileMode) {
+        // Search the mapping directly, starting next to the selected row
+        int selection = m_largeView->GetSelection();
+        size_t current = selection == wxNOT_FOUND ? 0 : static_cast<size_t>(selection);
+        size_t from = forward ? (selection == wxNOT_FOUND ? 0 : current + 1) : current;
+        size_t line = m_largeFile->Find(text.ToStdString(wxConvUTF8), from, forward, matchCase);
+        if (line == MappedGCodeFile::npos) return false;
+        
+        GotoLine(static_cast<int>(line) + 1);
+        return true;
+    }
+    
+    if (!m_editor) return false;
+    
+    int flags = matchCase ? wxSTC_FIND_MATCHCASE : 0;
+    int length = m_editor->GetLength();
+    int start = forward ? m_editor->GetSelectionEnd() : m_editor->GetSelectionStart();
     
-    // Simple analysis
-    int totalLines = 0;
-    int codeLines = 0;
-    int commentLines = 0;
-    int emptyLines = 0;
+    m_editor->SetSearchFlags(flags);
+    m_editor->SetTargetStart(start);
+    m_editor->SetTargetEnd(forward ? length : 0);
+    int found = m_editor->SearchInTarget(text);
+    if (found < 0) {
+        // Wrap around
+        m_editor->SetTargetStart(forward ? 0 : length);
+        m_editor->SetTargetEnd(start);
+        found = m_editor->SearchInTarget(text);
+    }
+    if (found < 0) return false;
+    
+    m_editor->SetSelection(m_editor->GetTargetStart(), m_editor->GetTargetEnd());
+    m_editor->EnsureCaretVisible();
+    return true;
+}
+
+size_t GCodeEditor::GetLineCount() const
+{
+    if (m_largeFileMode) {
+        return m_largeFile->GetLineCount();
+    }
+    return m_editor ? static_cast<size_t>(m_editor->GetLineCount()) : 0;
+}
+
+std::string GCodeEditor::GetLineText(size_t line) const
+{
+    if (m_largeFileMode) {
+        return std::string(m_largeFile->GetLine(line));
+    }
+    if (!m_editor || line >= static_cast<size_t>(m_editor->GetLineCount())) return "";
     
-    wxStringTokenizer tokenizer(wxString::FromUTF8(text), "\n");
-    while (tokenizer.HasMoreTokens()) {
-        wxString line = tokenizer.GetNextToken().Trim();
-        totalLines++;
+    std::string text = m_editor->GetLine(static_cast<int>(line)).ToStdString(wxConvUTF8);
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) {
+        text.pop_back();
+    }
+    return text;
+}
+
+bool GCodeEditor::OpenLargeFile(const wxString& filename)
+{
+    // A new mapping each time - a search may still be reading the previous one
+    auto file = std::make_shared<MappedGCodeFile>();
+    std::string error;
+    if (!file->Open(filename.ToStdString(wxConvUTF8), &error)) {
+        LOG_ERROR("GCodeEditor::OpenLargeFile - " + error + ": " + filename.ToStdString());
+        return false;
+    }
+    
+    ClearSearch();
+    m_largeFile = file;
+    m_sourceText.reset();
+    
+    // Stop analysing and drop the editor document before switching views so
+    // the old text is not kept alongside the mapping
+    m_largeFileMode = true;
+    m_analysisTimer.Stop();
+    m_textChangePending = false;
+    m_analyzer->Cancel();
+    m_editor->ClearAll();
+    m_editor->EmptyUndoBuffer();
+    m_editor->SetSavePoint();
+    m_editor->Hide();
+    
+    m_largeView->SetFile(m_largeFile.get());
+    m_largeView->Show();
+    m_editorPanel->Layout();
+    
+    m_selectedLine = 0;
+    ShowLargeFileStatistics();
+    
+    if (m_mappedFileCallback) {
+        m_mappedFileCallback(m_largeFile);
+    }
+    
+    LOG_INFO(wxString::Format("GCodeEditor::OpenLargeFile - %zu lines, %zu bytes mapped, %zu bytes of line index",
+                              m_largeFile->GetLineCount(), m_largeFile->GetSize(), m_largeFile->GetIndexBytes()).ToStdString());
+    return true;
+}
+
+void GCodeEditor::CloseLargeFile()
+{
+    if (!m_largeFileMode) return;
+    
+    ClearSearch();
+    m_largeView->SetFile(nullptr);
+    m_largeView->Hide();
+    m_largeFile.reset();
+    m_largeFileMode = false;
+    
+    m_editor->Show();
+    m_editorPanel->Layout();
+}
+
+void GCodeEditor::ShowLargeFileStatistics()
+{
+    // The full analysis would parse the whole file on every open; show what
+    // the line index already knows
+    m_analysis.reset();
+    
+    std::vector<std::vector<wxString>> rows = {
+        {"Total Lines", wxString::Format("%zu", m_largeFile->GetLineCount())},
+        {"File Size", wxString::Format("%zu bytes", m_largeFile->GetSize())},
+        {"Line Index", wxString::Format("%zu KB", m_largeFile->GetIndexBytes() / 1024)},
+        {"Mode", "Large file (read-only)"},
+    };
+    
+    m_statisticsList->Freeze();
+    for (size_t i = 0; i < rows.size(); i++) {
+        SetListRow(m_statisticsList, static_cast<long>(i), rows[i]);
+    }
+    TrimListRows(m_statisticsList, static_cast<long>(rows.size()));
+    m_statisticsList->Thaw();
+    
+    m_issuesList->Freeze();
+    SetListRow(m_issuesList, 0, {"Info", "-", "Large file opened read-only without loading it into the editor"});
+    TrimListRows(m_issuesList, 1);
+    m_issuesList->Thaw();
+}
+
+void GCodeEditor::NotifyLineSelected(int line)
+{
+    if (line == m_selectedLine) return;
+    m_selectedLine = line;
+    
+    if (m_lineSelectCallback) {
+        m_lineSelectCallback(line);
+    }
+}
+
+void GCodeEditor::StartSearch(const wxString& text, bool matchCase)
+{
+    GCodeQuery query(text.ToStdString(wxConvUTF8), matchCase);
+    if (query.IsEmpty()) return;
+    
+    ClearSearch();
+    m_lastSearch = text;
+    
+    // The search reads the same buffer the rest of the program uses: the
+    // mapping in large-file mode, otherwise the analysis snapshot (taken now
+    // if edits are still waiting for the debounce)
+    const char* data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<const void> owner;
+    if (m_largeFileMode) {
+        data = m_largeFile->GetData();
+        size = m_largeFile->GetSize();
+        owner = m_largeFile;
+    } else {
+        if (m_textChangePending || !m_sourceText) {
+            UpdateJobStatistics();
+        }
+        data = m_sourceText->data();
+        size = m_sourceText->size();
+        owner = m_sourceText;
+    }
+    
+    m_searchRunning = true;
+    m_searchGeneration = m_search->Start(query, data, size, owner,
+        [this](uint64_t generation, std::vector<size_t> lines, bool finished) {
+            CallAfter([this, generation, lines = std::move(lines), finished]() mutable {
+                OnSearchResults(generation, std::move(lines), finished);
+            });
+        });
+    UpdateSearchTab();
+}
+
+void GCodeEditor::ClearSearch()
+{
+    if (m_search) {
+        m_search->Cancel();
+    }
+    m_searchGeneration = 0;
+    m_searchRunning = false;
+    m_searchHits.clear();
+    
+    if (m_editor) {
+        m_editor->MarkerDeleteAll(MARKER_SEARCH_HIT);
+    }
+    if (m_largeView) {
+        m_largeView->SetMarkedLines(nullptr);
+    }
+    if (m_searchList) {
+        m_searchList->SetItemCount(0);
+        m_searchList->Refresh();
+        UpdateSearchTab();
+    }
+}
+
+void GCodeEditor::OnSearchResults(uint64_t generation, std::vector<size_t> lines, bool finished)
+{
+    // Results of cancelled or superseded searches are dropped
+    if (generation != m_searchGeneration) return;
+    
+    if (!lines.empty()) {
+        size_t first = m_searchHits.size();
+        m_searchHits.insert(m_searchHits.end(), lines.begin(), lines.end());
         
-        if (line.IsEmpty()) {
-            emptyLines++;
-        } else if (line.StartsWith(";")) {
-            commentLines++;
+        if (m_largeFileMode) {
+            m_largeView->SetMarkedLines(&m_searchHits);
         } else {
-            codeLines++;
+            for (size_t i = first; i < m_searchHits.size() && i < MAX_SEARCH_MARKERS; i++) {
+                m_editor->MarkerAdd(static_cast<int>(m_searchHits[i]), MARKER_SEARCH_HIT);
+            }
         }
+        
+        m_searchList->SetItemCount(static_cast<long>(m_searchHits.size()));
+        m_searchList->Refresh();
     }
     
-    // Populate statistics
-    long index = 0;
+    m_searchRunning = !finished;
+    UpdateSearchTab();
+    if (!finished) return;
     
-    index = m_statisticsList->InsertItem(index, "Total Lines");
-    m_statisticsList->SetItem(index, 1, std::to_string(totalLines));
+    if (m_searchHits.empty()) {
+        NOTIFY_INFO("Find", wxString::Format("'%s' was not found.", m_lastSearch));
+        return;
+    }
     
-    index = m_statisticsList->InsertItem(index + 1, "Code Lines");
-    m_statisticsList->SetItem(index, 1, std::to_string(codeLines));
+    // Show the first hit after the current line, wrapping to the top
+    auto next = m_searchHits.begin();
+    if (m_selectedLine > 0) {
+        next = std::upper_bound(m_searchHits.begin(), m_searchHits.end(), static_cast<size_t>(m_selectedLine - 1));
+    }
+    if (next == m_searchHits.end()) {
+        next = m_searchHits.begin();
+    }
+    long item = static_cast<long>(next - m_searchHits.begin());
+    m_searchList->SetItemState(item, wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED,
+                               wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
+    m_searchList->EnsureVisible(item);
+    m_jobNotebook->SetSelection(m_searchPage);
+    GotoLine(static_cast<int>(*next) + 1);
+}
+
+void GCodeEditor::UpdateSearchTab()
+{
+    if (!m_jobNotebook || m_searchPage == wxNOT_FOUND) return;
     
-    index = m_statisticsList->InsertItem(index + 1, "Comment Lines");
-    m_statisticsList->SetItem(index, 1, std::to_string(commentLines));
+    wxString label = "Search";
+    if (m_searchRunning) {
+        label += wxString::Format(" (%zu...)", m_searchHits.size());
+    } else if (!m_searchHits.empty()) {
+        label += wxString::Format(" (%zu)", m_searchHits.size());
+    }
+    m_jobNotebook->SetPageText(m_searchPage, label);
+}
+
+void GCodeEditor::UpdateJobStatistics()
+{
+    m_analysisTimer.Stop();
+    
+    if (m_largeFileMode) {
+        ShowLargeFileStatistics();
+        return;
+    }
     
-    index = m_statisticsList->InsertItem(index + 1, "Empty Lines");
-    m_statisticsList->SetItem(index, 1, std::to_string(emptyLines));
+    // One copy of the text serves the listener, the analysis and searches
+    m_sourceText = std::make_shared<const std::string>(GetText());
+    if (m_textChangePending) {
+        m_textChangePending = false;
+        if (m_textChangeCallback) {
+            LOG_INFO("GCodeEditor::UpdateJobStatistics - Text changed, firing callback with text of length: " + std::to_string(m_sourceText->length()));
+            m_textChangeCallback(*m_sourceText);
+        }
+    }
     
-    index = m_statisticsList->InsertItem(index + 1, "Estimated Time");
-    m_statisticsList->SetItem(index, 1, "~5 minutes");
+    m_analysisGeneration = m_analyzer->Start(m_sourceText);
+}
+
+void GCodeEditor::ApplyAnalysis(std::shared_ptr<const GCodeAnalysis> analysis)
+{
+    // Results of superseded analyses are dropped
+    if (!analysis || analysis->generation != m_analysisGeneration || m_largeFileMode) {
+        return;
+    }
+    m_analysis = analysis;
     
-    index = m_statisticsList->InsertItem(index + 1, "File Size");
-    m_statisticsList->SetItem(index, 1, std::to_string(text.length()) + " bytes");
+    const char* units = analysis->inches ? "in" : "mm";
+    auto distance = [units](double value) {
+        return wxString::Format("%.1f %s", value, units);
+    };
+    auto range = [units](double minValue, double maxValue) {
+        return wxString::Format("%.3f .. %.3f %s", minValue, maxValue, units);
+    };
     
-    // Add sample issues
-    if (codeLines > 0) {
-        index = m_issuesList->InsertItem(0, "Info");
-        m_issuesList->SetItem(index, 1, "1");
-        m_issuesList->SetItem(index, 2, "File ready for processing");
-        
-        if (totalLines > 50) {
-            index = m_issuesList->InsertItem(1, "Warning");
-            m_issuesList->SetItem(index, 1, "-");
-            m_issuesList->SetItem(index, 2, "Large file - verify before sending");
+    long seconds = static_cast<long>(analysis->estimatedSeconds + 0.5);
+    wxString estimatedTime = wxString::Format("%ld:%02ld:%02ld", seconds / 3600, (seconds / 60) % 60, seconds % 60);
+    
+    wxString tools;
+    for (int tool : analysis->tools) {
+        if (!tools.IsEmpty()) tools += ", ";
+        tools += wxString::Format("T%d", tool);
+    }
+    if (tools.IsEmpty()) tools = "None";
+    
+    std::vector<std::vector<wxString>> rows = {
+        {"Total Lines", wxString::Format("%d", analysis->totalLines)},
+        {"Code Lines", wxString::Format("%d", analysis->commandLines)},
+        {"Comment Lines", wxString::Format("%d", analysis->commentLines)},
+        {"Empty Lines", wxString::Format("%d", analysis->emptyLines)},
+        {"Rapid Moves", wxString::Format("%d", analysis->rapidMoves)},
+        {"Linear Moves", wxString::Format("%d", analysis->linearMoves)},
+        {"Arc Moves", wxString::Format("%d", analysis->arcMoves)},
+        {"Tool Changes", wxString::Format("%d", analysis->toolChanges)},
+        {"Tools Used", tools},
+        {"Total Distance", distance(analysis->totalDistance)},
+        {"Cutting Distance", distance(analysis->cuttingDistance)},
+        {"Rapid Distance", distance(analysis->rapidDistance)},
+        {"Estimated Time", estimatedTime},
+    };
+    if (analysis->boundsValid) {
+        rows.push_back({"X Range", range(analysis->minBounds.x, analysis->maxBounds.x)});
+        rows.push_back({"Y Range", range(analysis->minBounds.y, analysis->maxBounds.y)});
+        rows.push_back({"Z Range", range(analysis->minBounds.z, analysis->maxBounds.z)});
+    }
+    rows.push_back({"File Size", wxString::Format("%zu bytes", analysis->bytes)});
+    
+    // Only cells whose text changed are touched, so the lists don't flicker
+    // or lose their scroll position while typing
+    m_statisticsList->Freeze();
+    for (size_t i = 0; i < rows.size(); i++) {
+        SetListRow(m_statisticsList, static_cast<long>(i), rows[i]);
+    }
+    TrimListRows(m_statisticsList, static_cast<long>(rows.size()));
+    m_statisticsList->Thaw();
+    
+    m_issuesList->Freeze();
+    long issueRow = 0;
+    for (const auto& error : analysis->errors) {
+        wxString type = error.severity == ParseError::WARNING ? "Warning" : "Error";
+        SetListRow(m_issuesList, issueRow++, {type, wxString::Format("%d", error.lineNumber),
+                                              wxString::FromUTF8(error.message)});
+    }
+    if (issueRow == 0 && analysis->commandLines > 0) {
+        SetListRow(m_issuesList, issueRow++, {"Info", "-", "File ready for processing"});
+    }
+    TrimListRows(m_issuesList, issueRow);
+    m_issuesList->Thaw();
+}
+
+void GCodeEditor::SetListRow(wxListCtrl* list, long row, const std::vector<wxString>& columns)
+{
+    if (row >= list->GetItemCount()) {
+        list->InsertItem(row, columns.empty() ? wxString() : columns[0]);
+        for (size_t column = 1; column < columns.size(); column++) {
+            list->SetItem(row, static_cast<int>(column), columns[column]);
+        }
+        return;
+    }
+    
+    for (size_t column = 0; column < columns.size(); column++) {
+        if (list->GetItemText(row, static_cast<int>(column)) != columns[column]) {
+            list->SetItem(row, static_cast<int>(column), columns[column]);
         }
     }
 }
 
+void GCodeEditor::TrimListRows(wxListCtrl* list, long rowCount)
+{
+    while (list->GetItemCount() > rowCount) {
+        list->DeleteItem(list->GetItemCount() - 1);
+    }
+}
+
 // Event handlers
 void GCodeEditor::OnNew(wxCommandEvent& WXUNUSED(event))
 {
@@ -385,23 +837,229 @@ void GCodeEditor::OnValidateCode(wxCommandEvent& WXUNUSED(event))
 
 void GCodeEditor::OnTextChanged(wxStyledTextEvent& event)
 {
+    // The editor document is only cleared while a large file is shown
+    if (m_largeFileMode) {
+        event.Skip();
+        return;
+    }
+    
     m_modified = true;
-    UpdateJobStatistics();
     
-    // Notify any registered callback that the text has changed
-    if (m_textChangeCallback) {
-        std::string text = GetText();
-        LOG_INFO("GCodeEditor::OnTextChanged - Text changed, firing callback with text of length: " + std::to_string(text.length()));
-        m_textChangeCallback(text);
+    // Analysis and the change callback wait until typing pauses
+    m_textChangePending = true;
+    m_analysisTimer.Start(ANALYSIS_DEBOUNCE_MS, wxTIMER_ONE_SHOT);
+    event.Skip();
+}
+
+void GCodeEditor::OnStyleNeeded(wxStyledTextEvent& event)
+{
+    // Scintilla asks for styling from the first unstyled line up to the end of
+    // what is on screen; everything before keeps its styles, so an edit only
+    // costs the lines from the change to the bottom of the view
+    int startLine = m_editor->LineFromPosition(m_editor->GetEndStyled());
+    int endLine = m_editor->LineFromPosition(event.GetPosition());
+    int startPos = m_editor->PositionFromLine(startLine);
+    int endPos = endLine + 1 < m_editor->GetLineCount() ? m_editor->PositionFromLine(endLine + 1)
+                                                        : m_editor->GetLength();
+    if (endPos <= startPos) return;
+    
+    size_t length = static_cast<size_t>(endPos - startPos);
+    const char* text = m_editor->GetRangePointer(startPos, static_cast<int>(length));
+    if (!text) return;
+    
+    if (m_styleBuffer.size() < length) {
+        m_styleBuffer.resize(length);
+    }
+    
+    // The modal motion mode carried into the range is cached as line state
+    int state = startLine > 0 ? m_editor->GetLineState(startLine - 1) : GCodeLexer::STATE_NONE;
+    size_t lineStart = 0;
+    for (int line = startLine; lineStart < length; line++) {
+        size_t lineEnd = lineStart;
+        while (lineEnd < length && text[lineEnd] != '\n') lineEnd++;
+        if (lineEnd < length) lineEnd++;
+        
+        state = GCodeLexer::styleLine(text + lineStart, lineEnd - lineStart, m_styleBuffer.data() + lineStart, state);
+        m_editor->SetLineState(line, state);
+        lineStart = lineEnd;
+    }
+    
+    m_editor->StartStyling(startPos);
+    m_editor->SetStyleBytes(static_cast<int>(length), reinterpret_cast<char*>(m_styleBuffer.data()));
+}
+
+void GCodeEditor::OnUpdateUI(wxStyledTextEvent& event)
+{
+    // Caret moves drive the cross-highlighting in the visualizer
+    if (m_editor && !m_largeFileMode) {
+        NotifyLineSelected(m_editor->GetCurrentLine() + 1);
     }
     event.Skip();
 }
 
+void GCodeEditor::OnLargeViewSelect(wxCommandEvent& event)
+{
+    if (event.GetInt() >= 0) {
+        NotifyLineSelected(event.GetInt() + 1);
+    }
+}
+
+void GCodeEditor::OnSearchHitActivated(wxListEvent& event)
+{
+    long item = event.GetIndex();
+    if (item >= 0 && static_cast<size_t>(item) < m_searchHits.size()) {
+        GotoLine(static_cast<int>(m_searchHits[item]) + 1);
+    }
+}
+
+void GCodeEditor::OnFind(wxCommandEvent& WXUNUSED(event))
+{
+    wxString text = wxGetTextFromUser("Find text or words written on a line (e.g. Z<-5 F>3000):", "Find", m_lastSearch, this);
+    if (text.IsEmpty()) return;
+    
+    StartSearch(text);
+}
+
+void GCodeEditor::OnTransform(wxCommandEvent& WXUNUSED(event))
+{
+    GCodeTransformDialog dialog(this);
+    if (dialog.ShowModal() != wxID_OK) return;
+    
+    GCodeTransform transform;
+    dialog.ConfigureTransform(transform);
+    if (transform.IsIdentity()) return;
+    
+    TransformProgram(transform);
+}
+
+void GCodeEditor::TransformProgram(const GCodeTransform& transform)
+{
+    auto started = std::chrono::steady_clock::now();
+    GCodeTransform::Result result;
+    
+    try {
+        if (m_largeFileMode) {
+            // The mapping is read-only; the result streams into a new file
+            // that then replaces it in the view
+            wxFileName source(m_currentFile);
+            wxFileDialog saveDialog(this, "Save Transformed G-code", source.GetPath(),
+                                    source.GetName() + "_transformed." + source.GetExt(),
+                                    "G-code files (*.gcode;*.nc;*.cnc;*.tap)|*.gcode;*.nc;*.cnc;*.tap|All files (*.*)|*.*",
+                                    wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+            if (saveDialog.ShowModal() != wxID_OK) return;
+            wxString path = saveDialog.GetPath();
+            if (wxFileName(path).SameAs(source)) {
+                NOTIFY_ERROR("Transform Failed", "The open file is mapped and cannot be overwritten; choose another name.");
+                return;
+            }
+            
+            // The transform runs on a worker while the dialog keeps the window
+            // painting; its output replaces the destination only once complete
+            std::shared_ptr<MappedGCodeFile> file = m_largeFile;
+            std::atomic<size_t> doneBytes(0);
+            std::atomic<bool> cancel(false);
+            std::string error;
+            std::future<bool> task = std::async(std::launch::async, [&]() {
+                return AtomicFile::write(std::filesystem::path(path.ToStdWstring()), [&](const AtomicFile::Sink& sink) {
+                    result = transform.Apply(file->GetData(), file->GetSize(), sink, [&](size_t done, size_t) {
+                        if (cancel) throw TransformCancelled();
+                        doneBytes = done;
+                    });
+                }, &error);
+            });
+            
+            {
+                wxProgressDialog progress("Transforming G-code", "Writing " + wxFileName(path).GetFullName() + "...",
+                                          1000, this, wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME);
+                size_t total = std::max<size_t>(1, file->GetSize());
+                while (task.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready) {
+                    // Kept below the maximum, which would switch the dialog to its finished state
+                    int value = static_cast<int>(std::min<size_t>(999, doneBytes * 1000 / total));
+                    if (!cancel && !progress.Update(value)) {
+                        cancel = true;
+                    }
+                }
+            }
+            if (!task.get()) {
+                LOG_ERROR("GCodeEditor::TransformProgram - " + error);
+                NOTIFY_ERROR("Transform Failed", wxString::FromUTF8(error));
+                return;
+            }
+            LoadGCodeFile(path);
+        } else {
+            if (m_textChangePending || !m_sourceText) {
+                UpdateJobStatistics();
+            }
+            
+            std::string output;
+            {
+                wxBusyCursor busy;
+                result = transform.Apply(*m_sourceText, output);
+            }
+            
+            // Kept undoable; the listeners (visualizer) get the new program
+            // right away instead of after the edit debounce
+            ClearSearch();
+            m_editor->SetText(wxString::FromUTF8(output));
+            m_modified = true;
+            UpdateJobStatistics();
+        }
+    } catch (const TransformCancelled&) {
+        LOG_INFO("GCodeEditor::TransformProgram - cancelled");
+        return;
+    } catch (const std::exception& e) {
+        LOG_ERROR("GCodeEditor::TransformProgram - " + std::string(e.what()));
+        NOTIFY_ERROR("Transform Failed", wxString::Format("Failed to transform program: %s", e.what()));
+        return;
+    }
+    
+    long elapsed = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count());
+    LOG_INFO(wxString::Format("GCodeEditor::TransformProgram - %zu lines, %zu arcs linearized in %ld ms",
+                              result.lines, result.arcsLinearized, elapsed).ToStdString());
+    
+    if (result.unknownPositions > 0) {
+        NOTIFY_WARNING("Transform Applied", wxString::Format("%zu lines were transformed from an unknown position (taken as 0). "
+                                                             "Check moves after homing or machine-coordinate moves.",
+                                                             result.unknownPositions));
+    } else {
+        NOTIFY_SUCCESS("Transform Applied", wxString::Format("%zu lines transformed%s.", result.lines,
+                       result.arcsLinearized ? wxString::Format(", %zu arcs split into lines", result.arcsLinearized) : wxString()));
+    }
+}
+
+void GCodeEditor::OnGoto(wxCommandEvent& WXUNUSED(event))
+{
+    long lineCount = static_cast<long>(std::min<size_t>(GetLineCount(), LONG_MAX));
+    if (lineCount < 1) return;
+    
+    long line = wxGetNumberFromUser(wxString::Format("Line number (1 - %ld):", lineCount), "Line:", "Go To Line",
+                                    m_selectedLine > 0 ? m_selectedLine : 1, 1, lineCount, this);
+    if (line > 0) {
+        GotoLine(static_cast<int>(line));
+    }
+}
+
+void GCodeEditor::OnAnalysisTimer(wxTimerEvent& WXUNUSED(event))
+{
+    UpdateJobStatistics();
+}
+
 void GCodeEditor::SetTextChangeCallback(std::function<void(const std::string&)> callback)
 {
     m_textChangeCallback = callback;
 }
 
+void GCodeEditor::SetMappedFileCallback(std::function<void(std::shared_ptr<const MappedGCodeFile> file)> callback)
+{
+    m_mappedFileCallback = callback;
+}
+
+void GCodeEditor::SetLineSelectCallback(std::function<void(int line)> callback)
+{
+    m_lineSelectCallback = callback;
+}
+
 bool GCodeEditor::PromptSaveChanges()
 {
     if (IsModified()) {
@@ -423,25 +1081,27 @@ void GCodeEditor::SetupSyntaxHighlighting()
     if (!m_editor) return;
     
     try {
-        // Set up basic G-code syntax highlighting
-        // Use a simple approach with custom styling
-        
-        // Define styles for different G-code elements
-        m_editor->StyleSetForeground(0, wxColour(0, 0, 0));        // Default text
-        m_editor->StyleSetForeground(1, wxColour(0, 0, 255));      // G-codes (blue)
-        m_editor->StyleSetForeground(2, wxColour(255, 0, 0));      // M-codes (red)
-        m_editor->StyleSetForeground(3, wxColour(0, 128, 0));      // Comments (green)
-        m_editor->StyleSetForeground(4, wxColour(128, 0, 128));    // Numbers (purple)
-        m_editor->StyleSetForeground(5, wxColour(255, 165, 0));    // Parameters (orange)
+        // Styles assigned by GCodeLexer from OnStyleNeeded
+        m_editor->StyleSetForeground(GCodeLexer::STYLE_DEFAULT, wxColour(0, 0, 0));
+        m_editor->StyleSetForeground(GCodeLexer::STYLE_GCODE, wxColour(0, 0, 255));         // G-codes (blue)
+        m_editor->StyleSetForeground(GCodeLexer::STYLE_MCODE, wxColour(255, 0, 0));         // M-codes (red)
+        m_editor->StyleSetForeground(GCodeLexer::STYLE_COMMENT, wxColour(0, 128, 0));       // Comments (green)
+        m_editor->StyleSetForeground(GCodeLexer::STYLE_NUMBER, wxColour(128, 0, 128));      // Numbers (purple)
+        m_editor->StyleSetForeground(GCodeLexer::STYLE_PARAMETER, wxColour(255, 165, 0));   // Parameters (orange)
+        m_editor->StyleSetForeground(GCodeLexer::STYLE_LINE_NUMBER, wxColour(128, 128, 128)); // N words (grey)
+        m_editor->StyleSetForeground(GCodeLexer::STYLE_RAPID, wxColour(200, 120, 0));       // Rapid axis words
+        m_editor->StyleSetForeground(GCodeLexer::STYLE_ERROR, wxColour(255, 255, 255));
+        m_editor->StyleSetBackground(GCodeLexer::STYLE_ERROR, wxColour(220, 50, 50));
         
         // Set font for all styles
         wxFont font(10, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL);
-        for (int i = 0; i <= 5; i++) {
+        for (int i = 0; i < GCodeLexer::STYLE_COUNT; i++) {
             m_editor->StyleSetFont(i, font);
         }
         
         // Make comments italic
-        m_editor->StyleSetItalic(3, true);
+        m_editor->StyleSetItalic(GCodeLexer::STYLE_COMMENT, true);
+        m_editor->StyleSetItalic(GCodeLexer::STYLE_RAPID, true);
         
         LOG_INFO("GCodeEditor::SetupSyntaxHighlighting - Basic G-code syntax highlighting configured");
         
@@ -456,7 +1116,7 @@ void GCodeEditor::SetupEditorProperties()
     
     try {
         // Set up editor properties
-        m_editor->SetLexer(wxSTC_LEX_NULL);  // Use null lexer for custom highlighting
+        m_editor->SetLexer(wxSTC_LEX_CONTAINER);  // Styled on demand by OnStyleNeeded
         
         // Line numbers
         m_editor->SetMarginType(0, wxSTC_MARGIN_NUMBER);
@@ -464,7 +1124,7 @@ void GCodeEditor::SetupEditorProperties()
         
         // Folding
         m_editor->SetMarginType(1, wxSTC_MARGIN_SYMBOL);
-        m_editor->SetMarginMask(1, wxSTC_MASK_FOLDERS);
+        m_editor->SetMarginMask(1, wxSTC_MASK_FOLDERS | (1 << MARKER_SEARCH_HIT));
         m_editor->SetMarginWidth(1, 16);
         m_editor->SetMarginSensitive(1, true);
         
@@ -487,6 +1147,11 @@ void GCodeEditor::SetupEditorProperties()
             m_editor->MarkerSetBackground(i, wxColour(128, 128, 128));
         }
         
+        // Search hits share the symbol margin
+        m_editor->MarkerDefine(MARKER_SEARCH_HIT, wxSTC_MARK_SHORTARROW);
+        m_editor->MarkerSetForeground(MARKER_SEARCH_HIT, wxColour(0, 0, 160));
+        m_editor->MarkerSetBackground(MARKER_SEARCH_HIT, wxColour(255, 200, 0));
+        
         // Other editor properties
         m_editor->SetTabWidth(4);
         m_editor->SetUseTabs(false);  // Use spaces instead of tabs
@@ -524,6 +1189,21 @@ void GCodeEditor::LoadGCodeFile(const wxString& filename)
             return; // User cancelled
         }
         
+        // Large files are mapped and shown read-only instead of copied into the editor
+        wxFileName fileInfo(filename);
+        wxULongLong fileSize = fileInfo.GetSize();
+        if (fileSize != wxInvalidSize && fileSize.GetValue() >= LARGE_FILE_BYTES) {
+            if (!OpenLargeFile(filename)) {
+                wxMessageBox(wxString::Format("Cannot open file: %s", filename), "Error", wxOK | wxICON_ERROR);
+                return;
+            }
+            m_currentFile = filename.ToStdString();
+            m_modified = false;
+            NOTIFY_SUCCESS("File Loaded", wxString::Format("Opened %s read-only (%zu lines).",
+                                                           fileInfo.GetFullName(), m_largeFile->GetLineCount()));
+            return;
+        }
+        
         // Read the file
         wxTextFile file;
         if (!file.Open(filename)) {
@@ -11,9 +11,19 @@
 #include <wx/splitter.h>
 #include <wx/listctrl.h>
 #include <wx/dnd.h>
+#include <wx/timer.h>
+#include "core/GCodeAnalyzer.h"
+#include "core/MappedGCodeFile.h"
+#include "core/GCodeSearch.h"
+#include "core/GCodeTransform.h"
 #include <vector>
 #include <string>
 #include <functional>
+#include <memory>
+
+class wxNotebook;
+class LargeFileView;
+class SearchResultsList;
 
 /**
  * G-code Editor Panel - advanced text editor for G-code files
@@ -28,6 +38,7 @@ class GCodeEditor : public wxPanel
 {
 public:
     GCodeEditor(wxWindow* parent);
+    ~GCodeEditor();
     
     // File operations
     void NewFile();
@@ -42,12 +53,42 @@ public:
     void SetReadOnly(bool readOnly);
     bool IsModified() const;
     
-    // Job analysis
+    // Navigation; lines are 1-based program lines as shown in the margin
+    void GotoLine(int line);
+    bool FindNext(const wxString& text, bool forward = true, bool matchCase = false);
+    
+    // Searches the whole program in the background. Plain text or word
+    // conditions such as "Z<-5 F>3000"; matching lines stream into the Search
+    // tab and the marker margin, then the first match after the caret is shown
+    void StartSearch(const wxString& text, bool matchCase = false);
+    void ClearSearch();
+    
+    // Rewrites the program with a geometric transform. Editor content is
+    // replaced (undoably); a large file is written to a new file chosen by
+    // the user and opened in its place
+    void TransformProgram(const GCodeTransform& transform);
+    
+    // Line access that works in both modes (e.g. for streaming the program);
+    // lines are 0-based and returned without their line ending
+    size_t GetLineCount() const;
+    std::string GetLineText(size_t line) const;
+    
+    // Files of LARGE_FILE_BYTES or more are mapped read-only and shown in a
+    // virtual view instead of being copied into the editor
+    bool IsLargeFileMode() const { return m_largeFileMode; }
+    
+    // Job analysis (runs in the background; lists update when it completes)
     void AnalyzeJob();
     void UpdateJobStatistics();
     
     // Text change callback
     void SetTextChangeCallback(std::function<void(const std::string&)> callback);
+    // Called instead of the text change callback when a large file is opened.
+    // The mapping is shared so background work can keep reading it after the
+    // editor moves on to another file.
+    void SetMappedFileCallback(std::function<void(std::shared_ptr<const MappedGCodeFile> file)> callback);
+    // Called with the 1-based program line under the caret / selected row
+    void SetLineSelectCallback(std::function<void(int line)> callback);
     
     // File loading (public for drag and drop)
     void LoadGCodeFile(const wxString& filename);
@@ -67,6 +108,7 @@ private:
     void OnFind(wxCommandEvent& event);
     void OnReplace(wxCommandEvent& event);
     void OnGoto(wxCommandEvent& event);
+    void OnTransform(wxCommandEvent& event);
     void OnSendToMachine(wxCommandEvent& event);
     void OnValidateCode(wxCommandEvent& event);
     
@@ -74,6 +116,10 @@ private:
     void OnTextChanged(wxStyledTextEvent& event);
     void OnMarginClick(wxStyledTextEvent& event);
     void OnUpdateUI(wxStyledTextEvent& event);
+    void OnStyleNeeded(wxStyledTextEvent& event);
+    void OnAnalysisTimer(wxTimerEvent& event);
+    void OnLargeViewSelect(wxCommandEvent& event);
+    void OnSearchHitActivated(wxListEvent& event);
     
     // UI Creation
     void CreateControls();
@@ -92,23 +138,20 @@ private:
     void ConfigureGCodeLexer();
     void SetGCodeKeywords();
     
+    // Large-file mode
+    bool OpenLargeFile(const wxString& filename);
+    void CloseLargeFile();
+    void ShowLargeFileStatistics();
+    void NotifyLineSelected(int line);
+    
+    // Whole-program search
+    void OnSearchResults(uint64_t generation, std::vector<size_t> lines, bool finished);
+    void UpdateSearchTab();
+    
     // Job analysis
-    struct JobStatistics {
-        int totalLines;
-        int codeLines;
-        int commentLines;
-        int emptyLines;
-        double estimatedTime;
-        double totalDistance;
-        struct {
-            double minX, maxX;
-            double minY, maxY;
-            double minZ, maxZ;
-        } bounds;
-        std::vector<std::string> toolsUsed;
-        std::vector<std::string> warnings;
-        std::vector<std::string> errors;
-    };
+    void ApplyAnalysis(std::shared_ptr<const GCodeAnalysis> analysis);
+    void SetListRow(wxListCtrl* list, long row, const std::vector<wxString>& columns);
+    void TrimListRows(wxListCtrl* list, long rowCount);
     
     // UI Components
     wxSplitterWindow* m_splitter;
@@ -120,21 +163,54 @@ private:
     
     // Job info panel
     wxPanel* m_jobPanel;
+    wxNotebook* m_jobNotebook;
     wxListCtrl* m_statisticsList;
     wxListCtrl* m_issuesList;
+    SearchResultsList* m_searchList;
+    int m_searchPage;
     wxButton* m_analyzeBtn;
     wxButton* m_sendBtn;
     wxButton* m_validateBtn;
     
+    // Style bytes for the range being highlighted, reused between requests
+    std::vector<unsigned char> m_styleBuffer;
+    
     // Current file
     std::string m_currentFile;
     bool m_modified;
     
-    // Job data
-    JobStatistics m_jobStats;
-    
-    // Text change callback
+    static const int ANALYSIS_DEBOUNCE_MS = 300;  // Quiet time after the last edit
+    
+    // Job data - edits are debounced, then analysed on a worker thread. The
+    // snapshot taken for the analysis is shared with searches
+    std::shared_ptr<const std::string> m_sourceText;
+    std::unique_ptr<GCodeAnalyzer> m_analyzer;
+    std::shared_ptr<const GCodeAnalysis> m_analysis;
+    uint64_t m_analysisGeneration;
+    wxTimer m_analysisTimer;
+    bool m_textChangePending;
+    
+    // Large-file mode
+    static const size_t LARGE_FILE_BYTES = 32 * 1024 * 1024;
+    std::shared_ptr<MappedGCodeFile> m_largeFile;  // Shared with searches still reading it
+    LargeFileView* m_largeView;
+    bool m_largeFileMode;
+    
+    // Cross-highlighting and search
+    std::function<void(int line)> m_lineSelectCallback;
+    int m_selectedLine;
+    wxString m_lastSearch;
+    
+    static const int MARKER_SEARCH_HIT = 2;
+    static const size_t MAX_SEARCH_MARKERS = 100000;  // Margin markers beyond this are skipped
+    std::unique_ptr<GCodeSearch> m_search;
+    uint64_t m_searchGeneration;
+    std::vector<size_t> m_searchHits;  // 0-based lines, ascending
+    bool m_searchRunning;
+    
+    // Content callbacks
     std::function<void(const std::string&)> m_textChangeCallback;
+    std::function<void(std::shared_ptr<const MappedGCodeFile> file)> m_mappedFileCallback;
     
     wxDECLARE_EVENT_TABLE();
 };
@@ -0,0 +1,114 @@
+/**
+ * gui/GCodeTransformDialog.cpp
+ * G-code transform dialog implementation
+ */
+
+#include "GCodeTransformDialog.h"
+#include <wx/sizer.h>
+
+GCodeTransformDialog::GCodeTransformDialog(wxWindow* parent)
+    : wxDialog(parent, wxID_ANY, "Transform Program", wxDefaultPosition, wxDefaultSize,
+               wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
+{
+    CreateControls();
+}
+
+void GCodeTransformDialog::CreateControls()
+{
+    wxBoxSizer* mainSizer = new wxBoxSizer(wxVERTICAL);
+    
+    // Move
+    wxStaticBoxSizer* moveSizer = new wxStaticBoxSizer(wxVERTICAL, this, "Move (mm)");
+    wxFlexGridSizer* moveGrid = new wxFlexGridSizer(3, 2, 5, 10);
+    moveGrid->AddGrowableCol(1, 1);
+    m_moveX = AddValue(moveSizer->GetStaticBox(), moveGrid, "X:", -10000, 10000, 0, 3);
+    m_moveY = AddValue(moveSizer->GetStaticBox(), moveGrid, "Y:", -10000, 10000, 0, 3);
+    m_moveZ = AddValue(moveSizer->GetStaticBox(), moveGrid, "Z:", -1000, 1000, 0, 3);
+    moveSizer->Add(moveGrid, 1, wxEXPAND | wxALL, 10);
+    
+    // Rotate
+    wxStaticBoxSizer* rotateSizer = new wxStaticBoxSizer(wxVERTICAL, this, "Rotate about Z");
+    wxFlexGridSizer* rotateGrid = new wxFlexGridSizer(3, 2, 5, 10);
+    rotateGrid->AddGrowableCol(1, 1);
+    m_angle = AddValue(rotateSizer->GetStaticBox(), rotateGrid, "Angle (deg, CCW):", -360, 360, 0, 3);
+    m_centerX = AddValue(rotateSizer->GetStaticBox(), rotateGrid, "Center X (mm):", -10000, 10000, 0, 3);
+    m_centerY = AddValue(rotateSizer->GetStaticBox(), rotateGrid, "Center Y (mm):", -10000, 10000, 0, 3);
+    rotateSizer->Add(rotateGrid, 1, wxEXPAND | wxALL, 10);
+    
+    // Scale and mirror
+    wxStaticBoxSizer* scaleSizer = new wxStaticBoxSizer(wxVERTICAL, this, "Scale and Mirror");
+    wxFlexGridSizer* scaleGrid = new wxFlexGridSizer(3, 2, 5, 10);
+    scaleGrid->AddGrowableCol(1, 1);
+    m_scaleX = AddValue(scaleSizer->GetStaticBox(), scaleGrid, "X (%):", 1, 10000, 100, 2);
+    m_scaleY = AddValue(scaleSizer->GetStaticBox(), scaleGrid, "Y (%):", 1, 10000, 100, 2);
+    m_scaleZ = AddValue(scaleSizer->GetStaticBox(), scaleGrid, "Z (%):", 1, 10000, 100, 2);
+    scaleSizer->Add(scaleGrid, 1, wxEXPAND | wxALL, 10);
+    
+    wxBoxSizer* mirrorSizer = new wxBoxSizer(wxHORIZONTAL);
+    m_mirrorX = new wxCheckBox(scaleSizer->GetStaticBox(), wxID_ANY, "Mirror X");
+    m_mirrorY = new wxCheckBox(scaleSizer->GetStaticBox(), wxID_ANY, "Mirror Y");
+    mirrorSizer->Add(m_mirrorX, 0, wxRIGHT, 15);
+    mirrorSizer->Add(m_mirrorY, 0);
+    scaleSizer->Add(mirrorSizer, 0, wxLEFT | wxRIGHT | wxBOTTOM, 10);
+    
+    // Output
+    wxStaticBoxSizer* outputSizer = new wxStaticBoxSizer(wxVERTICAL, this, "Output");
+    wxFlexGridSizer* outputGrid = new wxFlexGridSizer(2, 2, 5, 10);
+    outputGrid->AddGrowableCol(1, 1);
+    outputGrid->Add(new wxStaticText(outputSizer->GetStaticBox(), wxID_ANY, "Units:"), 0, wxALIGN_CENTER_VERTICAL);
+    m_units = new wxChoice(outputSizer->GetStaticBox(), wxID_ANY);
+    m_units->Append("Keep program units");
+    m_units->Append("Millimeters (G21)");
+    m_units->Append("Inches (G20)");
+    m_units->SetSelection(0);
+    outputGrid->Add(m_units, 1, wxEXPAND);
+    m_arcTolerance = AddValue(outputSizer->GetStaticBox(), outputGrid, "Arc tolerance (mm):", 0.001, 1, 0.01, 3);
+    m_arcTolerance->SetToolTip("Largest deviation of arcs that are split into lines under uneven scaling");
+    outputSizer->Add(outputGrid, 1, wxEXPAND | wxALL, 10);
+    
+    mainSizer->Add(moveSizer, 0, wxEXPAND | wxALL, 10);
+    mainSizer->Add(rotateSizer, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+    mainSizer->Add(scaleSizer, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+    mainSizer->Add(outputSizer, 0, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+    mainSizer->Add(CreateStdDialogButtonSizer(wxOK | wxCANCEL), 0, wxEXPAND | wxALL, 10);
+    
+    SetSizerAndFit(mainSizer);
+}
+
+wxSpinCtrlDouble* GCodeTransformDialog::AddValue(wxWindow* parent, wxSizer* sizer, const wxString& label,
+                                                 double minimum, double maximum, double value, int digits)
+{
+    sizer->Add(new wxStaticText(parent, wxID_ANY, label), 0, wxALIGN_CENTER_VERTICAL);
+    wxSpinCtrlDouble* control = new wxSpinCtrlDouble(parent, wxID_ANY, "", wxDefaultPosition, wxDefaultSize,
+                                                     wxSP_ARROW_KEYS, minimum, maximum, value,
+                                                     digits > 2 ? 0.1 : 1.0);
+    control->SetDigits(digits);
+    sizer->Add(control, 1, wxEXPAND);
+    return control;
+}
+
+void GCodeTransformDialog::ConfigureTransform(GCodeTransform& transform) const
+{
+    transform.Reset();
+    
+    switch (m_units->GetSelection()) {
+        case 1: transform.SetOutputUnits(GCodeTransform::OutputUnits::MILLIMETERS); break;
+        case 2: transform.SetOutputUnits(GCodeTransform::OutputUnits::INCHES); break;
+        default: transform.SetOutputUnits(GCodeTransform::OutputUnits::KEEP); break;
+    }
+    transform.SetArcTolerance(m_arcTolerance->GetValue());
+    
+    if (m_scaleX->GetValue() != 100.0 || m_scaleY->GetValue() != 100.0 || m_scaleZ->GetValue() != 100.0) {
+        transform.Scale(m_scaleX->GetValue() / 100.0, m_scaleY->GetValue() / 100.0, m_scaleZ->GetValue() / 100.0);
+    }
+    if (m_mirrorX->GetValue()) {
+        transform.MirrorX();
+    }
+    if (m_mirrorY->GetValue()) {
+        transform.MirrorY();
+    }
+    if (m_angle->GetValue() != 0.0) {
+        transform.RotateZ(m_angle->GetValue(), m_centerX->GetValue(), m_centerY->GetValue());
+    }
+    transform.Translate(m_moveX->GetValue(), m_moveY->GetValue(), m_moveZ->GetValue());
+}
@@ -0,0 +1,49 @@
+/**
+ * gui/GCodeTransformDialog.h
+ * Dialog for repositioning a loaded program on the bed
+ * Collects a move, rotation, scale, mirror and units conversion and turns
+ * them into a GCodeTransform.
+ */
+
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/spinctrl.h>
+#include <wx/choice.h>
+#include <wx/statbox.h>
+#include "core/GCodeTransform.h"
+
+class GCodeTransformDialog : public wxDialog
+{
+public:
+    GCodeTransformDialog(wxWindow* parent);
+    
+    // Scale, then mirror, then rotate, then move; units are converted first
+    void ConfigureTransform(GCodeTransform& transform) const;
+
+private:
+    void CreateControls();
+    wxSpinCtrlDouble* AddValue(wxWindow* parent, wxSizer* sizer, const wxString& label,
+                               double minimum, double maximum, double value, int digits);
+    
+    // Move
+    wxSpinCtrlDouble* m_moveX;
+    wxSpinCtrlDouble* m_moveY;
+    wxSpinCtrlDouble* m_moveZ;
+    
+    // Rotate about Z
+    wxSpinCtrlDouble* m_angle;
+    wxSpinCtrlDouble* m_centerX;
+    wxSpinCtrlDouble* m_centerY;
+    
+    // Scale and mirror
+    wxSpinCtrlDouble* m_scaleX;
+    wxSpinCtrlDouble* m_scaleY;
+    wxSpinCtrlDouble* m_scaleZ;
+    wxCheckBox* m_mirrorX;
+    wxCheckBox* m_mirrorY;
+    
+    // Output
+    wxChoice* m_units;
+    wxSpinCtrlDouble* m_arcTolerance;
+};
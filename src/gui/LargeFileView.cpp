@@ -0,0 +1,153 @@
+/**
+ * gui/LargeFileView.cpp
+ * Virtual view of a memory-mapped G-code file
+ */
+
+#include "LargeFileView.h"
+#include "core/MappedGCodeFile.h"
+#include <wx/dcclient.h>
+#include <algorithm>
+
+LargeFileView::LargeFileView(wxWindow* parent, wxWindowID id)
+    : wxVListBox(parent, id, wxDefaultPosition, wxDefaultSize, wxBORDER_NONE)
+    , m_file(nullptr)
+    , m_markedLines(nullptr)
+    , m_font(10, wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL)
+    , m_gutterWidth(0)
+{
+    SetBackgroundColour(*wxWHITE);
+    SetSelectionBackground(wxColour(173, 216, 230));
+
+    for (int i = 0; i < GCodeLexer::STYLE_COUNT; i++) {
+        m_foreground[i] = *wxBLACK;
+    }
+
+    // Monospaced rows of one height - columns map directly to pixels
+    wxClientDC dc(this);
+    dc.SetFont(m_font);
+    m_rowHeight = dc.GetCharHeight() + 1;
+    m_charWidth = dc.GetTextExtent("0").x;
+
+    UpdateGutterWidth();
+    SetItemCount(0);
+}
+
+void LargeFileView::SetFile(const MappedGCodeFile* file)
+{
+    m_file = file;
+    UpdateGutterWidth();
+    SetSelection(wxNOT_FOUND);
+    SetItemCount(m_file ? m_file->GetLineCount() : 0);
+    ScrollToRow(0);
+    RefreshAll();
+}
+
+void LargeFileView::SetStyleColours(int style, const wxColour& foreground, const wxColour& background)
+{
+    if (style < 0 || style >= GCodeLexer::STYLE_COUNT) return;
+    m_foreground[style] = foreground;
+    m_background[style] = background;
+    RefreshAll();
+}
+
+void LargeFileView::GotoLine(size_t line)
+{
+    if (!m_file || line >= GetItemCount()) return;
+
+    SetSelection(static_cast<int>(line));
+    size_t visible = GetVisibleRowsEnd() - GetVisibleRowsBegin();
+    ScrollToRow(line > visible / 2 ? line - visible / 2 : 0);
+}
+
+void LargeFileView::SetMarkedLines(const std::vector<size_t>* lines)
+{
+    m_markedLines = lines;
+    RefreshAll();
+}
+
+void LargeFileView::UpdateGutterWidth()
+{
+    // Wide enough for the largest line number, same as the editor margin
+    size_t lines = m_file ? m_file->GetLineCount() : 0;
+    int digits = 1;
+    for (size_t n = lines; n >= 10; n /= 10) {
+        digits++;
+    }
+    m_gutterWidth = (std::max(digits, 4) + 2) * m_charWidth;
+}
+
+void LargeFileView::OnDrawBackground(wxDC& dc, const wxRect& rect, size_t n) const
+{
+    wxVListBox::OnDrawBackground(dc, rect, n);
+
+    wxRect gutter(rect.x, rect.y, m_gutterWidth, rect.height);
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    dc.SetBrush(wxBrush(wxColour(240, 240, 240)));
+    dc.DrawRectangle(gutter);
+    
+    if (m_markedLines && std::binary_search(m_markedLines->begin(), m_markedLines->end(), n)) {
+        // Same arrow and colours as the editor's search marker
+        int size = std::max(4, rect.height / 3);
+        int midY = rect.y + rect.height / 2;
+        wxPoint arrow[3] = {
+            wxPoint(rect.x + 2, midY - size),
+            wxPoint(rect.x + 2 + size, midY),
+            wxPoint(rect.x + 2, midY + size),
+        };
+        dc.SetPen(wxPen(wxColour(0, 0, 160)));
+        dc.SetBrush(wxBrush(wxColour(255, 200, 0)));
+        dc.DrawPolygon(3, arrow);
+    }
+}
+
+void LargeFileView::OnDrawItem(wxDC& dc, const wxRect& rect, size_t n) const
+{
+    if (!m_file || n >= m_file->GetLineCount()) return;
+
+    wxDCClipper clip(dc, rect);
+    dc.SetFont(m_font);
+    dc.SetBackgroundMode(wxBRUSHSTYLE_TRANSPARENT);
+
+    wxString number = wxString::Format("%zu", n + 1);
+    dc.SetTextForeground(wxColour(128, 128, 128));
+    dc.DrawText(number, rect.x + m_gutterWidth - m_charWidth - dc.GetTextExtent(number).x, rect.y);
+
+    // Only the columns that fit are styled and drawn
+    std::string_view text = m_file->GetLine(n);
+    size_t columns = static_cast<size_t>(std::max(0, rect.width - m_gutterWidth) / std::max(1, m_charWidth)) + 1;
+    size_t length = std::min(text.size(), columns);
+    if (length == 0) return;
+
+    if (m_styles.size() < text.size()) {
+        m_styles.resize(text.size());
+    }
+    GCodeLexer::styleLine(text.data(), text.size(), m_styles.data(), GCodeLexer::STATE_NONE);
+
+    int x = rect.x + m_gutterWidth + m_charWidth / 2;
+    for (size_t runStart = 0; runStart < length;) {
+        unsigned char style = m_styles[runStart];
+        size_t runEnd = runStart + 1;
+        while (runEnd < length && m_styles[runEnd] == style) runEnd++;
+
+        wxString run = wxString::FromUTF8(text.data() + runStart, runEnd - runStart);
+        if (run.IsEmpty()) {
+            run = wxString::From8BitData(text.data() + runStart, runEnd - runStart);
+        }
+
+        int runX = x + static_cast<int>(runStart) * m_charWidth;
+        if (m_background[style].IsOk()) {
+            dc.SetPen(*wxTRANSPARENT_PEN);
+            dc.SetBrush(wxBrush(m_background[style]));
+            dc.DrawRectangle(runX, rect.y, static_cast<int>(runEnd - runStart) * m_charWidth, rect.height);
+        }
+        dc.SetTextForeground(m_foreground[style]);
+        dc.DrawText(run, runX, rect.y);
+
+        runStart = runEnd;
+    }
+}
+
+wxCoord LargeFileView::OnMeasureItem(size_t WXUNUSED(n)) const
+{
+    return m_rowHeight;
+}
@@ -0,0 +1,53 @@
+/**
+ * gui/LargeFileView.h
+ * Read-only virtual view of a memory-mapped G-code file
+ * Rows are read straight from the mapping and highlighted when painted, so
+ * opening a file costs only its line index regardless of its size.
+ */
+
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/vlbox.h>
+#include <vector>
+#include "core/GCodeLexer.h"
+
+class MappedGCodeFile;
+
+class LargeFileView : public wxVListBox
+{
+public:
+    LargeFileView(wxWindow* parent, wxWindowID id);
+
+    // File shown by the view (not owned); nullptr clears it
+    void SetFile(const MappedGCodeFile* file);
+
+    // Colours for the GCodeLexer styles (normally copied from the editor)
+    void SetStyleColours(int style, const wxColour& foreground, const wxColour& background = wxNullColour);
+
+    // Selects a line (0-based) and scrolls it into the middle of the view
+    void GotoLine(size_t line);
+    
+    // Lines (0-based, ascending) flagged in the gutter, e.g. search hits; the
+    // vector is not copied and must stay alive while set. nullptr clears them
+    void SetMarkedLines(const std::vector<size_t>* lines);
+
+protected:
+    void OnDrawItem(wxDC& dc, const wxRect& rect, size_t n) const override;
+    void OnDrawBackground(wxDC& dc, const wxRect& rect, size_t n) const override;
+    wxCoord OnMeasureItem(size_t n) const override;
+
+private:
+    void UpdateGutterWidth();
+
+    const MappedGCodeFile* m_file;
+    const std::vector<size_t>* m_markedLines;
+    wxFont m_font;
+    int m_rowHeight;
+    int m_charWidth;
+    int m_gutterWidth;
+
+    wxColour m_foreground[GCodeLexer::STYLE_COUNT];
+    wxColour m_background[GCodeLexer::STYLE_COUNT];
+    mutable std::vector<unsigned char> m_styles;  // Scratch for the row being drawn
+};
@@ -6,6 +6,8 @@
 
 #include "MachineManagerPanel.h"
 #include "core/SimpleLogger.h"
+#include "core/ConfigFile.h"
+#include "core/CommunicationManager.h"
 #include <wx/wx.h>
 #include <wx/dir.h>
 #include <wx/filename.h>
@@ -21,25 +23,23 @@ void MachineManagerPanel::LoadMachineConfigs()
     wxString settingsPath = GetSettingsPath();
     wxString machinesFile = settingsPath + wxFileName::GetPathSeparator() + "machines.json";
     
-    // Check if machines.json exists
-    if (!wxFileName::FileExists(machinesFile)) {
+    // Check if machines.json or its binary copy exists
+    if (!wxFileName::FileExists(machinesFile)
+        && !wxFileName::FileExists(wxString(ConfigFile::binaryPath(machinesFile.ToStdString()).string()))) {
         // Create empty machines file
         CreateEmptyMachinesFile(machinesFile);
         return; // Start with empty machine list
     }
     
     try {
-        // Read the JSON file
-        std::ifstream file(machinesFile.ToStdString());
-        if (!file.is_open()) {
-            LOG_ERROR("Could not open machines.json file for reading");
+        // Read machines.json or its binary copy - see ConfigFile::load
+        nlohmann::json j;
+        std::string error;
+        if (!ConfigFile::load(machinesFile.ToStdString(), j, &error)) {
+            LOG_ERROR("Could not read machines.json: " + error);
             return;
         }
         
-        nlohmann::json j;
-        file >> j;
-        file.close();
-        
         // Parse machines from JSON
         if (j.contains("machines") && j["machines"].is_array()) {
             for (const auto& machineJson : j["machines"]) {
@@ -51,7 +51,8 @@ void MachineManagerPanel::LoadMachineConfigs()
                 machine.host = machineJson.value("host", "");
                 machine.port = machineJson.value("port", 23);
                 machine.machineType = machineJson.value("machineType", "FluidNC");
-                machine.connected = false; // Always start disconnected
+                // The panel may be built after the connection was made
+                machine.connected = CommunicationManager::Instance().IsConnected(machine.id);
                 machine.lastConnected = machineJson.value("lastConnected", "Never");
                 machine.autoConnect = machineJson.value("autoConnect", false);
                 
@@ -99,15 +100,13 @@ void MachineManagerPanel::SaveMachineConfigs()
             j["machines"].push_back(machineJson);
         }
         
-        // Write to file
-        std::ofstream file(machinesFile.ToStdString());
-        if (file.is_open()) {
-            file << j.dump(4); // Pretty print with 4-space indentation
-            file.close();
+        // Saved on user edits only - keep the JSON copy current too
+        std::string error;
+        if (ConfigFile::save(machinesFile.ToStdString(), j, &error, true)) {
             std::string saveMsg = "Saved " + std::to_string(m_machines.size()) + " machine configurations to " + machinesFile.ToStdString();
             LOG_INFO(saveMsg);
         } else {
-            LOG_ERROR("Could not open machines.json file for writing: " + machinesFile.ToStdString());
+            LOG_ERROR("Could not write machines.json: " + error);
         }
         
     } catch (const std::exception& e) {
@@ -6,14 +6,194 @@
 #include "MachineVisualizationPanel.h"
 #include "core/SimpleLogger.h"
 #include "core/GCodeParser.h"
+#include "core/StateManager.h"
+#include "core/StockSimulator.h"
+#include "core/MappedGCodeFile.h"
+#include "ToolpathRenderer.h"
+#ifdef HAVE_GL_TOOLPATH_VIEW
+#include "ToolpathGLView.h"
+#endif
 #include <wx/filename.h>
 #include <wx/textfile.h>
 #include <wx/msgdlg.h>
 #include <wx/tokenzr.h>
+#include <wx/dcmemory.h>
+#include <wx/stopwatch.h>
 #include <cmath>
 #include <algorithm>
 #include <sstream>
 #include <map>
+#include <chrono>
+#include <memory>
+
+enum {
+    ID_MOTION_TIMER = wxID_HIGHEST + 7000
+};
+
+namespace {
+
+double MonotonicSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Segment budget of a large-file preview (about 40 MB of lines)
+const size_t MAX_PREVIEW_SEGMENTS = 500000;
+// Starting merge distance in program units; doubled whenever the budget is exceeded
+const double PREVIEW_START_TOLERANCE = 0.01;
+
+// Thrown from the parser's progress callback to abandon a superseded preview
+struct PreviewCancelled {};
+
+// Collects a toolpath with runs of short continuous moves merged into single
+// lines, coarsening the merge distance until it fits the segment budget
+class PreviewBuilder
+{
+public:
+    explicit PreviewBuilder(size_t maxSegments)
+        : m_maxSegments(maxSegments), m_tolerance(PREVIEW_START_TOLERANCE), m_truncated(false),
+          m_minX(0.0f), m_maxX(0.0f), m_minY(0.0f), m_maxY(0.0f)
+    {
+    }
+    
+    void Add(GCodeLine line)
+    {
+        if (m_truncated) return;
+        
+        if (m_lines.empty()) {
+            m_minX = m_maxX = line.startX;
+            m_minY = m_maxY = line.startY;
+        }
+        m_minX = std::min(m_minX, line.endX);
+        m_maxX = std::max(m_maxX, line.endX);
+        m_minY = std::min(m_minY, line.endY);
+        m_maxY = std::max(m_maxY, line.endY);
+        
+        // Arcs smaller than the merge distance are drawn as their chord
+        if (line.type == GCodeLine::ARC && line.radius <= m_tolerance) {
+            line.type = GCodeLine::LINE;
+        }
+        if (!m_lines.empty() && Merge(m_lines.back(), line)) return;
+        m_lines.push_back(line);
+        
+        if (m_lines.size() <= m_maxSegments) return;
+        
+        // Coarsen until a quarter of the budget is free again. Moves that
+        // cannot be merged (e.g. alternating rapids and plunges) stop the
+        // preview once the merge distance would blur the whole program.
+        double extent = std::max(m_maxX - m_minX, m_maxY - m_minY);
+        while (m_lines.size() > m_maxSegments - m_maxSegments / 4) {
+            if (m_tolerance * 2.0 > extent / 100.0) {
+                m_truncated = true;
+                break;
+            }
+            Coarsen();
+        }
+    }
+    
+    std::vector<GCodeLine>& GetLines() { return m_lines; }
+    double GetTolerance() const { return m_tolerance; }
+    bool IsTruncated() const { return m_truncated; }
+    
+private:
+    // Extends 'into' by 'line' when every point of the run stays within the
+    // merge distance of the run's start
+    bool Merge(GCodeLine& into, const GCodeLine& line) const
+    {
+        if (into.type != GCodeLine::LINE || line.type != GCodeLine::LINE ||
+            into.renderClass != line.renderClass ||
+            into.endX != line.startX || into.endY != line.startY || into.endZ != line.startZ) {
+            return false;
+        }
+        double dx = line.endX - into.startX;
+        double dy = line.endY - into.startY;
+        double dz = line.endZ - into.startZ;
+        if (dx * dx + dy * dy + dz * dz > m_tolerance * m_tolerance) {
+            return false;
+        }
+        into.endX = line.endX;
+        into.endY = line.endY;
+        into.endZ = line.endZ;
+        into.lineNumber = line.lineNumber;
+        return true;
+    }
+    
+    void Coarsen()
+    {
+        m_tolerance *= 2.0;
+        size_t kept = 0;
+        for (size_t i = 0; i < m_lines.size(); ++i) {
+            if (kept > 0 && Merge(m_lines[kept - 1], m_lines[i])) continue;
+            if (kept != i) {
+                m_lines[kept] = m_lines[i];
+            }
+            kept++;
+        }
+        m_lines.resize(kept);
+    }
+    
+    std::vector<GCodeLine> m_lines;
+    size_t m_maxSegments;
+    double m_tolerance;
+    bool m_truncated;
+    float m_minX, m_maxX, m_minY, m_maxY;  // XY extent of the moves seen so far
+};
+
+// Simplified toolpath levels for zoomed-out views. Reads only its arguments,
+// so the parse worker builds them next to the toolpath.
+void BuildToolpathLOD(const std::vector<GCodeLine>& lines, double extent, ToolpathLOD& lod)
+{
+    lod.clear();
+    if (lines.empty()) return;
+    
+    // Base tolerance relative to the program size; each level doubles it
+    double baseTolerance = std::max(extent * 1e-5, 1e-4);
+    
+    // Join continuous moves of the same class into polylines, flattening arcs
+    // to within the base tolerance. Each point records how many moves are
+    // complete when the tool reaches it, so progress can be drawn per level.
+    std::vector<LODPolyline> polylines;
+    for (size_t segment = 0; segment < lines.size(); ++segment) {
+        const GCodeLine& line = lines[segment];
+        uint32_t done = static_cast<uint32_t>(segment + 1);
+        if (polylines.empty() || polylines.back().renderClass != line.renderClass ||
+            polylines.back().points.back().x != line.startX || polylines.back().points.back().y != line.startY) {
+            LODPolyline polyline;
+            polyline.renderClass = line.renderClass;
+            polyline.points.push_back({line.startX, line.startY, static_cast<uint32_t>(segment)});
+            polylines.push_back(std::move(polyline));
+        }
+        
+        auto& points = polylines.back().points;
+        if (line.type == GCodeLine::ARC && line.radius > 0) {
+            double startAngle;
+            double sweepAngle = GetArcSweep(line, startAngle);
+            double chordAngle = 2.0 * std::acos(std::max(-1.0, 1.0 - baseTolerance / line.radius));
+            int steps = std::max(1, std::min(4096, static_cast<int>(std::ceil(std::abs(sweepAngle) / chordAngle))));
+            for (int i = 1; i < steps; ++i) {
+                double angle = startAngle + sweepAngle * i / steps;
+                points.push_back({static_cast<float>(line.centerX + line.radius * std::cos(angle)),
+                                  static_cast<float>(line.centerY + line.radius * std::sin(angle)), done});
+            }
+        }
+        points.push_back({line.endX, line.endY, done});
+    }
+    
+    lod.build(polylines, baseTolerance);
+}
+
+} // namespace
+
+struct MachineVisualizationPanel::ToolpathPreview {
+    std::vector<GCodeLine> lines;
+    GCodeStatistics statistics;
+    size_t sourceMoves = 0;
+    double tolerance = 0.0;
+    bool truncated = false;
+    ToolpathLOD lod;
+    long lodMs = 0;
+};
 
 // Event table
 wxBEGIN_EVENT_TABLE(MachineVisualizationPanel, wxPanel)
@@ -24,6 +204,7 @@ wxBEGIN_EVENT_TABLE(MachineVisualizationPanel, wxPanel)
     EVT_MOTION(MachineVisualizationPanel::OnMouseMove)
     EVT_LEFT_UP(MachineVisualizationPanel::OnMouseUp)
     EVT_KEY_DOWN(MachineVisualizationPanel::OnKeyDown)
+    EVT_TIMER(ID_MOTION_TIMER, MachineVisualizationPanel::OnMotionTimer)
 wxEND_EVENT_TABLE()
 
 MachineVisualizationPanel::MachineVisualizationPanel(wxWindow* parent)
@@ -36,6 +217,21 @@ MachineVisualizationPanel::MachineVisualizationPanel(wxWindow* parent)
     , m_showToolPath(true)
     , m_showCurrentPosition(true)
     , m_showWorkspaceBounds(false)  // Hidden until machine is connected
+    , m_staticLayerValid(false)
+    , m_lastLayerRenderMs(0)
+    , m_executedSegments(0)
+    , m_highlightedLine(0)
+    , m_motionTimer(this, ID_MOTION_TIMER)
+    , m_showStock(false)
+    , m_stockCancel(false)
+    , m_stockGeneration(0)
+    , m_stockTarget(0)
+    , m_stockMinX(0), m_stockMinY(0), m_stockWidth(0), m_stockHeight(0)
+    , m_previewCancel(false)
+    , m_previewGeneration(0)
+    , m_previewRunning(false)
+    , m_previewSourceMoves(0)
+    , m_glView(nullptr)
     , m_workspaceWidth(300.0f)
     , m_workspaceHeight(200.0f)
     , m_workspaceDepth(100.0f)
@@ -47,9 +243,14 @@ MachineVisualizationPanel::MachineVisualizationPanel(wxWindow* parent)
     // Initialize tool position as invalid
     m_toolPosition.isValid = false;
     
+    m_toolpathRenderer.SetToolpath(&m_gcodeLines, &m_lod);
+    
     // Set background color
     SetBackgroundColour(wxColour(240, 240, 240));
     
+    // Every pixel is painted from the cached layer, so skip the background erase
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+    
     // Enable key events
     SetCanFocus(true);
     
@@ -58,6 +259,9 @@ MachineVisualizationPanel::MachineVisualizationPanel(wxWindow* parent)
 
 MachineVisualizationPanel::~MachineVisualizationPanel()
 {
+    m_motionTimer.Stop();
+    StopPreview();
+    StopStockSimulation();
     LOG_INFO("Machine Visualization Panel destroyed");
 }
 
@@ -89,38 +293,421 @@ void MachineVisualizationPanel::LoadGCodeFile(const wxString& filename)
 
 void MachineVisualizationPanel::SetGCodeContent(const wxString& gcode)
 {
-    LOG_INFO(wxString::Format("SetGCodeContent called with gcode of length %zu", gcode.length()).ToStdString());
+    std::string text = gcode.ToStdString();
+    SetGCodeContent(text.data(), text.size());
+}
+
+void MachineVisualizationPanel::SetGCodeContent(const char* data, size_t size)
+{
+    LOG_INFO(wxString::Format("SetGCodeContent called with gcode of length %zu", size).ToStdString());
     ClearGCode();
-    ParseGCode(gcode);
+    ParseGCode(data, size);
     LOG_INFO(wxString::Format("Parsing complete. %zu path segments generated.", m_gcodeLines.size()).ToStdString());
+    FinishToolpath();
+    StartLevelOfDetail();
+}
+
+void MachineVisualizationPanel::StartLevelOfDetail()
+{
+    if (m_gcodeLines.empty() || !m_boundsValid) return;
+    
+    // The lines are left alone until ClearGCode, which joins the worker first;
+    // until the levels arrive every zoom draws the full-detail path
+    double extent = std::max(m_maxX - m_minX, m_maxY - m_minY);
+    int generation = ++m_previewGeneration;
+    m_previewThread = std::thread([this, extent, generation]() {
+        wxStopWatch timer;
+        auto lod = std::make_shared<ToolpathLOD>();
+        BuildToolpathLOD(m_gcodeLines, extent, *lod);
+        long elapsed = timer.Time();
+        
+        CallAfter([this, lod, generation, elapsed]() {
+            if (generation != m_previewGeneration) return;
+            if (m_previewThread.joinable()) {
+                m_previewThread.join();
+            }
+            SetLevelOfDetail(std::move(*lod), elapsed);
+            InvalidateStaticLayer();
+        });
+    });
+}
+
+void MachineVisualizationPanel::SetLevelOfDetail(ToolpathLOD&& lod, long elapsedMs)
+{
+    m_lod = std::move(lod);
+    m_toolpathRenderer.InvalidateLevels();
+    LOG_INFO(wxString::Format("Toolpath LOD: %zu levels built in %ld ms",
+                             m_lod.getLevels().size(), elapsedMs).ToStdString());
+}
+
+void MachineVisualizationPanel::FinishToolpath()
+{
+    BuildMotionPath();
+    UpdateGLToolpath();
+    if (m_showStock) {
+        StartStockSimulation();
+    }
     ZoomToFit();
-    Refresh();
+    InvalidateStaticLayer();
+}
+
+void MachineVisualizationPanel::SetGCodePreview(std::shared_ptr<const MappedGCodeFile> file)
+{
+    ClearGCode();
+    if (!file || !file->IsOpen()) return;
+    
+    m_currentFilename = wxFileName(wxString::FromUTF8(file->GetPath().c_str())).GetFullName();
+    m_previewRunning = true;
+    int generation = ++m_previewGeneration;
+    
+    // Every segment of a large file would cost gigabytes and parsing it blocks
+    // for minutes; the worker keeps only the merged preview
+    m_previewThread = std::thread([this, file, generation]() {
+        wxStopWatch timer;
+        auto preview = std::make_shared<ToolpathPreview>();
+        PreviewBuilder builder(MAX_PREVIEW_SEGMENTS);
+        
+        GCodeParser parser;
+        parser.enableStatistics(true);
+        parser.enableToolpathGeneration(true);
+        parser.setKeepToolpath(false);
+        parser.setStrictMode(false);
+        parser.setSegmentCallback([&preview, &builder](const ToolpathSegment& segment) {
+            preview->sourceMoves++;
+            builder.Add(ToolpathRenderer::MakeLine(segment));
+        });
+        parser.setProgressCallback([this](int currentLine, int) {
+            if ((currentLine & 4095) == 0 && m_previewCancel) {
+                throw PreviewCancelled();
+            }
+        });
+        
+        try {
+            parser.parseBuffer(file->GetData(), file->GetSize());
+        } catch (const PreviewCancelled&) {
+            return;
+        }
+        
+        preview->lines = std::move(builder.GetLines());
+        preview->statistics = parser.getStatistics();
+        preview->tolerance = builder.GetTolerance();
+        preview->truncated = builder.IsTruncated();
+        if (preview->statistics.boundsValid) {
+            const GCodeStatistics& statistics = preview->statistics;
+            wxStopWatch lodTimer;
+            BuildToolpathLOD(preview->lines, std::max(statistics.maxBounds.x - statistics.minBounds.x,
+                                                      statistics.maxBounds.y - statistics.minBounds.y), preview->lod);
+            preview->lodMs = lodTimer.Time();
+        }
+        long elapsed = timer.Time();
+        
+        CallAfter([this, preview, generation, elapsed]() {
+            if (generation != m_previewGeneration) return;
+            ApplyPreview(*preview, elapsed);
+        });
+    });
+    
+    Refresh(false);
+}
+
+void MachineVisualizationPanel::ApplyPreview(ToolpathPreview& preview, long elapsedMs)
+{
+    // The worker posted this as its last step
+    if (m_previewThread.joinable()) {
+        m_previewThread.join();
+    }
+    m_previewRunning = false;
+    
+    m_gcodeLines = std::move(preview.lines);
+    m_previewSourceMoves = preview.sourceMoves;
+    m_totalLines = preview.statistics.totalLines;
+    
+    const GCodeStatistics& statistics = preview.statistics;
+    if (statistics.boundsValid) {
+        m_minX = static_cast<float>(statistics.minBounds.x);
+        m_maxX = static_cast<float>(statistics.maxBounds.x);
+        m_minY = static_cast<float>(statistics.minBounds.y);
+        m_maxY = static_cast<float>(statistics.maxBounds.y);
+        m_minZ = static_cast<float>(statistics.minBounds.z);
+        m_maxZ = static_cast<float>(statistics.maxBounds.z);
+        m_boundsValid = true;
+    }
+    
+    LOG_INFO(wxString::Format("Toolpath preview: %zu of %zu moves kept (merge distance %.3f) from %d lines in %ld ms",
+                             m_gcodeLines.size(), m_previewSourceMoves, preview.tolerance,
+                             m_totalLines, elapsedMs).ToStdString());
+    if (preview.truncated) {
+        LOG_WARNING(wxString::Format("Toolpath preview stopped at %zu segments; the moves that follow are not shown",
+                                    m_gcodeLines.size()).ToStdString());
+    }
+    
+    SetLevelOfDetail(std::move(preview.lod), preview.lodMs);
+    FinishToolpath();
+}
+
+void MachineVisualizationPanel::StopPreview()
+{
+    m_previewCancel = true;
+    if (m_previewThread.joinable()) {
+        m_previewThread.join();
+    }
+    m_previewCancel = false;
+    m_previewRunning = false;
+    m_previewSourceMoves = 0;
+    ++m_previewGeneration;  // Drops a result already posted
+}
+
+void MachineVisualizationPanel::SetHighlightedLine(int line)
+{
+    if (line == m_highlightedLine) return;
+    m_highlightedLine = line;
+    // The highlight is part of the overlay; the cached layer is only blitted
+    Refresh(false);
 }
 
 void MachineVisualizationPanel::ClearGCode()
 {
+    StopPreview();
     m_gcodeLines.clear();
+    m_gcodeLines.shrink_to_fit();
+    m_lod.clear();
+    m_toolpathRenderer.Invalidate();
+    m_executedSegments = 0;
+    m_motionPredictor.clear();
+    m_motionTimer.Stop();
+    StopStockSimulation();
+    m_stockBitmap = wxNullBitmap;
     m_boundsValid = false;
     m_totalLines = 0;
     m_currentFilename.Clear();
-    Refresh();
+    UpdateGLToolpath();
+    InvalidateStaticLayer();
 }
 
-void MachineVisualizationPanel::UpdateToolPosition(float x, float y, float z)
+void MachineVisualizationPanel::SetView3D(bool enable)
 {
+#ifdef HAVE_GL_TOOLPATH_VIEW
+    if (enable == IsView3D()) return;
+    
+    if (enable) {
+        if (!m_glView) {
+            m_glView = new ToolpathGLView(this);
+            m_glView->SetCloseCallback([this]() {
+                CallAfter([this]() { SetView3D(false); });
+            });
+            UpdateGLToolpath();
+        }
+        m_glView->SetSize(GetClientSize());
+        m_glView->Show();
+        m_glView->SetFocus();
+    } else {
+        m_glView->Hide();
+        SetFocus();
+        InvalidateStaticLayer();
+    }
+#else
+    if (enable) {
+        LOG_WARNING("3D toolpath view is not available in this build");
+    }
+#endif
+}
+
+bool MachineVisualizationPanel::IsView3D() const
+{
+#ifdef HAVE_GL_TOOLPATH_VIEW
+    return m_glView && m_glView->IsShown();
+#else
+    return false;
+#endif
+}
+
+void MachineVisualizationPanel::UpdateGLToolpath()
+{
+#ifdef HAVE_GL_TOOLPATH_VIEW
+    if (!m_glView) return;
+    
+    if (m_boundsValid) {
+        m_glView->SetToolpath(m_gcodeLines, m_minX, m_maxX, m_minY, m_maxY, m_minZ, m_maxZ);
+        m_glView->SetExecutedSegments(m_executedSegments);
+    } else {
+        m_glView->ClearToolpath();
+    }
+#endif
+}
+
+void MachineVisualizationPanel::UpdateToolPosition(float x, float y, float z, float feedRate)
+{
+    // A real report always replaces the predicted position
     m_toolPosition.x = x;
     m_toolPosition.y = y;
     m_toolPosition.z = z;
     m_toolPosition.isValid = true;
     m_toolPosition.lastUpdate = wxDateTime::Now();
     
-    Refresh();
+    MotionPoint reported;
+    reported.x = x;
+    reported.y = y;
+    reported.z = z;
+    if (m_motionPredictor.report(reported, feedRate, MonotonicSeconds())) {
+        if (!m_motionTimer.IsRunning()) {
+            m_motionTimer.Start(MOTION_FRAME_MS);
+        }
+        
+        // Everything before the reported path segment has been cut. Only moves
+        // forward; a rewind or new run goes through ClearExecutedLines().
+        size_t reached = m_motionPathProgress[m_motionPredictor.getSegment()];
+        if (reached > m_executedSegments) {
+            SetExecutedSegments(reached);
+        }
+    } else {
+        m_motionTimer.Stop();
+    }
+    
+    RefreshOverlay();
 }
 
 void MachineVisualizationPanel::ClearToolPosition()
 {
     m_toolPosition.isValid = false;
-    Refresh();
+    m_motionTimer.Stop();
+    RefreshOverlay();
+}
+
+void MachineVisualizationPanel::OnMotionTimer(wxTimerEvent& WXUNUSED(event))
+{
+    MotionPoint predicted;
+    if (!m_toolPosition.isValid || !m_motionPredictor.predict(MonotonicSeconds(), predicted)) {
+        m_motionTimer.Stop();
+        return;
+    }
+    
+    // Nothing moved (end of path or past the extrapolation limit)
+    if (predicted.x == m_toolPosition.x && predicted.y == m_toolPosition.y && predicted.z == m_toolPosition.z) {
+        return;
+    }
+    
+    m_toolPosition.x = predicted.x;
+    m_toolPosition.y = predicted.y;
+    m_toolPosition.z = predicted.z;
+    
+    if (m_showCurrentPosition) {
+        RefreshOverlay();
+    }
+}
+
+void MachineVisualizationPanel::BuildMotionPath()
+{
+    m_motionPredictor.clear();
+    m_motionPathProgress.clear();
+    if (m_gcodeLines.empty()) return;
+    
+    // Arcs are flattened finely enough that the marker stays on the drawn curve
+    const double chordTolerance = 0.01;
+    
+    std::vector<MotionPoint> points;
+    points.reserve(m_gcodeLines.size() + 1);
+    m_motionPathProgress.reserve(m_gcodeLines.size() + 1);
+    
+    for (size_t segment = 0; segment < m_gcodeLines.size(); ++segment) {
+        const GCodeLine& line = m_gcodeLines[segment];
+        if (points.empty() || points.back().x != line.startX || points.back().y != line.startY ||
+            points.back().z != line.startZ) {
+            points.push_back({line.startX, line.startY, line.startZ});
+            m_motionPathProgress.push_back(static_cast<uint32_t>(segment));
+        }
+        
+        if (line.type == GCodeLine::ARC && line.radius > 0) {
+            double startAngle;
+            double sweepAngle = GetArcSweep(line, startAngle);
+            double chordAngle = 2.0 * std::acos(std::max(-1.0, 1.0 - chordTolerance / line.radius));
+            int steps = std::max(1, std::min(4096, static_cast<int>(std::ceil(std::abs(sweepAngle) / chordAngle))));
+            for (int i = 1; i < steps; ++i) {
+                double angle = startAngle + sweepAngle * i / steps;
+                double t = static_cast<double>(i) / steps;
+                points.push_back({static_cast<float>(line.centerX + line.radius * std::cos(angle)),
+                                  static_cast<float>(line.centerY + line.radius * std::sin(angle)),
+                                  static_cast<float>(line.startZ + (line.endZ - line.startZ) * t)});
+                m_motionPathProgress.push_back(static_cast<uint32_t>(segment));
+            }
+        }
+        points.push_back({line.endX, line.endY, line.endZ});
+        m_motionPathProgress.push_back(static_cast<uint32_t>(segment + 1));
+    }
+    
+    m_motionPredictor.setPath(points);
+}
+
+size_t MachineVisualizationPanel::SegmentsThroughLine(int line) const
+{
+    // Segments are generated in line order, so those of lines 1..n are a prefix
+    auto it = std::upper_bound(m_gcodeLines.begin(), m_gcodeLines.end(), line,
+        [](int value, const GCodeLine& segment) { return value < segment.lineNumber; });
+    return static_cast<size_t>(it - m_gcodeLines.begin());
+}
+
+void MachineVisualizationPanel::SetExecutedLines(int lines)
+{
+    SetExecutedSegments(lines > 0 ? SegmentsThroughLine(lines) : 0);
+}
+
+void MachineVisualizationPanel::SetExecutedSegments(size_t executed)
+{
+    executed = std::min(executed, m_gcodeLines.size());
+    if (executed == m_executedSegments) return;
+    
+    size_t first = m_executedSegments;
+    m_executedSegments = executed;
+    
+    // The stock follows the job; back at zero it shows the finished part again
+    if (m_showStock && m_stockThread.joinable()) {
+        SetStockTarget(executed > 0 ? executed : m_gcodeLines.size());
+    }
+    
+#ifdef HAVE_GL_TOOLPATH_VIEW
+    if (m_glView) {
+        m_glView->SetExecutedSegments(executed);
+    }
+#endif
+    
+    // Going backwards (new run, rewind) needs the pending colors back
+    if (executed < first) {
+        InvalidateStaticLayer();
+        return;
+    }
+    
+    RefreshRect(GetStatusInfoRect(), false);
+    
+    // A stale cache is rebuilt with the executed range on the next paint anyway
+    if (!m_staticLayerValid || !m_staticLayer.IsOk() || !m_showToolPath || (m_showStock && m_stockBitmap.IsOk())) return;
+    
+    // Stroke just the newly completed segments into the cache and repaint
+    // the screen area they cover
+    wxRect2DDouble bounds;
+    wxMemoryDC memDC(m_staticLayer);
+    wxGraphicsContext* gc = wxGraphicsContext::Create(memDC);
+    if (!gc) {
+        memDC.SelectObject(wxNullBitmap);
+        InvalidateStaticLayer();
+        return;
+    }
+    ApplyViewTransform(gc);
+    DrawExecutedSegments(gc, first, executed, &bounds);
+    delete gc;
+    memDC.SelectObject(wxNullBitmap);
+    
+    wxPoint2DDouble topLeft = WorldToScreen(bounds.m_x, bounds.m_y + bounds.m_height);
+    wxPoint2DDouble bottomRight = WorldToScreen(bounds.m_x + bounds.m_width, bounds.m_y);
+    
+    // Pen half-width plus antialiasing slack
+    const int margin = 3;
+    wxRect damaged(static_cast<int>(std::floor(topLeft.m_x)) - margin,
+                   static_cast<int>(std::floor(topLeft.m_y)) - margin,
+                   static_cast<int>(std::ceil(bottomRight.m_x - topLeft.m_x)) + 2 * margin + 1,
+                   static_cast<int>(std::ceil(bottomRight.m_y - topLeft.m_y)) + 2 * margin + 1);
+    damaged.Intersect(wxRect(GetClientSize()));
+    if (!damaged.IsEmpty()) {
+        RefreshRect(damaged, false);
+    }
 }
 
 
@@ -141,12 +728,19 @@ void MachineVisualizationPanel::UpdateBounds(float x, float y)
 // Legacy parsing methods removed - now using comprehensive GCodeParser
 
 
-void MachineVisualizationPanel::ParseGCode(const wxString& gcode)
+void MachineVisualizationPanel::ParseGCode(const char* data, size_t size)
 {
     LOG_INFO("ParseGCode started with comprehensive parser.");
     
     // Clear previous visualization data
     m_gcodeLines.clear();
+    m_lod.clear();
+    m_toolpathRenderer.Invalidate();
+    m_executedSegments = 0;
+    m_motionPredictor.clear();
+    m_motionTimer.Stop();
+    StopStockSimulation();
+    m_stockBitmap = wxNullBitmap;
     m_boundsValid = false;
     
     // Create parser instance
@@ -172,8 +766,7 @@ void MachineVisualizationPanel::ParseGCode(const wxString& gcode)
     parser.setStrictMode(false); // Be lenient with non-standard G-code
     
     // Parse the G-code
-    std::string gcodeStd = gcode.ToStdString();
-    bool success = parser.parseString(gcodeStd);
+    bool success = parser.parseBuffer(data, size);
     
     if (!success) {
         LOG_ERROR("G-code parsing failed with errors");
@@ -189,50 +782,7 @@ void MachineVisualizationPanel::ParseGCode(const wxString& gcode)
     
     // Convert toolpath segments to visualization lines
     for (const auto& segment : toolpath) {
-        GCodeLine gcLine;
-        gcLine.startX = static_cast<float>(segment.start.x);
-        gcLine.startY = static_cast<float>(segment.start.y);
-        gcLine.startZ = static_cast<float>(segment.start.z);
-        gcLine.endX = static_cast<float>(segment.end.x);
-        gcLine.endY = static_cast<float>(segment.end.y);
-        gcLine.endZ = static_cast<float>(segment.end.z);
-        
-        // Set color and style based on segment type
-        switch (segment.type) {
-            case ToolpathSegment::RAPID:
-                gcLine.type = GCodeLine::LINE;
-                gcLine.isRapid = true;
-                gcLine.color = wxColour(255, 0, 0); // Red for rapid moves
-                break;
-            case ToolpathSegment::LINEAR:
-                gcLine.type = GCodeLine::LINE;
-                gcLine.isRapid = false;
-                gcLine.color = wxColour(0, 100, 255); // Blue for cutting moves
-                break;
-            case ToolpathSegment::ARC_CW:
-                gcLine.type = GCodeLine::ARC;
-                gcLine.centerX = static_cast<float>(segment.center.x);
-                gcLine.centerY = static_cast<float>(segment.center.y);
-                gcLine.radius = static_cast<float>(segment.radius);
-                gcLine.isClockwise = true;
-                gcLine.isRapid = false;
-                gcLine.color = wxColour(0, 150, 0); // Green for arcs
-                break;
-            case ToolpathSegment::ARC_CCW:
-                gcLine.type = GCodeLine::ARC;
-                gcLine.centerX = static_cast<float>(segment.center.x);
-                gcLine.centerY = static_cast<float>(segment.center.y);
-                gcLine.radius = static_cast<float>(segment.radius);
-                gcLine.isClockwise = false;
-                gcLine.isRapid = false;
-                gcLine.color = wxColour(0, 150, 0); // Green for arcs
-                break;
-            case ToolpathSegment::DRILL_CYCLE:
-                gcLine.type = GCodeLine::LINE;
-                gcLine.isRapid = false;
-                gcLine.color = wxColour(255, 165, 0); // Orange for drilling
-                break;
-        }
+        GCodeLine gcLine = ToolpathRenderer::MakeLine(segment);
         
         m_gcodeLines.push_back(gcLine);
         
@@ -287,29 +837,42 @@ void MachineVisualizationPanel::OnPaint(wxPaintEvent& event)
 {
     wxPaintDC dc(this);
     
-    // Create graphics context
+    wxSize clientSize = GetClientSize();
+    if (clientSize.x <= 0 || clientSize.y <= 0) return;
+    
+    if (!m_staticLayerValid || !m_staticLayer.IsOk() || m_staticLayer.GetSize() != clientSize) {
+        RebuildStaticLayer(clientSize);
+    }
+    
+    // Copy only the damaged part of the cached layer
+    wxMemoryDC layerDC(m_staticLayer);
+    for (wxRegionIterator it(GetUpdateRegion()); it; ++it) {
+        wxRect rect = it.GetRect();
+        dc.Blit(rect.x, rect.y, rect.width, rect.height, &layerDC, rect.x, rect.y);
+    }
+    layerDC.SelectObject(wxNullBitmap);
+    
+    // Draw the overlay on top
     wxGraphicsContext* gc = wxGraphicsContext::Create(dc);
     if (!gc) return;
     
     try {
-        // Clear background
-        DrawBackground(gc);
-        
-        // Set up coordinate system (flip Y axis for standard CNC orientation)
-        wxSize clientSize = GetClientSize();
-        gc->Translate(clientSize.x / 2.0 + m_viewOffsetX, clientSize.y / 2.0 - m_viewOffsetY);
-        gc->Scale(m_zoomFactor, -m_zoomFactor); // Flip Y axis
+        if (m_highlightedLine > 0) {
+            gc->PushState();
+            ApplyViewTransform(gc);
+            DrawHighlightedLine(gc);
+            gc->PopState();
+        }
         
-        // Draw components in order
-        if (m_showWorkspaceBounds) DrawWorkspaceBounds(gc);
-        if (m_showGrid) DrawGrid(gc);
-        if (m_showOrigin) DrawOrigin(gc);
-        if (m_showToolPath) DrawGCodePath(gc);
-        if (m_showCurrentPosition) DrawCurrentPosition(gc);
+        m_toolMarkerRect = wxRect();
+        if (m_showCurrentPosition && m_toolPosition.isValid) {
+            gc->PushState();
+            ApplyViewTransform(gc);
+            DrawCurrentPosition(gc);
+            gc->PopState();
+            m_toolMarkerRect = GetToolMarkerRect();
+        }
         
-        // Reset transformation for status info
-        gc->ResetClip();
-        gc->SetTransform(gc->CreateMatrix());
         DrawStatusInfo(gc);
         
     } catch (const std::exception& e) {
@@ -319,6 +882,98 @@ void MachineVisualizationPanel::OnPaint(wxPaintEvent& event)
     delete gc;
 }
 
+void MachineVisualizationPanel::RebuildStaticLayer(const wxSize& size)
+{
+    if (!m_staticLayer.IsOk() || m_staticLayer.GetSize() != size) {
+        m_staticLayer.Create(size);
+    }
+    
+    wxStopWatch renderTimer;
+    
+    wxMemoryDC memDC(m_staticLayer);
+    wxGraphicsContext* gc = wxGraphicsContext::Create(memDC);
+    if (gc) {
+        try {
+            // Clear background
+            DrawBackground(gc);
+            
+            ApplyViewTransform(gc);
+            
+            // Draw components in order
+            if (m_showWorkspaceBounds) DrawWorkspaceBounds(gc);
+            if (m_showGrid) DrawGrid(gc);
+            if (m_showOrigin) DrawOrigin(gc);
+            if (m_showStock && m_stockBitmap.IsOk()) {
+                DrawStock(gc);
+            } else if (m_showToolPath) {
+                DrawGCodePath(gc);
+                DrawExecutedSegments(gc, 0, m_executedSegments);
+            }
+            
+        } catch (const std::exception& e) {
+            LOG_ERROR("Static layer render error: " + std::string(e.what()));
+        }
+        delete gc;
+    }
+    memDC.SelectObject(wxNullBitmap);
+    
+    m_staticLayerValid = true;
+    m_lastLayerRenderMs = renderTimer.Time();
+}
+
+void MachineVisualizationPanel::InvalidateStaticLayer()
+{
+    m_staticLayerValid = false;
+    Refresh();
+}
+
+void MachineVisualizationPanel::ApplyViewTransform(wxGraphicsContext* gc)
+{
+    // Set up coordinate system (flip Y axis for standard CNC orientation)
+    wxSize clientSize = GetClientSize();
+    gc->Translate(clientSize.x / 2.0 + m_viewOffsetX, clientSize.y / 2.0 - m_viewOffsetY);
+    gc->Scale(m_zoomFactor, -m_zoomFactor); // Flip Y axis
+}
+
+wxPoint2DDouble MachineVisualizationPanel::WorldToScreen(float x, float y) const
+{
+    // Same mapping as ApplyViewTransform
+    wxSize clientSize = GetClientSize();
+    return wxPoint2DDouble(clientSize.x / 2.0 + m_viewOffsetX + x * m_zoomFactor,
+                           clientSize.y / 2.0 - m_viewOffsetY - y * m_zoomFactor);
+}
+
+wxRect MachineVisualizationPanel::GetToolMarkerRect() const
+{
+    if (!m_showCurrentPosition || !m_toolPosition.isValid) return wxRect();
+    
+    // Crosshair is 10px each way plus half the 3px pen, with a pixel of slack for antialiasing
+    const int extent = 13;
+    wxPoint2DDouble center = WorldToScreen(m_toolPosition.x, m_toolPosition.y);
+    return wxRect(static_cast<int>(std::floor(center.m_x)) - extent,
+                  static_cast<int>(std::floor(center.m_y)) - extent,
+                  2 * extent + 1, 2 * extent + 1);
+}
+
+wxRect MachineVisualizationPanel::GetStatusInfoRect() const
+{
+    return wxRect(0, 0, GetClientSize().x, STATUS_TEXT_TOP + STATUS_MAX_LINES * STATUS_LINE_HEIGHT + 5);
+}
+
+void MachineVisualizationPanel::RefreshOverlay()
+{
+    // Erase the marker where it was last drawn and draw it at its new place;
+    // the cached layer under it is blitted back, nothing is re-rendered
+    if (!m_toolMarkerRect.IsEmpty()) {
+        RefreshRect(m_toolMarkerRect, false);
+    }
+    wxRect marker = GetToolMarkerRect();
+    if (!marker.IsEmpty()) {
+        RefreshRect(marker, false);
+    }
+    RefreshRect(GetStatusInfoRect(), false);
+}
+
 void MachineVisualizationPanel::DrawBackground(wxGraphicsContext* gc)
 {
     wxSize size = GetClientSize();
@@ -390,56 +1045,20 @@ void MachineVisualizationPanel::DrawGCodePath(wxGraphicsContext* gc)
 {
     if (m_gcodeLines.empty()) return;
     
-    for (const auto& line : m_gcodeLines) {
-        gc->SetPen(wxPen(line.color, line.isRapid ? 1 : 2));
-        
-        if (line.type == GCodeLine::LINE) {
-            // Draw straight line
-            gc->StrokeLine(line.startX, line.startY, line.endX, line.endY);
-        } else if (line.type == GCodeLine::ARC) {
-            // Draw arc
-            if (line.radius > 0) {
-                // Calculate start and end angles
-                double startAngle = std::atan2(line.startY - line.centerY, line.startX - line.centerX);
-                double endAngle = std::atan2(line.endY - line.centerY, line.endX - line.centerX);
-                
-                // Convert from radians to degrees for wxWidgets
-                double startDegrees = startAngle * 180.0 / M_PI;
-                double endDegrees = endAngle * 180.0 / M_PI;
-                
-                // Calculate sweep angle based on direction
-                double sweepAngle;
-                if (line.isClockwise) {
-                    // Clockwise direction
-                    sweepAngle = startDegrees - endDegrees;
-                    if (sweepAngle <= 0) sweepAngle += 360;
-                    sweepAngle = -sweepAngle; // Negative for clockwise
-                } else {
-                    // Counter-clockwise direction
-                    sweepAngle = endDegrees - startDegrees;
-                    if (sweepAngle <= 0) sweepAngle += 360;
-                }
-                
-                // Handle full circles
-                if (std::abs(line.startX - line.endX) < 0.001f && std::abs(line.startY - line.endY) < 0.001f) {
-                    sweepAngle = line.isClockwise ? -360.0 : 360.0;
-                }
-                
-                // Create arc path
-                wxGraphicsPath path = gc->CreatePath();
-                path.AddArc(line.centerX, line.centerY, line.radius, 
-                           startAngle, startAngle + sweepAngle * M_PI / 180.0, 
-                           !line.isClockwise);
-                
-                gc->StrokePath(path);
-            } else {
-                // Fallback to line if radius is invalid
-                gc->StrokeLine(line.startX, line.startY, line.endX, line.endY);
-            }
-        }
+    bool batched = m_toolpathRenderer.IsBatched();
+    wxStopWatch drawTimer;
+    m_toolpathRenderer.Draw(gc, m_zoomFactor);
+    if (!batched && m_toolpathRenderer.IsBatched()) {
+        LOG_INFO(wxString::Format("Toolpath batched and stroked: %zu segments in %ld ms",
+                                 m_gcodeLines.size(), drawTimer.Time()).ToStdString());
     }
 }
 
+void MachineVisualizationPanel::DrawExecutedSegments(wxGraphicsContext* gc, size_t first, size_t last, wxRect2DDouble* bounds)
+{
+    m_toolpathRenderer.DrawExecuted(gc, first, last, bounds);
+}
+
 void MachineVisualizationPanel::DrawCurrentPosition(wxGraphicsContext* gc)
 {
     if (!m_toolPosition.isValid) return;
@@ -460,13 +1079,39 @@ void MachineVisualizationPanel::DrawCurrentPosition(wxGraphicsContext* gc)
     gc->DrawEllipse(x - size/2, y - size/2, size, size);
 }
 
+void MachineVisualizationPanel::DrawHighlightedLine(wxGraphicsContext* gc)
+{
+    if (m_highlightedLine <= 0) return;
+    
+    size_t first = SegmentsThroughLine(m_highlightedLine - 1);
+    size_t last = SegmentsThroughLine(m_highlightedLine);
+    if (first >= last) return;
+    
+    wxGraphicsPath path = gc->CreatePath();
+    for (size_t i = first; i < last; ++i) {
+        const GCodeLine& segment = m_gcodeLines[i];
+        path.MoveToPoint(segment.startX, segment.startY);
+        if (segment.type == GCodeLine::ARC && segment.radius > 0) {
+            double startAngle;
+            double sweepAngle = GetArcSweep(segment, startAngle);
+            path.AddArc(segment.centerX, segment.centerY, segment.radius,
+                        startAngle, startAngle + sweepAngle, !segment.isClockwise);
+        } else {
+            path.AddLineToPoint(segment.endX, segment.endY);
+        }
+    }
+    
+    gc->SetPen(wxPen(wxColour(255, 0, 200), 3));  // Magenta
+    gc->StrokePath(path);
+}
+
 void MachineVisualizationPanel::DrawStatusInfo(wxGraphicsContext* gc)
 {
     wxSize size = GetClientSize();
     gc->SetFont(wxFont(10, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL), wxColour(0, 0, 0));
     
-    int y = 10;
-    const int lineHeight = 15;
+    int y = STATUS_TEXT_TOP;
+    const int lineHeight = STATUS_LINE_HEIGHT;
     
     // File info
     if (!m_currentFilename.IsEmpty()) {
@@ -474,8 +1119,20 @@ void MachineVisualizationPanel::DrawStatusInfo(wxGraphicsContext* gc)
         y += lineHeight;
     }
     
-    if (m_totalLines > 0) {
-        gc->DrawText(wxString::Format("Lines: %d, Segments: %zu", m_totalLines, m_gcodeLines.size()), 10, y);
+    if (m_previewRunning) {
+        gc->DrawText("Building preview...", 10, y);
+        y += lineHeight;
+    } else if (m_previewSourceMoves > 0) {
+        gc->DrawText(wxString::Format("Lines: %d, Segments: %zu (preview of %zu moves)", m_totalLines,
+                                     m_gcodeLines.size(), m_previewSourceMoves), 10, y);
+        y += lineHeight;
+    } else if (m_totalLines > 0) {
+        if (m_executedSegments > 0) {
+            gc->DrawText(wxString::Format("Lines: %d, Segments: %zu (%zu executed)", m_totalLines,
+                                         m_gcodeLines.size(), m_executedSegments), 10, y);
+        } else {
+            gc->DrawText(wxString::Format("Lines: %d, Segments: %zu", m_totalLines, m_gcodeLines.size()), 10, y);
+        }
         y += lineHeight;
     }
     
@@ -496,6 +1153,16 @@ void MachineVisualizationPanel::DrawStatusInfo(wxGraphicsContext* gc)
     // View info
     gc->DrawText(wxString::Format("Zoom: %.1f%% View: %.1f,%.1f", 
                                  m_zoomFactor * 100, m_viewOffsetX, m_viewOffsetY), 10, y);
+    y += lineHeight;
+    
+    // Time spent rendering the cached layer, and the detail level it used
+    int level = m_toolpathRenderer.GetLastLevel();
+    if (level >= 0 && level < static_cast<int>(m_lod.getLevels().size())) {
+        gc->DrawText(wxString::Format("Render: %ld ms (LOD %d, %zu points)", m_lastLayerRenderMs, level,
+                                     m_lod.getLevels()[level].pointCount), 10, y);
+    } else {
+        gc->DrawText(wxString::Format("Render: %ld ms", m_lastLayerRenderMs), 10, y);
+    }
 }
 
 void MachineVisualizationPanel::ZoomToFit()
@@ -508,51 +1175,278 @@ void MachineVisualizationPanel::ZoomToFit()
     LOG_INFO(wxString::Format("ZoomToFit: FORCED zoom to 100%%, offset to -400,-300. Bounds X:%.2f-%.2f Y:%.2f-%.2f", 
                              m_minX, m_maxX, m_minY, m_maxY).ToStdString());
     
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 void MachineVisualizationPanel::ZoomIn()
 {
     m_zoomFactor *= 1.5f;
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 void MachineVisualizationPanel::ZoomOut()
 {
     m_zoomFactor /= 1.5f;
     if (m_zoomFactor < 0.01f) m_zoomFactor = 0.01f;
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 void MachineVisualizationPanel::ResetView()
 {
     m_zoomFactor = 1.0f;
     m_viewOffsetX = m_viewOffsetY = 0.0f;
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 void MachineVisualizationPanel::SetShowGrid(bool show)
 {
     m_showGrid = show;
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 void MachineVisualizationPanel::SetShowOrigin(bool show)
 {
     m_showOrigin = show;
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 void MachineVisualizationPanel::SetShowToolPath(bool show)
 {
     m_showToolPath = show;
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 void MachineVisualizationPanel::SetShowCurrentPosition(bool show)
 {
     m_showCurrentPosition = show;
-    Refresh();
+    RefreshOverlay();
+}
+
+void MachineVisualizationPanel::SetShowStock(bool show)
+{
+    if (m_showStock == show) return;
+    m_showStock = show;
+    
+    if (show) {
+        StartStockSimulation();
+    } else {
+        StopStockSimulation();
+        m_stockBitmap = wxNullBitmap;
+    }
+    InvalidateStaticLayer();
+}
+
+void MachineVisualizationPanel::StopStockSimulation()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stockMutex);
+        m_stockCancel = true;
+    }
+    m_stockWake.notify_one();
+    if (m_stockThread.joinable()) {
+        m_stockThread.join();
+    }
+    m_stockCancel = false;
+}
+
+void MachineVisualizationPanel::SetStockTarget(size_t segments)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stockMutex);
+        m_stockTarget = segments;
+    }
+    m_stockWake.notify_one();
+}
+
+void MachineVisualizationPanel::StartStockSimulation()
+{
+    StopStockSimulation();
+    m_stockBitmap = wxNullBitmap;
+    if (m_gcodeLines.empty() || !m_boundsValid) return;
+    
+    JobSettings job = StateManager::getInstance().getCurrentJobSettings();
+    StockTool tool = StockTool::fromJobSettings(job.toolType, job.toolDiameter);
+    
+    // Cutting moves in program order, arcs flattened to within half a cell.
+    // Rapids travel above the stock and are left out; segmentMoves[s] is the
+    // number of moves before segment s.
+    std::vector<StockMove> moves;
+    std::vector<size_t> segmentMoves;
+    moves.reserve(m_gcodeLines.size());
+    segmentMoves.reserve(m_gcodeLines.size() + 1);
+    float lowestZ = 0.0f;
+    for (const auto& line : m_gcodeLines) {
+        segmentMoves.push_back(moves.size());
+        if (line.renderClass == GCodeLine::RENDER_RAPID) continue;
+        
+        lowestZ = std::min(lowestZ, std::min(line.startZ, line.endZ));
+        if (line.type == GCodeLine::ARC && line.radius > 0) {
+            double startAngle;
+            double sweepAngle = GetArcSweep(line, startAngle);
+            double chordAngle = 2.0 * std::acos(std::max(-1.0, 1.0 - STOCK_RESOLUTION / 2.0 / line.radius));
+            int steps = std::max(1, std::min(4096, static_cast<int>(std::ceil(std::abs(sweepAngle) / chordAngle))));
+            float x = line.startX, y = line.startY, z = line.startZ;
+            for (int i = 1; i <= steps; ++i) {
+                double angle = startAngle + sweepAngle * i / steps;
+                float nextX = (i == steps) ? line.endX : static_cast<float>(line.centerX + line.radius * std::cos(angle));
+                float nextY = (i == steps) ? line.endY : static_cast<float>(line.centerY + line.radius * std::sin(angle));
+                float nextZ = line.startZ + (line.endZ - line.startZ) * i / steps;
+                moves.push_back({x, y, z, nextX, nextY, nextZ});
+                x = nextX;
+                y = nextY;
+                z = nextZ;
+            }
+        } else {
+            moves.push_back({line.startX, line.startY, line.startZ, line.endX, line.endY, line.endZ});
+        }
+    }
+    segmentMoves.push_back(moves.size());
+    
+    double margin = tool.diameter / 2.0 + STOCK_RESOLUTION;
+    double minX = m_minX - margin, minY = m_minY - margin;
+    double maxX = m_maxX + margin, maxY = m_maxY + margin;
+    int generation = ++m_stockGeneration;
+    
+    // The finished part until a job runs, then the cuts made so far
+    m_stockTarget = m_executedSegments > 0 ? m_executedSegments : m_gcodeLines.size();
+    
+    m_stockThread = std::thread([this, moves = std::move(moves), segmentMoves = std::move(segmentMoves),
+                                 tool, lowestZ, minX, minY, maxX, maxY, generation]() {
+        wxStopWatch timer;
+        
+        // Z0 at the stock surface, the usual work zero. Colors are scaled to
+        // the program's lowest Z so patches rendered earlier stay valid.
+        StockSimulator simulator;
+        simulator.setTool(tool);
+        double resolution = 0.0;
+        auto restart = [&]() {
+            resolution = simulator.reset(minX, minY, maxX, maxY, STOCK_RESOLUTION, 0.0f);
+            simulator.setShadeMinZ(lowestZ);
+        };
+        restart();
+        
+        size_t cutMoves = 0;
+        bool whole = true;  // Next image covers the whole grid
+        bool logged = false;
+        while (true) {
+            size_t targetMoves;
+            {
+                std::unique_lock<std::mutex> lock(m_stockMutex);
+                m_stockWake.wait(lock, [&]() {
+                    return m_stockCancel || whole || segmentMoves[m_stockTarget] != cutMoves;
+                });
+                if (m_stockCancel) return;
+                targetMoves = segmentMoves[m_stockTarget];
+            }
+            
+            // Rewound (a new run of the job): start again from uncut stock
+            if (targetMoves < cutMoves) {
+                restart();
+                cutMoves = 0;
+                whole = true;
+            }
+            
+            // A slice at a time, so the image fills in as the sweep advances
+            size_t end = std::min(targetMoves, cutMoves + STOCK_CHUNK_MOVES);
+            StockRect dirty = simulator.cut(moves, cutMoves, end);
+            cutMoves = end;
+            
+            StockRect rect;
+            if (whole) {
+                rect.x1 = simulator.getWidth();
+                rect.y1 = simulator.getHeight();
+            } else if (!dirty.empty()) {
+                rect.x0 = std::max(dirty.x0 - 1, 0);
+                rect.y0 = std::max(dirty.y0 - 1, 0);
+                rect.x1 = std::min(dirty.x1 + 1, simulator.getWidth());
+                rect.y1 = std::min(dirty.y1 + 1, simulator.getHeight());
+            }
+            bool done = cutMoves == moves.size() && !logged;
+            logged = logged || done;
+            if (rect.empty() && !done) continue;
+            
+            auto image = std::make_shared<wxImage>(std::max(rect.x1 - rect.x0, 1), std::max(rect.y1 - rect.y0, 1), false);
+            if (!rect.empty()) {
+                simulator.renderShaded(image->GetData(), rect);
+            }
+            bool fullImage = whole;
+            whole = false;
+            long elapsed = timer.Time();
+            size_t moveCount = moves.size();
+            
+            CallAfter([this, image, rect, fullImage, generation, done, elapsed, moveCount, minX, minY, resolution]() {
+                if (generation != m_stockGeneration || !m_showStock) return;
+                
+                if (fullImage) {
+                    // Cells are centered on the grid points
+                    m_stockBitmap = wxBitmap(*image);
+                    m_stockMinX = minX - resolution / 2.0;
+                    m_stockMinY = minY - resolution / 2.0;
+                    m_stockWidth = image->GetWidth() * resolution;
+                    m_stockHeight = image->GetHeight() * resolution;
+                    InvalidateStaticLayer();
+                } else if (!rect.empty()) {
+                    UpdateStockCells(*image, rect.x0, rect.y0);
+                }
+                
+                if (done) {
+                    LOG_INFO(wxString::Format("Stock simulation: %zu moves on a %dx%d grid (%.2f mm) in %ld ms",
+                                             moveCount, static_cast<int>(m_stockBitmap.GetWidth()),
+                                             static_cast<int>(m_stockBitmap.GetHeight()), resolution, elapsed).ToStdString());
+                }
+            });
+        }
+    });
+}
+
+void MachineVisualizationPanel::UpdateStockCells(const wxImage& patch, int cellX, int cellY)
+{
+    if (!m_stockBitmap.IsOk()) return;
+    
+    wxBitmap bitmap(patch);
+    {
+        wxMemoryDC stockDC(m_stockBitmap);
+        stockDC.DrawBitmap(bitmap, cellX, cellY);
+    }
+    
+    // A stale cache is rebuilt from the updated bitmap on the next paint
+    if (!m_staticLayerValid || !m_staticLayer.IsOk()) return;
+    
+    // Draw the patch into the cache and repaint just the screen area it covers
+    double cellSize = m_stockWidth / m_stockBitmap.GetWidth();
+    double x = m_stockMinX + cellX * cellSize;
+    double y = m_stockMinY + cellY * cellSize;
+    double width = patch.GetWidth() * cellSize;
+    double height = patch.GetHeight() * cellSize;
+    
+    wxMemoryDC memDC(m_staticLayer);
+    wxGraphicsContext* gc = wxGraphicsContext::Create(memDC);
+    if (!gc) {
+        memDC.SelectObject(wxNullBitmap);
+        InvalidateStaticLayer();
+        return;
+    }
+    ApplyViewTransform(gc);
+    gc->DrawBitmap(bitmap, x, y, width, height);
+    delete gc;
+    memDC.SelectObject(wxNullBitmap);
+    
+    wxPoint2DDouble topLeft = WorldToScreen(static_cast<float>(x), static_cast<float>(y + height));
+    wxPoint2DDouble bottomRight = WorldToScreen(static_cast<float>(x + width), static_cast<float>(y));
+    wxRect damaged(static_cast<int>(std::floor(topLeft.m_x)) - 1,
+                   static_cast<int>(std::floor(topLeft.m_y)) - 1,
+                   static_cast<int>(std::ceil(bottomRight.m_x - topLeft.m_x)) + 3,
+                   static_cast<int>(std::ceil(bottomRight.m_y - topLeft.m_y)) + 3);
+    damaged.Intersect(wxRect(GetClientSize()));
+    if (!damaged.IsEmpty()) {
+        RefreshRect(damaged, false);
+    }
+}
+
+void MachineVisualizationPanel::DrawStock(wxGraphicsContext* gc)
+{
+    // Image row 0 is the lowest Y, which the flipped view transform puts at the bottom
+    gc->DrawBitmap(m_stockBitmap, m_stockMinX, m_stockMinY, m_stockWidth, m_stockHeight);
 }
 
 void MachineVisualizationPanel::SetWorkspaceSize(float width, float height, float depth)
@@ -560,7 +1454,7 @@ void MachineVisualizationPanel::SetWorkspaceSize(float width, float height, floa
     m_workspaceWidth = width;
     m_workspaceHeight = height;
     m_workspaceDepth = depth;
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 void MachineVisualizationPanel::SetWorkspaceFromMachine(bool hasConnection, float minX, float maxX, float minY, float maxY, float minZ, float maxZ)
@@ -580,13 +1474,19 @@ void MachineVisualizationPanel::SetWorkspaceFromMachine(bool hasConnection, floa
         LOG_INFO("Workspace bounds hidden (no machine connection or invalid dimensions)");
     }
     
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 // Event handlers
 void MachineVisualizationPanel::OnSize(wxSizeEvent& event)
 {
-    Refresh();
+#ifdef HAVE_GL_TOOLPATH_VIEW
+    if (m_glView) {
+        m_glView->SetSize(GetClientSize());
+    }
+#endif
+
+    InvalidateStaticLayer();
     event.Skip();
 }
 
@@ -596,7 +1496,7 @@ void MachineVisualizationPanel::OnMouseWheel(wxMouseEvent& event)
     m_zoomFactor *= delta;
     if (m_zoomFactor < 0.01f) m_zoomFactor = 0.01f;
     if (m_zoomFactor > 100.0f) m_zoomFactor = 100.0f;
-    Refresh();
+    InvalidateStaticLayer();
 }
 
 void MachineVisualizationPanel::OnMouseDown(wxMouseEvent& event)
@@ -618,7 +1518,7 @@ void MachineVisualizationPanel::OnMouseMove(wxMouseEvent& event)
         m_viewOffsetY += delta.y;
         
         m_lastMousePos = currentPos;
-        Refresh();
+        InvalidateStaticLayer();
     }
 }
 
@@ -649,6 +1549,14 @@ void MachineVisualizationPanel::OnKeyDown(wxKeyEvent& event)
         case '_':
             ZoomOut();
             break;
+        case 'V':
+        case 'v':
+            SetView3D(true);
+            break;
+        case 'S':
+        case 's':
+            SetShowStock(!m_showStock);
+            break;
         default:
             event.Skip();
             break;
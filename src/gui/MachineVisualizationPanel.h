@@ -10,27 +10,21 @@
 #include <wx/dc.h>
 #include <wx/dcclient.h>
 #include <wx/graphics.h>
+#include <wx/bitmap.h>
 #include <vector>
 #include <string>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include "core/ToolpathLOD.h"
+#include "core/MotionPredictor.h"
+#include "ToolpathRenderer.h"
 
-struct GCodeLine {
-    enum Type {
-        LINE,
-        ARC
-    };
-    
-    Type type = LINE;
-    float startX, startY, startZ;
-    float endX, endY, endZ;
-    
-    // Arc-specific data
-    float centerX = 0.0f, centerY = 0.0f;
-    float radius = 0.0f;
-    bool isClockwise = true;
-    
-    bool isRapid; // G0 rapid move vs G1 feed move
-    wxColour color;
-};
+class ToolpathGLView;
+
+class MappedGCodeFile;
 
 struct ToolPosition {
     float x, y, z;
@@ -47,12 +41,31 @@ public:
     // G-code visualization
     void LoadGCodeFile(const wxString& filename);
     void SetGCodeContent(const wxString& gcode);
+    // Parses text in place without converting it to a wxString
+    void SetGCodeContent(const char* data, size_t size);
+    // Large (memory-mapped) files: parsed on a worker thread into a preview in
+    // which runs of short moves are merged, so the view never holds more than
+    // a bounded number of segments. The view is empty until it is ready.
+    void SetGCodePreview(std::shared_ptr<const MappedGCodeFile> file);
     void ClearGCode();
     
-    // Machine position updates
-    void UpdateToolPosition(float x, float y, float z);
+    // Segments of the given program line (1-based, 0 for none) are drawn
+    // highlighted on top of the toolpath, e.g. for the editor's caret line
+    void SetHighlightedLine(int line);
+    
+    // Machine position updates. feedRate is the reported feed (status FS field);
+    // while it is non-zero the marker is advanced along the program path at
+    // display rate until the next report
+    void UpdateToolPosition(float x, float y, float z, float feedRate = 0.0f);
     void ClearToolPosition();
     
+    // Execution progress: the first 'lines' program lines have been acknowledged
+    // by the controller. Segments up to there are drawn in the executed color;
+    // only the range completed since the last call is drawn. Status reports that
+    // lie on the path (UpdateToolPosition) advance it as well.
+    void SetExecutedLines(int lines);
+    void ClearExecutedLines() { SetExecutedLines(0); }
+    
     // View controls
     void ZoomToFit();
     void ZoomIn();
@@ -62,12 +75,20 @@ public:
     void SetShowOrigin(bool show);
     void SetShowToolPath(bool show);
     void SetShowCurrentPosition(bool show);
+    // Simulated stock (heightmap) instead of the toolpath lines; computed in
+    // the background with the current job's tool and shown progressively
+    void SetShowStock(bool show);
+    bool IsShowStock() const { return m_showStock; }
     
     // Machine workspace settings
     void SetWorkspaceSize(float width, float height, float depth);
     void SetWorkspaceFromMachine(bool hasConnection, float minX = 0, float maxX = 0, float minY = 0, float maxY = 0, float minZ = 0, float maxZ = 0);
-    void HideWorkspaceBounds() { m_showWorkspaceBounds = false; Refresh(); }
-    void ShowWorkspaceBounds() { m_showWorkspaceBounds = true; Refresh(); }
+    // Optional OpenGL 3D view (only when built with HAVE_GL_TOOLPATH_VIEW)
+    void SetView3D(bool enable);
+    bool IsView3D() const;
+    
+    void HideWorkspaceBounds() { m_showWorkspaceBounds = false; InvalidateStaticLayer(); }
+    void ShowWorkspaceBounds() { m_showWorkspaceBounds = true; InvalidateStaticLayer(); }
 
 private:
     // Event handlers
@@ -78,13 +99,52 @@ private:
     void OnMouseMove(wxMouseEvent& event);
     void OnMouseUp(wxMouseEvent& event);
     void OnKeyDown(wxKeyEvent& event);
+    void OnMotionTimer(wxTimerEvent& event);
     
     // G-code parsing
-    void ParseGCode(const wxString& gcode);
+    void ParseGCode(const char* data, size_t size);
     void AddLineSegment(float x, float y, bool isRapid);
     void AddArcSegments(float x, float y, float i, float j, bool isClockwise);
     void UpdateBounds(float x, float y);
     
+    // Static layer cache (background, grid, origin, workspace and toolpath)
+    // Rebuilt only when the program, view or visible layers change; tool
+    // position updates repaint just the overlay over a blit of the cache
+    void InvalidateStaticLayer();
+    void RebuildStaticLayer(const wxSize& size);
+    void ApplyViewTransform(wxGraphicsContext* gc);
+    
+    // Simplified toolpath levels for zoomed-out views, built on the parse
+    // worker; their paths are created the first time a level is drawn
+    void StartLevelOfDetail();
+    void SetLevelOfDetail(ToolpathLOD&& lod, long elapsedMs);
+    // Executed segments are stroked over the cached layer in place, at the
+    // detail level of the last render
+    void SetExecutedSegments(size_t executed);
+    void DrawExecutedSegments(wxGraphicsContext* gc, size_t first, size_t last, wxRect2DDouble* bounds = nullptr);
+    void BuildMotionPath();
+    // Segments produced by program lines [1, line]
+    size_t SegmentsThroughLine(int line) const;
+    // Derived data (motion path, 3D view, stock) for new m_gcodeLines
+    void FinishToolpath();
+    
+    // Large-file preview worker
+    struct ToolpathPreview;
+    void ApplyPreview(ToolpathPreview& preview, long elapsedMs);
+    void StopPreview();
+    
+    // Stock simulation runs on its own thread, cutting up to a target segment
+    // and posting shaded images of the cells each slice changed
+    void StartStockSimulation();
+    void StopStockSimulation();
+    void SetStockTarget(size_t segments);
+    void UpdateStockCells(const wxImage& patch, int cellX, int cellY);
+    void DrawStock(wxGraphicsContext* gc);
+    
+    wxRect GetToolMarkerRect() const;
+    wxRect GetStatusInfoRect() const;
+    void RefreshOverlay();
+    
     // Drawing methods
     void DrawBackground(wxGraphicsContext* gc);
     void DrawGrid(wxGraphicsContext* gc);
@@ -92,11 +152,12 @@ private:
     void DrawWorkspaceBounds(wxGraphicsContext* gc);
     void DrawGCodePath(wxGraphicsContext* gc);
     void DrawCurrentPosition(wxGraphicsContext* gc);
+    void DrawHighlightedLine(wxGraphicsContext* gc);
     void DrawCoordinateSystem(wxGraphicsContext* gc);
     void DrawStatusInfo(wxGraphicsContext* gc);
     
     // Coordinate transformation
-    wxPoint2DDouble WorldToScreen(float x, float y);
+    wxPoint2DDouble WorldToScreen(float x, float y) const;
     wxPoint2DDouble ScreenToWorld(wxPoint screenPoint);
     void UpdateTransform();
     
@@ -113,6 +174,52 @@ private:
     bool m_showCurrentPosition;
     bool m_showWorkspaceBounds;
     
+    // Cached static layer
+    wxBitmap m_staticLayer;
+    bool m_staticLayerValid;
+    wxRect m_toolMarkerRect;  // Screen area of the last drawn tool marker
+    long m_lastLayerRenderMs;
+    
+    // Strokes m_gcodeLines, or the m_lod level matching the zoom, with the
+    // same code as offscreen images
+    ToolpathRenderer m_toolpathRenderer;
+    ToolpathLOD m_lod;
+    
+    // Execution progress
+    size_t m_executedSegments;              // Segments [0, m_executedSegments) have been executed
+    int m_highlightedLine;                  // Program line drawn highlighted, 0 for none
+    
+    // Marker prediction between status reports
+    MotionPredictor m_motionPredictor;
+    std::vector<uint32_t> m_motionPathProgress;  // Segments completed at each motion path point
+    wxTimer m_motionTimer;
+    static const int MOTION_FRAME_MS = 16;
+    
+    // Stock simulation
+    bool m_showStock;
+    std::thread m_stockThread;
+    std::atomic<bool> m_stockCancel;
+    int m_stockGeneration;  // Bumped per run so images from a stopped run are dropped
+    std::mutex m_stockMutex;
+    std::condition_variable m_stockWake;
+    size_t m_stockTarget;   // Segments [0, m_stockTarget) to cut, guarded by m_stockMutex
+    wxBitmap m_stockBitmap;
+    double m_stockMinX, m_stockMinY, m_stockWidth, m_stockHeight;  // World rect of the bitmap
+    static constexpr double STOCK_RESOLUTION = 0.1;   // mm per cell
+    static const size_t STOCK_CHUNK_MOVES = 100000;   // Moves cut between progressive updates
+    
+    // Parse worker: the preview of a large file, or the detail levels of a
+    // program parsed on the GUI thread
+    std::thread m_previewThread;
+    std::atomic<bool> m_previewCancel;
+    int m_previewGeneration;      // Bumped per file so a superseded preview is dropped
+    bool m_previewRunning;
+    size_t m_previewSourceMoves;  // Moves in the file when m_gcodeLines is a preview, else 0
+    
+    // 3D view, created on first use and laid over the 2D view
+    ToolpathGLView* m_glView;
+    void UpdateGLToolpath();
+    
     // Workspace dimensions
     float m_workspaceWidth, m_workspaceHeight, m_workspaceDepth;
     
@@ -128,5 +235,10 @@ private:
     wxString m_currentFilename;
     int m_totalLines;
     
+    // Status text layout (top-left overlay)
+    static const int STATUS_TEXT_TOP = 10;
+    static const int STATUS_LINE_HEIGHT = 15;
+    static const int STATUS_MAX_LINES = 6;
+    
     wxDECLARE_EVENT_TABLE();
 };
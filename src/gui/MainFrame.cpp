@@ -21,7 +21,9 @@
 #include "core/BuildCounter.h"
 #include "core/ErrorHandler.h"
 #include "core/CommunicationManager.h"
+#include "core/MachineConfigManager.h"
 #include "core/StateManager.h"
+#include "core/StartupProfiler.h"
 #include <wx/msgdlg.h>
 #include <wx/menu.h>
 #include <wx/statusbr.h>
@@ -30,6 +32,7 @@
 #include <wx/panel.h>
 #include <wx/notebook.h>
 #include <wx/artprov.h>
+#include <algorithm>
 #include "NotificationSystem.h"
 
 // Menu IDs
@@ -72,11 +75,15 @@ MainFrame::MainFrame()
     CreateToolBars();
     CreateStatusBar();
     LOG_INFO("MainFrame - Basic UI components created");
+    StartupProfiler::Instance().Mark("menus, toolbars and status bar");
     
-    // Create and setup panels
+    // Register panels; each is built when first shown
     CreatePanels();
     SetupAuiManager();
     LOG_INFO("MainFrame - Panels created and AUI setup complete");
+    StartupProfiler::Instance().Mark("panel registration");
+    
+    Bind(wxEVT_PAINT, &MainFrame::OnFirstPaint, this);
     
     // Initialize notification system
     NotificationSystem::Instance().SetParentWindow(this);
@@ -96,19 +103,24 @@ MainFrame::MainFrame()
         UpdateMenuItems();
         m_auiManager.Update();
         LOG_INFO("MainFrame - Status and layout updated");
+        StartupProfiler::Instance().Mark("layout restored");
+        
+        // Interactive once the restored layout has been handled and the queue drains
+        Bind(wxEVT_IDLE, &MainFrame::OnFirstIdle, this);
         
         // 3. Show welcome notifications
         NOTIFY_INFO("Connect to Machine", "Please connect to a CNC machine to begin using FluidNC gCode Sender.");
         
-        // 4. Delay auto-connect attempt
-        wxMilliSleep(100); // Small delay to ensure UI is responsive
+        // 4. Auto-connect once pending UI events are processed
         CallAfter([this]() {
-            LOG_INFO("MainFrame - Attempting auto-connect if configured");
-            PanelInfo* machineManagerInfo = FindPanelInfo(PANEL_MACHINE_MANAGER);
-            if (machineManagerInfo) {
-                MachineManagerPanel* machineManager = dynamic_cast<MachineManagerPanel*>(machineManagerInfo->panel);
+            // The machine manager panel is only built if it has a machine to connect
+            auto snapshot = MachineConfigManager::Instance().GetSnapshot();
+            bool anyAutoConnect = std::any_of(snapshot->machines.begin(), snapshot->machines.end(),
+                [](const MachineConfigManager::MachinePtr& machine) { return machine->autoConnect; });
+            if (anyAutoConnect) {
+                LOG_INFO("MainFrame - Triggering auto-connect check");
+                MachineManagerPanel* machineManager = dynamic_cast<MachineManagerPanel*>(GetPanel(PANEL_MACHINE_MANAGER, true));
                 if (machineManager) {
-                    LOG_INFO("MainFrame - Triggering auto-connect check");
                     machineManager->AttemptAutoConnect();
                 }
             }
@@ -226,8 +238,9 @@ void MainFrame::ShowPanel(PanelID panelId, bool show) {
                 m_auiManager.Update();
             }
         } else if (show) {
-            // Panel not in AUI manager, add it
+            // Panel not built yet - build it, add it and show it
             AddPanelToAui(*panelInfo);
+            m_auiManager.GetPane(panelInfo->name).Show(true);
             m_auiManager.Update();
         }
         UpdateMenuItems();
@@ -332,30 +345,32 @@ bool MainFrame::IsPanelVisible(PanelID panelId) const {
 
 // Panel access methods
 ConsolePanel* MainFrame::GetConsolePanel() const {
-    PanelInfo* panelInfo = const_cast<MainFrame*>(this)->FindPanelInfo(PANEL_CONSOLE);
-    if (panelInfo) {
-        return dynamic_cast<ConsolePanel*>(panelInfo->panel);
-    }
-    return nullptr;
+    // Connection messages must not be lost while the console is hidden
+    return dynamic_cast<ConsolePanel*>(const_cast<MainFrame*>(this)->GetPanel(PANEL_CONSOLE, true));
 }
 
-void MainFrame::UpdateMachineStatus(const std::string& machineId, const std::string& status) {
-    // Find machine name from machine manager
-    std::string machineName = "Unknown";
-    PanelInfo* machineManagerInfo = FindPanelInfo(PANEL_MACHINE_MANAGER);
-    if (machineManagerInfo) {
-        MachineManagerPanel* machineManager = dynamic_cast<MachineManagerPanel*>(machineManagerInfo->panel);
-        if (machineManager) {
-            const auto& machines = machineManager->GetMachines();
-            for (const auto& machine : machines) {
-                if (machine.id == machineId) {
-                    machineName = machine.name;
-                    break;
-                }
+// Status messages must not build the machine manager panel; without it the
+// name comes from the machine configuration
+std::string MainFrame::FindMachineName(const std::string& machineId) {
+    MachineManagerPanel* machineManager = dynamic_cast<MachineManagerPanel*>(GetPanel(PANEL_MACHINE_MANAGER, false));
+    if (machineManager) {
+        for (const auto& machine : machineManager->GetMachines()) {
+            if (machine.id == machineId) {
+                return machine.name;
             }
         }
     }
     
+    auto machine = MachineConfigManager::Instance().FindMachine(machineId);
+    return machine ? machine->name : std::string();
+}
+
+void MainFrame::UpdateMachineStatus(const std::string& machineId, const std::string& status) {
+    std::string machineName = FindMachineName(machineId);
+    if (machineName.empty()) {
+        machineName = "Unknown";
+    }
+    
     SetStatusText(wxString::Format("%s: %s", machineName, status), STATUS_MACHINE);
     UpdateStatusBar();
 }
@@ -364,25 +379,13 @@ void MainFrame::UpdateMachineStatus(const std::string& machineId, const std::str
 void MainFrame::HandleConnectionStatusChange(const std::string& machineId, bool connected, bool isAutoConnect) {
     LOG_INFO("HandleConnectionStatusChange: machineId=" + machineId + ", connected=" + (connected ? "true" : "false"));
     
-    // Get machine info from machine manager
-    std::string machineName = "Unknown Machine";
-    MachineManagerPanel* machineManager = nullptr;
-    
-    PanelInfo* machineManagerInfo = FindPanelInfo(PANEL_MACHINE_MANAGER);
-    if (machineManagerInfo) {
-        machineManager = dynamic_cast<MachineManagerPanel*>(machineManagerInfo->panel);
-        if (machineManager) {
-            const auto& machines = machineManager->GetMachines();
-            for (const auto& machine : machines) {
-                if (machine.id == machineId) {
-                    machineName = machine.name;
-                    break;
-                }
-            }
-        }
+    std::string machineName = FindMachineName(machineId);
+    if (machineName.empty()) {
+        machineName = "Unknown Machine";
     }
     
-    // 1. UPDATE MACHINE MANAGER PANEL
+    // 1. UPDATE MACHINE MANAGER PANEL (if built - it reads the state when it is)
+    MachineManagerPanel* machineManager = dynamic_cast<MachineManagerPanel*>(GetPanel(PANEL_MACHINE_MANAGER, false));
     if (machineManager) {
         machineManager->UpdateConnectionStatus(machineId, connected);
     }
@@ -452,6 +455,15 @@ void MainFrame::UpdateDRO(const std::string& machineId, const std::vector<float>
         SetStatusText("Position: ---", STATUS_POSITION);
     }
     
+    // The toolpath view follows the tool in program (work) coordinates and
+    // predicts its movement between reports from the reported feed
+    MachineVisualizationPanel* visualization =
+        dynamic_cast<MachineVisualizationPanel*>(GetPanel(PANEL_MACHINE_VISUALIZATION, false));
+    if (visualization && wpos.size() >= 3) {
+        float feedRate = CommunicationManager::Instance().GetFeedRate(machineId);
+        visualization->UpdateToolPosition(wpos[0], wpos[1], wpos[2], feedRate);
+    }
+    
     UpdateStatusBar();
 }
 
@@ -467,6 +479,9 @@ PanelInfo* MainFrame::FindPanelInfo(PanelID id)
 
 PanelInfo* MainFrame::FindPanelInfo(wxPanel* panel)
 {
+    if (!panel) {
+        return nullptr;  // Would match every panel not built yet
+    }
     for (auto& panelInfo : m_panels) {
         if (panelInfo.panel == panel) {
             return &panelInfo;
@@ -580,13 +595,14 @@ void MainFrame::SetupCommunicationCallbacks()
     // });
     
     // Command sent callback - logs sent commands to console
+    // Called on the communication threads: Post* queues the line for the GUI thread
     commMgr.SetCommandSentCallback([console](const std::string& machineId, const std::string& command) {
-        console->LogSentCommand(command);
+        console->PostSentCommand(command);
     });
     
     // Response received callback - logs received responses to console
     commMgr.SetResponseReceivedCallback([console](const std::string& machineId, const std::string& response) {
-        console->LogReceivedResponse(response);
+        console->PostReceivedResponse(response);
     });
     
     // Connection status callback - updates GUI connection state
@@ -612,9 +628,11 @@ void MainFrame::SetupCommunicationCallbacks()
     });
     
     // DRO update callback - updates position displays
+    // Called on the client's receive thread for every status report
     commMgr.SetDROUpdateCallback([this](const std::string& machineId, const std::vector<float>& mpos, const std::vector<float>& wpos) {
-        // Update status bar position display
-        UpdateDRO(machineId, mpos, wpos);
+        CallAfter([this, machineId, mpos, wpos]() {
+            UpdateDRO(machineId, mpos, wpos);
+        });
         
         // TODO: Update DRO panel when available
         // Find and update DRO panel if visible
@@ -641,20 +659,31 @@ void MainFrame::UpdateStatusBar()
         int connectedCount = 0;
         
         // Get machine status from machine manager
-        PanelInfo* machineManagerInfo = FindPanelInfo(PANEL_MACHINE_MANAGER);
-        if (machineManagerInfo) {
-            MachineManagerPanel* machineManager = dynamic_cast<MachineManagerPanel*>(machineManagerInfo->panel);
-            if (machineManager) {
-                const auto& machines = machineManager->GetMachines();
-                totalMachines = machines.size();
-                
-                for (const auto& machine : machines) {
-                    if (machine.connected) {
-                        anyConnected = true;
-                        connectedCount++;
-                        if (connectedMachineName.empty()) {
-                            connectedMachineName = machine.name;
-                        }
+        MachineManagerPanel* machineManager = dynamic_cast<MachineManagerPanel*>(GetPanel(PANEL_MACHINE_MANAGER, false));
+        if (machineManager) {
+            const auto& machines = machineManager->GetMachines();
+            totalMachines = machines.size();
+            
+            for (const auto& machine : machines) {
+                if (machine.connected) {
+                    anyConnected = true;
+                    connectedCount++;
+                    if (connectedMachineName.empty()) {
+                        connectedMachineName = machine.name;
+                    }
+                }
+            }
+        } else {
+            // Panel not built yet - configured machines and live connections
+            auto snapshot = MachineConfigManager::Instance().GetSnapshot();
+            totalMachines = snapshot->machines.size();
+            
+            for (const auto& machine : snapshot->machines) {
+                if (CommunicationManager::Instance().IsConnected(machine->id)) {
+                    anyConnected = true;
+                    connectedCount++;
+                    if (connectedMachineName.empty()) {
+                        connectedMachineName = machine->name;
                     }
                 }
             }
@@ -7,6 +7,7 @@
 #include <memory>
 #include <map>
 #include <vector>
+#include <functional>
 
 class StateManager;
 class ConsolePanel;
@@ -28,7 +29,8 @@ enum PanelID {
 struct PanelInfo {
     wxString name;
     wxString title;
-    wxPanel* panel;
+    wxPanel* panel = nullptr;             // Built on first show - see MainFrame::EnsurePanel
+    std::function<wxPanel*()> create;
     PanelID id;
     bool canClose = true;
     bool defaultVisible = true;
@@ -50,7 +52,7 @@ public:
     void SaveCurrentLayout();
     void LoadSavedLayout();
     
-    // Panel access
+    // Panel access - the console is built on demand, hidden if never shown
     ConsolePanel* GetConsolePanel() const;
     
     // Machine status updates
@@ -95,6 +97,10 @@ private:
     void OnPaneButton(wxAuiManagerEvent& event);
     void OnAuiRender(wxAuiManagerEvent& event);
     
+    // Startup profile milestones
+    void OnFirstPaint(wxPaintEvent& event);
+    void OnFirstIdle(wxIdleEvent& event);
+    
     // UI Creation
     void CreateMenuBar();
     void CreateToolBars();
@@ -122,6 +128,9 @@ private:
     PanelInfo* FindPanelInfo(PanelID id);
     PanelInfo* FindPanelInfo(wxPanel* panel);
     wxAuiPaneInfo AddPanelToAui(PanelInfo& panelInfo);
+    wxPanel* EnsurePanel(PanelInfo& panelInfo);            // Builds the panel if not yet built
+    wxPanel* GetPanel(PanelID id, bool create = false);   // 'create' adds it to AUI hidden
+    void AddPanelsShownIn(const wxString& perspective);    // Before LoadPerspective
     
     // Communication setup
     void SetupCommunicationCallbacks();
@@ -157,6 +166,7 @@ private:
     bool HasMachineConnected() const { return m_hasMachineConnected; }
     void SetMachineConnected(bool connected) { m_hasMachineConnected = connected; }
     bool ShouldAllowPanelAccess(PanelID panelId) const;
+    std::string FindMachineName(const std::string& machineId);  // Empty if unknown
     void MinimizeNonEssentialPanels();
     
     wxDECLARE_EVENT_TABLE();
@@ -14,6 +14,7 @@
 #include "SettingsDialog.h"
 #include "core/SimpleLogger.h"
 #include "core/ErrorHandler.h"
+#include "core/StartupProfiler.h"
 #include "NotificationSystem.h"
 #include "MachineManagerPanel.h"
 #include <wx/msgdlg.h>
@@ -274,45 +275,40 @@ void MainFrame::OnToolbarConnectLayout(wxCommandEvent& WXUNUSED(event)) {
         LOG_INFO("No machines connected - checking for autoconnect machine");
         
         // Find machine manager and attempt autoconnect if available
-        PanelInfo* machineManagerInfo = FindPanelInfo(PANEL_MACHINE_MANAGER);
-        if (machineManagerInfo) {
-            MachineManagerPanel* machineManager = dynamic_cast<MachineManagerPanel*>(machineManagerInfo->panel);
-            if (machineManager) {
-                // Check if there's a machine configured for autoconnect
-                const auto& machines = machineManager->GetMachines();
-                bool hasAutoConnectMachine = false;
-                std::string autoConnectMachineName = "";
-                
-                for (const auto& machine : machines) {
-                    if (machine.autoConnect && !machine.connected) {
-                        hasAutoConnectMachine = true;
-                        autoConnectMachineName = machine.name;
-                        break;
-                    }
+        MachineManagerPanel* machineManager = dynamic_cast<MachineManagerPanel*>(GetPanel(PANEL_MACHINE_MANAGER, true));
+        if (machineManager) {
+            // Check if there's a machine configured for autoconnect
+            const auto& machines = machineManager->GetMachines();
+            bool hasAutoConnectMachine = false;
+            std::string autoConnectMachineName = "";
+            
+            for (const auto& machine : machines) {
+                if (machine.autoConnect && !machine.connected) {
+                    hasAutoConnectMachine = true;
+                    autoConnectMachineName = machine.name;
+                    break;
                 }
+            }
+            
+            if (hasAutoConnectMachine) {
+                LOG_INFO("Found autoconnect machine: " + autoConnectMachineName + " - attempting connection");
                 
-                if (hasAutoConnectMachine) {
-                    LOG_INFO("Found autoconnect machine: " + autoConnectMachineName + " - attempting connection");
-                    
-                    // Show notification that we're attempting autoconnect
-                    NOTIFY_INFO("Auto-Connecting", 
-                        wxString::Format("No machines connected. Attempting to connect to '%s'...", autoConnectMachineName));
-                    
-                    // Trigger autoconnect attempt
-                    machineManager->AttemptAutoConnect();
-                } else {
-                    LOG_INFO("No autoconnect machine found - just restoring layout");
-                    
-                    // Show notification that user needs to connect manually
-                    NOTIFY_WARNING("No Connection", 
-                        "No machines connected and no autoconnect machine configured. "
-                        "Use Machine Manager to connect to a machine.");
-                }
+                // Show notification that we're attempting autoconnect
+                NOTIFY_INFO("Auto-Connecting", 
+                    wxString::Format("No machines connected. Attempting to connect to '%s'...", autoConnectMachineName));
+                
+                // Trigger autoconnect attempt
+                machineManager->AttemptAutoConnect();
             } else {
-                LOG_ERROR("Machine Manager panel not available");
+                LOG_INFO("No autoconnect machine found - just restoring layout");
+                
+                // Show notification that user needs to connect manually
+                NOTIFY_WARNING("No Connection", 
+                    "No machines connected and no autoconnect machine configured. "
+                    "Use Machine Manager to connect to a machine.");
             }
         } else {
-            LOG_ERROR("Machine Manager panel not found");
+            LOG_ERROR("Machine Manager panel not available");
         }
     } else {
         LOG_INFO("Machine already connected - just restoring layout");
@@ -406,4 +402,17 @@ void MainFrame::OnAuiRender(wxAuiManagerEvent& event) {
     event.Skip();
 }
 
+// Startup profile milestones - each handler runs once
+void MainFrame::OnFirstPaint(wxPaintEvent& event) {
+    Unbind(wxEVT_PAINT, &MainFrame::OnFirstPaint, this);
+    StartupProfiler::Instance().Mark("first paint");
+    event.Skip();
+}
+
+void MainFrame::OnFirstIdle(wxIdleEvent& event) {
+    Unbind(wxEVT_IDLE, &MainFrame::OnFirstIdle, this);
+    StartupProfiler::Instance().Finish("interactive");
+    event.Skip();
+}
+
 
@@ -11,6 +11,7 @@
 #include "core/SimpleLogger.h"
 #include "core/StateManager.h"
 #include "core/StringUtils.h"
+#include "core/StartupProfiler.h"
 #include "NotificationSystem.h"
 #include "DROPanel.h"
 #include "JogPanel.h"
@@ -23,7 +24,11 @@
 
 #include <wx/wx.h> // For wxRect, wxGetDisplaySize etc.
 #include <wx/artprov.h>
+#include <wx/stopwatch.h>
 
+// Saved AUI perspectives (GUI thread only)
+static StateKey<std::string> s_connectionFirstLayoutKey("ConnectionFirstLayout");
+static StateKey<std::string> s_gcodeLayoutKey("GCodeLayout");
 
 // AUI-based panel creation
 void MainFrame::CreatePanels()
@@ -32,14 +37,15 @@ void MainFrame::CreatePanels()
     m_panels.clear();
     
     try {
-        // Create panels as direct children of the main frame
+        // Register the panels; each is created as a direct child of the main
+        // frame the first time it is shown (see EnsurePanel)
         
         // G-Code Editor
         PanelInfo gcodeInfo;
         gcodeInfo.id = PANEL_GCODE_EDITOR;
         gcodeInfo.name = "gcode_editor";
         gcodeInfo.title = "G-code Editor";
-        gcodeInfo.panel = new GCodeEditor(this);
+        gcodeInfo.create = [this]() -> wxPanel* { return new GCodeEditor(this); };
         gcodeInfo.defaultVisible = false;  // No default visibility - state dependent
         gcodeInfo.defaultPosition = "";     // No default position - state dependent
         gcodeInfo.defaultSize = wxSize(600, 400);
@@ -50,7 +56,7 @@ void MainFrame::CreatePanels()
         droInfo.id = PANEL_DRO;
         droInfo.name = "dro";
         droInfo.title = "Digital Readout";
-        droInfo.panel = new DROPanel(this, nullptr); // nullptr for ConnectionManager
+        droInfo.create = [this]() -> wxPanel* { return new DROPanel(this, nullptr); }; // nullptr for ConnectionManager
         droInfo.defaultVisible = false;  // No default visibility - state dependent
         droInfo.defaultPosition = "";     // No default position - state dependent
         droInfo.defaultSize = wxSize(250, 200);
@@ -61,7 +67,7 @@ void MainFrame::CreatePanels()
         jogInfo.id = PANEL_JOG;
         jogInfo.name = "jog";
         jogInfo.title = "Jogging Controls";
-        jogInfo.panel = new JogPanel(this, nullptr); // nullptr for ConnectionManager
+        jogInfo.create = [this]() -> wxPanel* { return new JogPanel(this, nullptr); }; // nullptr for ConnectionManager
         jogInfo.defaultVisible = false;  // No default visibility - state dependent
         jogInfo.defaultPosition = "";     // No default position - state dependent
         jogInfo.defaultSize = wxSize(250, 300);
@@ -72,7 +78,7 @@ void MainFrame::CreatePanels()
         consoleInfo.id = PANEL_CONSOLE;
         consoleInfo.name = "console";
         consoleInfo.title = "Terminal Console";
-        consoleInfo.panel = new ConsolePanel(this);
+        consoleInfo.create = [this]() -> wxPanel* { return new ConsolePanel(this); };
         consoleInfo.canClose = true;             // Allow closing
         consoleInfo.defaultVisible = false;      // No default visibility - state dependent
         consoleInfo.defaultPosition = "";        // No default position - state dependent
@@ -84,7 +90,7 @@ void MainFrame::CreatePanels()
         machineInfo.id = PANEL_MACHINE_MANAGER;
         machineInfo.name = "machine_manager";
         machineInfo.title = "Machine Manager";
-        machineInfo.panel = new MachineManagerPanel(this);
+        machineInfo.create = [this]() -> wxPanel* { return new MachineManagerPanel(this); };
         machineInfo.defaultVisible = false;  // No default visibility - state dependent
         machineInfo.defaultPosition = "";      // No default position - state dependent
         machineInfo.defaultSize = wxSize(300, 400);
@@ -95,7 +101,7 @@ void MainFrame::CreatePanels()
         macroInfo.id = PANEL_MACRO;
         macroInfo.name = "macro";
         macroInfo.title = "Macro Panel";
-        macroInfo.panel = new MacroPanel(this);
+        macroInfo.create = [this]() -> wxPanel* { return new MacroPanel(this); };
         macroInfo.defaultVisible = false;  // No default visibility - state dependent
         macroInfo.defaultPosition = "";      // No default position - state dependent
         macroInfo.defaultSize = wxSize(300, 200);
@@ -106,7 +112,7 @@ void MainFrame::CreatePanels()
         svgInfo.id = PANEL_SVG_VIEWER;
         svgInfo.name = "svg_viewer";
         svgInfo.title = "SVG Viewer";
-        svgInfo.panel = new SVGViewer(this);
+        svgInfo.create = [this]() -> wxPanel* { return new SVGViewer(this); };
         svgInfo.defaultVisible = false;  // No default visibility - state dependent
         svgInfo.defaultPosition = "";      // No default position - state dependent
         svgInfo.defaultSize = wxSize(400, 400);
@@ -117,7 +123,7 @@ void MainFrame::CreatePanels()
         machineVisInfo.id = PANEL_MACHINE_VISUALIZATION;
         machineVisInfo.name = "machine_visualization";
         machineVisInfo.title = "Machine Visualization";
-        machineVisInfo.panel = new MachineVisualizationPanel(this);
+        machineVisInfo.create = [this]() -> wxPanel* { return new MachineVisualizationPanel(this); };
         machineVisInfo.defaultVisible = false;  // No default visibility - state dependent
         machineVisInfo.defaultPosition = "";      // No default position - state dependent
         machineVisInfo.defaultSize = wxSize(500, 400);
@@ -280,17 +286,11 @@ void MainFrame::SaveWindowGeometry()
 // Setup AUI manager and add panels
 void MainFrame::SetupAuiManager()
 {
-    // Add ALL panels to AUI manager, even if they start hidden
-    // This ensures they can be shown later by layout restoration
+    // Only panels visible by default are built now; the rest are added to
+    // AUI when a layout or the Window menu first shows them
     for (auto& panelInfo : m_panels) {
-        AddPanelToAui(panelInfo);
-        
-        // Hide panels that shouldn't be visible by default
-        if (!panelInfo.defaultVisible) {
-            wxAuiPaneInfo& pane = m_auiManager.GetPane(panelInfo.name);
-            if (pane.IsOk()) {
-                pane.Show(false);
-            }
+        if (panelInfo.defaultVisible) {
+            AddPanelToAui(panelInfo);
         }
     }
 }
@@ -319,6 +319,10 @@ void MainFrame::SetupConnectionFirstLayout()
     
     // Then show and position only the panels we want
     for (auto& panelInfo : m_panels) {
+        if (panelInfo.id != PANEL_MACHINE_MANAGER && panelInfo.id != PANEL_CONSOLE) {
+            continue;  // Stays hidden - and unbuilt if it never was shown
+        }
+        
         wxAuiPaneInfo* pane = &m_auiManager.GetPane(panelInfo.name);
         if (!pane->IsOk()) {
             // Panel not in AUI manager yet, add it
@@ -366,6 +370,10 @@ wxAuiPaneInfo existingPane = m_auiManager.GetPane(panelInfo.name);
         return existingPane;
     }
     
+    if (!EnsurePanel(panelInfo)) {
+        return existingPane;
+    }
+    
     LOG_INFO(wxString::Format("Adding panel '%s' to AUI manager", panelInfo.name).ToStdString());
     
     // Create new pane info with default settings
@@ -396,6 +404,90 @@ wxAuiPaneInfo existingPane = m_auiManager.GetPane(panelInfo.name);
     return m_auiManager.GetPane(panelInfo.name);
 }
 
+// Build a registered panel the first time it is needed
+wxPanel* MainFrame::EnsurePanel(PanelInfo& panelInfo)
+{
+    if (panelInfo.panel || !panelInfo.create) {
+        return panelInfo.panel;
+    }
+    
+    // Taken out first: a panel constructor that reaches back into the frame
+    // (status updates, console logging) sees it as not available yet
+    auto create = std::move(panelInfo.create);
+    panelInfo.create = nullptr;
+    
+    wxStopWatch timer;
+    try {
+        panelInfo.panel = create();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to create panel '" + panelInfo.name.ToStdString() + "': " + StringUtils::enforceASCII(e.what()));
+        
+        // Stand in with an error panel so the layout still works
+        wxPanel* errorPanel = new wxPanel(this, wxID_ANY);
+        wxStaticText* errorText = new wxStaticText(errorPanel, wxID_ANY,
+            wxString::Format("Panel creation error: %s\n\nThe application will still run with limited functionality.", e.what()));
+        wxBoxSizer* errorSizer = new wxBoxSizer(wxVERTICAL);
+        errorSizer->Add(errorText, 1, wxALL | wxCENTER, 20);
+        errorPanel->SetSizer(errorSizer);
+        panelInfo.panel = errorPanel;
+    }
+    
+    StartupProfiler::Instance().Record("panel " + panelInfo.name.ToStdString(), timer.Time());
+    LOG_INFO(wxString::Format("Created panel '%s' in %ld ms", panelInfo.name, timer.Time()).ToStdString());
+    return panelInfo.panel;
+}
+
+wxPanel* MainFrame::GetPanel(PanelID id, bool create)
+{
+    PanelInfo* panelInfo = FindPanelInfo(id);
+    if (!panelInfo) {
+        return nullptr;
+    }
+    
+    if (create && !m_auiManager.GetPane(panelInfo->name).IsOk()) {
+        // Managed by AUI from the start, so it never shows up unplaced
+        AddPanelToAui(*panelInfo);
+    }
+    return panelInfo->panel;
+}
+
+// LoadPerspective() ignores panes the manager does not know yet, so build
+// the panels that the perspective shows before loading it
+void MainFrame::AddPanelsShownIn(const wxString& perspective)
+{
+    // Pane entries are separated by '|'; delimiters inside values are escaped with '\'
+    std::vector<wxString> entries(1);
+    for (size_t i = 0; i < perspective.length(); i++) {
+        wxUniChar c = perspective[i];
+        if (c == '\\' && i + 1 < perspective.length()) {
+            entries.back() += c;
+            entries.back() += perspective[++i];
+        } else if (c == '|') {
+            entries.emplace_back();
+        } else {
+            entries.back() += c;
+        }
+    }
+    
+    for (const wxString& entry : entries) {
+        if (!entry.StartsWith("name=")) {
+            continue;  // Layout version and dock sizes
+        }
+        
+        wxAuiPaneInfo pane;
+        m_auiManager.LoadPaneInfo(entry, pane);
+        if (!pane.IsShown()) {
+            continue;
+        }
+        
+        for (auto& panelInfo : m_panels) {
+            if (panelInfo.name == pane.name && !m_auiManager.GetPane(panelInfo.name).IsOk()) {
+                AddPanelToAui(panelInfo);
+            }
+        }
+    }
+}
+
 // Save the Connection-First layout state
 void MainFrame::SaveConnectionFirstLayout()
 {
@@ -404,7 +496,7 @@ void MainFrame::SaveConnectionFirstLayout()
         wxString perspective = m_auiManager.SavePerspective();
         
         // Save to StateManager with a special key for connection-first layout
-        StateManager::getInstance().setValue("ConnectionFirstLayout", perspective.ToStdString());
+        StateManager::getInstance().setValue(s_connectionFirstLayoutKey, perspective.ToStdString());
         
         LOG_INFO("Saved Connection-First layout perspective");
         
@@ -420,7 +512,7 @@ void MainFrame::RestoreConnectionFirstLayout()
     
     try {
         // Try to load saved ConnectionFirstLayout perspective first
-        std::string savedPerspective = StateManager::getInstance().getValue<std::string>("ConnectionFirstLayout", "");
+        std::string savedPerspective = StateManager::getInstance().getValue(s_connectionFirstLayoutKey);
         
         LOG_INFO("RestoreConnectionFirstLayout: Saved perspective length: " + std::to_string(savedPerspective.length()));
         
@@ -429,6 +521,7 @@ void MainFrame::RestoreConnectionFirstLayout()
 wxString perspective = TO_WX(savedPerspective);
             LOG_INFO("RestoreConnectionFirstLayout: Attempting to load saved perspective");
             
+            AddPanelsShownIn(perspective);
             if (m_auiManager.LoadPerspective(perspective, true)) {
                 LOG_INFO("RestoreConnectionFirstLayout: Successfully loaded saved perspective - PRESERVING splitter positions");
                 m_auiManager.Update();
@@ -516,6 +609,7 @@ wxString perspective = TO_WX(savedPerspective);
                            .Resizable(true)
                            .Movable(true)
                            .Floatable(true);
+                    EnsurePanel(panelInfo);
                     m_auiManager.AddPane(panelInfo.panel, paneInfo);
                 }
             }
@@ -556,6 +650,10 @@ void MainFrame::SetupGCodeLayout()
     
     // Then show and position only the panels we want
     for (auto& panelInfo : m_panels) {
+        if (panelInfo.id != PANEL_GCODE_EDITOR && panelInfo.id != PANEL_MACHINE_VISUALIZATION) {
+            continue;  // Stays hidden - and unbuilt if it never was shown
+        }
+        
         wxAuiPaneInfo* pane = &m_auiManager.GetPane(panelInfo.name);
         if (!pane->IsOk()) {
             // Panel not in AUI manager yet, add it
@@ -600,7 +698,7 @@ void MainFrame::SaveGCodeLayout()
         wxString perspective = m_auiManager.SavePerspective();
         
         // Save to StateManager with a special key for G-code layout
-        StateManager::getInstance().setValue("GCodeLayout", perspective.ToStdString());
+        StateManager::getInstance().setValue(s_gcodeLayoutKey, perspective.ToStdString());
         
         LOG_INFO("Saved G-Code layout perspective");
         
@@ -616,7 +714,7 @@ void MainFrame::RestoreGCodeLayout()
     
     try {
         // Try to load saved GCodeLayout perspective first
-        std::string savedPerspective = StateManager::getInstance().getValue<std::string>("GCodeLayout", "");
+        std::string savedPerspective = StateManager::getInstance().getValue(s_gcodeLayoutKey);
         
         LOG_INFO("RestoreGCodeLayout: Saved perspective length: " + std::to_string(savedPerspective.length()));
         
@@ -625,6 +723,7 @@ void MainFrame::RestoreGCodeLayout()
             wxString perspective = wxString::FromUTF8(savedPerspective.c_str());
             LOG_INFO("RestoreGCodeLayout: Attempting to load saved perspective");
             
+            AddPanelsShownIn(perspective);
             if (m_auiManager.LoadPerspective(perspective, true)) {
                 LOG_INFO("RestoreGCodeLayout: Successfully loaded saved perspective - PRESERVING splitter positions");
                 m_auiManager.Update();
@@ -693,6 +792,7 @@ void MainFrame::RestoreGCodeLayout()
                            .Resizable(true)
                            .Movable(true)
                            .Floatable(true);
+                    EnsurePanel(panelInfo);
                     m_auiManager.AddPane(panelInfo.panel, paneInfo);
                 }
             }
@@ -731,7 +831,7 @@ void MainFrame::ConnectGCodePanels() {
             return;
         }
         
-        GCodeEditor* gcodeEditor = dynamic_cast<GCodeEditor*>(gcodeEditorInfo->panel);
+        GCodeEditor* gcodeEditor = dynamic_cast<GCodeEditor*>(GetPanel(PANEL_GCODE_EDITOR, true));
         if (!gcodeEditor) {
             LOG_ERROR("ConnectGCodePanels: G-Code Editor panel cast failed");
             return;
@@ -744,7 +844,7 @@ void MainFrame::ConnectGCodePanels() {
             return;
         }
         
-        MachineVisualizationPanel* machineVis = dynamic_cast<MachineVisualizationPanel*>(machineVisInfo->panel);
+        MachineVisualizationPanel* machineVis = dynamic_cast<MachineVisualizationPanel*>(GetPanel(PANEL_MACHINE_VISUALIZATION, true));
         if (!machineVis) {
             LOG_ERROR("ConnectGCodePanels: Machine Visualization panel cast failed");
             return;
@@ -764,6 +864,18 @@ LOG_ERROR("Failed to update G-Code visualization: " + StringUtils::enforceASCII(
             }
         });
         
+        // Large files get a simplified preview built in the background from
+        // the editor's mapping
+        gcodeEditor->SetMappedFileCallback([machineVis](std::shared_ptr<const MappedGCodeFile> file) {
+            machineVis->SetGCodePreview(file);
+            LOG_INFO("G-Code visualization preview started for mapped file");
+        });
+        
+        // Highlight the toolpath of the line under the editor caret
+        gcodeEditor->SetLineSelectCallback([machineVis](int line) {
+            machineVis->SetHighlightedLine(line);
+        });
+        
         // Also update visualization with current G-code content immediately
         std::string currentGCode_std = gcodeEditor->GetText();
         if (!currentGCode_std.empty()) {
@@ -177,8 +177,15 @@ void NetworkScanDialog::OnStartScan(wxCommandEvent& WXUNUSED(event))
     
     // Create and start scanner
     m_scanner = std::make_unique<NetworkScanner>();
+    SetScannerCallbacks();
+    m_scanner->StartScan();
     
-    // Set up callbacks
+    // Start UI update timer
+    m_updateTimer.Start(100); // Update every 100ms
+}
+
+void NetworkScanDialog::SetScannerCallbacks()
+{
     m_scanner->SetProgressCallback([this](int current, int total, const std::string& currentIP, const std::string& message) {
         // Thread-safe progress update
         wxCriticalSectionLocker lock(m_updateSection);
@@ -190,6 +197,11 @@ void NetworkScanDialog::OnStartScan(wxCommandEvent& WXUNUSED(event))
         m_progressUpdates.push_back(update);
     });
     
+    m_scanner->SetDeviceCallback([this](const NetworkDevice& device) {
+        wxCriticalSectionLocker lock(m_updateSection);
+        m_foundDevices.push_back(device);
+    });
+    
     m_scanner->SetCompleteCallback([this](const std::vector<NetworkDevice>& devices, bool success, const std::string& error) {
         // Thread-safe completion update
         wxCriticalSectionLocker lock(m_updateSection);
@@ -199,11 +211,6 @@ void NetworkScanDialog::OnStartScan(wxCommandEvent& WXUNUSED(event))
         update.error = wxString(error);
         m_deviceUpdates.push_back(update);
     });
-    
-    m_scanner->StartScan();
-    
-    // Start UI update timer
-    m_updateTimer.Start(100); // Update every 100ms
 }
 
 void NetworkScanDialog::OnStopScan(wxCommandEvent& WXUNUSED(event))
@@ -234,27 +241,7 @@ void NetworkScanDialog::OnRescan(wxCommandEvent& WXUNUSED(event))
         ClearDeviceList();
         
         m_scanner = std::make_unique<NetworkScanner>();
-        
-        // Set up callbacks
-        m_scanner->SetProgressCallback([this](int current, int total, const std::string& currentIP, const std::string& message) {
-            wxCriticalSectionLocker lock(m_updateSection);
-            ProgressUpdate update;
-            update.current = current;
-            update.total = total;
-            update.currentIP = wxString(currentIP);
-            update.message = wxString(message);
-            m_progressUpdates.push_back(update);
-        });
-        
-        m_scanner->SetCompleteCallback([this](const std::vector<NetworkDevice>& devices, bool success, const std::string& error) {
-            wxCriticalSectionLocker lock(m_updateSection);
-            DeviceUpdate update;
-            update.devices = devices;
-            update.success = success;
-            update.error = wxString(error);
-            m_deviceUpdates.push_back(update);
-        });
-        
+        SetScannerCallbacks();
         m_scanner->StartScan();
         m_updateTimer.Start(100);
     }
@@ -294,6 +281,7 @@ void NetworkScanDialog::CleanupScanner()
         
         // Clear callbacks to prevent accessing destroyed dialog
         m_scanner->SetProgressCallback(nullptr);
+        m_scanner->SetDeviceCallback(nullptr);
         m_scanner->SetCompleteCallback(nullptr);
         
         // Wait for thread to finish
@@ -333,6 +321,16 @@ void NetworkScanDialog::OnTimer(wxTimerEvent& WXUNUSED(event))
     }
     m_progressUpdates.clear();
     
+    // Devices that answered so far; the completion update replaces them
+    for (const auto& device : m_foundDevices) {
+        m_discoveredDevices.push_back(device);
+        AddDeviceToList(device);
+    }
+    if (!m_foundDevices.empty() && m_deviceUpdates.empty()) {
+        m_statusLabel->SetLabel(wxString::Format("Found %zu devices so far...", m_discoveredDevices.size()));
+    }
+    m_foundDevices.clear();
+    
     // Process device updates
     if (!m_deviceUpdates.empty()) {
         LOG_DEBUG("OnTimer: Processing " + std::to_string(m_deviceUpdates.size()) + " device updates");
@@ -373,8 +371,21 @@ void NetworkScanDialog::UpdateDeviceList(const std::vector<NetworkDevice>& devic
         LOG_DEBUG(deviceInfo);
     }
     
+    // Devices listed while scanning may already be selected; keep the selection
+    std::string selectedIP = m_hasSelectedDevice ? m_selectedDevice.ip : std::string();
+    
     m_discoveredDevices = devices;
     PopulateDeviceList();
+    
+    for (size_t i = 0; i < m_discoveredDevices.size() && !selectedIP.empty(); ++i) {
+        if (m_discoveredDevices[i].ip == selectedIP) {
+            m_deviceList->SetItemState(i, wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED, wxLIST_STATE_SELECTED | wxLIST_STATE_FOCUSED);
+            m_selectedDevice = m_discoveredDevices[i];
+            m_hasSelectedDevice = true;
+            m_useSelectedBtn->Enable(true);
+            break;
+        }
+    }
 }
 
 void NetworkScanDialog::SetScanningState(bool scanning)
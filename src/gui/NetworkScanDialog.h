@@ -51,6 +51,7 @@ private:
     // Scanning callbacks (thread-safe)
     void OnScanProgress(int current, int total, const std::string& currentIP, const std::string& message);
     void OnScanComplete(const std::vector<NetworkDevice>& devices, bool success, const std::string& error);
+    void SetScannerCallbacks();
 
     // UI Updates (must be called from main thread)
     void UpdateProgress(int current, int total, const wxString& currentIP, const wxString& message);
@@ -115,6 +116,7 @@ private:
     wxCriticalSection m_updateSection;
     std::vector<ProgressUpdate> m_progressUpdates;
     std::vector<DeviceUpdate> m_deviceUpdates;
+    std::vector<NetworkDevice> m_foundDevices;  // Shown as they answer, before the scan completes
 
     wxDECLARE_EVENT_TABLE();
 };
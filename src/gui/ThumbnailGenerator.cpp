@@ -0,0 +1,152 @@
+/**
+ * gui/ThumbnailGenerator.cpp
+ * Batch toolpath thumbnail generation implementation
+ */
+
+#include "ThumbnailGenerator.h"
+#include "ToolpathRenderer.h"
+#include "core/SimpleLogger.h"
+#include <wx/filename.h>
+#include <wx/graphics.h>
+#include <wx/image.h>
+#include <wx/stopwatch.h>
+#include <wx/utils.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+ThumbnailGenerator::ThumbnailGenerator(const wxString& cacheDir, const wxSize& size)
+    : m_cacheDir(cacheDir)
+    , m_size(size)
+{
+    if (!wxImage::FindHandler(wxBITMAP_TYPE_PNG)) {
+        wxImage::AddHandler(new wxPNGHandler);
+    }
+    // The default graphics renderer loads lazily; do it here rather than in
+    // several workers at once
+    wxImage probe(1, 1);
+    delete wxGraphicsContext::Create(probe);
+    if (!wxFileName::DirExists(m_cacheDir)) {
+        wxFileName::Mkdir(m_cacheDir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+    }
+}
+
+uint64_t ThumbnailGenerator::HashContent(const std::string& content)
+{
+    // 64-bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : content) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+wxString ThumbnailGenerator::GetCachePath(uint64_t contentHash) const
+{
+    wxString name = wxString::Format("%016llx_%dx%d.png", static_cast<unsigned long long>(contentHash),
+                                     m_size.x, m_size.y);
+    return wxFileName(m_cacheDir, name).GetFullPath();
+}
+
+ThumbnailGenerator::Result ThumbnailGenerator::GenerateOne(const wxString& file) const
+{
+    Result result;
+    result.source = file;
+
+    std::ifstream stream(file.ToStdString(), std::ios::binary);
+    if (!stream) {
+        return result;
+    }
+    std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    wxString cachePath = GetCachePath(HashContent(content));
+    if (wxFileName::FileExists(cachePath)) {
+        result.thumbnail = cachePath;
+        result.fromCache = true;
+        result.success = true;
+        return result;
+    }
+
+    wxStopWatch timer;
+    std::vector<GCodeLine> lines;
+    ToolpathRenderer::ParseToolpath(content, lines);
+    result.parseMs = timer.Time();
+    result.segments = lines.size();
+
+    timer.Start();
+    wxImage image = ToolpathRenderer::RenderImage(lines, m_size);
+    result.renderMs = timer.Time();
+
+    // Write under a temporary name so a concurrent reader never sees half a file.
+    // Files with the same content share the cache path, so workers (and other
+    // instances) rendering them at the same time each need their own name.
+    static std::atomic<unsigned int> tempCounter(0);
+    wxString tempPath = wxString::Format("%s.%lu.%u.tmp", cachePath,
+                                         static_cast<unsigned long>(wxGetProcessId()), tempCounter++);
+    if (image.IsOk() && image.SaveFile(tempPath, wxBITMAP_TYPE_PNG) && wxRenameFile(tempPath, cachePath, true)) {
+        result.thumbnail = cachePath;
+        result.success = true;
+    } else {
+        wxRemoveFile(tempPath);
+    }
+
+    return result;
+}
+
+std::vector<ThumbnailGenerator::Result> ThumbnailGenerator::Generate(const std::vector<wxString>& files,
+                                                                     ProgressCallback progress)
+{
+    std::vector<Result> results(files.size());
+    if (files.empty()) return results;
+
+    wxStopWatch batchTimer;
+
+    // Files are independent - hand them out to a few threads
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> done(0);
+    auto worker = [this, &files, &results, &next, &done, &progress]() {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            results[i] = GenerateOne(files[i]);
+            size_t finished = ++done;
+            if (progress) {
+                progress(finished, files.size());
+            }
+        }
+    };
+
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, files.size()));
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threadCount; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    size_t generated = 0, cached = 0, failed = 0;
+    long parseMs = 0, renderMs = 0;
+    for (const auto& result : results) {
+        if (!result.success) {
+            failed++;
+        } else if (result.fromCache) {
+            cached++;
+        } else {
+            generated++;
+        }
+        parseMs += result.parseMs;
+        renderMs += result.renderMs;
+    }
+
+    LOG_INFO(wxString::Format("Thumbnails: %zu generated, %zu cached, %zu failed in %ld ms "
+                             "(parse %ld ms, render %ld ms, %u threads)",
+                             generated, cached, failed, batchTimer.Time(), parseMs, renderMs,
+                             threadCount).ToStdString());
+
+    return results;
+}
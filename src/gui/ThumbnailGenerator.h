@@ -0,0 +1,54 @@
+/**
+ * gui/ThumbnailGenerator.h
+ * Batch toolpath thumbnail generation for the job library
+ * Files are parsed and rendered offscreen in parallel; PNGs are cached under
+ * a name derived from the file content hash, so unchanged files (even when
+ * renamed or copied) are never parsed twice.
+ * Each image is stroked by ToolpathRenderer, the visualization panel's own
+ * drawing code, so the render times it reports are those of the panel's
+ * full-detail paint (batching and stroking). There is no job library view
+ * yet; the ToolpathThumbnails tool drives it.
+ */
+
+#pragma once
+
+#include <wx/wx.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class ThumbnailGenerator
+{
+public:
+    struct Result {
+        wxString source;
+        wxString thumbnail;   // PNG path in the cache, empty on failure
+        bool fromCache = false;
+        bool success = false;
+        size_t segments = 0;  // Rendered segments (0 when served from the cache)
+        long parseMs = 0;
+        long renderMs = 0;
+    };
+
+    // Called from worker threads with the number of files done so far
+    using ProgressCallback = std::function<void(size_t done, size_t total)>;
+
+    // Must be created on the main thread (registers the PNG handler and loads
+    // the graphics renderer)
+    ThumbnailGenerator(const wxString& cacheDir, const wxSize& size = wxSize(256, 256));
+
+    // Returns one result per file, in input order. Blocks until all files are
+    // done; run it from a worker thread to keep the UI responsive.
+    std::vector<Result> Generate(const std::vector<wxString>& files, ProgressCallback progress = nullptr);
+
+    // Cached thumbnail for the content, generated if needed
+    Result GenerateOne(const wxString& file) const;
+
+    wxString GetCachePath(uint64_t contentHash) const;
+    static uint64_t HashContent(const std::string& content);
+
+private:
+    wxString m_cacheDir;
+    wxSize m_size;
+};
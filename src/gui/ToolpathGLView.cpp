@@ -0,0 +1,471 @@
+/**
+ * gui/ToolpathGLView.cpp
+ * OpenGL 3D toolpath view implementation
+ */
+
+#ifndef __WXMSW__
+#define GL_GLEXT_PROTOTYPES  // Mesa's libGL exports the buffer object entry points directly
+#endif
+
+#include "ToolpathGLView.h"
+#include "NotificationSystem.h"
+#include "core/SimpleLogger.h"
+#include <wx/stopwatch.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+
+namespace {
+
+// Buffer object entry points (GL 1.5) - opengl32.dll only exports GL 1.1
+typedef void (APIENTRY* GenBuffersProc)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRY* DeleteBuffersProc)(GLsizei n, const GLuint* buffers);
+typedef void (APIENTRY* BindBufferProc)(GLenum target, GLuint buffer);
+typedef void (APIENTRY* BufferDataProc)(GLenum target, std::ptrdiff_t size, const void* data, GLenum usage);
+
+GenBuffersProc s_glGenBuffers = nullptr;
+DeleteBuffersProc s_glDeleteBuffers = nullptr;
+BindBufferProc s_glBindBuffer = nullptr;
+BufferDataProc s_glBufferData = nullptr;
+
+bool LoadBufferFunctions()
+{
+    // Buffer objects are core since 1.5
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    if (!version) return false;
+    int major = std::atoi(version);
+    const char* dot = std::strchr(version, '.');
+    int minor = dot ? std::atoi(dot + 1) : 0;
+    if (major < 1 || (major == 1 && minor < 5)) return false;
+
+#ifdef __WXMSW__
+    s_glGenBuffers = reinterpret_cast<GenBuffersProc>(wglGetProcAddress("glGenBuffers"));
+    s_glDeleteBuffers = reinterpret_cast<DeleteBuffersProc>(wglGetProcAddress("glDeleteBuffers"));
+    s_glBindBuffer = reinterpret_cast<BindBufferProc>(wglGetProcAddress("glBindBuffer"));
+    s_glBufferData = reinterpret_cast<BufferDataProc>(wglGetProcAddress("glBufferData"));
+#else
+    s_glGenBuffers = reinterpret_cast<GenBuffersProc>(&glGenBuffers);
+    s_glDeleteBuffers = reinterpret_cast<DeleteBuffersProc>(&glDeleteBuffers);
+    s_glBindBuffer = reinterpret_cast<BindBufferProc>(&glBindBuffer);
+    s_glBufferData = reinterpret_cast<BufferDataProc>(&glBufferData);
+#endif
+
+    return s_glGenBuffers && s_glDeleteBuffers && s_glBindBuffer && s_glBufferData;
+}
+
+// Canvas attributes; falls back to the platform defaults if depth/double
+// buffering is not offered (some software configurations)
+wxGLAttributes MakeCanvasAttributes()
+{
+    wxGLAttributes attributes;
+    attributes.PlatformDefaults().RGBA().DoubleBuffer().Depth(16).EndList();
+    if (!wxGLCanvas::IsDisplaySupported(attributes)) {
+        attributes.Reset();
+        attributes.PlatformDefaults().Defaults().EndList();
+    }
+    return attributes;
+}
+
+} // namespace
+
+wxBEGIN_EVENT_TABLE(ToolpathGLView, wxGLCanvas)
+    EVT_PAINT(ToolpathGLView::OnPaint)
+    EVT_SIZE(ToolpathGLView::OnSize)
+    EVT_MOUSEWHEEL(ToolpathGLView::OnMouseWheel)
+    EVT_LEFT_DOWN(ToolpathGLView::OnMouseDown)
+    EVT_RIGHT_DOWN(ToolpathGLView::OnMouseDown)
+    EVT_MIDDLE_DOWN(ToolpathGLView::OnMouseDown)
+    EVT_MOTION(ToolpathGLView::OnMouseMove)
+    EVT_LEFT_UP(ToolpathGLView::OnMouseUp)
+    EVT_RIGHT_UP(ToolpathGLView::OnMouseUp)
+    EVT_MIDDLE_UP(ToolpathGLView::OnMouseUp)
+    EVT_KEY_DOWN(ToolpathGLView::OnKeyDown)
+wxEND_EVENT_TABLE()
+
+ToolpathGLView::ToolpathGLView(wxWindow* parent)
+    : wxGLCanvas(parent, MakeCanvasAttributes(), wxID_ANY, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE)
+    , m_context(nullptr)
+    , m_glInitialized(false)
+    , m_vboSupported(false)
+    , m_vbo(0)
+    , m_geometryDirty(false)
+    , m_uploadedVertexCount(0)
+    , m_executedSegments(0)
+    , m_minZ(0), m_maxZ(0)
+    , m_centerX(0), m_centerY(0), m_centerZ(0)
+    , m_radius(100.0f)
+    , m_orbiting(false)
+    , m_panning(false)
+{
+    m_context = new wxGLContext(this);
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+    SetCanFocus(true);
+    ResetCamera();
+
+    LOG_INFO("Toolpath 3D view created");
+}
+
+ToolpathGLView::~ToolpathGLView()
+{
+    if (m_context && m_vbo && s_glDeleteBuffers) {
+        SetCurrent(*m_context);
+        s_glDeleteBuffers(1, &m_vbo);
+    }
+    delete m_context;
+}
+
+void ToolpathGLView::ResetCamera()
+{
+    m_yaw = -30.0f;
+    m_pitch = -60.0f;
+    m_zoom = 1.0f;
+    m_panX = m_panY = 0.0f;
+    Refresh(false);
+}
+
+ToolpathGLView::Vertex ToolpathGLView::MakeVertex(float x, float y, float z, bool isRapid) const
+{
+    Vertex vertex;
+    vertex.x = x;
+    vertex.y = y;
+    vertex.z = z;
+    vertex.a = 255;
+
+    if (isRapid) {
+        vertex.r = vertex.g = vertex.b = 170;
+        return vertex;
+    }
+
+    // Depth ramp: deepest cuts blue, through green, to red at the top
+    float range = m_maxZ - m_minZ;
+    float t = range > 1e-6f ? (z - m_minZ) / range : 1.0f;
+    t = std::max(0.0f, std::min(1.0f, t));
+    if (t < 0.5f) {
+        float u = t * 2.0f;
+        vertex.r = 0;
+        vertex.g = static_cast<unsigned char>(200 * u);
+        vertex.b = static_cast<unsigned char>(255 * (1.0f - u));
+    } else {
+        float u = (t - 0.5f) * 2.0f;
+        vertex.r = static_cast<unsigned char>(255 * u);
+        vertex.g = static_cast<unsigned char>(200 * (1.0f - u));
+        vertex.b = 0;
+    }
+    return vertex;
+}
+
+void ToolpathGLView::AddLine(const Vertex& start, const Vertex& end)
+{
+    m_vertices.push_back(start);
+    m_vertices.push_back(end);
+}
+
+void ToolpathGLView::SetToolpath(const std::vector<GCodeLine>& lines,
+                                 float minX, float maxX, float minY, float maxY, float minZ, float maxZ)
+{
+    m_minZ = minZ;
+    m_maxZ = maxZ;
+    m_centerX = (minX + maxX) / 2.0f;
+    m_centerY = (minY + maxY) / 2.0f;
+    m_centerZ = (minZ + maxZ) / 2.0f;
+    float dx = maxX - minX, dy = maxY - minY, dz = maxZ - minZ;
+    m_radius = std::max(1.0f, std::sqrt(dx * dx + dy * dy + dz * dz) / 2.0f);
+
+    m_vertices.clear();
+    m_segmentVertexEnd.clear();
+    m_vertices.reserve(lines.size() * 2);
+    m_segmentVertexEnd.reserve(lines.size());
+
+    for (const auto& line : lines) {
+        if (line.type == GCodeLine::ARC && line.radius > 0) {
+            // Flatten arcs (helical when Z changes) into short lines
+            double startAngle;
+            double sweep = GetArcSweep(line, startAngle);
+            int steps = std::max(8, static_cast<int>(std::abs(sweep) / (2 * M_PI) * 64));
+            Vertex previous = MakeVertex(line.startX, line.startY, line.startZ, false);
+            for (int i = 1; i <= steps; ++i) {
+                double angle = startAngle + sweep * i / steps;
+                float z = line.startZ + (line.endZ - line.startZ) * i / steps;
+                Vertex next = (i == steps)
+                    ? MakeVertex(line.endX, line.endY, line.endZ, false)
+                    : MakeVertex(static_cast<float>(line.centerX + line.radius * std::cos(angle)),
+                                 static_cast<float>(line.centerY + line.radius * std::sin(angle)), z, false);
+                AddLine(previous, next);
+                previous = next;
+            }
+        } else {
+            AddLine(MakeVertex(line.startX, line.startY, line.startZ, line.isRapid),
+                    MakeVertex(line.endX, line.endY, line.endZ, line.isRapid));
+        }
+        m_segmentVertexEnd.push_back(m_vertices.size());
+    }
+
+    m_executedSegments = std::min(m_executedSegments, m_segmentVertexEnd.size());
+    m_geometryDirty = true;
+    Refresh(false);
+}
+
+void ToolpathGLView::ClearToolpath()
+{
+    SetToolpath(std::vector<GCodeLine>(), 0, 0, 0, 0, 0, 0);
+}
+
+void ToolpathGLView::SetExecutedSegments(size_t count)
+{
+    count = std::min(count, m_segmentVertexEnd.size());
+    if (count == m_executedSegments) return;
+    m_executedSegments = count;
+    Refresh(false);
+}
+
+bool ToolpathGLView::InitGL()
+{
+    if (m_glInitialized) return true;
+    if (!m_context || !m_context->IsOK()) return false;
+
+    SetCurrent(*m_context);
+    m_vboSupported = LoadBufferFunctions();
+    m_glInitialized = true;
+
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    LOG_INFO(wxString::Format("Toolpath 3D view: %s, OpenGL %s, %s",
+                             renderer ? renderer : "unknown", version ? version : "unknown",
+                             m_vboSupported ? "vertex buffers" : "client-side arrays").ToStdString());
+    return true;
+}
+
+void ToolpathGLView::UploadGeometry()
+{
+    m_uploadedVertexCount = m_vertices.size();
+    m_geometryDirty = false;
+
+    if (!m_vboSupported) return;
+
+    if (!m_vbo) {
+        s_glGenBuffers(1, &m_vbo);
+    }
+    s_glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    s_glBufferData(GL_ARRAY_BUFFER, static_cast<std::ptrdiff_t>(m_vertices.size() * sizeof(Vertex)),
+                   m_vertices.empty() ? nullptr : m_vertices.data(), GL_STATIC_DRAW);
+    s_glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ToolpathGLView::Render()
+{
+    if (!InitGL()) return;
+    SetCurrent(*m_context);
+
+    if (m_geometryDirty) {
+        UploadGeometry();
+    }
+
+    wxSize size = GetClientSize() * GetContentScaleFactor();
+    if (size.x <= 0 || size.y <= 0) return;
+
+    glViewport(0, 0, size.x, size.y);
+    glClearColor(240 / 255.0f, 240 / 255.0f, 240 / 255.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+
+    // Orthographic projection sized to the program
+    double halfHeight = m_radius * 1.2 / m_zoom;
+    double halfWidth = halfHeight * size.x / size.y;
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(-halfWidth, halfWidth, -halfHeight, halfHeight, -m_radius * 20.0, m_radius * 20.0);
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glTranslatef(m_panX, m_panY, 0.0f);
+    glRotatef(m_pitch, 1.0f, 0.0f, 0.0f);
+    glRotatef(m_yaw, 0.0f, 0.0f, 1.0f);
+    glTranslatef(-m_centerX, -m_centerY, -m_centerZ);
+
+    DrawAxes();
+
+    if (m_uploadedVertexCount > 0) {
+        const char* base = nullptr;
+        if (m_vboSupported) {
+            s_glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+        } else {
+            base = reinterpret_cast<const char*>(m_vertices.data());
+        }
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glVertexPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, x));
+
+        // Executed range in a flat color, the rest with the per-vertex depth colors
+        size_t executedVertices = m_executedSegments > 0 ? m_segmentVertexEnd[m_executedSegments - 1] : 0;
+        if (executedVertices > 0) {
+            glColor3ub(110, 110, 110);
+            glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(executedVertices));
+        }
+
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), base + offsetof(Vertex, r));
+        glDrawArrays(GL_LINES, static_cast<GLint>(executedVertices),
+                     static_cast<GLsizei>(m_uploadedVertexCount - executedVertices));
+
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        if (m_vboSupported) {
+            s_glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+    }
+
+    SwapBuffers();
+}
+
+void ToolpathGLView::DrawAxes()
+{
+    float length = m_radius * 0.2f;
+    glBegin(GL_LINES);
+    glColor3ub(255, 0, 0);
+    glVertex3f(0, 0, 0);
+    glVertex3f(length, 0, 0);
+    glColor3ub(0, 200, 0);
+    glVertex3f(0, 0, 0);
+    glVertex3f(0, length, 0);
+    glColor3ub(0, 0, 255);
+    glVertex3f(0, 0, 0);
+    glVertex3f(0, 0, length);
+    glEnd();
+}
+
+ToolpathGLView::FrameTimings ToolpathGLView::RunBenchmark(int frames)
+{
+    FrameTimings timings;
+    if (frames <= 0 || !InitGL()) return timings;
+
+    float savedYaw = m_yaw;
+    double total = 0.0;
+    timings.minMs = 1e9;
+
+    for (int i = 0; i < frames; ++i) {
+        m_yaw = savedYaw + i * 3.0f;
+
+        wxStopWatch frameTimer;
+        Render();
+        glFinish();  // Include the rasterization, not just command submission
+        double elapsed = frameTimer.TimeInMicro().ToDouble() / 1000.0;
+
+        total += elapsed;
+        timings.minMs = std::min(timings.minMs, elapsed);
+        timings.maxMs = std::max(timings.maxMs, elapsed);
+    }
+
+    m_yaw = savedYaw;
+    timings.frames = frames;
+    timings.averageMs = total / frames;
+    Refresh(false);
+
+    LOG_INFO(wxString::Format("Toolpath 3D benchmark: %d frames, %zu vertices, avg %.2f ms, min %.2f ms, max %.2f ms",
+                             timings.frames, m_uploadedVertexCount,
+                             timings.averageMs, timings.minMs, timings.maxMs).ToStdString());
+    return timings;
+}
+
+void ToolpathGLView::OnPaint(wxPaintEvent& WXUNUSED(event))
+{
+    wxPaintDC dc(this);  // Required even though GL does the drawing
+    Render();
+}
+
+void ToolpathGLView::OnSize(wxSizeEvent& event)
+{
+    Refresh(false);
+    event.Skip();
+}
+
+void ToolpathGLView::OnMouseWheel(wxMouseEvent& event)
+{
+    m_zoom *= event.GetWheelRotation() > 0 ? 1.2f : 1.0f / 1.2f;
+    m_zoom = std::max(0.01f, std::min(1000.0f, m_zoom));
+    Refresh(false);
+}
+
+void ToolpathGLView::OnMouseDown(wxMouseEvent& event)
+{
+    SetFocus();
+    // Left drag orbits, right/middle drag pans
+    m_orbiting = event.LeftDown();
+    m_panning = !m_orbiting;
+    m_lastMousePos = event.GetPosition();
+    if (!HasCapture()) {
+        CaptureMouse();
+    }
+}
+
+void ToolpathGLView::OnMouseMove(wxMouseEvent& event)
+{
+    if (!event.Dragging() || (!m_orbiting && !m_panning)) return;
+
+    wxPoint delta = event.GetPosition() - m_lastMousePos;
+    m_lastMousePos = event.GetPosition();
+
+    if (m_orbiting) {
+        m_yaw += delta.x * 0.5f;
+        m_pitch = std::max(-180.0f, std::min(0.0f, m_pitch + delta.y * 0.5f));
+    } else {
+        // Convert pixels to view units at the current zoom
+        wxSize size = GetClientSize();
+        float unitsPerPixel = size.y > 0 ? static_cast<float>(m_radius * 2.4 / m_zoom / size.y) : 1.0f;
+        m_panX += delta.x * unitsPerPixel;
+        m_panY -= delta.y * unitsPerPixel;
+    }
+    Refresh(false);
+}
+
+void ToolpathGLView::OnMouseUp(wxMouseEvent& WXUNUSED(event))
+{
+    m_orbiting = m_panning = false;
+    if (HasCapture()) {
+        ReleaseMouse();
+    }
+}
+
+void ToolpathGLView::OnKeyDown(wxKeyEvent& event)
+{
+    switch (event.GetKeyCode()) {
+        case 'R':
+            ResetCamera();
+            break;
+        case 'B': {
+            FrameTimings timings = RunBenchmark();
+            NOTIFY_INFO("3D View Benchmark",
+                        wxString::Format("%d frames: avg %.2f ms (%.0f fps), min %.2f ms, max %.2f ms",
+                                         timings.frames, timings.averageMs,
+                                         timings.averageMs > 0 ? 1000.0 / timings.averageMs : 0.0,
+                                         timings.minMs, timings.maxMs));
+            break;
+        }
+        case 'V':
+            if (m_closeCallback) {
+                m_closeCallback();
+            }
+            break;
+        case '+':
+        case '=':
+            m_zoom *= 1.5f;
+            Refresh(false);
+            break;
+        case '-':
+        case '_':
+            m_zoom /= 1.5f;
+            Refresh(false);
+            break;
+        default:
+            event.Skip();
+            break;
+    }
+}
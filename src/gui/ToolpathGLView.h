@@ -0,0 +1,97 @@
+/**
+ * gui/ToolpathGLView.h
+ * Optional OpenGL 3D toolpath view
+ * The toolpath is uploaded once as a vertex buffer (client-side arrays when
+ * buffer objects are unavailable) and drawn with two range draws - executed
+ * and pending - so orbiting a large program costs no CPU work per segment.
+ * Uses only the fixed-function pipeline so it also runs on software
+ * rasterizers such as Mesa's llvmpipe.
+ */
+
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/glcanvas.h>
+#include <functional>
+#include <vector>
+#include "MachineVisualizationPanel.h"
+
+class ToolpathGLView : public wxGLCanvas
+{
+public:
+    struct FrameTimings {
+        int frames = 0;
+        double averageMs = 0.0;
+        double minMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    ToolpathGLView(wxWindow* parent);
+    ~ToolpathGLView();
+
+    // Geometry - colored by depth, rapids drawn in grey
+    void SetToolpath(const std::vector<GCodeLine>& lines,
+                     float minX, float maxX, float minY, float maxY, float minZ, float maxZ);
+    void ClearToolpath();
+
+    // Segments [0, count) are drawn in the executed color
+    void SetExecutedSegments(size_t count);
+
+    void ResetCamera();
+
+    // Renders 'frames' frames while orbiting and reports the frame times
+    FrameTimings RunBenchmark(int frames = 120);
+
+    // Called when the user asks to leave the 3D view ('V')
+    void SetCloseCallback(std::function<void()> callback) { m_closeCallback = callback; }
+
+private:
+    struct Vertex {
+        float x, y, z;
+        unsigned char r, g, b, a;
+    };
+
+    void OnPaint(wxPaintEvent& event);
+    void OnSize(wxSizeEvent& event);
+    void OnMouseWheel(wxMouseEvent& event);
+    void OnMouseDown(wxMouseEvent& event);
+    void OnMouseMove(wxMouseEvent& event);
+    void OnMouseUp(wxMouseEvent& event);
+    void OnKeyDown(wxKeyEvent& event);
+
+    bool InitGL();
+    void UploadGeometry();
+    void Render();
+    void DrawAxes();
+    void AddLine(const Vertex& start, const Vertex& end);
+    Vertex MakeVertex(float x, float y, float z, bool isRapid) const;
+
+    wxGLContext* m_context;
+    bool m_glInitialized;
+    bool m_vboSupported;
+    unsigned int m_vbo;
+    bool m_geometryDirty;
+
+    // Line list (vertex pairs); kept for the client-array fallback
+    std::vector<Vertex> m_vertices;
+    std::vector<size_t> m_segmentVertexEnd;  // Vertex count up to and including each segment
+    size_t m_uploadedVertexCount;
+    size_t m_executedSegments;
+
+    // Program bounds
+    float m_minZ, m_maxZ;
+    float m_centerX, m_centerY, m_centerZ;
+    float m_radius;
+
+    // Camera (orthographic)
+    float m_yaw, m_pitch;
+    float m_zoom;
+    float m_panX, m_panY;
+    bool m_orbiting;
+    bool m_panning;
+    wxPoint m_lastMousePos;
+
+    std::function<void()> m_closeCallback;
+
+    wxDECLARE_EVENT_TABLE();
+};
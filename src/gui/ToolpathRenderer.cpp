@@ -0,0 +1,471 @@
+/**
+ * gui/ToolpathRenderer.cpp
+ * Toolpath renderer implementation
+ */
+
+#include "ToolpathRenderer.h"
+#include "core/GCodeParser.h"
+#include <algorithm>
+#include <cmath>
+
+GCodeLine ToolpathRenderer::MakeLine(const ToolpathSegment& segment)
+{
+    GCodeLine gcLine;
+    gcLine.startX = static_cast<float>(segment.start.x);
+    gcLine.startY = static_cast<float>(segment.start.y);
+    gcLine.startZ = static_cast<float>(segment.start.z);
+    gcLine.endX = static_cast<float>(segment.end.x);
+    gcLine.endY = static_cast<float>(segment.end.y);
+    gcLine.endZ = static_cast<float>(segment.end.z);
+    gcLine.lineNumber = segment.lineNumber;
+
+    // Set color and style based on segment type
+    switch (segment.type) {
+        case ToolpathSegment::RAPID:
+            gcLine.type = GCodeLine::LINE;
+            gcLine.isRapid = true;
+            gcLine.color = wxColour(255, 0, 0); // Red for rapid moves
+            gcLine.renderClass = GCodeLine::RENDER_RAPID;
+            break;
+        case ToolpathSegment::LINEAR:
+            gcLine.type = GCodeLine::LINE;
+            gcLine.isRapid = false;
+            gcLine.color = wxColour(0, 100, 255); // Blue for cutting moves
+            gcLine.renderClass = GCodeLine::RENDER_FEED;
+            break;
+        case ToolpathSegment::ARC_CW:
+            gcLine.type = GCodeLine::ARC;
+            gcLine.centerX = static_cast<float>(segment.center.x);
+            gcLine.centerY = static_cast<float>(segment.center.y);
+            gcLine.radius = static_cast<float>(segment.radius);
+            gcLine.isClockwise = true;
+            gcLine.isRapid = false;
+            gcLine.color = wxColour(0, 150, 0); // Green for arcs
+            gcLine.renderClass = GCodeLine::RENDER_ARC;
+            break;
+        case ToolpathSegment::ARC_CCW:
+            gcLine.type = GCodeLine::ARC;
+            gcLine.centerX = static_cast<float>(segment.center.x);
+            gcLine.centerY = static_cast<float>(segment.center.y);
+            gcLine.radius = static_cast<float>(segment.radius);
+            gcLine.isClockwise = false;
+            gcLine.isRapid = false;
+            gcLine.color = wxColour(0, 150, 0); // Green for arcs
+            gcLine.renderClass = GCodeLine::RENDER_ARC;
+            break;
+        case ToolpathSegment::DRILL_CYCLE:
+            gcLine.type = GCodeLine::LINE;
+            gcLine.isRapid = false;
+            gcLine.color = wxColour(255, 165, 0); // Orange for drilling
+            gcLine.renderClass = GCodeLine::RENDER_DRILL;
+            break;
+    }
+
+    return gcLine;
+}
+
+bool ToolpathRenderer::ParseToolpath(const std::string& gcode, std::vector<GCodeLine>& lines)
+{
+    GCodeParser parser;
+    parser.enableStatistics(false);
+    parser.enableToolpathGeneration(true);
+    parser.setStrictMode(false);
+
+    bool success = parser.parseString(gcode);
+
+    const auto& toolpath = parser.getToolpath();
+    lines.clear();
+    lines.reserve(toolpath.size());
+    for (const auto& segment : toolpath) {
+        lines.push_back(MakeLine(segment));
+    }
+
+    return success;
+}
+
+ToolpathBounds ToolpathRenderer::ComputeBounds(const std::vector<GCodeLine>& lines)
+{
+    ToolpathBounds bounds;
+    if (lines.empty()) return bounds;
+
+    bounds.minX = bounds.maxX = lines.front().startX;
+    bounds.minY = bounds.maxY = lines.front().startY;
+    bounds.minZ = bounds.maxZ = lines.front().startZ;
+    bounds.valid = true;
+
+    auto include = [&bounds](float x, float y, float z) {
+        bounds.minX = std::min(bounds.minX, x);
+        bounds.maxX = std::max(bounds.maxX, x);
+        bounds.minY = std::min(bounds.minY, y);
+        bounds.maxY = std::max(bounds.maxY, y);
+        bounds.minZ = std::min(bounds.minZ, z);
+        bounds.maxZ = std::max(bounds.maxZ, z);
+    };
+
+    for (const auto& line : lines) {
+        include(line.startX, line.startY, line.startZ);
+        include(line.endX, line.endY, line.endZ);
+        if (line.type == GCodeLine::ARC) {
+            include(line.centerX - line.radius, line.centerY - line.radius, line.endZ);
+            include(line.centerX + line.radius, line.centerY + line.radius, line.endZ);
+        }
+    }
+
+    return bounds;
+}
+
+double GetArcSweep(const GCodeLine& line, double& startAngle)
+{
+    startAngle = std::atan2(line.startY - line.centerY, line.startX - line.centerX);
+    double endAngle = std::atan2(line.endY - line.centerY, line.endX - line.centerX);
+
+    // Calculate sweep angle based on direction
+    double sweepAngle;
+    if (line.isClockwise) {
+        sweepAngle = startAngle - endAngle;
+        if (sweepAngle <= 0) sweepAngle += 2 * M_PI;
+        sweepAngle = -sweepAngle; // Negative for clockwise
+    } else {
+        sweepAngle = endAngle - startAngle;
+        if (sweepAngle <= 0) sweepAngle += 2 * M_PI;
+    }
+
+    // Handle full circles
+    if (std::abs(line.startX - line.endX) < 0.001f && std::abs(line.startY - line.endY) < 0.001f) {
+        sweepAngle = line.isClockwise ? -2 * M_PI : 2 * M_PI;
+    }
+
+    return sweepAngle;
+}
+
+ToolpathRenderer::ToolpathRenderer(const std::vector<GCodeLine>* lines, const ToolpathLOD* lod)
+    : m_lines(lines)
+    , m_lod(lod)
+    , m_pathBatchesValid(false)
+    , m_lastLevel(-1)
+{
+}
+
+void ToolpathRenderer::SetToolpath(const std::vector<GCodeLine>* lines, const ToolpathLOD* lod)
+{
+    m_lines = lines;
+    m_lod = lod;
+    Invalidate();
+}
+
+void ToolpathRenderer::Invalidate()
+{
+    for (auto& batch : m_pathBatches) {
+        batch.paths.clear();
+    }
+    m_pathBatchesValid = false;
+    InvalidateLevels();
+}
+
+void ToolpathRenderer::InvalidateLevels()
+{
+    m_levelPaths.clear();
+    m_lastLevel = -1;
+}
+
+wxImage ToolpathRenderer::RenderImage(const std::vector<GCodeLine>& lines, const wxSize& size,
+                                      const wxColour& background, int margin)
+{
+    return RenderImage(lines, ComputeBounds(lines), size, background, margin);
+}
+
+wxImage ToolpathRenderer::RenderImage(const std::vector<GCodeLine>& lines, const ToolpathBounds& bounds,
+                                      const wxSize& size, const wxColour& background, int margin)
+{
+    wxImage image(size.x, size.y, false);
+    if (!image.IsOk()) return image;
+
+    unsigned char* data = image.GetData();
+    const size_t pixels = static_cast<size_t>(size.x) * size.y;
+    for (size_t i = 0; i < pixels; ++i) {
+        data[i * 3] = background.Red();
+        data[i * 3 + 1] = background.Green();
+        data[i * 3 + 2] = background.Blue();
+    }
+
+    if (lines.empty() || !bounds.valid) return image;
+
+    // The context writes into the image when it is destroyed
+    wxGraphicsContext* gc = wxGraphicsContext::Create(image);
+    if (!gc) return image;
+
+    // Fit the program into the image keeping its aspect ratio, Y axis up
+    double spanX = std::max(static_cast<double>(bounds.maxX - bounds.minX), 1e-6);
+    double spanY = std::max(static_cast<double>(bounds.maxY - bounds.minY), 1e-6);
+    double usableX = std::max(size.x - 2 * margin, 1);
+    double usableY = std::max(size.y - 2 * margin, 1);
+    double scale = std::min(usableX / spanX, usableY / spanY);
+    gc->Translate(margin + (usableX - spanX * scale) / 2.0, size.y - margin - (usableY - spanY * scale) / 2.0);
+    gc->Scale(scale, -scale);
+    gc->Translate(-bounds.minX, -bounds.minY);
+
+    // Full detail: a thumbnail is drawn once, building levels would cost more
+    ToolpathRenderer renderer(&lines);
+    renderer.Draw(gc, scale);
+    delete gc;
+
+    return image;
+}
+
+void ToolpathRenderer::SetupBatchPens(PathBatch* batches)
+{
+    batches[GCodeLine::RENDER_RAPID].pen = wxPen(wxColour(255, 0, 0), 1);
+    batches[GCodeLine::RENDER_FEED].pen = wxPen(wxColour(0, 100, 255), 2);
+    batches[GCodeLine::RENDER_ARC].pen = wxPen(wxColour(0, 150, 0), 2);
+    batches[GCodeLine::RENDER_DRILL].pen = wxPen(wxColour(255, 165, 0), 2);
+}
+
+void ToolpathRenderer::BuildPathBatches(wxGraphicsContext* gc)
+{
+    for (auto& batch : m_pathBatches) {
+        batch.paths.clear();
+    }
+
+    SetupBatchPens(m_pathBatches);
+
+    // Per class: the path being filled, its segment count and its current point
+    struct Builder {
+        wxGraphicsPath path;
+        size_t segments = 0;
+        bool open = false;
+        float lastX = 0.0f, lastY = 0.0f;
+    };
+    Builder builders[GCodeLine::RENDER_CLASS_COUNT];
+
+    for (const auto& line : *m_lines) {
+        PathBatch& batch = m_pathBatches[line.renderClass];
+        Builder& builder = builders[line.renderClass];
+
+        if (builder.open && builder.segments >= SEGMENTS_PER_PATH) {
+            batch.paths.push_back(builder.path);
+            builder.open = false;
+        }
+        if (!builder.open) {
+            builder.path = gc->CreatePath();
+            builder.segments = 0;
+            builder.open = true;
+        }
+
+        // Continuous moves extend the current subpath instead of starting a new one
+        if (builder.segments == 0 || builder.lastX != line.startX || builder.lastY != line.startY) {
+            builder.path.MoveToPoint(line.startX, line.startY);
+        }
+
+        if (line.type == GCodeLine::ARC && line.radius > 0) {
+            double startAngle;
+            double sweepAngle = GetArcSweep(line, startAngle);
+            builder.path.AddArc(line.centerX, line.centerY, line.radius,
+                                startAngle, startAngle + sweepAngle, !line.isClockwise);
+        } else {
+            // Straight move (or arc with an invalid radius)
+            builder.path.AddLineToPoint(line.endX, line.endY);
+        }
+
+        builder.segments++;
+        builder.lastX = line.endX;
+        builder.lastY = line.endY;
+    }
+
+    for (int i = 0; i < GCodeLine::RENDER_CLASS_COUNT; ++i) {
+        if (builders[i].open) {
+            m_pathBatches[i].paths.push_back(builders[i].path);
+        }
+    }
+
+    m_pathBatchesValid = true;
+}
+
+void ToolpathRenderer::BuildLevelPaths(wxGraphicsContext* gc, int levelIndex)
+{
+    const LODLevel& level = m_lod->getLevels()[levelIndex];
+    LevelPaths& levelPaths = m_levelPaths[levelIndex];
+
+    SetupBatchPens(levelPaths.batches);
+
+    wxGraphicsPath paths[GCodeLine::RENDER_CLASS_COUNT];
+    size_t segments[GCodeLine::RENDER_CLASS_COUNT] = {};
+
+    for (const auto& polyline : level.polylines) {
+        if (polyline.points.size() < 2) continue;
+
+        int renderClass = polyline.renderClass;
+        if (segments[renderClass] == 0) {
+            paths[renderClass] = gc->CreatePath();
+        }
+
+        wxGraphicsPath& path = paths[renderClass];
+        path.MoveToPoint(polyline.points[0].x, polyline.points[0].y);
+        for (size_t i = 1; i < polyline.points.size(); ++i) {
+            path.AddLineToPoint(polyline.points[i].x, polyline.points[i].y);
+        }
+
+        segments[renderClass] += polyline.points.size() - 1;
+        if (segments[renderClass] >= SEGMENTS_PER_PATH) {
+            levelPaths.batches[renderClass].paths.push_back(path);
+            segments[renderClass] = 0;
+        }
+    }
+
+    for (int i = 0; i < GCodeLine::RENDER_CLASS_COUNT; ++i) {
+        if (segments[i] > 0) {
+            levelPaths.batches[i].paths.push_back(paths[i]);
+        }
+    }
+
+    levelPaths.valid = true;
+}
+
+void ToolpathRenderer::StrokeBatches(wxGraphicsContext* gc, const PathBatch* batches)
+{
+    // One pen change per render class, one stroke per path chunk
+    for (int i = 0; i < GCodeLine::RENDER_CLASS_COUNT; ++i) {
+        if (batches[i].paths.empty()) continue;
+
+        gc->SetPen(batches[i].pen);
+        for (const auto& path : batches[i].paths) {
+            gc->StrokePath(path);
+        }
+    }
+}
+
+void ToolpathRenderer::Draw(wxGraphicsContext* gc, double pixelsPerUnit)
+{
+    m_lastLevel = -1;
+    if (!m_lines || m_lines->empty()) return;
+
+    // Coarsest level that stays within half a pixel of the real path
+    if (m_lod && pixelsPerUnit > 0.0) {
+        m_lastLevel = m_lod->selectLevel(0.5 / pixelsPerUnit);
+        if (m_levelPaths.size() != m_lod->getLevels().size()) {
+            m_levelPaths.assign(m_lod->getLevels().size(), LevelPaths());
+        }
+    }
+
+    if (m_lastLevel >= 0) {
+        if (!m_levelPaths[m_lastLevel].valid) {
+            BuildLevelPaths(gc, m_lastLevel);
+        }
+        StrokeBatches(gc, m_levelPaths[m_lastLevel].batches);
+        return;
+    }
+
+    if (!m_pathBatchesValid) {
+        BuildPathBatches(gc);
+    }
+    StrokeBatches(gc, m_pathBatches);
+}
+
+void ToolpathRenderer::DrawExecuted(wxGraphicsContext* gc, size_t first, size_t last, wxRect2DDouble* bounds)
+{
+    if (!m_lines) return;
+    last = std::min(last, m_lines->size());
+    if (first >= last) return;
+
+    // Zoomed out: the same simplified level as the pending path, so the cost
+    // stays bounded by the screen instead of the program size
+    if (m_lod && m_lastLevel >= 0 && m_lastLevel < static_cast<int>(m_lod->getLevels().size())) {
+        DrawExecutedLevel(gc, m_lod->getLevels()[m_lastLevel], first, last, bounds);
+        return;
+    }
+
+    // One path for the whole range, stroked once over the pending colors
+    wxGraphicsPath path = gc->CreatePath();
+    float minX = (*m_lines)[first].startX, maxX = minX;
+    float minY = (*m_lines)[first].startY, maxY = minY;
+    float lastX = 0.0f, lastY = 0.0f;
+
+    for (size_t i = first; i < last; ++i) {
+        const GCodeLine& line = (*m_lines)[i];
+
+        if (i == first || lastX != line.startX || lastY != line.startY) {
+            path.MoveToPoint(line.startX, line.startY);
+        }
+
+        if (line.type == GCodeLine::ARC && line.radius > 0) {
+            double startAngle;
+            double sweepAngle = GetArcSweep(line, startAngle);
+            path.AddArc(line.centerX, line.centerY, line.radius,
+                        startAngle, startAngle + sweepAngle, !line.isClockwise);
+            minX = std::min(minX, line.centerX - line.radius);
+            maxX = std::max(maxX, line.centerX + line.radius);
+            minY = std::min(minY, line.centerY - line.radius);
+            maxY = std::max(maxY, line.centerY + line.radius);
+        } else {
+            path.AddLineToPoint(line.endX, line.endY);
+        }
+
+        minX = std::min(minX, std::min(line.startX, line.endX));
+        maxX = std::max(maxX, std::max(line.startX, line.endX));
+        minY = std::min(minY, std::min(line.startY, line.endY));
+        maxY = std::max(maxY, std::max(line.startY, line.endY));
+        lastX = line.endX;
+        lastY = line.endY;
+    }
+
+    gc->SetPen(wxPen(wxColour(110, 110, 110), 2));
+    gc->StrokePath(path);
+
+    if (bounds) {
+        *bounds = wxRect2DDouble(minX, minY, maxX - minX, maxY - minY);
+    }
+}
+
+void ToolpathRenderer::DrawExecutedLevel(wxGraphicsContext* gc, const LODLevel& level,
+                                         size_t first, size_t last, wxRect2DDouble* bounds)
+{
+    // An edge is drawn once the move completing its end point is executed, so
+    // a simplified edge covering several moves follows when the last of them is
+    // done. Polylines and their points are in program order.
+    auto it = std::partition_point(level.polylines.begin(), level.polylines.end(),
+        [first](const LODPolyline& polyline) {
+            return polyline.points.empty() || polyline.points.back().segment <= first;
+        });
+
+    wxGraphicsPath path = gc->CreatePath();
+    bool empty = true;
+    float minX = 0.0f, maxX = 0.0f, minY = 0.0f, maxY = 0.0f;
+    auto extend = [&](const LODPoint& point) {
+        if (empty) {
+            minX = maxX = point.x;
+            minY = maxY = point.y;
+            empty = false;
+        }
+        minX = std::min(minX, point.x);
+        maxX = std::max(maxX, point.x);
+        minY = std::min(minY, point.y);
+        maxY = std::max(maxY, point.y);
+    };
+
+    for (; it != level.polylines.end(); ++it) {
+        const auto& points = it->points;
+        if (points.size() < 2) continue;
+        if (points.front().segment >= last) break;
+
+        // First edge ending after 'first'
+        size_t i = static_cast<size_t>(std::partition_point(points.begin() + 1, points.end(),
+            [first](const LODPoint& point) { return point.segment <= first; }) - points.begin());
+        if (i >= points.size() || points[i].segment > last) break;
+
+        path.MoveToPoint(points[i - 1].x, points[i - 1].y);
+        extend(points[i - 1]);
+        for (; i < points.size() && points[i].segment <= last; ++i) {
+            path.AddLineToPoint(points[i].x, points[i].y);
+            extend(points[i]);
+        }
+        if (i < points.size()) break;
+    }
+
+    if (empty) return;
+
+    gc->SetPen(wxPen(wxColour(110, 110, 110), 2));
+    gc->StrokePath(path);
+
+    if (bounds) {
+        *bounds = wxRect2DDouble(minX, minY, maxX - minX, maxY - minY);
+    }
+}
@@ -0,0 +1,127 @@
+/**
+ * gui/ToolpathRenderer.h
+ * Toolpath drawing shared by the visualization panel and offscreen images
+ * The moves are batched into a few graphics paths per render class, built
+ * once per program and stroked with one pen change per class; zoomed out, a
+ * simplified level of detail is stroked instead. The panel draws through it
+ * into its cached layer, and RenderImage() runs the same code on a
+ * wxGraphicsContext over a wxImage, which needs no window (thumbnails,
+ * headless paint timing).
+ */
+
+#pragma once
+
+#include <wx/wx.h>
+#include <wx/graphics.h>
+#include <wx/image.h>
+#include <string>
+#include <vector>
+#include "core/ToolpathLOD.h"
+
+struct ToolpathSegment;
+
+struct GCodeLine {
+    enum Type {
+        LINE,
+        ARC
+    };
+
+    // Segments sharing a render class are stroked together with one pen
+    enum RenderClass {
+        RENDER_RAPID,
+        RENDER_FEED,
+        RENDER_ARC,
+        RENDER_DRILL,
+        RENDER_CLASS_COUNT
+    };
+
+    Type type = LINE;
+    RenderClass renderClass = RENDER_FEED;
+    float startX, startY, startZ;
+    float endX, endY, endZ;
+
+    // Arc-specific data
+    float centerX = 0.0f, centerY = 0.0f;
+    float radius = 0.0f;
+    bool isClockwise = true;
+
+    bool isRapid; // G0 rapid move vs G1 feed move
+    wxColour color;
+    int lineNumber = 0; // Source line the segment came from (1-based)
+};
+
+// Start angle and signed sweep (radians) of an arc segment
+double GetArcSweep(const GCodeLine& line, double& startAngle);
+
+struct ToolpathBounds {
+    float minX = 0.0f, maxX = 0.0f;
+    float minY = 0.0f, maxY = 0.0f;
+    float minZ = 0.0f, maxZ = 0.0f;
+    bool valid = false;
+};
+
+class ToolpathRenderer
+{
+public:
+    // Visualization line for one parsed segment (type, render class and color)
+    static GCodeLine MakeLine(const ToolpathSegment& segment);
+
+    // Parses a program into visualization lines without any logging or
+    // callbacks. Returns false when the parser reported errors; the lines
+    // that could be parsed are still returned.
+    static bool ParseToolpath(const std::string& gcode, std::vector<GCodeLine>& lines);
+
+    // XY extent of the lines, arcs included
+    static ToolpathBounds ComputeBounds(const std::vector<GCodeLine>& lines);
+
+    // Offscreen target: the lines scaled to fit a new image, Y up
+    static wxImage RenderImage(const std::vector<GCodeLine>& lines, const wxSize& size,
+                               const wxColour& background = wxColour(240, 240, 240), int margin = 4);
+    static wxImage RenderImage(const std::vector<GCodeLine>& lines, const ToolpathBounds& bounds, const wxSize& size,
+                               const wxColour& background, int margin);
+
+    // The lines and levels (either may be null) are read when drawing, so
+    // they must stay alive; call Invalidate() after changing them
+    ToolpathRenderer(const std::vector<GCodeLine>* lines = nullptr, const ToolpathLOD* lod = nullptr);
+    void SetToolpath(const std::vector<GCodeLine>* lines, const ToolpathLOD* lod);
+    void Invalidate();
+    void InvalidateLevels();
+
+    // Strokes the toolpath through a context whose transform maps program
+    // units to device pixels at 'pixelsPerUnit', using the coarsest level
+    // that stays within half a pixel of the real path
+    void Draw(wxGraphicsContext* gc, double pixelsPerUnit);
+
+    // Strokes moves [first, last) in the executed colour at the level of the
+    // last Draw(); 'bounds' receives the program-unit area they cover
+    void DrawExecuted(wxGraphicsContext* gc, size_t first, size_t last, wxRect2DDouble* bounds = nullptr);
+
+    // Level used by the last Draw(), -1 for full detail
+    int GetLastLevel() const { return m_lastLevel; }
+    bool IsBatched() const { return m_pathBatchesValid; }
+
+private:
+    struct PathBatch {
+        wxPen pen;
+        std::vector<wxGraphicsPath> paths;  // Chunked so no single path grows unbounded
+    };
+    struct LevelPaths {
+        PathBatch batches[GCodeLine::RENDER_CLASS_COUNT];
+        bool valid = false;
+    };
+
+    static void SetupBatchPens(PathBatch* batches);
+    static void StrokeBatches(wxGraphicsContext* gc, const PathBatch* batches);
+    void BuildPathBatches(wxGraphicsContext* gc);
+    void BuildLevelPaths(wxGraphicsContext* gc, int levelIndex);
+    void DrawExecutedLevel(wxGraphicsContext* gc, const LODLevel& level, size_t first, size_t last, wxRect2DDouble* bounds);
+
+    static const size_t SEGMENTS_PER_PATH = 50000;
+
+    const std::vector<GCodeLine>* m_lines;
+    const ToolpathLOD* m_lod;
+    PathBatch m_pathBatches[GCodeLine::RENDER_CLASS_COUNT];
+    bool m_pathBatchesValid;
+    std::vector<LevelPaths> m_levelPaths;  // Parallel to the levels of m_lod
+    int m_lastLevel;
+};
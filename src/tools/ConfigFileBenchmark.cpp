@@ -0,0 +1,143 @@
+/**
+ * tools/ConfigFileBenchmark.cpp
+ * Save and load times of a settings file in JSON and CBOR format
+ * Builds a settings.json shaped like StateManager's (machines, job profiles,
+ * window layouts), then saves and loads it through ConfigFile in both
+ * formats. Each figure is the mean of several runs and includes the file
+ * I/O. Built with -DBUILD_CONFIG_BENCHMARK=ON.
+ *
+ * Usage: ConfigFileBenchmark [machines] [profiles] [layouts] [runs]
+ */
+
+#include "ConfigFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+nlohmann::json MakeSettings(int machines, int profiles, int layouts)
+{
+    nlohmann::json data = nlohmann::json::object();
+    data["activeMachine"] = "machine1";
+    data["machines"] = nlohmann::json::array();
+    data["jobProfiles"] = nlohmann::json::array();
+    data["windowLayouts"] = nlohmann::json::array();
+
+    for (int i = 0; i < machines; i++) {
+        nlohmann::json settings;
+        settings["maxFeedRate"] = {{"x", 5000.0 + i}, {"y", 5000.0 + i}, {"z", 1000.0}};
+        settings["acceleration"] = {{"x", 200.0}, {"y", 200.0}, {"z", 50.0}};
+        settings["travel"] = {{"x", 800.0}, {"y", 600.0}, {"z", 120.0}};
+        settings["homing"] = {{"enabled", true}, {"sequence", "Z->X->Y"}, {"feedRate", 500.0}};
+        data["machines"].push_back({
+            {"name", "Machine " + std::to_string(i + 1)},
+            {"id", "machine" + std::to_string(i + 1)},
+            {"type", "Telnet"},
+            {"host", "192.168.1." + std::to_string(i % 250 + 2)},
+            {"port", 23},
+            {"device", ""},
+            {"baudRate", 115200},
+            {"autoConnect", i == 0},
+            {"machineSettings", settings}
+        });
+    }
+
+    for (int i = 0; i < profiles; i++) {
+        data["jobProfiles"].push_back({
+            {"name", "Profile " + std::to_string(i + 1)},
+            {"feedRate", 800.0 + i},
+            {"spindleSpeed", 12000.0},
+            {"safeZ", 5.0},
+            {"workZ", -1.5},
+            {"depthPerPass", 0.5},
+            {"material", i % 2 ? "Aluminium" : "Wood"},
+            {"toolType", "End Mill"},
+            {"toolDiameter", 3.175}
+        });
+    }
+
+    for (int i = 0; i < layouts; i++) {
+        data["windowLayouts"].push_back({
+            {"windowId", "panel" + std::to_string(i)},
+            {"x", 10 * i}, {"y", 20 * i}, {"width", 400}, {"height", 300},
+            {"visible", true}, {"docked", true}, {"maximized", false},
+            {"dockingSide", "left"}
+        });
+    }
+    return data;
+}
+
+double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool Measure(const std::filesystem::path& jsonPath, ConfigFile::Format format,
+             const nlohmann::json& data, int runs)
+{
+    ConfigFile::setFormat(format);
+    std::string error;
+
+    double saveMs = 0.0;
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!ConfigFile::save(jsonPath, data, &error)) {
+            std::fprintf(stderr, "Save failed: %s\n", error.c_str());
+            return false;
+        }
+        saveMs += Milliseconds(start);
+    }
+
+    double loadMs = 0.0;
+    for (int run = 0; run < runs; run++) {
+        nlohmann::json loaded;
+        ConfigFile::Format loadedFrom;
+        auto start = std::chrono::steady_clock::now();
+        if (!ConfigFile::load(jsonPath, loaded, &error, &loadedFrom)) {
+            std::fprintf(stderr, "Load failed: %s\n", error.c_str());
+            return false;
+        }
+        loadMs += Milliseconds(start);
+        if (loadedFrom != format || loaded != data) {
+            std::fprintf(stderr, "Load returned different data\n");
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::path written = format == ConfigFile::Format::CBOR ? ConfigFile::binaryPath(jsonPath) : jsonPath;
+    auto bytes = std::filesystem::file_size(written, ec);
+    std::printf("%-5s %7.0f KB  save %6.2f ms  load %6.2f ms\n", ConfigFile::formatName(format),
+                ec ? 0.0 : bytes / 1024.0, saveMs / runs, loadMs / runs);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int machines = argc > 1 ? std::atoi(argv[1]) : 400;
+    int profiles = argc > 2 ? std::atoi(argv[2]) : 300;
+    int layouts = argc > 3 ? std::atoi(argv[3]) : 20;
+    int runs = argc > 4 ? std::max(1, std::atoi(argv[4])) : 20;
+
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(ec) / "config_file_benchmark";
+    std::filesystem::create_directories(dir, ec);
+    std::filesystem::path jsonPath = dir / "settings.json";
+
+    std::printf("%d machines, %d job profiles, %d layouts, mean of %d runs\n", machines, profiles, layouts, runs);
+    nlohmann::json data = MakeSettings(machines, profiles, layouts);
+
+    // JSON first, so the CBOR loads also find (and hash) a JSON file next to
+    // the binary copy, as after a normal shutdown
+    bool ok = Measure(jsonPath, ConfigFile::Format::JSON, data, runs)
+              && Measure(jsonPath, ConfigFile::Format::CBOR, data, runs);
+
+    std::filesystem::remove_all(dir, ec);
+    return ok ? 0 : 1;
+}